@@ -0,0 +1,429 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "BasicBlockAnalyzer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace CppCoverage
+{
+	namespace
+	{
+		const size_t NoBlock = std::numeric_limits<size_t>::max();
+
+		//---------------------------------------------------------------------
+		struct Instruction
+		{
+			uint64_t address_;
+			DecodedInstruction decodedInstruction_;
+		};
+
+		//---------------------------------------------------------------------
+		struct FunctionCode
+		{
+			std::vector<Instruction> instructions_;
+			std::vector<uint64_t> leaders_;
+			uint64_t codeEnd_;
+		};
+
+		//---------------------------------------------------------------------
+		struct Block
+		{
+			std::vector<size_t> successors_;
+			bool canLeaveFunction_ = false;
+			bool canBeInferred_ = false;
+			bool isReachable_ = false;
+			size_t immediateDominator_ = NoBlock;
+			size_t postOrderIndex_ = 0;
+			boost::optional<size_t> lineGroupIndex_;
+		};
+
+		//---------------------------------------------------------------------
+		bool Contains(const std::vector<uint64_t>& sortedValues, uint64_t value)
+		{
+			return std::binary_search(sortedValues.begin(), sortedValues.end(), value);
+		}
+
+		//---------------------------------------------------------------------
+		boost::optional<FunctionCode>
+		DecodeFunction(const InstructionDecoder& instructionDecoder,
+		               const std::vector<unsigned char>& code,
+		               uint64_t codeAddress,
+		               const std::vector<uint64_t>& lineAddresses)
+		{
+			const auto lastLineAddress = lineAddresses.back();
+			FunctionCode functionCode;
+			auto& leaders = functionCode.leaders_;
+			size_t offset = 0;
+
+			leaders.push_back(codeAddress);
+			while (offset < code.size())
+			{
+				auto instruction = instructionDecoder.Decode(code, offset, codeAddress);
+
+				// Targets of indirect branches (switch tables...) are unknown.
+				if (!instruction || instruction->kind_ == InstructionKind::IndirectBranch)
+					return boost::none;
+
+				const auto instructionAddress = codeAddress + offset;
+				functionCode.instructions_.push_back({instructionAddress, *instruction});
+				offset += instruction->length_;
+
+				if (instruction->target_)
+					leaders.push_back(*instruction->target_);
+				// A callee may not return (exception, exit...) so the instruction
+				// after a call is a leader like after a branch.
+				if (instruction->kind_ != InstructionKind::Sequential)
+					leaders.push_back(codeAddress + offset);
+
+				auto kind = instruction->kind_;
+				if (instructionAddress >= lastLineAddress &&
+				    (kind == InstructionKind::UnconditionalBranch ||
+				     kind == InstructionKind::Return || kind == InstructionKind::Trap))
+				{
+					break;
+				}
+			}
+			const auto codeEnd = codeAddress + offset;
+			functionCode.codeEnd_ = codeEnd;
+
+			leaders.erase(std::remove_if(leaders.begin(),
+			                             leaders.end(),
+			                             [&](uint64_t leader) {
+				                             return leader < codeAddress ||
+				                                    leader > codeEnd;
+			                             }),
+			              leaders.end());
+			std::sort(leaders.begin(), leaders.end());
+			leaders.erase(std::unique(leaders.begin(), leaders.end()), leaders.end());
+
+			// A line or a branch target in the middle of an instruction means
+			// the code was not decoded as executed.
+			std::vector<uint64_t> instructionAddresses;
+			instructionAddresses.reserve(functionCode.instructions_.size() + 1);
+			for (const auto& instruction : functionCode.instructions_)
+				instructionAddresses.push_back(instruction.address_);
+			instructionAddresses.push_back(codeEnd);
+
+			for (auto address : lineAddresses)
+			{
+				if (!Contains(instructionAddresses, address))
+					return boost::none;
+			}
+			for (auto leader : leaders)
+			{
+				if (!Contains(instructionAddresses, leader))
+					return boost::none;
+			}
+			return functionCode;
+		}
+
+		//---------------------------------------------------------------------
+		// Index in leaders of the block containing address. The last leader
+		// can be the end of the code which is not a block.
+		size_t GetBlockIndex(const std::vector<uint64_t>& leaders, uint64_t address)
+		{
+			return std::upper_bound(leaders.begin(), leaders.end(), address) -
+			       leaders.begin() - 1;
+		}
+
+		//---------------------------------------------------------------------
+		std::vector<Block> CreateBlocks(const FunctionCode& functionCode)
+		{
+			const auto& leaders = functionCode.leaders_;
+			const auto& instructions = functionCode.instructions_;
+			const auto codeEnd = functionCode.codeEnd_;
+			std::vector<Block> blocks(leaders.size() - (leaders.back() == codeEnd ? 1 : 0));
+			auto itInstruction = instructions.cbegin();
+
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				auto& block = blocks[i];
+				auto blockEnd = (i + 1 < leaders.size()) ? leaders[i + 1] : codeEnd;
+				while (itInstruction + 1 != instructions.cend() &&
+				       (itInstruction + 1)->address_ < blockEnd)
+				{
+					++itInstruction;
+				}
+
+				auto addSuccessor = [&](uint64_t address) {
+					if (address >= leaders.front() && address < codeEnd)
+						block.successors_.push_back(GetBlockIndex(leaders, address));
+					else
+						block.canLeaveFunction_ = true;
+				};
+				const auto& lastInstruction = itInstruction->decodedInstruction_;
+				switch (lastInstruction.kind_)
+				{
+				case InstructionKind::ConditionalBranch:
+					addSuccessor(*lastInstruction.target_);
+					addSuccessor(blockEnd);
+					block.canBeInferred_ = true;
+					break;
+				case InstructionKind::UnconditionalBranch:
+					addSuccessor(*lastInstruction.target_);
+					block.canBeInferred_ = true;
+					break;
+				case InstructionKind::Sequential:
+					addSuccessor(blockEnd);
+					block.canBeInferred_ = true;
+					break;
+				case InstructionKind::Call:
+					addSuccessor(blockEnd);
+					break;
+				default:
+					break;
+				}
+			}
+			return blocks;
+		}
+
+		//---------------------------------------------------------------------
+		// Return the reachable blocks in post order.
+		std::vector<size_t> ComputePostOrder(std::vector<Block>& blocks)
+		{
+			std::vector<size_t> postOrder;
+			std::vector<std::pair<size_t, size_t>> stack{{0, 0}};
+
+			blocks[0].isReachable_ = true;
+			while (!stack.empty())
+			{
+				auto& top = stack.back();
+				const auto& successors = blocks[top.first].successors_;
+				if (top.second < successors.size())
+				{
+					auto successor = successors[top.second++];
+					if (!blocks[successor].isReachable_)
+					{
+						blocks[successor].isReachable_ = true;
+						stack.push_back({successor, 0});
+					}
+				}
+				else
+				{
+					blocks[top.first].postOrderIndex_ = postOrder.size();
+					postOrder.push_back(top.first);
+					stack.pop_back();
+				}
+			}
+			return postOrder;
+		}
+
+		//---------------------------------------------------------------------
+		// "A Simple, Fast Dominance Algorithm" from Cooper, Harvey and Kennedy.
+		void ComputeDominators(std::vector<Block>& blocks,
+		                       const std::vector<size_t>& postOrder)
+		{
+			std::vector<std::vector<size_t>> predecessors(blocks.size());
+			for (auto blockIndex : postOrder)
+			{
+				for (auto successor : blocks[blockIndex].successors_)
+					predecessors[successor].push_back(blockIndex);
+			}
+
+			auto intersect = [&](size_t block1, size_t block2) {
+				while (block1 != block2)
+				{
+					while (blocks[block1].postOrderIndex_ < blocks[block2].postOrderIndex_)
+						block1 = blocks[block1].immediateDominator_;
+					while (blocks[block2].postOrderIndex_ < blocks[block1].postOrderIndex_)
+						block2 = blocks[block2].immediateDominator_;
+				}
+				return block1;
+			};
+
+			blocks[0].immediateDominator_ = 0;
+			for (bool hasChanged = true; hasChanged;)
+			{
+				hasChanged = false;
+				for (auto it = postOrder.rbegin(); it != postOrder.rend(); ++it)
+				{
+					if (*it == 0)
+						continue;
+					auto immediateDominator = NoBlock;
+					for (auto predecessor : predecessors[*it])
+					{
+						if (blocks[predecessor].immediateDominator_ == NoBlock)
+							continue;
+						immediateDominator =
+						    (immediateDominator == NoBlock)
+						        ? predecessor
+						        : intersect(predecessor, immediateDominator);
+					}
+					if (blocks[*it].immediateDominator_ != immediateDominator)
+					{
+						blocks[*it].immediateDominator_ = immediateDominator;
+						hasChanged = true;
+					}
+				}
+			}
+		}
+
+		//---------------------------------------------------------------------
+		bool StrictlyDominates(const std::vector<Block>& blocks,
+		                       size_t dominator,
+		                       size_t blockIndex)
+		{
+			while (blockIndex != 0)
+			{
+				blockIndex = blocks[blockIndex].immediateDominator_;
+				if (blockIndex == dominator)
+					return true;
+			}
+			return false;
+		}
+
+		//---------------------------------------------------------------------
+		std::vector<size_t> GetLineGroupFirstIndexes(
+		    const std::vector<uint64_t>& leaders,
+		    const std::vector<uint64_t>& lineAddresses)
+		{
+			// A new group starts if there is a leader in
+			// ]previous line address, address].
+			std::vector<size_t> firstIndexes;
+			auto itLeader = leaders.begin();
+			for (size_t i = 0; i < lineAddresses.size(); ++i)
+			{
+				bool isNewGroup = firstIndexes.empty();
+				while (itLeader != leaders.end() && *itLeader <= lineAddresses[i])
+				{
+					isNewGroup = true;
+					++itLeader;
+				}
+				firstIndexes.push_back(isNewGroup ? i : firstIndexes.back());
+			}
+			return firstIndexes;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	BasicBlockAnalyzer::BasicBlockAnalyzer(bool is64Bit)
+	    : instructionDecoder_{is64Bit}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	boost::optional<std::vector<uint64_t>>
+	BasicBlockAnalyzer::GetBlockFirstLineAddresses(
+	    const std::vector<unsigned char>& code,
+	    uint64_t codeAddress,
+	    const std::vector<uint64_t>& lineAddresses) const
+	{
+		auto functionCode =
+		    DecodeFunction(instructionDecoder_, code, codeAddress, lineAddresses);
+		if (!functionCode)
+			return boost::none;
+
+		std::vector<uint64_t> blockFirstLineAddresses;
+		blockFirstLineAddresses.reserve(lineAddresses.size());
+		for (auto index :
+		     GetLineGroupFirstIndexes(functionCode->leaders_, lineAddresses))
+		{
+			blockFirstLineAddresses.push_back(lineAddresses[index]);
+		}
+		return blockFirstLineAddresses;
+	}
+
+	//-------------------------------------------------------------------------
+	boost::optional<std::vector<LineBlock>>
+	BasicBlockAnalyzer::GetLineBlocks(
+	    const std::vector<unsigned char>& code,
+	    uint64_t codeAddress,
+	    const std::vector<uint64_t>& lineAddresses,
+	    const std::vector<uint64_t>& monitoredLineAddresses) const
+	{
+		auto functionCode =
+		    DecodeFunction(instructionDecoder_, code, codeAddress, lineAddresses);
+		if (!functionCode)
+			return boost::none;
+
+		const auto& leaders = functionCode->leaders_;
+		auto blocks = CreateBlocks(*functionCode);
+		std::vector<size_t> postOrder;
+		if (!blocks.empty())
+		{
+			postOrder = ComputePostOrder(blocks);
+			ComputeDominators(blocks, postOrder);
+		}
+
+		// Lines at the end of the code are not in a block.
+		auto getBlock = [&](uint64_t lineAddress) -> Block* {
+			if (lineAddress >= functionCode->codeEnd_)
+				return nullptr;
+			return &blocks[GetBlockIndex(leaders, lineAddress)];
+		};
+
+		// The lines of a group are in the same block. A group without
+		// monitored line has no breakpoint.
+		auto firstIndexes = GetLineGroupFirstIndexes(leaders, lineAddresses);
+		for (size_t i = 0; i < firstIndexes.size(); ++i)
+		{
+			auto* block = getBlock(lineAddresses[i]);
+			if (block && Contains(monitoredLineAddresses, lineAddresses[i]))
+				block->lineGroupIndex_ = firstIndexes[i];
+		}
+
+		// A block is covered when it has a line group or when it is inferred.
+		// Blocks dominated by a block are before it in post order.
+		std::vector<bool> isCovered(blocks.size());
+		std::vector<bool> isInferred(blocks.size());
+		for (auto blockIndex : postOrder)
+		{
+			const auto& block = blocks[blockIndex];
+			isInferred[blockIndex] =
+			    block.canBeInferred_ && !block.canLeaveFunction_ &&
+			    !block.successors_.empty() &&
+			    std::all_of(block.successors_.begin(),
+			                block.successors_.end(),
+			                [&](size_t successor) {
+				                return isCovered[successor] &&
+				                       StrictlyDominates(blocks, blockIndex, successor);
+			                });
+			isCovered[blockIndex] = isInferred[blockIndex] || block.lineGroupIndex_;
+		}
+
+		std::vector<LineBlock> lineBlocks;
+		lineBlocks.reserve(lineAddresses.size());
+		for (size_t i = 0; i < lineAddresses.size(); ++i)
+		{
+			auto firstIndex = firstIndexes[i];
+			if (firstIndex != i)
+			{
+				lineBlocks.push_back(lineBlocks[firstIndex]);
+				continue;
+			}
+
+			LineBlock lineBlock{lineAddresses[i], false, boost::none};
+			auto* block = getBlock(lineAddresses[i]);
+			if (block && block->isReachable_)
+			{
+				auto blockIndex = static_cast<size_t>(block - blocks.data());
+				lineBlock.isInferred_ = isInferred[blockIndex];
+				while (blockIndex != 0 && !lineBlock.dominatorAddress_)
+				{
+					blockIndex = blocks[blockIndex].immediateDominator_;
+					const auto& lineGroupIndex = blocks[blockIndex].lineGroupIndex_;
+					if (lineGroupIndex)
+						lineBlock.dominatorAddress_ = lineAddresses[*lineGroupIndex];
+				}
+			}
+			lineBlocks.push_back(lineBlock);
+		}
+		return lineBlocks;
+	}
+}
@@ -0,0 +1,76 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "CppCoverageExport.hpp"
+#include "InstructionDecoder.hpp"
+
+namespace CppCoverage
+{
+	struct LineBlock
+	{
+		// First line address of the basic block of the line.
+		uint64_t address_;
+		// No breakpoint is required: the block is executed if one of the
+		// blocks it dominates is executed.
+		bool isInferred_;
+		// First line address of the closest block dominating this one.
+		boost::optional<uint64_t> dominatorAddress_;
+	};
+
+	// Group the line addresses of a function by basic block. All the lines of
+	// a block are executed when its first line is executed.
+	class CPPCOVERAGE_DLL BasicBlockAnalyzer
+	{
+	  public:
+		explicit BasicBlockAnalyzer(bool is64Bit);
+
+		// code is the function code from its first line address, codeAddress,
+		// to at least its last line address. Code after the last line address
+		// is decoded until the control flow leaves it (ret, jmp...) as it can
+		// branch back into the function. lineAddresses must be sorted and
+		// inside [codeAddress, codeAddress + code.size()].
+		// Return for each line address the first line address of its basic
+		// block or boost::none when the control flow cannot be computed.
+		boost::optional<std::vector<uint64_t>>
+		GetBlockFirstLineAddresses(const std::vector<unsigned char>& code,
+		                           uint64_t codeAddress,
+		                           const std::vector<uint64_t>& lineAddresses) const;
+
+		// Same as GetBlockFirstLineAddresses but also compute the dominators
+		// of the control flow graph of the function. A block is inferred when
+		// it always branches to blocks it dominates: one of them is executed
+		// after it, unless an instruction of the block faults.
+		// codeAddress must be the entry of the function and lineAddresses all
+		// its line addresses. Only the blocks with a line of
+		// monitoredLineAddresses, a sorted subset of lineAddresses, are
+		// dominators or executed blocks from which a block is inferred.
+		boost::optional<std::vector<LineBlock>>
+		GetLineBlocks(const std::vector<unsigned char>& code,
+		              uint64_t codeAddress,
+		              const std::vector<uint64_t>& lineAddresses,
+		              const std::vector<uint64_t>& monitoredLineAddresses) const;
+
+	  private:
+		const InstructionDecoder instructionDecoder_;
+	};
+}
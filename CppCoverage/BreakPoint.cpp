@@ -28,73 +28,144 @@ namespace CppCoverage
 	using Addresses = std::vector<DWORD64>;
 	using AddressesIt = Addresses::const_iterator;
 
-	//-------------------------------------------------------------------------
-	void SetBreakPointsRange(HANDLE hProcess,
-	                         AddressesIt begin,
-	                         AddressesIt end,
-	                         BreakPoint::InstructionCollection& oldInstructions)
+	namespace
 	{
-		if (begin == end)
-			return;
+		const DWORD64 PageSize = 4096;
+		const DWORD64 MaxRegionSize = 1024 * 1024;
+
+		//---------------------------------------------------------------------
+		DWORD64 GetPage(DWORD64 address)
+		{
+			return address / PageSize;
+		}
+
+		//---------------------------------------------------------------------
+		void SetBreakPointsRegion(Tools::IProcessMemory& processMemory,
+		                          HANDLE hProcess,
+		                          AddressesIt begin,
+		                          AddressesIt end,
+		                          std::vector<unsigned char>& buffer,
+		                          BreakPoint::InstructionCollection& oldInstructions,
+		                          bool writeBreakPoints)
+		{
+			if (begin == end)
+				return;
+
+			auto firstValue = *begin;
+			auto memorySpaceSize = *(end - 1) - firstValue +
+			                       sizeof(BreakPoint::breakPointInstruction);
+			buffer.resize(static_cast<size_t>(memorySpaceSize));
+			processMemory.Read(hProcess, firstValue, buffer.data(), buffer.size());
+
+			for (auto it = begin; it < end; ++it)
+			{
+				auto index = static_cast<size_t>(*it - firstValue);
+				auto oldInstruction = buffer[index];
+				buffer[index] = BreakPoint::breakPointInstruction;
+				oldInstructions.emplace_back(oldInstruction, *it);
+			}
+
+			if (!writeBreakPoints)
+				return;
 
-		auto firstValue = *begin;
-		auto memorySpaceSize =
-		    *(end - 1) - firstValue + sizeof(BreakPoint::breakPointInstruction);
-		auto firstAddress = reinterpret_cast<void*>(firstValue);
-		auto buffer = Tools::ReadProcessMemory(
-		    hProcess, firstAddress, static_cast<size_t>(memorySpaceSize));
+			// Write the whole region at once to flush the instruction cache
+			// a single time.
+			processMemory.Write(
+			    hProcess, firstValue, buffer.data(), buffer.size());
+		}
 
-		for (auto it = begin; it < end; ++it)
+		//---------------------------------------------------------------------
+		BreakPoint::InstructionCollection
+		CollectInstructions(Tools::IProcessMemory& processMemory,
+		                    HANDLE hProcess,
+		                    Addresses&& addresses,
+		                    bool writeBreakPoints)
 		{
-			auto index = static_cast<size_t>(*it - firstValue);
-			auto oldInstruction = buffer[index];
-			buffer[index] = BreakPoint::breakPointInstruction;
-			oldInstructions.emplace_back(oldInstruction, *it);
+			BreakPoint::InstructionCollection oldInstructions;
+			std::vector<unsigned char> buffer;
+
+			std::sort(addresses.begin(), addresses.end());
+			addresses.erase(std::unique(addresses.begin(), addresses.end()),
+			                addresses.end());
+			oldInstructions.reserve(addresses.size());
+
+			// Addresses on the same or on contiguous pages are patched with
+			// a single read and a single write.
+			auto beginRegion = addresses.cbegin();
+			for (auto it = beginRegion; it < addresses.cend(); ++it)
+			{
+				if (it != beginRegion &&
+				    (GetPage(*it) > GetPage(*(it - 1)) + 1 ||
+				     *it - *beginRegion >= MaxRegionSize))
+				{
+					SetBreakPointsRegion(processMemory,
+					                     hProcess,
+					                     beginRegion,
+					                     it,
+					                     buffer,
+					                     oldInstructions,
+					                     writeBreakPoints);
+					beginRegion = it;
+				}
+			}
+			SetBreakPointsRegion(processMemory,
+			                     hProcess,
+			                     beginRegion,
+			                     addresses.cend(),
+			                     buffer,
+			                     oldInstructions,
+			                     writeBreakPoints);
+
+			return oldInstructions;
 		}
-		Tools::WriteProcessMemory(
-		    hProcess, firstAddress, &buffer[0], buffer.size());
 	}
 
 	const unsigned char BreakPoint::breakPointInstruction = 0xCC;
 
 	//-------------------------------------------------------------------------
-	BreakPoint::InstructionCollection
-	BreakPoint::SetBreakPoints(HANDLE hProcess, Addresses&& addresses) const
+	BreakPoint::BreakPoint()
+	    : BreakPoint{std::make_shared<Tools::ProcessMemory>()}
 	{
-		InstructionCollection oldInstructions;
+	}
 
-		std::sort(addresses.begin(), addresses.end());
-		auto beginRange = addresses.cbegin();
+	//-------------------------------------------------------------------------
+	BreakPoint::BreakPoint(std::shared_ptr<Tools::IProcessMemory> processMemory)
+	    : processMemory_{std::move(processMemory)}
+	{
+	}
 
-		for (auto it = beginRange; it < addresses.cend(); ++it)
-		{
-			if (*it - *beginRange > 4096)
-			{
-				SetBreakPointsRange(hProcess, beginRange, it, oldInstructions);
-				beginRange = it;
-			}
-		}
-		SetBreakPointsRange(
-		    hProcess, beginRange, addresses.end(), oldInstructions);
+	//-------------------------------------------------------------------------
+	BreakPoint::InstructionCollection
+	BreakPoint::SetBreakPoints(HANDLE hProcess, Addresses&& addresses) const
+	{
+		return CollectInstructions(
+		    *processMemory_, hProcess, std::move(addresses), true);
+	}
 
-		return oldInstructions;
+	//-------------------------------------------------------------------------
+	BreakPoint::InstructionCollection
+	BreakPoint::ReadInstructions(HANDLE hProcess, Addresses&& addresses) const
+	{
+		return CollectInstructions(
+		    *processMemory_, hProcess, std::move(addresses), false);
 	}
 
 	//-------------------------------------------------------------------------
 	void BreakPoint::RemoveBreakPoint(const Address& address,
 	                                  unsigned char oldInstruction) const
 	{
-		Tools::WriteProcessMemory(address.GetProcessHandle(),
-		                          address.GetValue(),
-		                          &oldInstruction,
-		                          sizeof(oldInstruction));
+		processMemory_->Write(address.GetProcessHandle(),
+		                      reinterpret_cast<DWORD64>(address.GetValue()),
+		                      &oldInstruction,
+		                      sizeof(oldInstruction));
 	}
 
 	//-------------------------------------------------------------------------
 	void BreakPoint::AdjustEipAfterBreakPointRemoval(HANDLE hThread) const
 	{
 		CONTEXT lcContext;
-		lcContext.ContextFlags = CONTEXT_ALL;
+		// Only the instruction pointer is needed.
+		lcContext.ContextFlags = CONTEXT_CONTROL;
 		if (!GetThreadContext(hThread, &lcContext))
 			THROW_LAST_ERROR("Error in GetThreadContext", GetLastError());
 
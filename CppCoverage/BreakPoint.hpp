@@ -17,8 +17,16 @@
 #pragma once
 
 #include <Windows.h>
+#include <memory>
+#include <vector>
+
 #include "CppCoverageExport.hpp"
 
+namespace Tools
+{
+	class IProcessMemory;
+}
+
 namespace CppCoverage
 {
 	class Address;
@@ -26,7 +34,8 @@ namespace CppCoverage
 	class CPPCOVERAGE_DLL BreakPoint
 	{
 	  public:
-		BreakPoint() = default;
+		BreakPoint();
+		explicit BreakPoint(std::shared_ptr<Tools::IProcessMemory>);
 
 		static const unsigned char breakPointInstruction;
 
@@ -36,13 +45,21 @@ namespace CppCoverage
 		using InstructionCollection =
 		    std::vector<std::pair<unsigned char, DWORD64>>;
 
+		// Return the old instructions sorted by address. Duplicated
+		// addresses are ignored.
 		InstructionCollection
 		SetBreakPoints(HANDLE hProcess, std::vector<DWORD64>&& addresses) const;
 
+		// Same as SetBreakPoints but the memory is not modified.
+		InstructionCollection
+		ReadInstructions(HANDLE hProcess, std::vector<DWORD64>&& addresses) const;
+
 		void AdjustEipAfterBreakPointRemoval(HANDLE hThread) const;
 
 	  private:
 		BreakPoint(const BreakPoint&) = delete;
 		BreakPoint& operator=(const BreakPoint&) = delete;
+
+		const std::shared_ptr<Tools::IProcessMemory> processMemory_;
 	};
 }
@@ -17,7 +17,11 @@
 #include "stdafx.h"
 #include "CodeCoverageRunner.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <sstream>
+#include <thread>
 #include <boost/optional.hpp>
 
 #include "tools/Log.hpp"
@@ -35,23 +39,45 @@
 #include "RunCoverageSettings.hpp"
 #include "MonitoredLineRegister.hpp"
 #include "FilterAssistant.hpp"
+#include "LineTableCache.hpp"
+#include "SymbolLoadingPipeline.hpp"
 #include "FileSystem.hpp"
+#include "LazyBreakPoints.hpp"
+#include "PageMemory.hpp"
+#include "DebugEventsRecorder.hpp"
+#include "DebugEventsReplayer.hpp"
+#include "DebugEventStatistics.hpp"
+#include "TraceDebugInformationEnumerator.hpp"
 
 #include "Tools/WarningManager.hpp"
 #include "Tools/Tool.hpp"
+#include "Tools/ProcessMemory.hpp"
+#include "Tools/ScopedAction.hpp"
+#include "Tools/SimulatedProcessMemory.hpp"
 
 namespace CppCoverage
 {
+	namespace
+	{
+		//---------------------------------------------------------------------
+		size_t GetSymbolLoadingWorkerCount()
+		{
+			auto threadCount = std::thread::hardware_concurrency();
+			return std::max<size_t>(1, std::min<size_t>(4, threadCount / 2));
+		}
+	}
+
 	//-------------------------------------------------------------------------
 	CodeCoverageRunner::CodeCoverageRunner(
 	    std::shared_ptr<Tools::WarningManager> warningManager)
 	    : warningManager_{warningManager},
 	      filterAssistant_{
-	          std::make_shared<FilterAssistant>(std::make_shared<FileSystem>())}
+	          std::make_shared<FilterAssistant>(std::make_shared<FileSystem>())},
+	      replayer_{nullptr},
+	      detachOnSaturation_{false}
 	{
 		executedAddressManager_ = std::make_shared<ExecutedAddressManager>();
 		exceptionHandler_ = std::make_unique<ExceptionHandler>();
-		breakpoint_ = std::make_shared<BreakPoint>();
 	}
 	
 	//-------------------------------------------------------------------------
@@ -63,7 +89,103 @@ namespace CppCoverage
 	Plugin::CoverageData CodeCoverageRunner::RunCoverage(
 		const RunCoverageSettings& settings)
 	{
-		Debugger debugger{ settings.GetCoverChildren(), settings.GetContinueAfterCppException(), settings.GetStopOnAssert()};
+		Debugger debugger{ settings.GetCoverChildren(),
+		                   settings.GetContinueAfterCppException(),
+		                   settings.GetStopOnAssert(),
+		                   settings.GetDebugEventStatisticsPath().is_initialized() };
+
+		std::shared_ptr<LineTableCache> lineTableCache;
+		if (const auto& lineTableCacheFolder = settings.GetLineTableCacheFolder())
+		{
+			lineTableCache = std::make_shared<LineTableCache>(
+				*lineTableCacheFolder, settings.GetLineTableCacheMaxSize());
+		}
+
+		auto processMemory = std::make_shared<Tools::ProcessMemory>();
+		Initialize(settings,
+		           std::make_unique<DebugInformationEnumerator>(
+		               settings.GetSubstitutePdbSourcePaths(), lineTableCache),
+		           GetSymbolLoadingWorkerCount(),
+		           processMemory,
+		           std::make_shared<PageMemory>(
+		               std::make_shared<BreakPoint>(processMemory)));
+
+		const auto& startInfo = settings.GetStartInfo();
+		int exitCode = 0;
+		if (const auto& debugEventsTracePath = settings.GetDebugEventsTracePath())
+		{
+			DebugEventsRecorder debugEventsRecorder{
+			    *this,
+			    [this](const std::filesystem::path& path) {
+				    return coverageFilterManager_->IsModuleSelected(path.wstring());
+			    },
+			    std::make_unique<DebugInformationEnumerator>(
+			        settings.GetSubstitutePdbSourcePaths(), lineTableCache)};
+			exitCode = debugger.Debug(startInfo, debugEventsRecorder);
+
+			const auto& trace = debugEventsRecorder.GetTrace();
+			SaveDebugEventTrace(trace, *debugEventsTracePath);
+			LOG_INFO << trace.events_.size() << L" debug event(s) recorded in "
+			         << debugEventsTracePath->wstring();
+		}
+		else
+			exitCode = debugger.Debug(startInfo, *this);
+
+		const auto& debugEventStatistics = debugger.GetStatistics();
+		debugEventStatistics.LogStatistics();
+		for (const auto& pair : debugEventStatistics.GetExceptionHistograms())
+		{
+			std::chrono::duration<double> handlingTime = pair.second.GetTotal();
+			exceptionHandler_->AddHandlingTime(pair.first, handlingTime.count());
+		}
+		if (const auto& debugEventStatisticsPath = settings.GetDebugEventStatisticsPath())
+		{
+			Tools::CreateParentFolderIfNeeded(*debugEventStatisticsPath);
+			std::ofstream ofs{ *debugEventStatisticsPath };
+			debugEventStatistics.WriteJson(ofs);
+			if (!ofs)
+				LOG_WARNING << L"Cannot write debug event statistics to " << debugEventStatisticsPath->wstring();
+		}
+		if (lineTableCache)
+			lineTableCache->LogStatistics();
+
+		return CreateCoverageData(settings, exitCode);
+	}
+
+	//-------------------------------------------------------------------------
+	Plugin::CoverageData CodeCoverageRunner::ReplayCoverage(
+		const RunCoverageSettings& settings,
+		const DebugEventTrace& trace)
+	{
+		DebugEventsReplayer replayer{ trace };
+
+		// The line tables are read from the trace: prefetching is useless.
+		Initialize(settings,
+		           std::make_unique<TraceDebugInformationEnumerator>(trace),
+		           0,
+		           replayer.GetProcessMemory(),
+		           replayer.CreatePageMemory());
+		replayer_ = &replayer;
+		Tools::ScopedAction resetReplayer{ [this]() { replayer_ = nullptr; } };
+
+		auto eventCount = replayer.Replay(*this);
+		LOG_INFO << eventCount << L" debug event(s) replayed.";
+
+		return CreateCoverageData(settings, replayer.GetExitCode());
+	}
+
+	//-------------------------------------------------------------------------
+	void CodeCoverageRunner::Initialize(
+		const RunCoverageSettings& settings,
+		std::unique_ptr<IDebugInformationEnumerator> debugInformationEnumerator,
+		size_t symbolLoadingWorkerCount,
+		std::shared_ptr<Tools::IProcessMemory> processMemory,
+		std::shared_ptr<IPageMemory> pageMemory)
+	{
+		// Children of a detached process would not be covered.
+		detachOnSaturation_ = settings.GetDetachOnSaturation() && !settings.GetCoverChildren();
+		selectedModulesByProcess_.clear();
+		processesWithAllSelectedModules_.clear();
 
 		coverageFilterManager_ = std::make_shared<CoverageFilterManager>(
 			settings.GetCoverageFilterSettings(),
@@ -71,16 +193,36 @@ namespace CppCoverage
 			settings.GetExcludedLineRegexes(),
 			settings.GetOptimizedBuildSupport());
 
+		breakpoint_ = std::make_shared<BreakPoint>(processMemory);
+		symbolLoadingPipeline_ = std::make_shared<SymbolLoadingPipeline>(
+		    std::move(debugInformationEnumerator), symbolLoadingWorkerCount);
+		lazyBreakPoints_ = settings.GetLazyBreakPoints()
+			? std::make_shared<LazyBreakPoints>(std::move(pageMemory))
+			: nullptr;
 		monitoredLineRegister_ = std::make_unique<MonitoredLineRegister>(
 		    breakpoint_,
 		    executedAddressManager_,
 		    coverageFilterManager_,
-		    std::make_unique<DebugInformationEnumerator>(settings.GetSubstitutePdbSourcePaths()),
-			filterAssistant_);
+		    symbolLoadingPipeline_,
+			filterAssistant_,
+			settings.GetCoveredLines(),
+			settings.GetFunctionCoverage(),
+			settings.GetBasicBlockBreakPoints(),
+			settings.GetDominatorBreakPoints(),
+			lazyBreakPoints_,
+			std::move(processMemory));
+	}
 
-		const auto& startInfo = settings.GetStartInfo();
-		int exitCode = debugger.Debug(startInfo, *this);
-		const auto& path = startInfo.GetPath();
+	//-------------------------------------------------------------------------
+	Plugin::CoverageData CodeCoverageRunner::CreateCoverageData(
+		const RunCoverageSettings& settings,
+		int exitCode)
+	{
+		symbolLoadingPipeline_->LogStatistics();
+		monitoredLineRegister_->LogStatistics();
+		exceptionHandler_->LogStatistics();
+		if (lazyBreakPoints_)
+			lazyBreakPoints_->LogStatistics();
 
 		auto warningMessageLines = coverageFilterManager_->ComputeWarningMessageLines(
 			settings.GetMaxUnmatchPathsForWarning());
@@ -89,7 +231,10 @@ namespace CppCoverage
 		auto filterAdviceMessage = filterAssistant_->GetAdviceMessage();
 		if (filterAdviceMessage)
 			warningManager_->AddWarning(*filterAdviceMessage);
-		return executedAddressManager_->CreateCoverageData(path.filename().wstring(), exitCode);
+
+		const auto& path = settings.GetStartInfo().GetPath();
+		return executedAddressManager_->CreateCoverageData(
+			path.filename().wstring(), exitCode, settings.GetFunctionCoverage());
 	}
 
 	//-------------------------------------------------------------------------
@@ -97,7 +242,18 @@ namespace CppCoverage
 	{
 		auto hProcess = processDebugInfo.hProcess;
 		auto lpBaseOfImage = processDebugInfo.lpBaseOfImage;
+		std::filesystem::path filename =
+		    GetModulePath(hProcess, processDebugInfo.hFile, lpBaseOfImage);
 
+		// Imported modules are loaded right after, start reading their
+		// debug information while the current module is processed.
+		symbolLoadingPipeline_->PrefetchImportedModules(
+		    hProcess,
+		    lpBaseOfImage,
+		    filename,
+		    [this](const std::filesystem::path& path) {
+			    return coverageFilterManager_->IsModuleSelected(path.wstring());
+		    });
 		LoadModule(hProcess, processDebugInfo.hFile, lpBaseOfImage);
 	}
 	
@@ -105,7 +261,12 @@ namespace CppCoverage
 	void CodeCoverageRunner::OnExitProcess(HANDLE hProcess, HANDLE, const EXIT_PROCESS_DEBUG_INFO&)
 	{
 		exceptionHandler_->OnExitProcess(hProcess);
-		executedAddressManager_->OnExitProcess(hProcess);
+		selectedModulesByProcess_.erase(hProcess);
+		processesWithAllSelectedModules_.erase(hProcess);
+		if (lazyBreakPoints_)
+			lazyBreakPoints_->OnExitProcess(hProcess);
+		auto removedAddressCount = executedAddressManager_->OnExitProcess(hProcess);
+		LOG_DEBUG << "Exit process: " << removedAddressCount << " addresses removed.";
 	}
 
 	//-------------------------------------------------------------------------
@@ -123,7 +284,12 @@ namespace CppCoverage
 		HANDLE hThread,
 		const UNLOAD_DLL_DEBUG_INFO& unloadDllDebugInfo)
 	{
-		executedAddressManager_->OnUnloadModule(hProcess, unloadDllDebugInfo.lpBaseOfDll);
+		if (lazyBreakPoints_)
+			lazyBreakPoints_->OnUnloadModule(hProcess, unloadDllDebugInfo.lpBaseOfDll);
+		auto removedAddressCount = executedAddressManager_->OnUnloadModule(
+			hProcess, unloadDllDebugInfo.lpBaseOfDll);
+		LOG_DEBUG << "Unload module " << unloadDllDebugInfo.lpBaseOfDll << ": "
+			<< removedAddressCount << " addresses removed.";
 	}
 
 	//-------------------------------------------------------------------------
@@ -132,16 +298,25 @@ namespace CppCoverage
 		HANDLE hThread, 
 		const EXCEPTION_DEBUG_INFO& exceptionDebugInfo)
 	{
-		std::wostringstream ostr;
-		
-		auto status = exceptionHandler_->HandleException(hProcess, exceptionDebugInfo, ostr);
+		// Fast path: most exceptions are coverage breakpoints.
+		if (exceptionDebugInfo.dwFirstChance &&
+			ExceptionHandler::IsBreakPointExceptionCode(exceptionDebugInfo.ExceptionRecord.ExceptionCode) &&
+			OnBreakPoint(exceptionDebugInfo, hProcess, hThread))
+		{
+			return IDebugEventsHandler::ExceptionType::BreakPoint;
+		}
+
+		if (lazyBreakPoints_ && lazyBreakPoints_->OnException(hProcess, exceptionDebugInfo))
+			return IDebugEventsHandler::ExceptionType::GuardPage;
+
+		const auto& exceptionRecord = exceptionDebugInfo.ExceptionRecord;
+		auto status = exceptionHandler_->HandleException(hProcess, exceptionDebugInfo);
 
 		switch (status)
 		{
 			case CppCoverage::ExceptionHandlerStatus::BreakPoint:
 			{
-				if (OnBreakPoint(exceptionDebugInfo, hProcess, hThread))
-					return IDebugEventsHandler::ExceptionType::BreakPoint;
+				// Not a coverage breakpoint, see the fast path above.
 				return IDebugEventsHandler::ExceptionType::InvalidBreakPoint;
 			}
 			case CppCoverage::ExceptionHandlerStatus::FirstChanceException:
@@ -150,13 +325,13 @@ namespace CppCoverage
 			}
 			case CppCoverage::ExceptionHandlerStatus::Error:
 			{
-				LOG_ERROR << ostr.str();
+				LogUnhandledException(exceptionRecord);
 				
 				return IDebugEventsHandler::ExceptionType::Error;
 			}
 			case CppCoverage::ExceptionHandlerStatus::CppError:
 			{
-				LOG_ERROR << ostr.str();
+				LogUnhandledException(exceptionRecord);
 
 				return IDebugEventsHandler::ExceptionType::CppError;
 			}
@@ -165,6 +340,23 @@ namespace CppCoverage
 		return IDebugEventsHandler::ExceptionType::NotHandled;
 	}
 	
+	//-------------------------------------------------------------------------
+	void CodeCoverageRunner::LogUnhandledException(const EXCEPTION_RECORD& exceptionRecord) const
+	{
+		std::wostringstream ostr;
+
+		exceptionHandler_->FormatUnhandledException(exceptionRecord, ostr);
+		LOG_ERROR << ostr.str();
+	}
+
+	//-------------------------------------------------------------------------
+	bool CodeCoverageRunner::ShouldDetach(HANDLE hProcess)
+	{
+		return detachOnSaturation_ &&
+			executedAddressManager_->GetArmedBreakPointCount(hProcess) == 0 &&
+			processesWithAllSelectedModules_.count(hProcess) != 0;
+	}
+
 	//-------------------------------------------------------------------------
 	bool CodeCoverageRunner::OnBreakPoint(
 		const EXCEPTION_DEBUG_INFO& exceptionDebugInfo,
@@ -179,23 +371,48 @@ namespace CppCoverage
 		if (oldInstruction)
 		{
 			breakpoint_->RemoveBreakPoint(address, *oldInstruction);
-			breakpoint_->AdjustEipAfterBreakPointRemoval(hThread);
+			// Replayed threads do not run.
+			if (!replayer_)
+				breakpoint_->AdjustEipAfterBreakPointRemoval(hThread);
 			return true;
 		}
 
 		return false;
 	}
 
+	//-------------------------------------------------------------------------
+	std::wstring CodeCoverageRunner::GetModulePath(HANDLE hProcess,
+	                                               HANDLE hFile,
+	                                               void* baseOfImage) const
+	{
+		// Replayed module events have no file handle.
+		if (replayer_)
+		{
+			const auto* module = replayer_->FindModule(hProcess, baseOfImage);
+			if (!module)
+				THROW(L"Cannot find the replayed module at " << baseOfImage);
+			return module->path_;
+		}
+
+		HandleInformation handleInformation;
+		return handleInformation.ComputeFilename(hFile);
+	}
+
 	//-------------------------------------------------------------------------
 	void CodeCoverageRunner::LoadModule(HANDLE hProcess,
 	                                    HANDLE hFile,
 	                                    void* baseOfImage)
 	{
-		HandleInformation handleInformation;
-
-		std::wstring filename = handleInformation.ComputeFilename(hFile);
+		std::wstring filename = GetModulePath(hProcess, hFile, baseOfImage);
 
 		auto isSelected = coverageFilterManager_->IsModuleSelected(filename);
+		if (isSelected && detachOnSaturation_)
+		{
+			auto& selectedModules = selectedModulesByProcess_[hProcess];
+			selectedModules.push_back(filename);
+			if (coverageFilterManager_->AreSelectedModulesLoaded(selectedModules))
+				processesWithAllSelectedModules_.insert(hProcess);
+		}
 		if (isSelected)
 		{
 			isSelected = monitoredLineRegister_->RegisterLineToMonitor(
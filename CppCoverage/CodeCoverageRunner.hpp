@@ -17,6 +17,10 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "Plugin/Exporter/CoverageData.hpp"
 #include "IDebugEventsHandler.hpp"
@@ -25,6 +29,7 @@
 namespace Tools
 {
 	class WarningManager;
+	class IProcessMemory;
 }
 
 namespace CppCoverage
@@ -39,6 +44,12 @@ namespace CppCoverage
 	class UnifiedDiffSettings;
 	class MonitoredLineRegister;
 	class FilterAssistant;
+	class SymbolLoadingPipeline;
+	class LazyBreakPoints;
+	class IDebugInformationEnumerator;
+	class IPageMemory;
+	struct DebugEventTrace;
+	class DebugEventsReplayer;
 
 	class CPPCOVERAGE_DLL CodeCoverageRunner : private IDebugEventsHandler
 	{
@@ -48,28 +59,55 @@ namespace CppCoverage
 
 		Plugin::CoverageData RunCoverage(const RunCoverageSettings&);
 
+		// Compute the coverage of a recorded run, see
+		// RunCoverageSettings::SetDebugEventsTracePath. The settings should
+		// be the ones of the recorded run. The start info is used only for the
+		// name of the coverage data.
+		Plugin::CoverageData ReplayCoverage(const RunCoverageSettings&,
+		                                    const DebugEventTrace&);
+
 	private:
 		virtual void OnCreateProcess(const CREATE_PROCESS_DEBUG_INFO&) override;
 		virtual void OnExitProcess(HANDLE hProcess, HANDLE hThread, const EXIT_PROCESS_DEBUG_INFO&) override;
 		virtual void OnLoadDll(HANDLE hProcess, HANDLE hThread, const LOAD_DLL_DEBUG_INFO&) override;
 		virtual void OnUnloadDll(HANDLE hProcess, HANDLE hThread, const UNLOAD_DLL_DEBUG_INFO&) override;
 		virtual ExceptionType OnException(HANDLE hProcess, HANDLE hThread, const EXCEPTION_DEBUG_INFO&) override;
+		virtual bool ShouldDetach(HANDLE hProcess) override;
 
 	private:
 		CodeCoverageRunner(const CodeCoverageRunner&) = delete;
 		CodeCoverageRunner& operator=(const CodeCoverageRunner&) = delete;
 
+		void Initialize(const RunCoverageSettings&,
+		                std::unique_ptr<IDebugInformationEnumerator>,
+		                size_t symbolLoadingWorkerCount,
+		                std::shared_ptr<Tools::IProcessMemory>,
+		                std::shared_ptr<IPageMemory>);
+		Plugin::CoverageData CreateCoverageData(const RunCoverageSettings&,
+		                                        int exitCode);
+		std::wstring GetModulePath(HANDLE hProcess,
+		                           HANDLE hFile,
+		                           void* baseOfImage) const;
 		void LoadModule(HANDLE hProcess, HANDLE hFile, void* baseOfImage);
 		bool OnBreakPoint(const EXCEPTION_DEBUG_INFO&, HANDLE hProcess, HANDLE hThread);
+		void LogUnhandledException(const EXCEPTION_RECORD&) const;
 
 	private:
 		std::shared_ptr<BreakPoint> breakpoint_;
 		std::shared_ptr<ExecutedAddressManager> executedAddressManager_;
 		std::shared_ptr<CoverageFilterManager> coverageFilterManager_;
+		std::shared_ptr<SymbolLoadingPipeline> symbolLoadingPipeline_;
 		std::unique_ptr<MonitoredLineRegister> monitoredLineRegister_;
+		std::shared_ptr<LazyBreakPoints> lazyBreakPoints_;
 		std::unique_ptr<ExceptionHandler> exceptionHandler_;
 		std::shared_ptr<Tools::WarningManager> warningManager_;
 		std::shared_ptr<FilterAssistant> filterAssistant_;
+
+		// Not null while a trace is replayed.
+		const DebugEventsReplayer* replayer_;
+		bool detachOnSaturation_;
+		std::unordered_map<HANDLE, std::vector<std::wstring>> selectedModulesByProcess_;
+		std::unordered_set<HANDLE> processesWithAllSelectedModules_;
 	};
 }
 
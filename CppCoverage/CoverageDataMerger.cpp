@@ -94,8 +94,14 @@ namespace CppCoverage
 			Plugin::FileCoverage& file,
 			const std::vector<Plugin::FileCoverage*>& files)
 		{
+			bool isFunctionGranularity = true;
+
 			for (const auto& f : files)
+			{
 				AddFileCoverageTo(f, &file);
+				isFunctionGranularity = isFunctionGranularity && f->IsFunctionGranularity();
+			}
+			file.SetFunctionGranularity(isFunctionGranularity);
 		}
 
 		//---------------------------------------------------------------------
@@ -126,7 +132,11 @@ namespace CppCoverage
 
 				mutableFileCoverages.pop_back();
 				for (const auto* fileCoverage : mutableFileCoverages)
+				{
 					AddFileCoverageTo(fileCoverage, fileCoverageSum);
+					if (!fileCoverage->IsFunctionGranularity())
+						fileCoverageSum->SetFunctionGranularity(false);
+				}
 
 				for (auto* fileCoverage : mutableFileCoverages)
 					*fileCoverage = *fileCoverageSum;
@@ -77,6 +77,13 @@ namespace CppCoverage
 		return unifiedDiffCoverageFilterManager_.IsLineSelected(fileInfo, lineInfo);
 	}
 
+	//-------------------------------------------------------------------------
+	bool CoverageFilterManager::AreSelectedModulesLoaded(
+		const std::vector<std::wstring>& loadedModules) const
+	{
+		return wildcardCoverageFilter_.AreSelectedModulesLoaded(loadedModules);
+	}
+
 	//-------------------------------------------------------------------------
 	std::vector<std::wstring> CoverageFilterManager::ComputeWarningMessageLines(size_t maxUnmatchPaths) const
 	{
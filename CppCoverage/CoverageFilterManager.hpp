@@ -53,6 +53,7 @@ namespace CppCoverage
 			const FileFilter::LineInfo&) override;
 
 		std::vector<std::wstring> ComputeWarningMessageLines(size_t maxUnmatchPaths) const;
+		bool AreSelectedModulesLoaded(const std::vector<std::wstring>& loadedModules) const;
 
 	private:
 		CoverageFilterManager(const CoverageFilterManager&) = delete;
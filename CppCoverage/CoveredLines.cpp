@@ -0,0 +1,90 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "CoveredLines.hpp"
+
+#include <algorithm>
+
+#include "Plugin/Exporter/CoverageData.hpp"
+#include "Plugin/Exporter/ModuleCoverage.hpp"
+#include "Plugin/Exporter/FileCoverage.hpp"
+#include "Plugin/Exporter/LineCoverage.hpp"
+
+namespace CppCoverage
+{
+	//-------------------------------------------------------------------------
+	CoveredLines::CoveredLines(
+		const std::vector<Plugin::CoverageData>& coverageDataCollection,
+		bool isAggregatedByFile)
+		: isAggregatedByFile_{isAggregatedByFile}
+		, executedLineCount_{0}
+	{
+		for (const auto& coverageData : coverageDataCollection)
+		{
+			for (const auto& module : coverageData.GetModules())
+			{
+				for (const auto& file : module->GetFiles())
+				{
+					auto& executedLines = executedLinesByFile_[GetKey(module->GetPath(), file->GetPath())];
+					for (const auto& line : file->GetLines())
+					{
+						if (line.HasBeenExecuted())
+							executedLines.push_back(line.GetLineNumber());
+					}
+				}
+			}
+		}
+
+		for (auto& pair : executedLinesByFile_)
+		{
+			auto& executedLines = pair.second;
+			std::sort(executedLines.begin(), executedLines.end());
+			executedLines.erase(
+				std::unique(executedLines.begin(), executedLines.end()), executedLines.end());
+			executedLineCount_ += executedLines.size();
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	const std::vector<unsigned int>* CoveredLines::GetExecutedLines(
+		const std::filesystem::path& modulePath,
+		const std::filesystem::path& filePath) const
+	{
+		auto it = executedLinesByFile_.find(GetKey(modulePath, filePath));
+
+		if (it == executedLinesByFile_.end() || it->second.empty())
+			return nullptr;
+		return &it->second;
+	}
+
+	//-------------------------------------------------------------------------
+	size_t CoveredLines::GetExecutedLineCount() const
+	{
+		return executedLineCount_;
+	}
+
+	//-------------------------------------------------------------------------
+	std::wstring CoveredLines::GetKey(
+		const std::filesystem::path& modulePath,
+		const std::filesystem::path& filePath) const
+	{
+		// Files of different modules are merged when coverage is aggregated by file.
+		if (isAggregatedByFile_)
+			return filePath.wstring();
+		return modulePath.wstring() + L'|' + filePath.wstring();
+	}
+}
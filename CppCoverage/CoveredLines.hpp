@@ -0,0 +1,58 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CppCoverageExport.hpp"
+
+namespace Plugin
+{
+	class CoverageData;
+}
+
+namespace CppCoverage
+{
+	// Lines already executed in previous coverage results. Paths are compared
+	// like CoverageDataMerger does so a skipped line is always merged back.
+	class CPPCOVERAGE_DLL CoveredLines
+	{
+	public:
+		CoveredLines(const std::vector<Plugin::CoverageData>&, bool isAggregatedByFile);
+
+		// Return the sorted executed lines of the file or nullptr.
+		const std::vector<unsigned int>* GetExecutedLines(
+			const std::filesystem::path& modulePath,
+			const std::filesystem::path& filePath) const;
+
+		size_t GetExecutedLineCount() const;
+
+	private:
+		CoveredLines(const CoveredLines&) = delete;
+		CoveredLines& operator=(const CoveredLines&) = delete;
+
+		std::wstring GetKey(const std::filesystem::path& modulePath,
+		                    const std::filesystem::path& filePath) const;
+
+		const bool isAggregatedByFile_;
+		std::map<std::wstring, std::vector<unsigned int>> executedLinesByFile_;
+		size_t executedLineCount_;
+	};
+}
@@ -0,0 +1,332 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "DebugEventStatistics.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include "tools/Log.hpp"
+#include "tools/Tool.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		const int JsonVersion = 1;
+
+		//---------------------------------------------------------------------
+		double ToMicroseconds(std::chrono::nanoseconds duration)
+		{
+			return duration.count() / 1000.0;
+		}
+
+		//---------------------------------------------------------------------
+		double ToSeconds(std::chrono::nanoseconds duration)
+		{
+			return duration.count() / 1e9;
+		}
+
+		//---------------------------------------------------------------------
+		void WriteJsonString(std::ostream& ostr, const std::string& str)
+		{
+			ostr << '"';
+			for (auto c : str)
+			{
+				switch (c)
+				{
+					case '"': ostr << "\\\""; break;
+					case '\\': ostr << "\\\\"; break;
+					case '\n': ostr << "\\n"; break;
+					case '\r': ostr << "\\r"; break;
+					case '\t': ostr << "\\t"; break;
+					default:
+						if (static_cast<unsigned char>(c) < 0x20)
+						{
+							ostr << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+							     << static_cast<int>(c) << std::dec << std::setfill(' ');
+						}
+						else
+							ostr << c;
+				}
+			}
+			ostr << '"';
+		}
+
+		//---------------------------------------------------------------------
+		void WriteJsonHistogram(std::ostream& ostr, const DebugEventStatistics::Histogram& histogram)
+		{
+			ostr << "{\"count\": " << histogram.GetCount()
+			     << ", \"totalMicroseconds\": " << ToMicroseconds(histogram.GetTotal())
+			     << ", \"maxMicroseconds\": " << ToMicroseconds(histogram.GetMax())
+			     << ", \"buckets\": [";
+
+			const auto& buckets = histogram.GetBuckets();
+			for (size_t i = 0; i < buckets.size(); ++i)
+				ostr << (i ? ", " : "") << buckets[i];
+			ostr << "]}";
+		}
+
+		//---------------------------------------------------------------------
+		uint64_t GetEventCount(const DebugEventStatistics& statistics)
+		{
+			uint64_t eventCount = 0;
+
+			for (size_t i = 0; i < static_cast<size_t>(DebugEventStatistics::EventType::Count); ++i)
+			{
+				auto eventType = static_cast<DebugEventStatistics::EventType>(i);
+				if (eventType != DebugEventStatistics::EventType::Wait)
+					eventCount += statistics.GetHistogram(eventType).GetCount();
+			}
+			return eventCount;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventStatistics::Histogram::Histogram()
+		: count_{ 0 }
+		, total_{ 0 }
+		, max_{ 0 }
+		, buckets_{}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::Histogram::Add(std::chrono::nanoseconds duration)
+	{
+		auto microseconds = static_cast<uint64_t>(duration.count()) / 1000;
+		size_t bucket = 0;
+
+		while (microseconds && bucket < BucketCount - 1)
+		{
+			microseconds >>= 1;
+			++bucket;
+		}
+		++buckets_[bucket];
+		++count_;
+		total_ += duration;
+		max_ = std::max(max_, duration);
+	}
+
+	//-------------------------------------------------------------------------
+	uint64_t DebugEventStatistics::Histogram::GetCount() const
+	{
+		return count_;
+	}
+
+	//-------------------------------------------------------------------------
+	std::chrono::nanoseconds DebugEventStatistics::Histogram::GetTotal() const
+	{
+		return total_;
+	}
+
+	//-------------------------------------------------------------------------
+	std::chrono::nanoseconds DebugEventStatistics::Histogram::GetMax() const
+	{
+		return max_;
+	}
+
+	//-------------------------------------------------------------------------
+	const std::array<uint64_t, DebugEventStatistics::Histogram::BucketCount>&
+	DebugEventStatistics::Histogram::GetBuckets() const
+	{
+		return buckets_;
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventStatistics::DebugEventStatistics()
+		: runTime_{ 0 }
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::AddDuration(
+		EventType eventType,
+		std::chrono::nanoseconds duration)
+	{
+		histograms_[static_cast<size_t>(eventType)].Add(duration);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::AddExceptionDuration(
+		DWORD exceptionCode,
+		std::chrono::nanoseconds duration)
+	{
+		exceptionHistograms_[exceptionCode].Add(duration);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::SetRunTime(std::chrono::nanoseconds runTime)
+	{
+		runTime_ = runTime;
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::OnLoadModule(
+		DWORD processId,
+		void* baseOfImage,
+		const std::wstring& path)
+	{
+		auto& breakPointCount = breakPointCounts_[path];
+		loadedModules_[processId][reinterpret_cast<DWORD64>(baseOfImage)] = &breakPointCount;
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::OnUnloadModule(DWORD processId, void* baseOfImage)
+	{
+		auto it = loadedModules_.find(processId);
+
+		if (it != loadedModules_.end())
+			it->second.erase(reinterpret_cast<DWORD64>(baseOfImage));
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::OnExitProcess(DWORD processId)
+	{
+		loadedModules_.erase(processId);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::OnBreakPoint(DWORD processId, void* address)
+	{
+		auto it = loadedModules_.find(processId);
+		if (it == loadedModules_.end())
+			return;
+
+		const auto& modules = it->second;
+		auto moduleIt = modules.upper_bound(reinterpret_cast<DWORD64>(address));
+		if (moduleIt != modules.begin())
+			++*(--moduleIt)->second;
+	}
+
+	//-------------------------------------------------------------------------
+	const DebugEventStatistics::Histogram&
+	DebugEventStatistics::GetHistogram(EventType eventType) const
+	{
+		return histograms_.at(static_cast<size_t>(eventType));
+	}
+
+	//-------------------------------------------------------------------------
+	const std::map<DWORD, DebugEventStatistics::Histogram>&
+	DebugEventStatistics::GetExceptionHistograms() const
+	{
+		return exceptionHistograms_;
+	}
+
+	//-------------------------------------------------------------------------
+	std::chrono::nanoseconds DebugEventStatistics::GetRunTime() const
+	{
+		return runTime_;
+	}
+
+	//-------------------------------------------------------------------------
+	uint64_t DebugEventStatistics::GetBreakPointCount(const std::wstring& modulePath) const
+	{
+		auto it = breakPointCounts_.find(modulePath);
+
+		return it != breakPointCounts_.end() ? it->second : 0;
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::LogStatistics() const
+	{
+		const auto& wait = GetHistogram(EventType::Wait);
+		const auto& breakPoint = GetHistogram(EventType::BreakPoint);
+		const auto& loadDll = GetHistogram(EventType::LoadDll);
+		auto eventCount = GetEventCount(*this);
+		auto runTime = ToSeconds(runTime_);
+
+		LOG_INFO << L"Debug events: " << eventCount << L" in " << runTime << L"s ("
+		         << (runTime > 0 ? eventCount / runTime : 0) << L" events/s), "
+		         << ToSeconds(wait.GetTotal()) << L"s waiting, "
+		         << breakPoint.GetCount() << L" breakpoint(s) handled in "
+		         << ToSeconds(breakPoint.GetTotal()) << L"s, "
+		         << loadDll.GetCount() << L" dll(s) loaded in "
+		         << ToSeconds(loadDll.GetTotal()) << L"s.";
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventStatistics::WriteJson(std::ostream& ostr) const
+	{
+		auto eventCount = GetEventCount(*this);
+		auto runTime = ToSeconds(runTime_);
+
+		ostr << "{\n";
+		ostr << "  \"version\": " << JsonVersion << ",\n";
+		ostr << "  \"runTimeInSeconds\": " << runTime << ",\n";
+		ostr << "  \"eventCount\": " << eventCount << ",\n";
+		ostr << "  \"eventsPerSecond\": " << (runTime > 0 ? eventCount / runTime : 0) << ",\n";
+		ostr << "  \"breakPointsPerSecond\": "
+		     << (runTime > 0 ? GetHistogram(EventType::BreakPoint).GetCount() / runTime : 0) << ",\n";
+
+		ostr << "  \"bucketUpperBoundsInMicroseconds\": [";
+		for (size_t i = 0; i < Histogram::BucketCount - 1; ++i)
+			ostr << (i ? ", " : "") << (uint64_t{ 1 } << i);
+		ostr << "],\n";
+
+		ostr << "  \"events\": {";
+		for (size_t i = 0; i < histograms_.size(); ++i)
+		{
+			ostr << (i ? "," : "") << "\n    \"" << GetEventTypeName(static_cast<EventType>(i)) << "\": ";
+			WriteJsonHistogram(ostr, histograms_[i]);
+		}
+		ostr << "\n  },\n";
+
+		ostr << "  \"exceptionsByCode\": {";
+		bool isFirstCode = true;
+		for (const auto& pair : exceptionHistograms_)
+		{
+			ostr << (isFirstCode ? "" : ",") << "\n    \"0x" << std::hex << pair.first << std::dec << "\": ";
+			WriteJsonHistogram(ostr, pair.second);
+			isFirstCode = false;
+		}
+		ostr << "\n  },\n";
+
+		ostr << "  \"breakPointsByModule\": [";
+		bool isFirst = true;
+		for (const auto& pair : breakPointCounts_)
+		{
+			ostr << (isFirst ? "" : ",") << "\n    {\"path\": ";
+			WriteJsonString(ostr, Tools::ToUtf8String(pair.first));
+			ostr << ", \"count\": " << pair.second << "}";
+			isFirst = false;
+		}
+		ostr << "\n  ]\n}\n";
+	}
+
+	//-------------------------------------------------------------------------
+	const char* DebugEventStatistics::GetEventTypeName(EventType eventType)
+	{
+		switch (eventType)
+		{
+			case EventType::Wait: return "wait";
+			case EventType::CreateProcess: return "createProcess";
+			case EventType::ExitProcess: return "exitProcess";
+			case EventType::CreateThread: return "createThread";
+			case EventType::ExitThread: return "exitThread";
+			case EventType::LoadDll: return "loadDll";
+			case EventType::UnloadDll: return "unloadDll";
+			case EventType::BreakPoint: return "breakPoint";
+			case EventType::GuardPage: return "guardPage";
+			case EventType::Exception: return "exception";
+			case EventType::Other: return "other";
+			default: return "unknown";
+		}
+	}
+}
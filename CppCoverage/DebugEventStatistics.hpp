@@ -0,0 +1,116 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Windows.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	// Time spent by the debugger loop for each kind of debug event and
+	// number of breakpoints hit by module. Adding a duration is a few
+	// arithmetic operations so the collection is always enabled.
+	class CPPCOVERAGE_DLL DebugEventStatistics
+	{
+	public:
+		enum class EventType
+		{
+			Wait, // Time blocked in WaitForDebugEvent.
+			CreateProcess,
+			ExitProcess,
+			CreateThread,
+			ExitThread,
+			LoadDll,
+			UnloadDll,
+			BreakPoint,
+			GuardPage,
+			Exception, // Exception not handled as a breakpoint.
+			Other,
+			Count
+		};
+
+		// Bucket i counts the durations lower than 2^i microseconds and
+		// greater or equal to 2^(i-1). The last bucket has no upper bound.
+		class CPPCOVERAGE_DLL Histogram
+		{
+		public:
+			static const size_t BucketCount = 24;
+
+			Histogram();
+
+			void Add(std::chrono::nanoseconds);
+
+			uint64_t GetCount() const;
+			std::chrono::nanoseconds GetTotal() const;
+			std::chrono::nanoseconds GetMax() const;
+			const std::array<uint64_t, BucketCount>& GetBuckets() const;
+
+		private:
+			uint64_t count_;
+			std::chrono::nanoseconds total_;
+			std::chrono::nanoseconds max_;
+			std::array<uint64_t, BucketCount> buckets_;
+		};
+
+		DebugEventStatistics();
+
+		DebugEventStatistics(const DebugEventStatistics&) = delete;
+		DebugEventStatistics& operator=(const DebugEventStatistics&) = delete;
+
+		void AddDuration(EventType, std::chrono::nanoseconds);
+		// Time of an exception of type EventType::Exception.
+		void AddExceptionDuration(DWORD exceptionCode, std::chrono::nanoseconds);
+		void SetRunTime(std::chrono::nanoseconds);
+
+		void OnLoadModule(DWORD processId, void* baseOfImage, const std::wstring& path);
+		void OnUnloadModule(DWORD processId, void* baseOfImage);
+		void OnExitProcess(DWORD processId);
+		void OnBreakPoint(DWORD processId, void* address);
+
+		const Histogram& GetHistogram(EventType) const;
+		const std::map<DWORD, Histogram>& GetExceptionHistograms() const;
+		std::chrono::nanoseconds GetRunTime() const;
+		uint64_t GetBreakPointCount(const std::wstring& modulePath) const;
+
+		void LogStatistics() const;
+		void WriteJson(std::ostream&) const;
+
+		static const char* GetEventTypeName(EventType);
+
+	private:
+		std::array<Histogram, static_cast<size_t>(EventType::Count)> histograms_;
+		std::map<DWORD, Histogram> exceptionHistograms_;
+		std::chrono::nanoseconds runTime_;
+
+		// Breakpoint count by module path.
+		std::map<std::wstring, uint64_t> breakPointCounts_;
+
+		// Module size is unknown: an address belongs to the module with the
+		// closest lower base of image.
+		std::unordered_map<DWORD, std::map<DWORD64, uint64_t*>> loadedModules_;
+	};
+}
@@ -0,0 +1,290 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "DebugEventTrace.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "CppCoverageException.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		const uint32_t TraceMagic = 0x5445434f; // "OCET"
+		const uint32_t TraceVersion = 3;
+
+		// Minimum sizes of the serialized elements: counts of the empty
+		// vectors and strings they contain.
+		const size_t MinModuleSize = 3 * sizeof(uint32_t);
+		const size_t MinSourceFileSize = 2 * sizeof(uint32_t);
+		const size_t LineSize = 2 * sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint8_t);
+		const size_t MinPageSize = sizeof(DWORD) + sizeof(uint32_t);
+		const size_t EventSize = sizeof(uint32_t) + 2 * sizeof(DWORD) +
+		                         sizeof(DWORD64) + sizeof(DWORD) +
+		                         sizeof(uint8_t) + sizeof(int32_t) +
+		                         sizeof(uint32_t);
+
+		//---------------------------------------------------------------------
+		template <typename T>
+		void Write(std::ofstream& ofs, const T& value)
+		{
+			ofs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		//---------------------------------------------------------------------
+		template <typename T>
+		void WriteVector(std::ofstream& ofs, const std::vector<T>& values)
+		{
+			Write(ofs, static_cast<uint32_t>(values.size()));
+			ofs.write(reinterpret_cast<const char*>(values.data()),
+			          values.size() * sizeof(T));
+		}
+
+		//---------------------------------------------------------------------
+		void WriteString(std::ofstream& ofs, const std::wstring& str)
+		{
+			Write(ofs, static_cast<uint32_t>(str.size()));
+			ofs.write(reinterpret_cast<const char*>(str.data()),
+			          str.size() * sizeof(wchar_t));
+		}
+
+		//---------------------------------------------------------------------
+		void WriteModule(std::ofstream& ofs, const DebugEventTrace::Module& module)
+		{
+			WriteString(ofs, module.path_);
+			Write(ofs, static_cast<uint32_t>(module.sourceFiles_.size()));
+			for (const auto& sourceFile : module.sourceFiles_)
+			{
+				WriteString(ofs, sourceFile.path_);
+				Write(ofs, static_cast<uint32_t>(sourceFile.lines_.size()));
+				for (const auto& line : sourceFile.lines_)
+				{
+					Write(ofs, static_cast<uint32_t>(line.lineNumber_));
+					Write(ofs, static_cast<uint32_t>(line.symbolIndex_));
+					Write(ofs, line.virtualAddress_);
+					Write(ofs, static_cast<uint8_t>(line.isFunctionEntry_));
+				}
+			}
+
+			Write(ofs, static_cast<uint32_t>(module.pages_.size()));
+			for (const auto& page : module.pages_)
+			{
+				Write(ofs, page.rva_);
+				WriteVector(ofs, page.bytes_);
+			}
+		}
+
+		//---------------------------------------------------------------------
+		void WriteEvent(std::ofstream& ofs, const DebugEventTrace::Event& event)
+		{
+			Write(ofs, static_cast<uint32_t>(event.type_));
+			Write(ofs, event.processId_);
+			Write(ofs, event.threadId_);
+			Write(ofs, event.address_);
+			Write(ofs, event.code_);
+			Write(ofs, static_cast<uint8_t>(event.isFirstChance_));
+			Write(ofs, event.moduleIndex_);
+			WriteVector(ofs, event.exceptionInformation_);
+		}
+
+		//---------------------------------------------------------------------
+		class TraceReader
+		{
+		  public:
+			//-----------------------------------------------------------------
+			TraceReader(const std::filesystem::path& path, std::vector<char>&& data)
+			    : path_{path}, data_{std::move(data)}, current_{0}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			template <typename T>
+			T Read()
+			{
+				T value;
+				Read(&value, sizeof(T));
+				return value;
+			}
+
+			//-----------------------------------------------------------------
+			void Read(void* buffer, size_t size)
+			{
+				CheckRemainingSize(size);
+				if (size)
+					std::memcpy(buffer, &data_[current_], size);
+				current_ += size;
+			}
+
+			//-----------------------------------------------------------------
+			std::wstring ReadString()
+			{
+				auto size = ReadCount(sizeof(wchar_t));
+				std::wstring str(size, L'\0');
+				Read(&str[0], str.size() * sizeof(wchar_t));
+				return str;
+			}
+
+			//-----------------------------------------------------------------
+			// Read a count of elements using at least elementSize bytes each.
+			// A corrupted count cannot allocate more than the trace size.
+			size_t ReadCount(size_t elementSize)
+			{
+				size_t count = Read<uint32_t>();
+				CheckRemainingSize(count * elementSize);
+				return count;
+			}
+
+			//-----------------------------------------------------------------
+			template <typename T>
+			std::vector<T> ReadVector()
+			{
+				auto size = ReadCount(sizeof(T));
+				std::vector<T> values(size);
+				Read(values.data(), values.size() * sizeof(T));
+				return values;
+			}
+
+			//-----------------------------------------------------------------
+			bool IsAtEnd() const
+			{
+				return current_ == data_.size();
+			}
+
+		  private:
+			//-----------------------------------------------------------------
+			void CheckRemainingSize(size_t size) const
+			{
+				if (data_.size() - current_ < size)
+					THROW(L"Debug event trace " << path_.wstring() << L" is truncated.");
+			}
+
+			const std::filesystem::path path_;
+			const std::vector<char> data_;
+			size_t current_;
+		};
+
+		//---------------------------------------------------------------------
+		DebugEventTrace::Module ReadModule(TraceReader& reader)
+		{
+			DebugEventTrace::Module module;
+
+			module.path_ = reader.ReadString();
+			module.sourceFiles_.resize(reader.ReadCount(MinSourceFileSize));
+			for (auto& sourceFile : module.sourceFiles_)
+			{
+				sourceFile.path_ = reader.ReadString();
+				auto lineCount = reader.ReadCount(LineSize);
+				sourceFile.lines_.reserve(lineCount);
+				for (size_t i = 0; i < lineCount; ++i)
+				{
+					auto lineNumber = reader.Read<uint32_t>();
+					auto symbolIndex = reader.Read<uint32_t>();
+					auto virtualAddress = reader.Read<int64_t>();
+					auto isFunctionEntry = reader.Read<uint8_t>() != 0;
+					sourceFile.lines_.emplace_back(
+					    lineNumber, virtualAddress, symbolIndex, isFunctionEntry);
+				}
+			}
+
+			module.pages_.resize(reader.ReadCount(MinPageSize));
+			for (auto& page : module.pages_)
+			{
+				page.rva_ = reader.Read<DWORD>();
+				page.bytes_ = reader.ReadVector<unsigned char>();
+			}
+			return module;
+		}
+
+		//---------------------------------------------------------------------
+		DebugEventTrace::Event ReadEvent(TraceReader& reader)
+		{
+			DebugEventTrace::Event event;
+
+			event.type_ =
+			    static_cast<DebugEventTrace::EventType>(reader.Read<uint32_t>());
+			event.processId_ = reader.Read<DWORD>();
+			event.threadId_ = reader.Read<DWORD>();
+			event.address_ = reader.Read<DWORD64>();
+			event.code_ = reader.Read<DWORD>();
+			event.isFirstChance_ = reader.Read<uint8_t>() != 0;
+			event.moduleIndex_ = reader.Read<int32_t>();
+			event.exceptionInformation_ = reader.ReadVector<DWORD64>();
+			return event;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void SaveDebugEventTrace(const DebugEventTrace& trace,
+	                         const std::filesystem::path& path)
+	{
+		std::ofstream ofs{path, std::ios::binary};
+
+		Write(ofs, TraceMagic);
+		Write(ofs, TraceVersion);
+		Write(ofs, static_cast<uint32_t>(trace.modules_.size()));
+		for (const auto& module : trace.modules_)
+			WriteModule(ofs, module);
+		Write(ofs, static_cast<uint32_t>(trace.events_.size()));
+		for (const auto& event : trace.events_)
+			WriteEvent(ofs, event);
+
+		if (!ofs)
+			THROW(L"Cannot write debug event trace " << path.wstring());
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventTrace LoadDebugEventTrace(const std::filesystem::path& path)
+	{
+		std::ifstream ifs{path, std::ios::binary};
+		if (!ifs)
+			THROW(L"Cannot open debug event trace " << path.wstring());
+
+		TraceReader reader{path,
+		                   std::vector<char>{std::istreambuf_iterator<char>{ifs},
+		                                     std::istreambuf_iterator<char>{}}};
+		if (reader.Read<uint32_t>() != TraceMagic ||
+		    reader.Read<uint32_t>() != TraceVersion)
+		{
+			THROW(path.wstring() << L" is not a valid debug event trace.");
+		}
+
+		DebugEventTrace trace;
+		trace.modules_.resize(reader.ReadCount(MinModuleSize));
+		for (auto& module : trace.modules_)
+			module = ReadModule(reader);
+
+		auto eventCount = reader.ReadCount(EventSize);
+		trace.events_.reserve(eventCount);
+		for (size_t i = 0; i < eventCount; ++i)
+		{
+			auto event = ReadEvent(reader);
+			if (event.moduleIndex_ >= static_cast<int32_t>(trace.modules_.size()))
+				THROW(L"Invalid module index in debug event trace " << path.wstring());
+			if (event.exceptionInformation_.size() > EXCEPTION_MAXIMUM_PARAMETERS)
+				THROW(L"Invalid exception information in debug event trace " << path.wstring());
+			trace.events_.push_back(std::move(event));
+		}
+
+		if (!reader.IsAtEnd())
+			THROW(path.wstring() << L" is not a valid debug event trace.");
+		return trace;
+	}
+}
@@ -0,0 +1,94 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Windows.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "CppCoverageExport.hpp"
+#include "DebugInformationEnumerator.hpp"
+
+namespace CppCoverage
+{
+	// Debug events of a run with the line tables and the code pages of the
+	// selected modules. It is enough to replay the coverage of the run
+	// without the debuggee, see DebugEventsRecorder, DebugEventsReplayer and
+	// CodeCoverageRunner::ReplayCoverage.
+	struct CPPCOVERAGE_DLL DebugEventTrace
+	{
+		static const DWORD PageSize = 4096;
+		static const int32_t NoModule = -1;
+
+		enum class EventType : uint32_t
+		{
+			CreateProcess,
+			ExitProcess,
+			LoadDll,
+			UnloadDll,
+			Exception
+		};
+
+		struct Event
+		{
+			EventType type_;
+			DWORD processId_;
+			DWORD threadId_;
+			// Base of image for module events, exception address otherwise.
+			DWORD64 address_;
+			// Exit code or exception code.
+			DWORD code_;
+			bool isFirstChance_;
+			int32_t moduleIndex_;
+			// EXCEPTION_RECORD::ExceptionInformation, for example the
+			// accessed address of a guard page violation.
+			std::vector<DWORD64> exceptionInformation_;
+		};
+
+		struct Page
+		{
+			DWORD rva_;
+			std::vector<unsigned char> bytes_;
+		};
+
+		struct SourceFile
+		{
+			std::wstring path_;
+			std::vector<IDebugInformationHandler::Line> lines_;
+		};
+
+		// Unselected modules have only a path.
+		struct Module
+		{
+			std::wstring path_;
+			std::vector<SourceFile> sourceFiles_;
+			std::vector<Page> pages_;
+		};
+
+		std::vector<Event> events_;
+		std::vector<Module> modules_;
+	};
+
+	CPPCOVERAGE_DLL void SaveDebugEventTrace(const DebugEventTrace&,
+	                                         const std::filesystem::path&);
+	CPPCOVERAGE_DLL DebugEventTrace
+	LoadDebugEventTrace(const std::filesystem::path&);
+}
@@ -0,0 +1,349 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "DebugEventsRecorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+#include "tools/Log.hpp"
+#include "Tools/PEFileHeader.hpp"
+#include "Tools/ProcessMemory.hpp"
+
+#include "DebugInformationEnumerator.hpp"
+#include "HandleInformation.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		struct SourceFileRecorder : IDebugInformationHandler
+		{
+			//-----------------------------------------------------------------
+			bool IsSourceFileSelected(const std::filesystem::path&) override
+			{
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			void OnSourceFile(const std::filesystem::path& path,
+			                  const std::vector<Line>& lines) override
+			{
+				sourceFiles_.push_back({path.wstring(), lines});
+			}
+
+			std::vector<DebugEventTrace::SourceFile> sourceFiles_;
+		};
+
+		// Same layout as RUNTIME_FUNCTION on x64.
+		struct RuntimeFunction
+		{
+			DWORD beginAddress_;
+			DWORD endAddress_;
+			DWORD unwindInfoAddress_;
+		};
+
+		// Header, unwind codes and exception handler or chained function.
+		const DWORD MaxUnwindInfoSize = 4 + 256 * 2 + 12;
+
+		//---------------------------------------------------------------------
+		// Function table of a x64 module, see UnwindTable.
+		struct ExceptionDirectory : private Tools::IPEFileHeaderHandler
+		{
+			//-----------------------------------------------------------------
+			IMAGE_DATA_DIRECTORY Load(HANDLE hProcess, void* baseOfImage)
+			{
+				Tools::PEFileHeader fileHeader;
+
+				fileHeader.Load(hProcess, reinterpret_cast<DWORD64>(baseOfImage), *this);
+				return exceptionDirectory_;
+			}
+
+		private:
+			//-----------------------------------------------------------------
+			void OnNtHeader32(HANDLE, DWORD64, const IMAGE_NT_HEADERS32&) override
+			{
+			}
+
+			//-----------------------------------------------------------------
+			void OnNtHeader64(HANDLE, DWORD64, const IMAGE_NT_HEADERS64& ntHeader) override
+			{
+				exceptionDirectory_ = ntHeader.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION];
+			}
+
+			IMAGE_DATA_DIRECTORY exceptionDirectory_ = {};
+		};
+
+		//---------------------------------------------------------------------
+		void AddPageRvas(std::set<DWORD>& pageRvas, DWORD rva, DWORD size)
+		{
+			for (auto pageRva = rva - rva % DebugEventTrace::PageSize; pageRva < rva + size;
+				pageRva += DebugEventTrace::PageSize)
+			{
+				pageRvas.insert(pageRva);
+			}
+		}
+
+		//---------------------------------------------------------------------
+		// Pages read by CodeCoverageRunner when the module is loaded: the
+		// header, the function table with the unwind information and the code
+		// of the lines with the next page as the code of a function is
+		// decoded past its last line.
+		std::set<DWORD> GetRecordedPageRvas(
+			HANDLE hProcess,
+			void* baseOfImage,
+			const std::vector<DebugEventTrace::SourceFile>& sourceFiles)
+		{
+			std::set<DWORD> pageRvas{ 0 };
+
+			try
+			{
+				auto exceptionDirectory = ExceptionDirectory{}.Load(hProcess, baseOfImage);
+				auto count = exceptionDirectory.Size / sizeof(RuntimeFunction);
+
+				if (exceptionDirectory.VirtualAddress != 0 && count != 0)
+				{
+					AddPageRvas(pageRvas, exceptionDirectory.VirtualAddress, exceptionDirectory.Size);
+
+					auto buffer = Tools::ReadProcessMemory(
+						hProcess,
+						static_cast<char*>(baseOfImage) + exceptionDirectory.VirtualAddress,
+						count * sizeof(RuntimeFunction));
+					std::vector<RuntimeFunction> runtimeFunctions(count);
+					std::memcpy(runtimeFunctions.data(), buffer.data(), buffer.size());
+					for (const auto& runtimeFunction : runtimeFunctions)
+						AddPageRvas(pageRvas, runtimeFunction.unwindInfoAddress_, MaxUnwindInfoSize);
+				}
+			}
+			catch (const std::exception& e)
+			{
+				LOG_DEBUG << L"Cannot read the function table of the module: " << e.what();
+			}
+
+			for (const auto& sourceFile : sourceFiles)
+			{
+				for (const auto& line : sourceFile.lines_)
+				{
+					AddPageRvas(pageRvas,
+					            static_cast<DWORD>(line.virtualAddress_),
+					            DebugEventTrace::PageSize);
+				}
+			}
+			return pageRvas;
+		}
+
+		//---------------------------------------------------------------------
+		// Pages are read before the handler sets its breakpoints so they
+		// contain the original instructions. Pages which cannot be read are
+		// not recorded.
+		std::vector<DebugEventTrace::Page> ReadPages(
+			HANDLE hProcess,
+			void* baseOfImage,
+			const std::set<DWORD>& pageRvas)
+		{
+			std::vector<DebugEventTrace::Page> pages;
+			for (auto rva : pageRvas)
+			{
+				DebugEventTrace::Page page{ rva, std::vector<unsigned char>(DebugEventTrace::PageSize) };
+				SIZE_T bytesRead = 0;
+
+				if (!ReadProcessMemory(
+					hProcess,
+					static_cast<char*>(baseOfImage) + rva,
+					page.bytes_.data(),
+					page.bytes_.size(),
+					&bytesRead) && bytesRead == 0)
+				{
+					LOG_DEBUG << L"Cannot read the page " << rva << L" of the module.";
+					continue;
+				}
+				page.bytes_.resize(bytesRead);
+				pages.push_back(std::move(page));
+			}
+			return pages;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventsRecorder::DebugEventsRecorder(
+		IDebugEventsHandler& debugEventsHandler,
+		IsModuleSelected isModuleSelected,
+		std::unique_ptr<IDebugInformationEnumerator> debugInformationEnumerator)
+		: debugEventsHandler_{ debugEventsHandler }
+		, isModuleSelected_{ std::move(isModuleSelected) }
+		, debugInformationEnumerator_{ std::move(debugInformationEnumerator) }
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventsRecorder::~DebugEventsRecorder()
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsRecorder::OnCreateProcess(const CREATE_PROCESS_DEBUG_INFO& processDebugInfo)
+	{
+		auto moduleIndex = RecordModule(
+			processDebugInfo.hProcess,
+			processDebugInfo.hFile,
+			processDebugInfo.lpBaseOfImage);
+		RecordEvent(
+			DebugEventTrace::EventType::CreateProcess,
+			processDebugInfo.hProcess,
+			processDebugInfo.hThread,
+			reinterpret_cast<DWORD64>(processDebugInfo.lpBaseOfImage),
+			0, false, moduleIndex);
+		debugEventsHandler_.OnCreateProcess(processDebugInfo);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsRecorder::OnExitProcess(
+		HANDLE hProcess,
+		HANDLE hThread,
+		const EXIT_PROCESS_DEBUG_INFO& exitProcessDebugInfo)
+	{
+		RecordEvent(
+			DebugEventTrace::EventType::ExitProcess,
+			hProcess, hThread, 0, exitProcessDebugInfo.dwExitCode);
+		debugEventsHandler_.OnExitProcess(hProcess, hThread, exitProcessDebugInfo);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsRecorder::OnLoadDll(
+		HANDLE hProcess,
+		HANDLE hThread,
+		const LOAD_DLL_DEBUG_INFO& loadDllDebugInfo)
+	{
+		auto moduleIndex = RecordModule(
+			hProcess, loadDllDebugInfo.hFile, loadDllDebugInfo.lpBaseOfDll);
+		RecordEvent(
+			DebugEventTrace::EventType::LoadDll,
+			hProcess,
+			hThread,
+			reinterpret_cast<DWORD64>(loadDllDebugInfo.lpBaseOfDll),
+			0, false, moduleIndex);
+		debugEventsHandler_.OnLoadDll(hProcess, hThread, loadDllDebugInfo);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsRecorder::OnUnloadDll(
+		HANDLE hProcess,
+		HANDLE hThread,
+		const UNLOAD_DLL_DEBUG_INFO& unloadDllDebugInfo)
+	{
+		RecordEvent(
+			DebugEventTrace::EventType::UnloadDll,
+			hProcess,
+			hThread,
+			reinterpret_cast<DWORD64>(unloadDllDebugInfo.lpBaseOfDll));
+		debugEventsHandler_.OnUnloadDll(hProcess, hThread, unloadDllDebugInfo);
+	}
+
+	//-------------------------------------------------------------------------
+	IDebugEventsHandler::ExceptionType DebugEventsRecorder::OnException(
+		HANDLE hProcess,
+		HANDLE hThread,
+		const EXCEPTION_DEBUG_INFO& exceptionDebugInfo)
+	{
+		const auto& exceptionRecord = exceptionDebugInfo.ExceptionRecord;
+
+		RecordEvent(
+			DebugEventTrace::EventType::Exception,
+			hProcess,
+			hThread,
+			reinterpret_cast<DWORD64>(exceptionRecord.ExceptionAddress),
+			exceptionRecord.ExceptionCode,
+			exceptionDebugInfo.dwFirstChance != 0);
+		auto numberParameters = std::min<DWORD>(
+			exceptionRecord.NumberParameters, EXCEPTION_MAXIMUM_PARAMETERS);
+		trace_.events_.back().exceptionInformation_.assign(
+			exceptionRecord.ExceptionInformation,
+			exceptionRecord.ExceptionInformation + numberParameters);
+		return debugEventsHandler_.OnException(hProcess, hThread, exceptionDebugInfo);
+	}
+
+	//-------------------------------------------------------------------------
+	bool DebugEventsRecorder::ShouldDetach(HANDLE hProcess)
+	{
+		return debugEventsHandler_.ShouldDetach(hProcess);
+	}
+
+	//-------------------------------------------------------------------------
+	const DebugEventTrace& DebugEventsRecorder::GetTrace() const
+	{
+		return trace_;
+	}
+
+	//-------------------------------------------------------------------------
+	int32_t DebugEventsRecorder::RecordModule(
+		HANDLE hProcess,
+		HANDLE hFile,
+		void* baseOfImage)
+	{
+		std::wstring filename;
+		try
+		{
+			filename = HandleInformation{}.ComputeFilename(hFile);
+		}
+		catch (const std::exception& e)
+		{
+			LOG_WARNING << L"Cannot record module: " << e.what();
+			return DebugEventTrace::NoModule;
+		}
+
+		DebugEventTrace::Module module;
+		module.path_ = filename;
+		if (isModuleSelected_(filename))
+		{
+			SourceFileRecorder sourceFileRecorder;
+			debugInformationEnumerator_->Enumerate(filename, sourceFileRecorder);
+
+			module.pages_ = ReadPages(
+				hProcess,
+				baseOfImage,
+				GetRecordedPageRvas(hProcess, baseOfImage, sourceFileRecorder.sourceFiles_));
+			module.sourceFiles_ = std::move(sourceFileRecorder.sourceFiles_);
+		}
+		trace_.modules_.push_back(std::move(module));
+
+		return static_cast<int32_t>(trace_.modules_.size() - 1);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsRecorder::RecordEvent(
+		DebugEventTrace::EventType type,
+		HANDLE hProcess,
+		HANDLE hThread,
+		DWORD64 address,
+		DWORD code,
+		bool isFirstChance,
+		int32_t moduleIndex)
+	{
+		trace_.events_.push_back({
+			type,
+			GetProcessId(hProcess),
+			GetThreadId(hThread),
+			address,
+			code,
+			isFirstChance,
+			moduleIndex,
+			{} });
+	}
+}
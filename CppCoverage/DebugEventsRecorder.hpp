@@ -0,0 +1,75 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+#include "IDebugEventsHandler.hpp"
+#include "DebugEventTrace.hpp"
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	class IDebugInformationEnumerator;
+
+	// Forward the debug events to another handler and record them with the
+	// paths of the modules and the line tables and the pages of the selected
+	// modules.
+	class CPPCOVERAGE_DLL DebugEventsRecorder : public IDebugEventsHandler
+	{
+	public:
+		using IsModuleSelected = std::function<bool(const std::filesystem::path&)>;
+
+		DebugEventsRecorder(
+			IDebugEventsHandler&,
+			IsModuleSelected,
+			std::unique_ptr<IDebugInformationEnumerator>);
+		~DebugEventsRecorder();
+
+		void OnCreateProcess(const CREATE_PROCESS_DEBUG_INFO&) override;
+		void OnExitProcess(HANDLE hProcess, HANDLE hThread, const EXIT_PROCESS_DEBUG_INFO&) override;
+		void OnLoadDll(HANDLE hProcess, HANDLE hThread, const LOAD_DLL_DEBUG_INFO&) override;
+		void OnUnloadDll(HANDLE hProcess, HANDLE hThread, const UNLOAD_DLL_DEBUG_INFO&) override;
+		ExceptionType OnException(HANDLE hProcess, HANDLE hThread, const EXCEPTION_DEBUG_INFO&) override;
+		bool ShouldDetach(HANDLE hProcess) override;
+
+		const DebugEventTrace& GetTrace() const;
+
+	private:
+		DebugEventsRecorder(const DebugEventsRecorder&) = delete;
+		DebugEventsRecorder& operator=(const DebugEventsRecorder&) = delete;
+
+		int32_t RecordModule(HANDLE hProcess, HANDLE hFile, void* baseOfImage);
+		void RecordEvent(
+			DebugEventTrace::EventType,
+			HANDLE hProcess,
+			HANDLE hThread,
+			DWORD64 address,
+			DWORD code = 0,
+			bool isFirstChance = false,
+			int32_t moduleIndex = DebugEventTrace::NoModule);
+
+	private:
+		IDebugEventsHandler& debugEventsHandler_;
+		IsModuleSelected isModuleSelected_;
+		std::unique_ptr<IDebugInformationEnumerator> debugInformationEnumerator_;
+		DebugEventTrace trace_;
+	};
+}
@@ -0,0 +1,257 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "DebugEventsReplayer.hpp"
+
+#include <algorithm>
+
+#include "tools/Log.hpp"
+#include "tools/Tool.hpp"
+#include "Tools/SimulatedProcessMemory.hpp"
+
+#include "BreakPoint.hpp"
+#include "CppCoverageException.hpp"
+#include "IPageMemory.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		class ReplayedPageMemory : public IPageMemory
+		{
+		  public:
+			//-----------------------------------------------------------------
+			explicit ReplayedPageMemory(
+			    std::shared_ptr<Tools::IProcessMemory> processMemory)
+			    : breakPoint_{std::move(processMemory)}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			bool GuardPage(HANDLE, DWORD64) override
+			{
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			void UnguardPage(HANDLE, DWORD64) override
+			{
+			}
+
+			//-----------------------------------------------------------------
+			void WriteBreakPoints(HANDLE hProcess,
+			                      std::vector<DWORD64>&& addresses) override
+			{
+				breakPoint_.SetBreakPoints(hProcess, std::move(addresses));
+			}
+
+		  private:
+			BreakPoint breakPoint_;
+		};
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventsReplayer::DebugEventsReplayer(const DebugEventTrace& trace)
+		: trace_{ trace }
+		, processMemory_{ std::make_shared<Tools::SimulatedProcessMemory>() }
+		, exitCode_{ 0 }
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventsReplayer::~DebugEventsReplayer()
+	{
+		Tools::Try([&]() {
+			while (!processes_.empty())
+				ReleaseProcess(processes_.begin()->first);
+		});
+	}
+
+	//-------------------------------------------------------------------------
+	size_t DebugEventsReplayer::Replay(IDebugEventsHandler& debugEventsHandler)
+	{
+		for (const auto& event : trace_.events_)
+		{
+			auto& process = GetProcess(event.processId_);
+			auto hProcess = process.hProcess_;
+			auto address = reinterpret_cast<void*>(event.address_);
+
+			switch (event.type_)
+			{
+				case DebugEventTrace::EventType::CreateProcess:
+				{
+					LoadModule(process, event);
+					CREATE_PROCESS_DEBUG_INFO processDebugInfo{};
+					processDebugInfo.hProcess = hProcess;
+					processDebugInfo.lpBaseOfImage = address;
+					debugEventsHandler.OnCreateProcess(processDebugInfo);
+					break;
+				}
+				case DebugEventTrace::EventType::ExitProcess:
+				{
+					if (event.processId_ == firstProcessId_)
+						exitCode_ = static_cast<int>(event.code_);
+					EXIT_PROCESS_DEBUG_INFO exitProcessDebugInfo{};
+					exitProcessDebugInfo.dwExitCode = event.code_;
+					debugEventsHandler.OnExitProcess(hProcess, nullptr, exitProcessDebugInfo);
+					ReleaseProcess(event.processId_);
+					break;
+				}
+				case DebugEventTrace::EventType::LoadDll:
+				{
+					LoadModule(process, event);
+					LOAD_DLL_DEBUG_INFO loadDllDebugInfo{};
+					loadDllDebugInfo.lpBaseOfDll = address;
+					debugEventsHandler.OnLoadDll(hProcess, nullptr, loadDllDebugInfo);
+					break;
+				}
+				case DebugEventTrace::EventType::UnloadDll:
+				{
+					UNLOAD_DLL_DEBUG_INFO unloadDllDebugInfo{};
+					unloadDllDebugInfo.lpBaseOfDll = address;
+					debugEventsHandler.OnUnloadDll(hProcess, nullptr, unloadDllDebugInfo);
+					UnloadModule(process, event.address_);
+					break;
+				}
+				case DebugEventTrace::EventType::Exception:
+				{
+					EXCEPTION_DEBUG_INFO exceptionDebugInfo{};
+					auto& exceptionRecord = exceptionDebugInfo.ExceptionRecord;
+					const auto& exceptionInformation = event.exceptionInformation_;
+
+					exceptionDebugInfo.dwFirstChance = event.isFirstChance_ ? 1 : 0;
+					exceptionRecord.ExceptionCode = event.code_;
+					exceptionRecord.ExceptionAddress = address;
+					exceptionRecord.NumberParameters = static_cast<DWORD>(
+						std::min<size_t>(exceptionInformation.size(), EXCEPTION_MAXIMUM_PARAMETERS));
+					for (DWORD i = 0; i < exceptionRecord.NumberParameters; ++i)
+						exceptionRecord.ExceptionInformation[i] = static_cast<ULONG_PTR>(exceptionInformation[i]);
+					debugEventsHandler.OnException(hProcess, nullptr, exceptionDebugInfo);
+					break;
+				}
+				default:
+					THROW(L"Invalid debug event type: " << static_cast<uint32_t>(event.type_));
+			}
+		}
+		return trace_.events_.size();
+	}
+
+	//-------------------------------------------------------------------------
+	const std::shared_ptr<Tools::SimulatedProcessMemory>&
+	DebugEventsReplayer::GetProcessMemory() const
+	{
+		return processMemory_;
+	}
+
+	//-------------------------------------------------------------------------
+	std::shared_ptr<IPageMemory> DebugEventsReplayer::CreatePageMemory() const
+	{
+		return std::make_shared<ReplayedPageMemory>(processMemory_);
+	}
+
+	//-------------------------------------------------------------------------
+	const DebugEventTrace::Module* DebugEventsReplayer::FindModule(
+		HANDLE hProcess,
+		void* baseOfImage) const
+	{
+		for (const auto& pair : processes_)
+		{
+			const auto& process = pair.second;
+			if (process.hProcess_ != hProcess)
+				continue;
+
+			auto it = process.modules_.find(reinterpret_cast<DWORD64>(baseOfImage));
+			if (it == process.modules_.end())
+				return nullptr;
+			return &trace_.modules_.at(it->second);
+		}
+		return nullptr;
+	}
+
+	//-------------------------------------------------------------------------
+	int DebugEventsReplayer::GetExitCode() const
+	{
+		return exitCode_;
+	}
+
+	//-------------------------------------------------------------------------
+	DebugEventsReplayer::Process& DebugEventsReplayer::GetProcess(DWORD processId)
+	{
+		auto it = processes_.find(processId);
+
+		if (it == processes_.end())
+		{
+			// A distinct handle per recorded process.
+			auto hProcess = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+			if (!hProcess)
+				THROW_LAST_ERROR(L"Cannot create a handle for a replayed process.", GetLastError());
+			it = processes_.emplace(processId, Process{ hProcess, {} }).first;
+			if (!firstProcessId_)
+				firstProcessId_ = processId;
+		}
+		return it->second;
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsReplayer::LoadModule(
+		Process& process,
+		const DebugEventTrace::Event& event)
+	{
+		if (event.moduleIndex_ == DebugEventTrace::NoModule)
+			return;
+
+		const auto& module = trace_.modules_.at(event.moduleIndex_);
+		for (const auto& page : module.pages_)
+		{
+			processMemory_->Allocate(process.hProcess_,
+			                         event.address_ + page.rva_,
+			                         page.bytes_.data(),
+			                         page.bytes_.size());
+		}
+		process.modules_[event.address_] = event.moduleIndex_;
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsReplayer::UnloadModule(Process& process, DWORD64 baseOfImage)
+	{
+		auto it = process.modules_.find(baseOfImage);
+
+		if (it == process.modules_.end())
+			return;
+
+		const auto& module = trace_.modules_.at(it->second);
+		for (const auto& page : module.pages_)
+			processMemory_->Free(process.hProcess_, baseOfImage + page.rva_, page.bytes_.size());
+		process.modules_.erase(it);
+	}
+
+	//-------------------------------------------------------------------------
+	void DebugEventsReplayer::ReleaseProcess(DWORD processId)
+	{
+		auto it = processes_.find(processId);
+
+		if (it == processes_.end())
+			return;
+
+		auto& process = it->second;
+		while (!process.modules_.empty())
+			UnloadModule(process, process.modules_.begin()->first);
+		CloseHandle(process.hProcess_);
+		processes_.erase(it);
+	}
+}
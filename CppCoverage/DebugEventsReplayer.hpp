@@ -0,0 +1,88 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "IDebugEventsHandler.hpp"
+#include "DebugEventTrace.hpp"
+#include "CppCoverageExport.hpp"
+
+namespace Tools
+{
+	class SimulatedProcessMemory;
+}
+
+namespace CppCoverage
+{
+	class IPageMemory;
+
+	// Feed the events of a trace to a handler without the debuggee.
+	// The recorded pages of each module are loaded at their recorded address
+	// in a simulated memory: use GetProcessMemory to access the memory of
+	// the replayed processes. Each process is represented by a handle which
+	// is not a process handle so the system functions fail with it. Module
+	// events have no file handle: use FindModule to get the module of a
+	// base of image and threads have no handle.
+	class CPPCOVERAGE_DLL DebugEventsReplayer
+	{
+	public:
+		explicit DebugEventsReplayer(const DebugEventTrace&);
+		~DebugEventsReplayer();
+
+		// Return the number of replayed events.
+		size_t Replay(IDebugEventsHandler&);
+
+		const std::shared_ptr<Tools::SimulatedProcessMemory>& GetProcessMemory() const;
+
+		// Replayed processes do not run: guarding a page always succeeds as
+		// the guard page violations are in the trace.
+		std::shared_ptr<IPageMemory> CreatePageMemory() const;
+
+		const DebugEventTrace::Module* FindModule(HANDLE hProcess, void* baseOfImage) const;
+
+		// Exit code of the first replayed process, 0 if it has not exited.
+		int GetExitCode() const;
+
+	private:
+		struct Process
+		{
+			HANDLE hProcess_;
+			// Module indexes by base of image.
+			std::map<DWORD64, int32_t> modules_;
+		};
+
+		DebugEventsReplayer(const DebugEventsReplayer&) = delete;
+		DebugEventsReplayer& operator=(const DebugEventsReplayer&) = delete;
+
+		Process& GetProcess(DWORD processId);
+		void LoadModule(Process&, const DebugEventTrace::Event&);
+		void UnloadModule(Process&, DWORD64 baseOfImage);
+		void ReleaseProcess(DWORD processId);
+
+	private:
+		const DebugEventTrace& trace_;
+		const std::shared_ptr<Tools::SimulatedProcessMemory> processMemory_;
+		std::unordered_map<DWORD, Process> processes_;
+		boost::optional<DWORD> firstProcessId_;
+		int exitCode_;
+	};
+}
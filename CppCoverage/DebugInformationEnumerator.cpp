@@ -22,12 +22,19 @@
 #include <dia2.h>
 #include <atlbase.h>
 
+#include <atomic>
 #include <filesystem>
+#include <future>
+#include <thread>
+#include <unordered_map>
 #include <boost/algorithm/string.hpp>
 
 #include "tools/Log.hpp"
 
 #include "CppCoverageException.hpp"
+#include "DwarfDebugInformationEnumerator.hpp"
+#include "FunctionAddressIndex.hpp"
+#include "LineTableCache.hpp"
 
 namespace CppCoverage
 {
@@ -92,28 +99,61 @@ namespace CppCoverage
 		}
 
 		//----------------------------------------------------------------------
-		CComPtr<IDiaEnumSourceFiles> GetEnumSourceFiles(IDiaSession& session)
+		template <typename Table>
+		CComPtr<Table> GetTable(IDiaSession& session)
 		{
 			CComPtr<IDiaEnumTables> tables;
 			if (session.getEnumTables(&tables) != S_OK || !tables)
 				THROW("DIA: Cannot get tables");
 
-			CComPtr<IDiaEnumSourceFiles> sourceFiles;
+			CComPtr<Table> result;
 
 			EnumerateCollection<IDiaTable>(*tables, [&](IDiaTable& table) {
-				if (!sourceFiles)
+				if (!result)
 				{
-					CComPtr<IDiaEnumSourceFiles> currentSourceFiles;
-					if (table.QueryInterface(_uuidof(IDiaEnumSourceFiles),
-					                         (void**)&currentSourceFiles) ==
-					    S_OK)
+					CComPtr<Table> currentTable;
+					if (table.QueryInterface(_uuidof(Table),
+					                         (void**)&currentTable) == S_OK)
 					{
-						sourceFiles = currentSourceFiles;
+						result = currentTable;
 					}
 				}
 			});
 
-			return sourceFiles;
+			return result;
+		}
+
+		//----------------------------------------------------------------------
+		FunctionAddressIndex CreateFunctionAddressIndex(IDiaSession& session)
+		{
+			CComPtr<IDiaSymbol> globalScope;
+			if (session.get_globalScope(&globalScope) != S_OK || !globalScope)
+				THROW("DIA: Cannot get global scope");
+
+			CComPtr<IDiaEnumSymbols> functions;
+			if (globalScope->findChildren(
+			        SymTagFunction, nullptr, nsNone, &functions) != S_OK ||
+			    !functions)
+			{
+				THROW("DIA: Cannot find functions");
+			}
+
+			FunctionAddressIndex functionAddressIndex;
+			EnumerateCollection<IDiaSymbol>(*functions, [&](IDiaSymbol& function) {
+				ULONGLONG virtualAddress = 0;
+				ULONGLONG length = 0;
+				unsigned long symIndex = 0;
+
+				if (function.get_virtualAddress(&virtualAddress) == S_OK &&
+				    function.get_length(&length) == S_OK &&
+				    function.get_symIndexId(&symIndex) == S_OK)
+				{
+					functionAddressIndex.Add(virtualAddress, length, symIndex);
+				}
+			});
+			functionAddressIndex.Seal();
+
+			return functionAddressIndex;
 		}
 
 		//----------------------------------------------------------------------
@@ -210,12 +250,294 @@ namespace CppCoverage
 			}
 			return sourcePtr;
 		}
+
+		//----------------------------------------------------------------------
+		CComPtr<IDiaSession> OpenSession(IDiaDataSource& source)
+		{
+			CComPtr<IDiaSession> sessionPtr;
+			if (source.openSession(&sessionPtr) != S_OK || !sessionPtr)
+				THROW("DIA: Cannot open session.");
+			return sessionPtr;
+		}
+
+		//----------------------------------------------------------------------
+		bool EnumerateDwarf(const std::filesystem::path& path,
+		                    IDebugInformationHandler& handler)
+		{
+			try
+			{
+				return DwarfDebugInformationEnumerator{}.Enumerate(path, handler);
+			}
+			catch (const std::exception& e)
+			{
+				LOG_WARNING << L"Cannot read DWARF debug information of "
+				            << path.wstring() << L": " << e.what();
+			}
+			return false;
+		}
+
+		//----------------------------------------------------------------------
+		using Line = IDebugInformationHandler::Line;
+
+		struct SourceFileLines
+		{
+			DWORD uniqueId_;
+			std::wstring pdbFilename_;
+			std::filesystem::path filename_;
+			bool isSelected_;
+			std::vector<Line> lines_;
+		};
+
+		//----------------------------------------------------------------------
+		void OnNewLine(IDiaSession& session,
+		               IDiaLineNumber& lineNumber,
+		               const FunctionAddressIndex& functionAddressIndex,
+		               std::vector<Line>& lines)
+		{
+			DWORD linenum = 0;
+			if (lineNumber.get_lineNumber(&linenum) != S_OK)
+				THROW("DIA: Cannot get line number");
+
+			const auto invalidLine = 0x00f00f00;
+			if (linenum != invalidLine)
+			{
+				ULONGLONG virtualAddress = 0;
+				if (lineNumber.get_virtualAddress(&virtualAddress) != S_OK)
+					THROW("DIA: Cannot get virtual address");
+
+				auto symIndex = functionAddressIndex.Find(virtualAddress);
+				if (!symIndex)
+				{
+					// The line is not inside a function: thunk, public symbol...
+					CComPtr<IDiaSymbol> symbol;
+					if (session.findSymbolByVA(virtualAddress,
+					                           SymTagEnum::SymTagNull,
+					                           &symbol) != S_OK ||
+					    !symbol)
+					{
+						THROW("DIA: Cannot find symbol");
+					}
+
+					unsigned long symbolIndex = 0;
+					if (symbol->get_symIndexId(&symbolIndex) != S_OK)
+						THROW("DIA: Cannot get symIndex");
+					symIndex = symbolIndex;
+				}
+
+				lines.emplace_back(linenum,
+				                   virtualAddress,
+				                   *symIndex,
+				                   functionAddressIndex.IsFunctionStart(virtualAddress));
+			}
+		}
+
+		//----------------------------------------------------------------------
+		void EnumLines(IDiaSession& session,
+		               IDiaSourceFile& sourceFile,
+		               const FunctionAddressIndex& functionAddressIndex,
+		               std::vector<Line>& lines)
+		{
+			CComPtr<IDiaEnumSymbols> symbols;
+			if (sourceFile.get_compilands(&symbols) != S_OK || !symbols)
+				THROW("DIA: Cannot get compilands");
+
+			EnumerateCollection<IDiaSymbol>(*symbols, [&](IDiaSymbol& symbol) {
+				CComPtr<IDiaEnumLineNumbers> lineNumbers;
+
+				if (session.findLines(&symbol, &sourceFile, &lineNumbers) !=
+				        S_OK ||
+				    !lineNumbers)
+				{
+					THROW("DIA: Cannot find lines");
+				}
+
+				EnumerateCollection<IDiaLineNumber>(
+				    *lineNumbers, [&](IDiaLineNumber& lineNumber) {
+					    OnNewLine(session, lineNumber, functionAddressIndex, lines);
+				    });
+			});
+		}
+
+		//----------------------------------------------------------------------
+		void EnumLinesFromQueue(IDiaSession& session,
+		                        const FunctionAddressIndex& functionAddressIndex,
+		                        std::vector<SourceFileLines>& sourceFileLinesCollection,
+		                        std::atomic<size_t>& nextIndex)
+		{
+			for (auto i = nextIndex++; i < sourceFileLinesCollection.size();
+			     i = nextIndex++)
+			{
+				auto& sourceFileLines = sourceFileLinesCollection[i];
+				CComPtr<IDiaSourceFile> sourceFile;
+
+				if (session.findFileById(sourceFileLines.uniqueId_,
+				                         &sourceFile) != S_OK ||
+				    !sourceFile)
+				{
+					THROW("DIA: Cannot find source file by id");
+				}
+				EnumLines(session,
+				          *sourceFile,
+				          functionAddressIndex,
+				          sourceFileLines.lines_);
+			}
+		}
+
+		//----------------------------------------------------------------------
+		// Threads enumerating debug information in the process. Concurrent
+		// calls to Enumerate (see SymbolLoadingPipeline) share the hardware
+		// concurrency instead of each one opening a DIA session by core.
+		std::atomic<size_t> enumeratingThreadCount{0};
+
+		//----------------------------------------------------------------------
+		class ThreadReservation
+		{
+		  public:
+			// Reserve at least minCount threads and up to maxCount when the
+			// budget allows it.
+			ThreadReservation(size_t minCount, size_t maxCount)
+			{
+				size_t budget =
+				    std::max<size_t>(1, std::thread::hardware_concurrency());
+				auto usedCount = enumeratingThreadCount.load();
+
+				do
+				{
+					auto availableCount =
+					    usedCount < budget ? budget - usedCount : 0;
+					count_ = std::max(minCount, std::min(maxCount, availableCount));
+				} while (!enumeratingThreadCount.compare_exchange_weak(
+				    usedCount, usedCount + count_));
+			}
+
+			ThreadReservation(const ThreadReservation&) = delete;
+			ThreadReservation& operator=(const ThreadReservation&) = delete;
+
+			~ThreadReservation()
+			{
+				enumeratingThreadCount -= count_;
+			}
+
+			size_t GetCount() const
+			{
+				return count_;
+			}
+
+		  private:
+			size_t count_;
+		};
+
+		//----------------------------------------------------------------------
+		size_t GetWorkerCount(size_t sourceFileCount)
+		{
+			// Opening a DIA session reloads the pdb so small modules are
+			// faster to enumerate on a single thread.
+			const size_t minSourceFileCountByWorker = 32;
+			size_t hardwareConcurrency = std::thread::hardware_concurrency();
+
+			return std::max<size_t>(
+			    1,
+			    std::min(hardwareConcurrency,
+			             sourceFileCount / minSourceFileCountByWorker));
+		}
+
+		//----------------------------------------------------------------------
+		// Each worker has its own DIA session as sessions cannot be shared
+		// between threads. Lines are stored by source file so the caller
+		// gets them in the enumeration order whatever the scheduling. The
+		// calling thread is already reserved by Enumerate.
+		void EnumLinesInParallel(
+		    const std::filesystem::path& modulePath,
+		    IDiaSession& session,
+		    const FunctionAddressIndex& functionAddressIndex,
+		    std::vector<SourceFileLines>& sourceFileLinesCollection)
+		{
+			std::atomic<size_t> nextIndex{0};
+			std::vector<std::future<void>> workers;
+			ThreadReservation extraWorkers{
+			    0, GetWorkerCount(sourceFileLinesCollection.size()) - 1};
+			auto workerCount = 1 + extraWorkers.GetCount();
+
+			for (size_t i = 1; i < workerCount; ++i)
+			{
+				workers.push_back(std::async(std::launch::async, [&]() {
+					auto sourcePtr = LoadDataForExe(modulePath);
+					if (!sourcePtr)
+						THROW(L"DIA: Cannot load " + modulePath.wstring());
+					auto workerSession = OpenSession(*sourcePtr);
+					EnumLinesFromQueue(*workerSession,
+					                   functionAddressIndex,
+					                   sourceFileLinesCollection,
+					                   nextIndex);
+				}));
+			}
+
+			EnumLinesFromQueue(session,
+			                   functionAddressIndex,
+			                   sourceFileLinesCollection,
+			                   nextIndex);
+			for (auto& worker : workers)
+				worker.get();
+		}
+
+		//----------------------------------------------------------------------
+		// Read all the line records of the module once and dispatch them by
+		// source file id, instead of one findLines per compiland and file.
+		void EnumAllLines(IDiaSession& session,
+		                  const FunctionAddressIndex& functionAddressIndex,
+		                  std::vector<SourceFileLines>& sourceFileLinesCollection)
+		{
+			auto lineNumbers = GetTable<IDiaEnumLineNumbers>(session);
+			if (!lineNumbers)
+				THROW("DIA: cannot get LineNumbers");
+
+			std::unordered_map<DWORD, std::vector<Line>*> linesBySourceFileId;
+			for (auto& sourceFileLines : sourceFileLinesCollection)
+			{
+				linesBySourceFileId.emplace(sourceFileLines.uniqueId_,
+				                            &sourceFileLines.lines_);
+			}
+
+			EnumerateCollection<IDiaLineNumber>(
+			    *lineNumbers, [&](IDiaLineNumber& lineNumber) {
+				    DWORD sourceFileId = 0;
+				    if (lineNumber.get_sourceFileId(&sourceFileId) != S_OK)
+					    THROW("DIA: Cannot get source file id");
+
+				    auto it = linesBySourceFileId.find(sourceFileId);
+				    if (it != linesBySourceFileId.end())
+				    {
+					    OnNewLine(
+					        session, lineNumber, functionAddressIndex, *it->second);
+				    }
+			    });
+		}
+
+		//----------------------------------------------------------------------
+		bool IsSinglePassSelected(LineEnumerationMode lineEnumerationMode,
+		                          size_t sourceFileCount,
+		                          size_t enumeratedSourceFileCount)
+		{
+			switch (lineEnumerationMode)
+			{
+			case LineEnumerationMode::BySourceFile: return false;
+			case LineEnumerationMode::SinglePass: return true;
+			}
+
+			// Reading all line records is cheaper than querying each
+			// compiland as soon as a significant part of the files is needed.
+			return enumeratedSourceFileCount * 4 >= sourceFileCount;
+		}
 	}
 
 	//--------------------------------------------------------------------------
 	DebugInformationEnumerator::DebugInformationEnumerator(
-	    const std::vector<SubstitutePdbSourcePath>& substitutePdbSourcePaths)
+	    const std::vector<SubstitutePdbSourcePath>& substitutePdbSourcePaths,
+	    std::shared_ptr<LineTableCache> lineTableCache,
+	    LineEnumerationMode lineEnumerationMode)
 		: substitutePdbSourcePaths_{ substitutePdbSourcePaths }
+		, lineTableCache_{ std::move(lineTableCache) }
+		, lineEnumerationMode_{ lineEnumerationMode }
 	{
 	}
 
@@ -224,99 +546,119 @@ namespace CppCoverage
 	DebugInformationEnumerator::Enumerate(const std::filesystem::path& path,
 	                                      IDebugInformationHandler& handler)
 	{
+		boost::optional<std::wstring> cacheKey;
+		if (lineTableCache_)
+		{
+			cacheKey = LineTableCache::ComputeKey(path);
+			if (cacheKey && EnumerateFromCache(*cacheKey, handler))
+				return true;
+		}
+
+		ThreadReservation currentThread{1, 1};
 		auto sourcePtr = LoadDataForExe(path);
 
 		if (!sourcePtr)
-			return false;
+			return EnumerateDwarf(path, handler);
 
-		CComPtr<IDiaSession> sessionPtr;
-		if (sourcePtr->openSession(&sessionPtr) != S_OK || !sessionPtr)
-			THROW("DIA: Cannot open session.");
-
-		auto sourceFiles = GetEnumSourceFiles(*sessionPtr);
+		auto sessionPtr = OpenSession(*sourcePtr);
+		auto sourceFiles = GetTable<IDiaEnumSourceFiles>(*sessionPtr);
 		if (!sourceFiles)
 			THROW("DIA: cannot get SourceFiles");
 
+		// When the cache is enabled, the lines of all source files are
+		// read so the entry can be reused whatever the selected sources are.
+		std::vector<SourceFileLines> sourceFileLinesCollection;
+		size_t sourceFileCount = 0;
 		EnumerateCollection<IDiaSourceFile>(
 		    *sourceFiles, [&](IDiaSourceFile& sourceFile) {
-			    auto filename = GetSourceFileName(sourceFile);
-			    if (handler.IsSourceFileSelected(filename))
+			    ++sourceFileCount;
+			    auto pdbFilename = GetPdbSourceFileName(sourceFile);
+			    auto filename = ApplySubstitutePdbSourcePaths(pdbFilename);
+			    bool isSelected = handler.IsSourceFileSelected(filename);
+			    if (isSelected || cacheKey)
 			    {
-				    lines_.clear();
-				    EnumLines(*sessionPtr, sourceFile, handler);
-				    handler.OnSourceFile(filename, lines_);
+				    DWORD uniqueId = 0;
+				    if (sourceFile.get_uniqueId(&uniqueId) != S_OK)
+					    THROW("DIA: Cannot get source file id");
+				    sourceFileLinesCollection.push_back(
+				        {uniqueId, pdbFilename, filename, isSelected, {}});
 			    }
 		    });
-		return true;
-	}
-
-	//----------------------------------------------------------------------
-	void
-	DebugInformationEnumerator::EnumLines(IDiaSession& session,
-	                                      IDiaSourceFile& sourceFile,
-	                                      IDebugInformationHandler& handler)
-	{
-		CComPtr<IDiaEnumSymbols> symbols;
-		if (sourceFile.get_compilands(&symbols) != S_OK || !symbols)
-			THROW("DIA: Cannot get compilands");
 
-		EnumerateCollection<IDiaSymbol>(*symbols, [&](IDiaSymbol& symbol) {
-			CComPtr<IDiaEnumLineNumbers> lines;
+		if (!sourceFileLinesCollection.empty())
+		{
+			auto functionAddressIndex = CreateFunctionAddressIndex(*sessionPtr);
+			if (IsSinglePassSelected(lineEnumerationMode_,
+			                         sourceFileCount,
+			                         sourceFileLinesCollection.size()))
+			{
+				EnumAllLines(
+				    *sessionPtr, functionAddressIndex, sourceFileLinesCollection);
+			}
+			else
+			{
+				EnumLinesInParallel(path,
+				                    *sessionPtr,
+				                    functionAddressIndex,
+				                    sourceFileLinesCollection);
+			}
+		}
 
-			if (session.findLines(&symbol, &sourceFile, &lines) != S_OK ||
-			    !lines)
+		std::vector<LineTableCache::SourceFile> cachedSourceFiles;
+		for (auto& sourceFileLines : sourceFileLinesCollection)
+		{
+			if (sourceFileLines.isSelected_)
+			{
+				handler.OnSourceFile(sourceFileLines.filename_,
+				                     sourceFileLines.lines_);
+			}
+			if (cacheKey)
 			{
-				THROW("DIA: Cannot find lines");
+				cachedSourceFiles.push_back(
+				    {std::move(sourceFileLines.pdbFilename_),
+				     std::move(sourceFileLines.lines_)});
 			}
+		}
 
-			EnumerateCollection<IDiaLineNumber>(
-			    *lines, [&](IDiaLineNumber& lineNumber) {
-				    OnNewLine(session, lineNumber, handler);
-			    });
-		});
+		if (cacheKey)
+			lineTableCache_->Store(*cacheKey, cachedSourceFiles);
+		return true;
 	}
 
-	//----------------------------------------------------------------------
-	void
-	DebugInformationEnumerator::OnNewLine(IDiaSession& session,
-	                                      IDiaLineNumber& lineNumber,
-	                                      IDebugInformationHandler& handler)
+	//-------------------------------------------------------------------------
+	bool DebugInformationEnumerator::EnumerateFromCache(
+	    const std::wstring& cacheKey,
+	    IDebugInformationHandler& handler)
 	{
-		DWORD linenum = 0;
-		if (lineNumber.get_lineNumber(&linenum) != S_OK)
-			THROW("DIA: Cannot get line number");
+		auto sourceFiles = lineTableCache_->Load(cacheKey);
+		if (!sourceFiles)
+			return false;
 
-		const auto invalidLine = 0x00f00f00;
-		if (linenum != invalidLine)
+		for (const auto& sourceFile : *sourceFiles)
 		{
-			ULONGLONG virtualAddress = 0;
-			if (lineNumber.get_virtualAddress(&virtualAddress) != S_OK)
-				THROW("DIA: Cannot get virtual address");
-
-			CComPtr<IDiaSymbol> symbol;
-			if (session.findSymbolByVA(
-			        virtualAddress, SymTagEnum::SymTagNull, &symbol) != S_OK ||
-			    !symbol)
-			{
-				THROW("DIA: Cannot find symbol");
-			}
-
-			unsigned long symIndex = 0;
-			if (symbol->get_symIndexId(&symIndex) != S_OK)
-				THROW("DIA: Cannot get symIndex");
-
-			lines_.emplace_back(linenum, virtualAddress, symIndex);
+			auto filename = ApplySubstitutePdbSourcePaths(sourceFile.path_);
+			if (handler.IsSourceFileSelected(filename))
+				handler.OnSourceFile(filename, sourceFile.lines_);
 		}
+		return true;
 	}
 
 	//----------------------------------------------------------------------
-	std::filesystem::path DebugInformationEnumerator::GetSourceFileName(
+	std::wstring DebugInformationEnumerator::GetPdbSourceFileName(
 	    IDiaSourceFile& sourceFile) const
 	{
 		DiaString fileName;
 		if (sourceFile.get_fileName(&fileName) != S_OK)
 			THROW("DIA: Cannot get filename");
-		std::wstring filenameStr = fileName;
+		return fileName;
+	}
+
+	//----------------------------------------------------------------------
+	std::filesystem::path
+	DebugInformationEnumerator::ApplySubstitutePdbSourcePaths(
+	    const std::wstring& pdbFilename) const
+	{
+		auto filenameStr = pdbFilename;
 
 		for (const auto& paths : substitutePdbSourcePaths_)
 		{
@@ -17,16 +17,17 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 
 #include "CppCoverageExport.hpp"
 #include "SubstitutePdbSourcePath.hpp"
 
-struct IDiaSession;
-struct IDiaLineNumber;
 struct IDiaSourceFile;
 
 namespace CppCoverage
 {
+	class LineTableCache;
+
 	//-------------------------------------------------------------------------
 	class IDebugInformationHandler
 	{
@@ -35,10 +36,12 @@ namespace CppCoverage
 		{
 			Line(unsigned long lineNumber,
 			     int64_t virtualAddress,
-			     unsigned long symbolIndex)
+			     unsigned long symbolIndex,
+			     bool isFunctionEntry = false)
 			    : lineNumber_{lineNumber},
 			      virtualAddress_{virtualAddress},
-			      symbolIndex_{symbolIndex}
+			      symbolIndex_{symbolIndex},
+			      isFunctionEntry_{isFunctionEntry}
 			{
 			}
 			Line(const Line&) = default;
@@ -48,6 +51,8 @@ namespace CppCoverage
 			unsigned long lineNumber_;
 			unsigned long symbolIndex_;
 			int64_t virtualAddress_;
+			// The address of the line is the start address of its function.
+			bool isFunctionEntry_;
 		};
 
 		virtual ~IDebugInformationHandler() = default;
@@ -56,24 +61,50 @@ namespace CppCoverage
 		                          const std::vector<Line>&) = 0;
 	};
 
+	//-------------------------------------------------------------------------
+	enum class LineEnumerationMode
+	{
+		Automatic,
+		BySourceFile, // One findLines by compiland and source file.
+		SinglePass    // All line records of the module read once.
+	};
+
+	//-------------------------------------------------------------------------
+	// Enumerate can be called by several threads at the same time, see
+	// SymbolLoadingPipeline.
+	class CPPCOVERAGE_DLL IDebugInformationEnumerator
+	{
+	  public:
+		virtual ~IDebugInformationEnumerator() = default;
+
+		// Return false if the module has no debug information.
+		virtual bool Enumerate(const std::filesystem::path&,
+		                       IDebugInformationHandler&) = 0;
+	};
+
 	//-------------------------------------------------------------------------
 	class CPPCOVERAGE_DLL DebugInformationEnumerator
+	    : public IDebugInformationEnumerator
 	{
 	  public:
-		explicit DebugInformationEnumerator(const std::vector<SubstitutePdbSourcePath>&);
+		explicit DebugInformationEnumerator(
+		    const std::vector<SubstitutePdbSourcePath>&,
+		    std::shared_ptr<LineTableCache> = nullptr,
+		    LineEnumerationMode = LineEnumerationMode::Automatic);
+
 		bool Enumerate(const std::filesystem::path&,
-		               IDebugInformationHandler&);
+		               IDebugInformationHandler&) override;
 
 	  private:
-		void
-		EnumLines(IDiaSession&, IDiaSourceFile&, IDebugInformationHandler&);
-		void
-		OnNewLine(IDiaSession&, IDiaLineNumber&, IDebugInformationHandler&);
+		bool EnumerateFromCache(const std::wstring& cacheKey,
+		                        IDebugInformationHandler&);
 
+		std::wstring GetPdbSourceFileName(IDiaSourceFile&) const;
 		std::filesystem::path
-		GetSourceFileName(IDiaSourceFile&) const;
+		ApplySubstitutePdbSourcePaths(const std::wstring& pdbFilename) const;
 
-		std::vector<IDebugInformationHandler::Line> lines_;
 		const std::vector<SubstitutePdbSourcePath> substitutePdbSourcePaths_;
+		const std::shared_ptr<LineTableCache> lineTableCache_;
+		const LineEnumerationMode lineEnumerationMode_;
 	};
 }
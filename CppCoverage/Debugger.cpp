@@ -20,9 +20,12 @@
 #include "tools/Log.hpp"
 #include "tools/ScopedAction.hpp"
 
-#include "Process.hpp"
+#include <chrono>
+
 #include "CppCoverageException.hpp"
 #include "IDebugEventsHandler.hpp"
+#include "IDebuggerBackend.hpp"
+#include "DebugEventStatistics.hpp"
 
 #include "Tools/Tool.hpp"
 
@@ -37,6 +40,38 @@ namespace CppCoverage
 				<< "(type:" << ripInfo.dwType << ")"
 				<< GetErrorMessage(ripInfo.dwError);
 		}
+
+		//---------------------------------------------------------------------
+		std::chrono::nanoseconds GetElapsedTime(std::chrono::steady_clock::time_point start)
+		{
+			return std::chrono::steady_clock::now() - start;
+		}
+
+		//---------------------------------------------------------------------
+		DebugEventStatistics::EventType GetStatisticsEventType(DWORD debugEventCode)
+		{
+			switch (debugEventCode)
+			{
+				case CREATE_PROCESS_DEBUG_EVENT: return DebugEventStatistics::EventType::CreateProcess;
+				case EXIT_PROCESS_DEBUG_EVENT: return DebugEventStatistics::EventType::ExitProcess;
+				case CREATE_THREAD_DEBUG_EVENT: return DebugEventStatistics::EventType::CreateThread;
+				case EXIT_THREAD_DEBUG_EVENT: return DebugEventStatistics::EventType::ExitThread;
+				case LOAD_DLL_DEBUG_EVENT: return DebugEventStatistics::EventType::LoadDll;
+				case UNLOAD_DLL_DEBUG_EVENT: return DebugEventStatistics::EventType::UnloadDll;
+				default: return DebugEventStatistics::EventType::Other;
+			}
+		}
+
+		//---------------------------------------------------------------------
+		DebugEventStatistics::EventType GetStatisticsEventType(IDebugEventsHandler::ExceptionType exceptionType)
+		{
+			switch (exceptionType)
+			{
+				case IDebugEventsHandler::ExceptionType::BreakPoint: return DebugEventStatistics::EventType::BreakPoint;
+				case IDebugEventsHandler::ExceptionType::GuardPage: return DebugEventStatistics::EventType::GuardPage;
+				default: return DebugEventStatistics::EventType::Exception;
+			}
+		}
 	}	
 
 	//-------------------------------------------------------------------------
@@ -60,10 +95,19 @@ namespace CppCoverage
 	Debugger::Debugger(
 		bool coverChildren,
 		bool continueAfterCppException,
-        bool stopOnAssert)
+        bool stopOnAssert,
+		bool moduleStatistics)
 		: coverChildren_{ coverChildren }
 		, continueAfterCppException_{ continueAfterCppException }
         , stopOnAssert_{ stopOnAssert }
+		, moduleStatistics_{ moduleStatistics }
+		, statistics_{ std::make_unique<DebugEventStatistics>() }
+		, backend_{ CreateDebuggerBackend() }
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	Debugger::~Debugger()
 	{
 	}
 
@@ -72,8 +116,7 @@ namespace CppCoverage
 		const StartInfo& startInfo,
 		IDebugEventsHandler& debugEventsHandler)
 	{
-		Process process(startInfo);
-		process.Start((coverChildren_) ? DEBUG_PROCESS: DEBUG_ONLY_THIS_PROCESS);
+		backend_->Start(startInfo, coverChildren_);
 		
 		DEBUG_EVENT debugEvent;
 		boost::optional<int> exitCode;
@@ -81,13 +124,36 @@ namespace CppCoverage
 		processHandles_.clear();
 		threadHandles_.clear();
 		rootProcessId_ = boost::none;
+		statistics_ = std::make_unique<DebugEventStatistics>();
+		auto runStart = std::chrono::steady_clock::now();
+
+		boost::optional<DEBUG_EVENT> detachEvent;
 
 		while (!exitCode || !processHandles_.empty())
 		{
-			if (!WaitForDebugEvent(&debugEvent, INFINITE))
-				THROW_LAST_ERROR(L"Error WaitForDebugEvent:", GetLastError());
+			// Detach only when no debug event is pending: DebugActiveProcessStop
+			// drops them, and a thread stopped by a breakpoint restored since
+			// would resume without its instruction pointer rewound.
+			auto waitStart = std::chrono::steady_clock::now();
+			if (!backend_->WaitForDebugEvent(debugEvent, detachEvent ? 0 : INFINITE))
+			{
+				auto detachedProcessExitCode = Detach(*detachEvent, debugEventsHandler);
+				if (detachedProcessExitCode && rootProcessId_ == detachEvent->dwProcessId && !exitCode)
+					exitCode = detachedProcessExitCode;
+				detachEvent = boost::none;
+				continue;
+			}
 
+			auto eventStart = std::chrono::steady_clock::now();
+			statistics_->AddDuration(DebugEventStatistics::EventType::Wait, eventStart - waitStart);
 			ProcessStatus processStatus = HandleDebugEvent(debugEvent, debugEventsHandler);
+
+			// Exceptions are timed by OnException according to their type.
+			if (debugEvent.dwDebugEventCode != EXCEPTION_DEBUG_EVENT)
+			{
+				statistics_->AddDuration(
+					GetStatisticsEventType(debugEvent.dwDebugEventCode), GetElapsedTime(eventStart));
+			}
 			
 			// Get the exit code of the root process
 			// Set once as we do not want EXCEPTION_BREAKPOINT to be override
@@ -96,9 +162,13 @@ namespace CppCoverage
 
 			auto continueStatus = boost::get_optional_value_or(processStatus.continueStatus_, DBG_CONTINUE);
 
-			if (!ContinueDebugEvent(debugEvent.dwProcessId, debugEvent.dwThreadId, continueStatus))
-				THROW_LAST_ERROR("Error in ContinueDebugEvent:", GetLastError());
+			backend_->ContinueDebugEvent(debugEvent, continueStatus);
+
+			detachEvent = boost::none;
+			if (ShouldDetach(debugEvent, debugEventsHandler))
+				detachEvent = debugEvent;
 		}
+		statistics_->SetRunTime(GetElapsedTime(runStart));
 
 		return *exitCode;
 	}
@@ -146,13 +216,21 @@ namespace CppCoverage
 			case LOAD_DLL_DEBUG_EVENT:
 			{
 				const auto& loadDll = debugEvent.u.LoadDll;
-				Tools::ScopedAction scopedAction{ [&loadDll]{ CloseHandle(loadDll.hFile); } };
+				Tools::ScopedAction scopedAction{ [&]{ backend_->CloseFile(loadDll.hFile); } };
+				if (moduleStatistics_)
+				{
+					statistics_->OnLoadModule(
+						debugEvent.dwProcessId,
+						loadDll.lpBaseOfDll,
+						backend_->GetModulePath(loadDll.hFile, loadDll.lpBaseOfDll));
+				}
 				debugEventsHandler.OnLoadDll(hProcess, hThread, loadDll);
 				break;
 			}
 			case UNLOAD_DLL_DEBUG_EVENT:
 			{
 				debugEventsHandler.OnUnloadDll(hProcess, hThread, debugEvent.u.UnloadDll);
+				statistics_->OnUnloadModule(debugEvent.dwProcessId, debugEvent.u.UnloadDll.lpBaseOfDll);
 				break;
 			}
 			case EXCEPTION_DEBUG_EVENT: return OnException(debugEvent, debugEventsHandler, hProcess, hThread);
@@ -169,14 +247,24 @@ namespace CppCoverage
 		const DEBUG_EVENT& debugEvent,
 		IDebugEventsHandler& debugEventsHandler,
 		HANDLE hProcess,
-		HANDLE hThread) const
+		HANDLE hThread)
 	{
 		const auto& exception = debugEvent.u.Exception;
+		auto exceptionStart = std::chrono::steady_clock::now();
 		auto exceptionType = debugEventsHandler.OnException(hProcess, hThread, exception);
+		auto exceptionDuration = GetElapsedTime(exceptionStart);
+		auto eventType = GetStatisticsEventType(exceptionType);
+
+		statistics_->AddDuration(eventType, exceptionDuration);
+		if (eventType == DebugEventStatistics::EventType::Exception)
+			statistics_->AddExceptionDuration(exception.ExceptionRecord.ExceptionCode, exceptionDuration);
+		if (exceptionType == IDebugEventsHandler::ExceptionType::BreakPoint)
+			statistics_->OnBreakPoint(debugEvent.dwProcessId, exception.ExceptionRecord.ExceptionAddress);
 
 		switch (exceptionType)
 		{
 			case IDebugEventsHandler::ExceptionType::BreakPoint:
+			case IDebugEventsHandler::ExceptionType::GuardPage:
 			{
 				return ProcessStatus{ boost::none, DBG_CONTINUE };
 			}
@@ -218,13 +306,57 @@ namespace CppCoverage
 		THROW("Invalid exception Type.");
 	}
 
+	//-------------------------------------------------------------------------
+	bool Debugger::ShouldDetach(
+		const DEBUG_EVENT& debugEvent,
+		IDebugEventsHandler& debugEventsHandler) const
+	{
+		// The thread of the event must still exist when detaching.
+		switch (debugEvent.dwDebugEventCode)
+		{
+			case EXIT_THREAD_DEBUG_EVENT: case EXIT_PROCESS_DEBUG_EVENT: return false;
+		}
+
+		// Waiting for the exit of the process cannot block other debugged processes.
+		auto processId = debugEvent.dwProcessId;
+		if (processHandles_.size() != 1 || processHandles_.count(processId) == 0)
+			return false;
+
+		return debugEventsHandler.ShouldDetach(GetProcessHandle(processId));
+	}
+
+	//-------------------------------------------------------------------------
+	// Return the exit code of the process if the debugger detached from it.
+	boost::optional<int> Debugger::Detach(
+		const DEBUG_EVENT& debugEvent,
+		IDebugEventsHandler& debugEventsHandler)
+	{
+		auto processId = debugEvent.dwProcessId;
+		auto hProcess = GetProcessHandle(processId);
+
+		if (!backend_->Detach(processId))
+			return boost::none;
+		LOG_INFO << "Detach from process " << processId << ", no more debug events are needed.";
+
+		auto exitCode = backend_->WaitForExitCode(hProcess);
+		LOG_INFO << "Detached process " << processId << " exited with code " << exitCode;
+
+		EXIT_PROCESS_DEBUG_INFO exitProcess{ exitCode };
+		debugEventsHandler.OnExitProcess(hProcess, GetThreadHandle(debugEvent.dwThreadId), exitProcess);
+		statistics_->OnExitProcess(processId);
+		processHandles_.clear();
+		threadHandles_.clear();
+
+		return static_cast<int>(exitCode);
+	}
+
 	//-------------------------------------------------------------------------
 	void Debugger::OnCreateProcess(
 		const DEBUG_EVENT& debugEvent,
 		IDebugEventsHandler& debugEventsHandler)
 	{		
 		const auto& processInfo = debugEvent.u.CreateProcessInfo;
-		Tools::ScopedAction scopedAction{ [&processInfo]{ CloseHandle(processInfo.hFile); } };
+		Tools::ScopedAction scopedAction{ [&]{ backend_->CloseFile(processInfo.hFile); } };
 
 		LOG_DEBUG << "Create Process:" << debugEvent.dwProcessId;
 
@@ -233,6 +365,13 @@ namespace CppCoverage
 
 		if (!processHandles_.emplace(debugEvent.dwProcessId, processInfo.hProcess).second)
 			THROW("Process id already exist");
+		if (moduleStatistics_)
+		{
+			statistics_->OnLoadModule(
+				debugEvent.dwProcessId,
+				processInfo.lpBaseOfImage,
+				backend_->GetModulePath(processInfo.hFile, processInfo.lpBaseOfImage));
+		}
 				
 		debugEventsHandler.OnCreateProcess(processInfo);
 
@@ -253,6 +392,7 @@ namespace CppCoverage
 
 		auto exitProcess = debugEvent.u.ExitProcess;
 		debugEventsHandler.OnExitProcess(hProcess, hThread, exitProcess);
+		statistics_->OnExitProcess(processId);
 
 		if (processHandles_.erase(processId) != 1)
 			THROW("Cannot find exited process.");
@@ -303,4 +443,10 @@ namespace CppCoverage
 	{
 		return threadHandles_.size();
 	}
+
+	//-------------------------------------------------------------------------
+	const DebugEventStatistics& Debugger::GetStatistics() const
+	{
+		return *statistics_;
+	}
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
 
 #include <boost/optional/optional.hpp>
 
+#include <memory>
 #include <unordered_map>
 #include <Windows.h>
 #include "CppCoverageExport.hpp"
@@ -27,6 +28,8 @@ namespace CppCoverage
 {
 	class StartInfo;
 	class IDebugEventsHandler;
+	class DebugEventStatistics;
+	class IDebuggerBackend;
 
 	class CPPCOVERAGE_DLL Debugger
 	{
@@ -34,12 +37,19 @@ namespace CppCoverage
 		Debugger(
 			bool coverChildren,
 			bool continueAfterCppException,
-            bool stopOnAssert);
+            bool stopOnAssert,
+			bool moduleStatistics);
+		~Debugger();
 
 		int Debug(const StartInfo&, IDebugEventsHandler&);
 		size_t GetRunningProcesses() const;
 		size_t GetRunningThreads() const;
 
+		// Statistics of the last call to Debug. Breakpoints are counted by
+		// module only when moduleStatistics is set: resolving the module
+		// paths costs a system call per loaded module.
+		const DebugEventStatistics& GetStatistics() const;
+
 	private:
 		Debugger(const Debugger&) = delete;
 		Debugger& operator=(const Debugger&) = delete;
@@ -74,7 +84,10 @@ namespace CppCoverage
 			HANDLE hThread,
 			DWORD dwThreadId);
 
-		ProcessStatus OnException(const DEBUG_EVENT&, IDebugEventsHandler&, HANDLE hProcess, HANDLE hThread) const;
+		ProcessStatus OnException(const DEBUG_EVENT&, IDebugEventsHandler&, HANDLE hProcess, HANDLE hThread);
+
+		bool ShouldDetach(const DEBUG_EVENT&, IDebugEventsHandler&) const;
+		boost::optional<int> Detach(const DEBUG_EVENT&, IDebugEventsHandler&);
 
 	private:
 		std::unordered_map<DWORD, HANDLE> processHandles_;
@@ -83,6 +96,9 @@ namespace CppCoverage
 		bool coverChildren_;
 		bool continueAfterCppException_;
         bool stopOnAssert_;
+		bool moduleStatistics_;
+		std::unique_ptr<DebugEventStatistics> statistics_;
+		std::unique_ptr<IDebuggerBackend> backend_;
     };
 }
 
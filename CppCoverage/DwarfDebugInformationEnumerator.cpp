@@ -0,0 +1,274 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "DwarfDebugInformationEnumerator.hpp"
+
+#include <Windows.h>
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "CppCoverageException.hpp"
+#include "DebugInformationEnumerator.hpp"
+#include "DwarfDecoder.hpp"
+#include "FunctionAddressIndex.hpp"
+#include "Handle.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		template <typename T>
+		T ReadStruct(const DwarfSection& file, uint64_t offset)
+		{
+			T value;
+			if (offset > file.size_ || sizeof(T) > file.size_ - offset)
+				THROW("Invalid PE file: unexpected end of file.");
+			std::memcpy(&value, file.data_ + offset, sizeof(T));
+			return value;
+		}
+
+		//---------------------------------------------------------------------
+		std::string GetSectionName(const DwarfSection& file,
+		                           const IMAGE_FILE_HEADER& fileHeader,
+		                           const IMAGE_SECTION_HEADER& sectionHeader)
+		{
+			auto name = reinterpret_cast<const char*>(sectionHeader.Name);
+			std::string shortName{name, strnlen(name, IMAGE_SIZEOF_SHORT_NAME)};
+
+			// Long names such as .debug_info are stored in the COFF string
+			// table: "/<offset>".
+			if (shortName.size() < 2 || shortName[0] != '/')
+				return shortName;
+			auto stringTableOffset =
+			    uint64_t{fileHeader.PointerToSymbolTable} +
+			    uint64_t{fileHeader.NumberOfSymbols} * IMAGE_SIZEOF_SYMBOL;
+			auto offset = stringTableOffset + std::stoull(shortName.substr(1));
+			if (offset >= file.size_)
+				THROW("Invalid PE file: invalid section name.");
+
+			auto begin = reinterpret_cast<const char*>(file.data_ + offset);
+			return {begin, strnlen(begin, static_cast<size_t>(file.size_ - offset))};
+		}
+
+		//---------------------------------------------------------------------
+		DwarfSections FindDwarfSections(const DwarfSection& file, uint64_t& imageBase)
+		{
+			auto dosHeader = ReadStruct<IMAGE_DOS_HEADER>(file, 0);
+			if (dosHeader.e_magic != IMAGE_DOS_SIGNATURE)
+				THROW("Invalid PE file: invalid DOS signature.");
+			uint64_t ntHeaderOffset = dosHeader.e_lfanew;
+			if (ReadStruct<DWORD>(file, ntHeaderOffset) != IMAGE_NT_SIGNATURE)
+				THROW("Invalid PE file: invalid NT signature.");
+
+			auto fileHeaderOffset = ntHeaderOffset + sizeof(DWORD);
+			auto fileHeader = ReadStruct<IMAGE_FILE_HEADER>(file, fileHeaderOffset);
+			auto optionalHeaderOffset = fileHeaderOffset + sizeof(IMAGE_FILE_HEADER);
+			auto magic = ReadStruct<WORD>(file, optionalHeaderOffset);
+			if (magic == IMAGE_NT_OPTIONAL_HDR32_MAGIC)
+				imageBase = ReadStruct<IMAGE_OPTIONAL_HEADER32>(file, optionalHeaderOffset).ImageBase;
+			else if (magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC)
+				imageBase = ReadStruct<IMAGE_OPTIONAL_HEADER64>(file, optionalHeaderOffset).ImageBase;
+			else
+				THROW("Invalid PE file: invalid optional header magic " << magic);
+
+			const std::unordered_map<std::string, DwarfSection DwarfSections::*> sectionMembers{
+			    {".debug_info", &DwarfSections::debugInfo_},
+			    {".debug_abbrev", &DwarfSections::debugAbbrev_},
+			    {".debug_line", &DwarfSections::debugLine_},
+			    {".debug_line_str", &DwarfSections::debugLineStr_},
+			    {".debug_str", &DwarfSections::debugStr_},
+			    {".debug_addr", &DwarfSections::debugAddr_},
+			    {".debug_ranges", &DwarfSections::debugRanges_},
+			    {".debug_rnglists", &DwarfSections::debugRngLists_}};
+			DwarfSections sections;
+
+			auto sectionHeaderOffset = optionalHeaderOffset + fileHeader.SizeOfOptionalHeader;
+			for (WORD i = 0; i < fileHeader.NumberOfSections; ++i)
+			{
+				auto sectionHeader = ReadStruct<IMAGE_SECTION_HEADER>(
+				    file, sectionHeaderOffset + i * sizeof(IMAGE_SECTION_HEADER));
+				auto it = sectionMembers.find(GetSectionName(file, fileHeader, sectionHeader));
+				if (it == sectionMembers.end())
+					continue;
+
+				// The raw data is padded to the file alignment.
+				uint64_t size = sectionHeader.SizeOfRawData;
+				if (sectionHeader.Misc.VirtualSize != 0 && sectionHeader.Misc.VirtualSize < size)
+					size = sectionHeader.Misc.VirtualSize;
+				uint64_t offset = sectionHeader.PointerToRawData;
+				if (offset > file.size_ || size > file.size_ - offset)
+					THROW("Invalid PE file: invalid section " << it->first.c_str());
+				sections.*(it->second) = {file.data_ + offset, static_cast<size_t>(size)};
+			}
+			return sections;
+		}
+
+		//---------------------------------------------------------------------
+		class LineCollector : public IDwarfHandler
+		{
+		  public:
+			//-----------------------------------------------------------------
+			LineCollector(IDebugInformationHandler& handler, uint64_t imageBase)
+			    : handler_{handler}, imageBase_{imageBase}, lastFunctionId_{0}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			void OnFunction(uint64_t address, uint64_t size, unsigned long id) override
+			{
+				if (address < imageBase_)
+					return;
+				functionAddressIndex_.Add(address - imageBase_, size, id);
+
+				// The ranges of a function are reported in a row and its
+				// entry is the start of the first one.
+				if (functionEntries_.empty() || id != lastFunctionId_)
+					functionEntries_.insert(address - imageBase_);
+				lastFunctionId_ = id;
+			}
+
+			//-----------------------------------------------------------------
+			void OnFiles(const std::vector<std::string>& paths) override
+			{
+				sourceFileIndexes_.clear();
+				for (const auto& path : paths)
+					sourceFileIndexes_.push_back(GetSourceFileIndex(path));
+			}
+
+			//-----------------------------------------------------------------
+			void OnLine(size_t fileIndex, unsigned long lineNumber, uint64_t address) override
+			{
+				auto sourceFileIndex = sourceFileIndexes_.at(fileIndex);
+				if (sourceFileIndex != NotSelected && address >= imageBase_)
+				{
+					sourceFiles_[sourceFileIndex].lines_.emplace_back(
+					    lineNumber, static_cast<int64_t>(address - imageBase_), 0);
+				}
+			}
+
+			//-----------------------------------------------------------------
+			void NotifyHandler()
+			{
+				functionAddressIndex_.Seal();
+
+				// A line outside the known functions is its own block: its
+				// symbol index counts down from the maximum value so it
+				// cannot match the offset of a DW_TAG_subprogram entry.
+				auto unknownFunctionSymbolIndex = std::numeric_limits<unsigned long>::max();
+				for (auto& sourceFile : sourceFiles_)
+				{
+					for (auto& line : sourceFile.lines_)
+					{
+						auto symbolIndex = functionAddressIndex_.Find(line.virtualAddress_);
+						line.symbolIndex_ = symbolIndex ? *symbolIndex : unknownFunctionSymbolIndex--;
+						line.isFunctionEntry_ =
+						    functionEntries_.count(static_cast<uint64_t>(line.virtualAddress_)) != 0;
+					}
+					handler_.OnSourceFile(sourceFile.path_, sourceFile.lines_);
+				}
+			}
+
+		  private:
+			static const size_t NotSelected = static_cast<size_t>(-1);
+
+			struct SourceFile
+			{
+				std::filesystem::path path_;
+				std::vector<IDebugInformationHandler::Line> lines_;
+			};
+
+			//-----------------------------------------------------------------
+			// The same files appear in the line programs of many compile
+			// units: ask the handler only once.
+			size_t GetSourceFileIndex(const std::string& dwarfPath)
+			{
+				if (dwarfPath.empty())
+					return NotSelected;
+
+				auto it = sourceFileIndexesByPath_.find(dwarfPath);
+				if (it != sourceFileIndexesByPath_.end())
+					return it->second;
+
+				auto path = std::filesystem::u8path(dwarfPath).make_preferred();
+				auto sourceFileIndex = NotSelected;
+				if (handler_.IsSourceFileSelected(path))
+				{
+					sourceFileIndex = sourceFiles_.size();
+					sourceFiles_.push_back({path, {}});
+				}
+				sourceFileIndexesByPath_.emplace(dwarfPath, sourceFileIndex);
+				return sourceFileIndex;
+			}
+
+			IDebugInformationHandler& handler_;
+			const uint64_t imageBase_;
+			FunctionAddressIndex functionAddressIndex_;
+			std::unordered_set<uint64_t> functionEntries_;
+			unsigned long lastFunctionId_;
+			std::unordered_map<std::string, size_t> sourceFileIndexesByPath_;
+			std::vector<size_t> sourceFileIndexes_;
+			std::vector<SourceFile> sourceFiles_;
+		};
+	}
+
+	//-------------------------------------------------------------------------
+	bool DwarfDebugInformationEnumerator::Enumerate(
+	    const std::filesystem::path& path,
+	    IDebugInformationHandler& handler) const
+	{
+		auto hFile = CreateFileW(path.wstring().c_str(),
+		                         GENERIC_READ,
+		                         FILE_SHARE_READ,
+		                         nullptr,
+		                         OPEN_EXISTING,
+		                         FILE_ATTRIBUTE_NORMAL,
+		                         nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+			THROW_LAST_ERROR(L"Cannot open " << path.wstring(), GetLastError());
+		auto fileHandle = CreateHandle(hFile, CloseHandle);
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(hFile, &fileSize))
+			THROW_LAST_ERROR(L"Cannot get the size of " << path.wstring(), GetLastError());
+		if (fileSize.QuadPart == 0)
+			return false;
+
+		auto fileMappingHandle = CreateHandle(
+		    CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr), CloseHandle);
+		auto mapViewOfFile = CreateHandle(
+		    MapViewOfFile(fileMappingHandle.GetValue(), FILE_MAP_READ, 0, 0, 0),
+		    UnmapViewOfFile);
+
+		DwarfSection file{static_cast<const unsigned char*>(mapViewOfFile.GetValue()),
+		                  static_cast<size_t>(fileSize.QuadPart)};
+		uint64_t imageBase = 0;
+		auto sections = FindDwarfSections(file, imageBase);
+		if (!sections.debugLine_.data_)
+			return false;
+
+		LineCollector lineCollector{handler, imageBase};
+		DwarfDecoder{sections}.Decode(lineCollector);
+		lineCollector.NotifyHandler();
+		return true;
+	}
+}
@@ -0,0 +1,38 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <filesystem>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	class IDebugInformationHandler;
+
+	// Line information of the executables built with DWARF debug
+	// information, for example by MinGW gcc or clang, which store the DWARF
+	// sections in the PE file.
+	class CPPCOVERAGE_DLL DwarfDebugInformationEnumerator
+	{
+	  public:
+		// Return false if the file has no DWARF line information.
+		bool Enumerate(const std::filesystem::path&,
+		               IDebugInformationHandler&) const;
+	};
+}
@@ -0,0 +1,982 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "DwarfDecoder.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "CppCoverageException.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		const uint64_t DW_TAG_compile_unit = 0x11;
+		const uint64_t DW_TAG_subprogram = 0x2e;
+		const uint64_t DW_TAG_partial_unit = 0x3c;
+
+		const uint64_t DW_AT_stmt_list = 0x10;
+		const uint64_t DW_AT_low_pc = 0x11;
+		const uint64_t DW_AT_high_pc = 0x12;
+		const uint64_t DW_AT_comp_dir = 0x1b;
+		const uint64_t DW_AT_ranges = 0x55;
+		const uint64_t DW_AT_addr_base = 0x73;
+		const uint64_t DW_AT_rnglists_base = 0x74;
+		const uint64_t DW_AT_GNU_addr_base = 0x2133;
+
+		const uint64_t DW_FORM_addr = 0x01;
+		const uint64_t DW_FORM_block2 = 0x03;
+		const uint64_t DW_FORM_block4 = 0x04;
+		const uint64_t DW_FORM_data2 = 0x05;
+		const uint64_t DW_FORM_data4 = 0x06;
+		const uint64_t DW_FORM_data8 = 0x07;
+		const uint64_t DW_FORM_string = 0x08;
+		const uint64_t DW_FORM_block = 0x09;
+		const uint64_t DW_FORM_block1 = 0x0a;
+		const uint64_t DW_FORM_data1 = 0x0b;
+		const uint64_t DW_FORM_flag = 0x0c;
+		const uint64_t DW_FORM_sdata = 0x0d;
+		const uint64_t DW_FORM_strp = 0x0e;
+		const uint64_t DW_FORM_udata = 0x0f;
+		const uint64_t DW_FORM_ref_addr = 0x10;
+		const uint64_t DW_FORM_ref1 = 0x11;
+		const uint64_t DW_FORM_ref2 = 0x12;
+		const uint64_t DW_FORM_ref4 = 0x13;
+		const uint64_t DW_FORM_ref8 = 0x14;
+		const uint64_t DW_FORM_ref_udata = 0x15;
+		const uint64_t DW_FORM_indirect = 0x16;
+		const uint64_t DW_FORM_sec_offset = 0x17;
+		const uint64_t DW_FORM_exprloc = 0x18;
+		const uint64_t DW_FORM_flag_present = 0x19;
+		const uint64_t DW_FORM_strx = 0x1a;
+		const uint64_t DW_FORM_addrx = 0x1b;
+		const uint64_t DW_FORM_ref_sup4 = 0x1c;
+		const uint64_t DW_FORM_strp_sup = 0x1d;
+		const uint64_t DW_FORM_data16 = 0x1e;
+		const uint64_t DW_FORM_line_strp = 0x1f;
+		const uint64_t DW_FORM_ref_sig8 = 0x20;
+		const uint64_t DW_FORM_implicit_const = 0x21;
+		const uint64_t DW_FORM_loclistx = 0x22;
+		const uint64_t DW_FORM_rnglistx = 0x23;
+		const uint64_t DW_FORM_ref_sup8 = 0x24;
+		const uint64_t DW_FORM_strx1 = 0x25;
+		const uint64_t DW_FORM_strx2 = 0x26;
+		const uint64_t DW_FORM_strx3 = 0x27;
+		const uint64_t DW_FORM_strx4 = 0x28;
+		const uint64_t DW_FORM_addrx1 = 0x29;
+		const uint64_t DW_FORM_addrx2 = 0x2a;
+		const uint64_t DW_FORM_addrx3 = 0x2b;
+		const uint64_t DW_FORM_addrx4 = 0x2c;
+		const uint64_t DW_FORM_GNU_addr_index = 0x1f01;
+		const uint64_t DW_FORM_GNU_str_index = 0x1f02;
+		const uint64_t DW_FORM_GNU_ref_alt = 0x1f20;
+		const uint64_t DW_FORM_GNU_strp_alt = 0x1f21;
+
+		const uint8_t DW_UT_compile = 0x01;
+		const uint8_t DW_UT_partial = 0x03;
+
+		const uint8_t DW_RLE_end_of_list = 0x00;
+		const uint8_t DW_RLE_base_addressx = 0x01;
+		const uint8_t DW_RLE_startx_endx = 0x02;
+		const uint8_t DW_RLE_startx_length = 0x03;
+		const uint8_t DW_RLE_offset_pair = 0x04;
+		const uint8_t DW_RLE_base_address = 0x05;
+		const uint8_t DW_RLE_start_end = 0x06;
+		const uint8_t DW_RLE_start_length = 0x07;
+
+		const uint64_t DW_LNCT_path = 0x1;
+		const uint64_t DW_LNCT_directory_index = 0x2;
+
+		const uint8_t DW_LNS_copy = 0x01;
+		const uint8_t DW_LNS_advance_pc = 0x02;
+		const uint8_t DW_LNS_advance_line = 0x03;
+		const uint8_t DW_LNS_set_file = 0x04;
+		const uint8_t DW_LNS_negate_stmt = 0x06;
+		const uint8_t DW_LNS_const_add_pc = 0x08;
+		const uint8_t DW_LNS_fixed_advance_pc = 0x09;
+
+		const uint8_t DW_LNE_end_sequence = 0x01;
+		const uint8_t DW_LNE_set_address = 0x02;
+		const uint8_t DW_LNE_define_file = 0x03;
+
+		//---------------------------------------------------------------------
+		class Reader
+		{
+		  public:
+			//-----------------------------------------------------------------
+			explicit Reader(const DwarfSection& section)
+			    : Reader{section.data_, section.data_, section.size_}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			bool IsEnd() const
+			{
+				return offset_ == size_;
+			}
+
+			//-----------------------------------------------------------------
+			uint64_t GetOffset() const
+			{
+				return static_cast<uint64_t>(data_ + offset_ - sectionData_);
+			}
+
+			//-----------------------------------------------------------------
+			uint64_t ReadUnsigned(uint64_t size)
+			{
+				CheckRemainingSize(size);
+				if (size > sizeof(uint64_t))
+					THROW("DWARF: invalid integer size " << size);
+				uint64_t value = 0;
+				for (uint64_t i = 0; i < size; ++i)
+					value |= uint64_t{data_[offset_ + i]} << (8 * i);
+				offset_ += static_cast<size_t>(size);
+				return value;
+			}
+
+			//-----------------------------------------------------------------
+			uint8_t ReadU8()
+			{
+				return static_cast<uint8_t>(ReadUnsigned(1));
+			}
+
+			//-----------------------------------------------------------------
+			uint64_t ReadULEB128()
+			{
+				uint64_t value = 0;
+				for (int shift = 0;; shift += 7)
+				{
+					auto byte = ReadU8();
+					if (shift < 64)
+						value |= uint64_t{byte & 0x7fu} << shift;
+					if ((byte & 0x80) == 0)
+						return value;
+				}
+			}
+
+			//-----------------------------------------------------------------
+			int64_t ReadSLEB128()
+			{
+				uint64_t value = 0;
+				int shift = 0;
+				uint8_t byte = 0;
+				do
+				{
+					byte = ReadU8();
+					if (shift < 64)
+						value |= uint64_t{byte & 0x7fu} << shift;
+					shift += 7;
+				} while (byte & 0x80);
+
+				if (shift < 64 && (byte & 0x40))
+					value |= ~uint64_t{0} << shift;
+				return static_cast<int64_t>(value);
+			}
+
+			//-----------------------------------------------------------------
+			const char* ReadCString()
+			{
+				auto begin = data_ + offset_;
+				auto end = static_cast<const unsigned char*>(
+				    std::memchr(begin, '\0', size_ - offset_));
+				if (!end)
+					THROW("DWARF: unterminated string.");
+				offset_ += end - begin + 1;
+				return reinterpret_cast<const char*>(begin);
+			}
+
+			//-----------------------------------------------------------------
+			void Skip(uint64_t size)
+			{
+				CheckRemainingSize(size);
+				offset_ += static_cast<size_t>(size);
+			}
+
+			//-----------------------------------------------------------------
+			// Return a reader for the next size bytes and skip them.
+			Reader ReadSubReader(uint64_t size)
+			{
+				CheckRemainingSize(size);
+				Reader reader{sectionData_, data_ + offset_, static_cast<size_t>(size)};
+				offset_ += static_cast<size_t>(size);
+				return reader;
+			}
+
+			//-----------------------------------------------------------------
+			// Read a unit length and return a reader for the unit content.
+			Reader ReadUnit(int& offsetSize)
+			{
+				uint64_t length = ReadUnsigned(4);
+				offsetSize = 4;
+				if (length == 0xffffffff)
+				{
+					length = ReadUnsigned(8);
+					offsetSize = 8;
+				}
+				else if (length >= 0xfffffff0)
+					THROW("DWARF: invalid unit length.");
+				return ReadSubReader(length);
+			}
+
+		  private:
+			//-----------------------------------------------------------------
+			Reader(const unsigned char* sectionData,
+			       const unsigned char* data,
+			       size_t size)
+			    : sectionData_{sectionData}, data_{data}, size_{size}, offset_{0}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			void CheckRemainingSize(uint64_t size) const
+			{
+				if (size > size_ - offset_)
+					THROW("DWARF: unexpected end of section.");
+			}
+
+			const unsigned char* sectionData_;
+			const unsigned char* data_;
+			size_t size_;
+			size_t offset_;
+		};
+
+		//---------------------------------------------------------------------
+		struct FormContext
+		{
+			const DwarfSections& sections_;
+			int version_;
+			int offsetSize_;
+			int addressSize_;
+		};
+
+		//---------------------------------------------------------------------
+		struct FormValue
+		{
+			uint64_t value_ = 0;
+			// Only set for the string forms which do not require
+			// .debug_str_offsets.
+			const char* string_ = nullptr;
+		};
+
+		//---------------------------------------------------------------------
+		const char* GetSectionString(const DwarfSection& section, uint64_t offset)
+		{
+			if (offset >= section.size_)
+				THROW("DWARF: invalid string offset " << offset);
+			auto begin = section.data_ + offset;
+			if (!std::memchr(begin, '\0', static_cast<size_t>(section.size_ - offset)))
+				THROW("DWARF: unterminated string.");
+			return reinterpret_cast<const char*>(begin);
+		}
+
+		//---------------------------------------------------------------------
+		FormValue ReadForm(Reader& reader,
+		                   uint64_t form,
+		                   int64_t implicitConst,
+		                   const FormContext& context)
+		{
+			FormValue formValue;
+			auto& value = formValue.value_;
+
+			switch (form)
+			{
+				case DW_FORM_addr: value = reader.ReadUnsigned(context.addressSize_); break;
+				case DW_FORM_data1:
+				case DW_FORM_ref1:
+				case DW_FORM_flag:
+				case DW_FORM_strx1:
+				case DW_FORM_addrx1: value = reader.ReadUnsigned(1); break;
+				case DW_FORM_data2:
+				case DW_FORM_ref2:
+				case DW_FORM_strx2:
+				case DW_FORM_addrx2: value = reader.ReadUnsigned(2); break;
+				case DW_FORM_strx3:
+				case DW_FORM_addrx3: value = reader.ReadUnsigned(3); break;
+				case DW_FORM_data4:
+				case DW_FORM_ref4:
+				case DW_FORM_ref_sup4:
+				case DW_FORM_strx4:
+				case DW_FORM_addrx4: value = reader.ReadUnsigned(4); break;
+				case DW_FORM_data8:
+				case DW_FORM_ref8:
+				case DW_FORM_ref_sig8:
+				case DW_FORM_ref_sup8: value = reader.ReadUnsigned(8); break;
+				case DW_FORM_data16: reader.Skip(16); break;
+				case DW_FORM_sdata: value = static_cast<uint64_t>(reader.ReadSLEB128()); break;
+				case DW_FORM_udata:
+				case DW_FORM_ref_udata:
+				case DW_FORM_strx:
+				case DW_FORM_addrx:
+				case DW_FORM_loclistx:
+				case DW_FORM_rnglistx:
+				case DW_FORM_GNU_addr_index:
+				case DW_FORM_GNU_str_index: value = reader.ReadULEB128(); break;
+				case DW_FORM_ref_addr:
+					value = reader.ReadUnsigned(context.version_ <= 2 ? context.addressSize_
+					                                                 : context.offsetSize_);
+					break;
+				case DW_FORM_sec_offset:
+				case DW_FORM_strp_sup:
+				case DW_FORM_GNU_ref_alt:
+				case DW_FORM_GNU_strp_alt: value = reader.ReadUnsigned(context.offsetSize_); break;
+				case DW_FORM_string: formValue.string_ = reader.ReadCString(); break;
+				case DW_FORM_strp:
+					value = reader.ReadUnsigned(context.offsetSize_);
+					formValue.string_ = GetSectionString(context.sections_.debugStr_, value);
+					break;
+				case DW_FORM_line_strp:
+					value = reader.ReadUnsigned(context.offsetSize_);
+					formValue.string_ = GetSectionString(context.sections_.debugLineStr_, value);
+					break;
+				case DW_FORM_block1: reader.Skip(reader.ReadUnsigned(1)); break;
+				case DW_FORM_block2: reader.Skip(reader.ReadUnsigned(2)); break;
+				case DW_FORM_block4: reader.Skip(reader.ReadUnsigned(4)); break;
+				case DW_FORM_block:
+				case DW_FORM_exprloc: reader.Skip(reader.ReadULEB128()); break;
+				case DW_FORM_flag_present: value = 1; break;
+				case DW_FORM_implicit_const: value = static_cast<uint64_t>(implicitConst); break;
+				case DW_FORM_indirect:
+					return ReadForm(reader, reader.ReadULEB128(), implicitConst, context);
+				default: THROW("DWARF: unsupported form " << form);
+			}
+			return formValue;
+		}
+
+		//---------------------------------------------------------------------
+		bool IsConstantForm(uint64_t form)
+		{
+			return form == DW_FORM_data1 || form == DW_FORM_data2 ||
+			       form == DW_FORM_data4 || form == DW_FORM_data8 ||
+			       form == DW_FORM_udata || form == DW_FORM_sdata ||
+			       form == DW_FORM_implicit_const;
+		}
+
+		//---------------------------------------------------------------------
+		bool IsAddressIndexForm(uint64_t form)
+		{
+			return form == DW_FORM_addrx || form == DW_FORM_addrx1 ||
+			       form == DW_FORM_addrx2 || form == DW_FORM_addrx3 ||
+			       form == DW_FORM_addrx4 || form == DW_FORM_GNU_addr_index;
+		}
+
+		//---------------------------------------------------------------------
+		struct AttributeValue
+		{
+			uint64_t form_;
+			uint64_t value_;
+		};
+
+		//---------------------------------------------------------------------
+		// Attributes of the compile unit required to read the addresses
+		// stored in .debug_addr, .debug_rnglists and .debug_ranges.
+		struct UnitAddresses
+		{
+			uint64_t addressBase_ = 0;
+			uint64_t rangeListsBase_ = 0;
+			// Base address of the range lists: low_pc of the compile unit.
+			uint64_t baseAddress_ = 0;
+		};
+
+		//---------------------------------------------------------------------
+		// Return a reader at the element index of a table starting at
+		// tableOffset.
+		Reader ReadTableElement(const DwarfSection& section,
+		                        uint64_t tableOffset,
+		                        uint64_t index,
+		                        uint64_t elementSize)
+		{
+			Reader reader{section};
+			reader.Skip(tableOffset);
+			if (elementSize != 0 && index > section.size_ / elementSize)
+				THROW("DWARF: invalid table index " << index);
+			reader.Skip(index * elementSize);
+			return reader;
+		}
+
+		//---------------------------------------------------------------------
+		uint64_t ReadIndexedAddress(const FormContext& context,
+		                            const UnitAddresses& unitAddresses,
+		                            uint64_t index)
+		{
+			auto reader = ReadTableElement(context.sections_.debugAddr_,
+			                               unitAddresses.addressBase_,
+			                               index,
+			                               context.addressSize_);
+			return reader.ReadUnsigned(context.addressSize_);
+		}
+
+		//---------------------------------------------------------------------
+		// Return none if the attribute is not of the address class.
+		boost::optional<uint64_t> GetAddress(const FormContext& context,
+		                                     const UnitAddresses& unitAddresses,
+		                                     const AttributeValue& attribute)
+		{
+			if (attribute.form_ == DW_FORM_addr)
+				return attribute.value_;
+			if (IsAddressIndexForm(attribute.form_))
+				return ReadIndexedAddress(context, unitAddresses, attribute.value_);
+			return boost::none;
+		}
+
+		//---------------------------------------------------------------------
+		uint64_t GetRangeListOffset(const FormContext& context,
+		                            const UnitAddresses& unitAddresses,
+		                            const AttributeValue& ranges)
+		{
+			if (ranges.form_ != DW_FORM_rnglistx)
+				return ranges.value_;
+
+			// The offsets of the table are relative to DW_AT_rnglists_base.
+			auto reader = ReadTableElement(context.sections_.debugRngLists_,
+			                               unitAddresses.rangeListsBase_,
+			                               ranges.value_,
+			                               context.offsetSize_);
+			return unitAddresses.rangeListsBase_ + reader.ReadUnsigned(context.offsetSize_);
+		}
+
+		//---------------------------------------------------------------------
+		template <typename T_Function>
+		void ReadRangeListV4(const FormContext& context,
+		                     const UnitAddresses& unitAddresses,
+		                     uint64_t offset,
+		                     T_Function onRange)
+		{
+			Reader reader{context.sections_.debugRanges_};
+			reader.Skip(offset);
+			auto baseAddress = unitAddresses.baseAddress_;
+			auto baseAddressSelection = context.addressSize_ >= 8
+			                                ? ~uint64_t{0}
+			                                : (uint64_t{1} << (8 * context.addressSize_)) - 1;
+
+			for (;;)
+			{
+				auto begin = reader.ReadUnsigned(context.addressSize_);
+				auto end = reader.ReadUnsigned(context.addressSize_);
+				if (begin == 0 && end == 0)
+					return;
+				if (begin == baseAddressSelection)
+					baseAddress = end;
+				else
+					onRange(baseAddress + begin, baseAddress + end);
+			}
+		}
+
+		//---------------------------------------------------------------------
+		template <typename T_Function>
+		void ReadRangeListV5(const FormContext& context,
+		                     const UnitAddresses& unitAddresses,
+		                     uint64_t offset,
+		                     T_Function onRange)
+		{
+			Reader reader{context.sections_.debugRngLists_};
+			reader.Skip(offset);
+			auto baseAddress = unitAddresses.baseAddress_;
+			auto readAddress = [&]() { return reader.ReadUnsigned(context.addressSize_); };
+			auto readIndexedAddress = [&]() {
+				return ReadIndexedAddress(context, unitAddresses, reader.ReadULEB128());
+			};
+
+			for (;;)
+			{
+				uint64_t begin = 0;
+				uint64_t end = 0;
+				auto kind = reader.ReadU8();
+
+				switch (kind)
+				{
+					case DW_RLE_end_of_list: return;
+					case DW_RLE_base_addressx: baseAddress = readIndexedAddress(); continue;
+					case DW_RLE_base_address: baseAddress = readAddress(); continue;
+					case DW_RLE_startx_endx:
+						begin = readIndexedAddress();
+						end = readIndexedAddress();
+						break;
+					case DW_RLE_startx_length:
+						begin = readIndexedAddress();
+						end = begin + reader.ReadULEB128();
+						break;
+					case DW_RLE_offset_pair:
+						begin = baseAddress + reader.ReadULEB128();
+						end = baseAddress + reader.ReadULEB128();
+						break;
+					case DW_RLE_start_end:
+						begin = readAddress();
+						end = readAddress();
+						break;
+					case DW_RLE_start_length:
+						begin = readAddress();
+						end = begin + reader.ReadULEB128();
+						break;
+					default: THROW("DWARF: invalid range list entry " << static_cast<int>(kind));
+				}
+				onRange(begin, end);
+			}
+		}
+
+		//---------------------------------------------------------------------
+		struct AttributeSpecification
+		{
+			uint64_t name_;
+			uint64_t form_;
+			int64_t implicitConst_;
+		};
+
+		//---------------------------------------------------------------------
+		struct Abbreviation
+		{
+			uint64_t tag_ = 0;
+			std::vector<AttributeSpecification> attributes_;
+		};
+
+		using Abbreviations = std::unordered_map<uint64_t, Abbreviation>;
+
+		//---------------------------------------------------------------------
+		Abbreviations ReadAbbreviations(const DwarfSection& debugAbbrev, uint64_t offset)
+		{
+			Reader reader{debugAbbrev};
+			Abbreviations abbreviations;
+
+			reader.Skip(offset);
+			for (auto code = reader.ReadULEB128(); code != 0; code = reader.ReadULEB128())
+			{
+				auto& abbreviation = abbreviations[code];
+				abbreviation.tag_ = reader.ReadULEB128();
+				reader.ReadU8(); // DW_CHILDREN_yes or DW_CHILDREN_no
+				for (;;)
+				{
+					auto name = reader.ReadULEB128();
+					auto form = reader.ReadULEB128();
+					if (name == 0 && form == 0)
+						break;
+					int64_t implicitConst = 0;
+					if (form == DW_FORM_implicit_const)
+						implicitConst = reader.ReadSLEB128();
+					abbreviation.attributes_.push_back({name, form, implicitConst});
+				}
+			}
+			return abbreviations;
+		}
+
+		//---------------------------------------------------------------------
+		bool IsAbsolutePath(const std::string& path)
+		{
+			return (!path.empty() && (path[0] == '/' || path[0] == '\\')) ||
+			       (path.size() >= 2 && path[1] == ':');
+		}
+
+		//---------------------------------------------------------------------
+		std::string JoinPath(const std::string& directory, const std::string& path)
+		{
+			if (directory.empty() || IsAbsolutePath(path))
+				return path;
+			auto last = directory.back();
+			if (last == '/' || last == '\\')
+				return directory + path;
+			return directory + '/' + path;
+		}
+
+		//---------------------------------------------------------------------
+		// Compilation directory of the compile units by offset of their
+		// line program.
+		using CompilationDirectories = std::unordered_map<uint64_t, std::string>;
+
+		//---------------------------------------------------------------------
+		void DecodeCompileUnit(Reader& unit,
+		                       int offsetSize,
+		                       const DwarfSections& sections,
+		                       std::unordered_map<uint64_t, Abbreviations>& abbreviationsCache,
+		                       CompilationDirectories& compilationDirectories,
+		                       IDwarfHandler& handler)
+		{
+			int version = static_cast<int>(unit.ReadUnsigned(2));
+			if (version < 2 || version > 5)
+				return;
+
+			uint64_t abbreviationOffset = 0;
+			int addressSize = 0;
+			if (version >= 5)
+			{
+				auto unitType = unit.ReadU8();
+				if (unitType != DW_UT_compile && unitType != DW_UT_partial)
+					return;
+				addressSize = unit.ReadU8();
+				abbreviationOffset = unit.ReadUnsigned(offsetSize);
+			}
+			else
+			{
+				abbreviationOffset = unit.ReadUnsigned(offsetSize);
+				addressSize = unit.ReadU8();
+			}
+
+			auto it = abbreviationsCache.find(abbreviationOffset);
+			if (it == abbreviationsCache.end())
+			{
+				it = abbreviationsCache
+				         .emplace(abbreviationOffset,
+				                  ReadAbbreviations(sections.debugAbbrev_, abbreviationOffset))
+				         .first;
+			}
+			const auto& abbreviations = it->second;
+			FormContext context{sections, version, offsetSize, addressSize};
+			UnitAddresses unitAddresses;
+
+			while (!unit.IsEnd())
+			{
+				auto dieOffset = unit.GetOffset();
+				auto code = unit.ReadULEB128();
+				if (code == 0)
+					continue;
+
+				auto abbreviationIt = abbreviations.find(code);
+				if (abbreviationIt == abbreviations.end())
+					THROW("DWARF: invalid abbreviation code " << code);
+				const auto& abbreviation = abbreviationIt->second;
+
+				boost::optional<AttributeValue> lowPc;
+				boost::optional<AttributeValue> highPc;
+				boost::optional<AttributeValue> ranges;
+				boost::optional<uint64_t> addressBase;
+				boost::optional<uint64_t> rangeListsBase;
+				boost::optional<uint64_t> stmtList;
+				const char* compilationDirectory = nullptr;
+
+				// The attributes of the address class are resolved after
+				// reading the entry: DW_AT_addr_base may follow DW_AT_low_pc.
+				for (const auto& attribute : abbreviation.attributes_)
+				{
+					auto formValue = ReadForm(unit, attribute.form_, attribute.implicitConst_, context);
+					AttributeValue attributeValue{attribute.form_, formValue.value_};
+					switch (attribute.name_)
+					{
+						case DW_AT_low_pc: lowPc = attributeValue; break;
+						case DW_AT_high_pc: highPc = attributeValue; break;
+						case DW_AT_ranges: ranges = attributeValue; break;
+						case DW_AT_addr_base:
+						case DW_AT_GNU_addr_base: addressBase = formValue.value_; break;
+						case DW_AT_rnglists_base: rangeListsBase = formValue.value_; break;
+						case DW_AT_stmt_list: stmtList = formValue.value_; break;
+						case DW_AT_comp_dir: compilationDirectory = formValue.string_; break;
+					}
+				}
+
+				if (abbreviation.tag_ == DW_TAG_subprogram)
+				{
+					auto id = static_cast<unsigned long>(dieOffset);
+					auto onRange = [&](uint64_t begin, uint64_t end) {
+						// The linker sets the address of discarded functions to 0.
+						if (begin != 0 && end > begin)
+							handler.OnFunction(begin, end - begin, id);
+					};
+
+					if (lowPc && highPc)
+					{
+						auto begin = GetAddress(context, unitAddresses, *lowPc);
+						auto end = GetAddress(context, unitAddresses, *highPc);
+						if (begin && end)
+							onRange(*begin, *end);
+						else if (begin && IsConstantForm(highPc->form_))
+							onRange(*begin, *begin + highPc->value_);
+					}
+					else if (ranges)
+					{
+						auto offset = GetRangeListOffset(context, unitAddresses, *ranges);
+						if (version >= 5)
+							ReadRangeListV5(context, unitAddresses, offset, onRange);
+						else
+							ReadRangeListV4(context, unitAddresses, offset, onRange);
+					}
+				}
+				else if (abbreviation.tag_ == DW_TAG_compile_unit ||
+				         abbreviation.tag_ == DW_TAG_partial_unit)
+				{
+					if (addressBase)
+						unitAddresses.addressBase_ = *addressBase;
+					if (rangeListsBase)
+						unitAddresses.rangeListsBase_ = *rangeListsBase;
+					if (lowPc)
+					{
+						if (auto baseAddress = GetAddress(context, unitAddresses, *lowPc))
+							unitAddresses.baseAddress_ = *baseAddress;
+					}
+					if (stmtList && compilationDirectory)
+						compilationDirectories.emplace(*stmtList, compilationDirectory);
+				}
+			}
+		}
+
+		//---------------------------------------------------------------------
+		struct LineProgramHeader
+		{
+			int version_ = 0;
+			int offsetSize_ = 0;
+			int addressSize_ = 0;
+			uint8_t minimumInstructionLength_ = 0;
+			bool defaultIsStmt_ = false;
+			int8_t lineBase_ = 0;
+			uint8_t lineRange_ = 0;
+			uint8_t opcodeBase_ = 0;
+			const unsigned char* standardOpcodeLengths_ = nullptr;
+		};
+
+		//---------------------------------------------------------------------
+		void ReadFileTableV4(Reader& reader,
+		                     const std::string& compilationDirectory,
+		                     std::vector<std::string>& paths)
+		{
+			std::vector<std::string> directories;
+			for (std::string directory = reader.ReadCString(); !directory.empty();
+			     directory = reader.ReadCString())
+			{
+				directories.push_back(JoinPath(compilationDirectory, directory));
+			}
+
+			// File indexes start at 1.
+			paths.emplace_back();
+			for (std::string name = reader.ReadCString(); !name.empty(); name = reader.ReadCString())
+			{
+				auto directoryIndex = reader.ReadULEB128();
+				reader.ReadULEB128(); // Modification time
+				reader.ReadULEB128(); // File size
+
+				const auto& directory = (directoryIndex == 0 || directoryIndex > directories.size())
+				                            ? compilationDirectory
+				                            : directories[static_cast<size_t>(directoryIndex - 1)];
+				paths.push_back(JoinPath(directory, name));
+			}
+		}
+
+		//---------------------------------------------------------------------
+		template <typename T_Function>
+		void ReadEntriesV5(Reader& reader, const FormContext& context, T_Function onEntry)
+		{
+			std::vector<std::pair<uint64_t, uint64_t>> formats(reader.ReadU8());
+			for (auto& format : formats)
+			{
+				format.first = reader.ReadULEB128();
+				format.second = reader.ReadULEB128();
+			}
+
+			auto count = reader.ReadULEB128();
+			for (uint64_t i = 0; i < count; ++i)
+			{
+				std::string path;
+				uint64_t directoryIndex = 0;
+				for (const auto& format : formats)
+				{
+					auto formValue = ReadForm(reader, format.second, 0, context);
+					if (format.first == DW_LNCT_path && formValue.string_)
+						path = formValue.string_;
+					else if (format.first == DW_LNCT_directory_index)
+						directoryIndex = formValue.value_;
+				}
+				onEntry(std::move(path), directoryIndex);
+			}
+		}
+
+		//---------------------------------------------------------------------
+		void ReadFileTableV5(Reader& reader,
+		                     const FormContext& context,
+		                     std::vector<std::string>& paths)
+		{
+			// The first directory is the compilation directory.
+			std::vector<std::string> directories;
+			ReadEntriesV5(reader, context, [&](std::string&& path, uint64_t) {
+				directories.push_back(directories.empty() ? std::move(path)
+				                                          : JoinPath(directories[0], path));
+			});
+			ReadEntriesV5(reader, context, [&](std::string&& path, uint64_t directoryIndex) {
+				if (directoryIndex < directories.size())
+					path = JoinPath(directories[static_cast<size_t>(directoryIndex)], path);
+				paths.push_back(std::move(path));
+			});
+		}
+
+		//---------------------------------------------------------------------
+		void RunLineProgram(Reader& program,
+		                    const LineProgramHeader& header,
+		                    std::vector<std::string>& paths,
+		                    IDwarfHandler& handler)
+		{
+			uint64_t address = 0;
+			uint64_t file = 1;
+			int64_t line = 1;
+			bool isStmt = header.defaultIsStmt_;
+			// Sequence of a function discarded by the linker.
+			bool isDiscarded = false;
+
+			auto addRow = [&]() {
+				if (isStmt && !isDiscarded && line > 0 && file < paths.size() &&
+				    !paths[static_cast<size_t>(file)].empty())
+				{
+					handler.OnLine(static_cast<size_t>(file), static_cast<unsigned long>(line), address);
+				}
+			};
+
+			while (!program.IsEnd())
+			{
+				auto opcode = program.ReadU8();
+
+				if (opcode >= header.opcodeBase_)
+				{
+					auto adjustedOpcode = opcode - header.opcodeBase_;
+					address += (adjustedOpcode / header.lineRange_) * header.minimumInstructionLength_;
+					line += header.lineBase_ + adjustedOpcode % header.lineRange_;
+					addRow();
+					continue;
+				}
+
+				switch (opcode)
+				{
+					case 0:
+					{
+						auto length = program.ReadULEB128();
+						if (length == 0)
+							break;
+						auto instruction = program.ReadSubReader(length);
+						auto extendedOpcode = instruction.ReadU8();
+						if (extendedOpcode == DW_LNE_end_sequence)
+						{
+							address = 0;
+							file = 1;
+							line = 1;
+							isStmt = header.defaultIsStmt_;
+							isDiscarded = false;
+						}
+						else if (extendedOpcode == DW_LNE_set_address)
+						{
+							address = instruction.ReadUnsigned(length - 1);
+							isDiscarded = address == 0;
+						}
+						else if (extendedOpcode == DW_LNE_define_file)
+						{
+							std::string name = instruction.ReadCString();
+							paths.push_back(name);
+							handler.OnFiles(paths);
+						}
+						break;
+					}
+					case DW_LNS_copy: addRow(); break;
+					case DW_LNS_advance_pc:
+						address += program.ReadULEB128() * header.minimumInstructionLength_;
+						break;
+					case DW_LNS_advance_line: line += program.ReadSLEB128(); break;
+					case DW_LNS_set_file: file = program.ReadULEB128(); break;
+					case DW_LNS_negate_stmt: isStmt = !isStmt; break;
+					case DW_LNS_const_add_pc:
+						address += ((255 - header.opcodeBase_) / header.lineRange_) *
+						           header.minimumInstructionLength_;
+						break;
+					case DW_LNS_fixed_advance_pc: address += program.ReadUnsigned(2); break;
+					default:
+						// Skip the ULEB128 operands of the other standard opcodes.
+						for (int i = 0; i < header.standardOpcodeLengths_[opcode - 1]; ++i)
+							program.ReadULEB128();
+				}
+			}
+		}
+
+		//---------------------------------------------------------------------
+		void DecodeLineProgram(Reader& unit,
+		                       int offsetSize,
+		                       const DwarfSections& sections,
+		                       const std::string& compilationDirectory,
+		                       IDwarfHandler& handler)
+		{
+			LineProgramHeader header;
+			header.offsetSize_ = offsetSize;
+			header.version_ = static_cast<int>(unit.ReadUnsigned(2));
+			if (header.version_ < 2 || header.version_ > 5)
+				return;
+			if (header.version_ >= 5)
+			{
+				header.addressSize_ = unit.ReadU8();
+				unit.ReadU8(); // Segment selector size
+			}
+
+			auto headerLength = unit.ReadUnsigned(offsetSize);
+			auto program = unit;
+			program.Skip(headerLength);
+
+			header.minimumInstructionLength_ = unit.ReadU8();
+			if (header.version_ >= 4)
+				unit.ReadU8(); // Maximum operations per instruction
+			header.defaultIsStmt_ = unit.ReadU8() != 0;
+			header.lineBase_ = static_cast<int8_t>(unit.ReadU8());
+			header.lineRange_ = unit.ReadU8();
+			header.opcodeBase_ = unit.ReadU8();
+			if (header.lineRange_ == 0 || header.opcodeBase_ == 0)
+				THROW("DWARF: invalid line program header.");
+			std::vector<unsigned char> standardOpcodeLengths(header.opcodeBase_ - 1);
+			for (auto& length : standardOpcodeLengths)
+				length = unit.ReadU8();
+			header.standardOpcodeLengths_ = standardOpcodeLengths.data();
+
+			std::vector<std::string> paths;
+			if (header.version_ >= 5)
+			{
+				FormContext context{sections, header.version_, offsetSize, header.addressSize_};
+				ReadFileTableV5(unit, context, paths);
+			}
+			else
+				ReadFileTableV4(unit, compilationDirectory, paths);
+
+			handler.OnFiles(paths);
+			RunLineProgram(program, header, paths, handler);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	DwarfDecoder::DwarfDecoder(const DwarfSections& sections)
+	    : sections_{sections}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	void DwarfDecoder::Decode(IDwarfHandler& handler) const
+	{
+		CompilationDirectories compilationDirectories;
+		std::unordered_map<uint64_t, Abbreviations> abbreviationsCache;
+		const std::string noCompilationDirectory;
+
+		for (Reader debugInfo{sections_.debugInfo_}; !debugInfo.IsEnd();)
+		{
+			int offsetSize = 0;
+			auto unit = debugInfo.ReadUnit(offsetSize);
+			DecodeCompileUnit(
+			    unit, offsetSize, sections_, abbreviationsCache, compilationDirectories, handler);
+		}
+
+		for (Reader debugLine{sections_.debugLine_}; !debugLine.IsEnd();)
+		{
+			auto unitOffset = debugLine.GetOffset();
+			int offsetSize = 0;
+			auto unit = debugLine.ReadUnit(offsetSize);
+			auto it = compilationDirectories.find(unitOffset);
+
+			DecodeLineProgram(unit,
+			                  offsetSize,
+			                  sections_,
+			                  it != compilationDirectories.end() ? it->second
+			                                                     : noCompilationDirectory,
+			                  handler);
+		}
+	}
+}
@@ -0,0 +1,84 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	//-------------------------------------------------------------------------
+	struct DwarfSection
+	{
+		const unsigned char* data_ = nullptr;
+		size_t size_ = 0;
+	};
+
+	//-------------------------------------------------------------------------
+	struct DwarfSections
+	{
+		DwarfSection debugInfo_;
+		DwarfSection debugAbbrev_;
+		DwarfSection debugLine_;
+		DwarfSection debugLineStr_;
+		DwarfSection debugStr_;
+		DwarfSection debugAddr_;
+		DwarfSection debugRanges_;
+		DwarfSection debugRngLists_;
+	};
+
+	//-------------------------------------------------------------------------
+	class IDwarfHandler
+	{
+	  public:
+		virtual ~IDwarfHandler() = default;
+
+		// id is the offset of the DW_TAG_subprogram entry in .debug_info.
+		// A function with several address ranges is reported once per range.
+		virtual void
+		OnFunction(uint64_t address, uint64_t size, unsigned long id) = 0;
+
+		// File table of the next line program. OnLine fileIndex is an
+		// index in this table.
+		virtual void OnFiles(const std::vector<std::string>& paths) = 0;
+		virtual void
+		OnLine(size_t fileIndex, unsigned long lineNumber, uint64_t address) = 0;
+	};
+
+	// Streaming decoder of the DWARF 2 to 5 debug information emitted by
+	// gcc and clang: functions from .debug_info and line programs from
+	// .debug_line. Sections are read in place and nothing is copied except
+	// the file tables.
+	class CPPCOVERAGE_DLL DwarfDecoder
+	{
+	  public:
+		explicit DwarfDecoder(const DwarfSections&);
+
+		// All OnFunction calls happen before the first OnFiles call.
+		void Decode(IDwarfHandler&) const;
+
+	  private:
+		DwarfDecoder(const DwarfDecoder&) = delete;
+		DwarfDecoder& operator=(const DwarfDecoder&) = delete;
+
+		const DwarfSections sections_;
+	};
+}
@@ -18,6 +18,10 @@
 #include "ExceptionHandler.hpp"
 #include "ProgramOptions.hpp"
 
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+
+#include "Tools/Log.hpp"
 #include "Tools/ScopedAction.hpp"
 #include "Tools/Tool.hpp"
 
@@ -35,11 +39,16 @@ namespace CppCoverage
 	//-------------------------------------------------------------------------
 	ExceptionHandler::ExceptionHandler()
 	{
-		breakPointExceptionCode_.emplace(EXCEPTION_BREAKPOINT, std::vector<HANDLE>{});
-		breakPointExceptionCode_.emplace(ExceptionEmulationX86ErrorCode, std::vector<HANDLE>{});
 		InitExceptionCode();
 	}
 
+	//-------------------------------------------------------------------------
+	bool ExceptionHandler::IsBreakPointExceptionCode(DWORD exceptionCode)
+	{
+		return exceptionCode == EXCEPTION_BREAKPOINT ||
+		       exceptionCode == static_cast<DWORD>(ExceptionEmulationX86ErrorCode);
+	}
+
 	//-------------------------------------------------------------------------
 	void ExceptionHandler::InitExceptionCode()
 	{
@@ -70,29 +79,51 @@ namespace CppCoverage
 	//-------------------------------------------------------------------------
 	ExceptionHandlerStatus ExceptionHandler::HandleException(
 		HANDLE hProcess,
-		const EXCEPTION_DEBUG_INFO& exceptionDebugInfo,
-		std::wostream& message)
+		const EXCEPTION_DEBUG_INFO& exceptionDebugInfo)
 	{
 		const auto& exceptionRecord = exceptionDebugInfo.ExceptionRecord;
 		const auto exceptionCode = exceptionRecord.ExceptionCode;
+		auto& statistics = statistics_[exceptionCode];
 
 		if (exceptionDebugInfo.dwFirstChance)
 		{
-			auto it = breakPointExceptionCode_.find(exceptionCode);
-			
-			if (it != breakPointExceptionCode_.end())
+			++statistics.firstChanceCount_;
+			if (IsBreakPointExceptionCode(exceptionCode))
 			{
-				auto& processHandles = it->second;
+				auto& receivedCodes = receivedBreakPointCodes_[hProcess];
 				// Breakpoint exception need to be ignore the first time by process.
-				if (std::find(processHandles.begin(), processHandles.end(), hProcess) == processHandles.end())
-					processHandles.push_back(hProcess);
+				if (std::find(receivedCodes.begin(), receivedCodes.end(), exceptionCode) == receivedCodes.end())
+					receivedCodes.push_back(exceptionCode);
 				else
 					return ExceptionHandlerStatus::BreakPoint;
 			}
 
 			return ExceptionHandlerStatus::FirstChanceException;
 		}
-				
+
+		++statistics.unhandledCount_;
+		return (exceptionCode == CppExceptionErrorCode) 
+			? ExceptionHandlerStatus::CppError : ExceptionHandlerStatus::Error;
+	}
+
+	//-------------------------------------------------------------------------
+	ExceptionHandlerStatus ExceptionHandler::HandleException(
+		HANDLE hProcess,
+		const EXCEPTION_DEBUG_INFO& exceptionDebugInfo,
+		std::wostream& message)
+	{
+		auto status = HandleException(hProcess, exceptionDebugInfo);
+
+		if (status == ExceptionHandlerStatus::Error || status == ExceptionHandlerStatus::CppError)
+			FormatUnhandledException(exceptionDebugInfo.ExceptionRecord, message);
+		return status;
+	}
+
+	//-------------------------------------------------------------------------
+	void ExceptionHandler::FormatUnhandledException(
+		const EXCEPTION_RECORD& exceptionRecord,
+		std::wostream& message) const
+	{
 		message << std::endl << std::endl;
 		message << Tools::GetSeparatorLine() << std::endl;
 		message << L"*** ";
@@ -101,35 +132,60 @@ namespace CppCoverage
 		message << Tools::GetSeparatorLine() << std::endl;
 		message << L"If your application was built with optimization enabled, make sure you use --"
 			+ Tools::LocalToWString(ProgramOptions::OptimizedBuildOption) << std::endl;
+	}
 
-		return (exceptionCode == CppExceptionErrorCode) 
-			? ExceptionHandlerStatus::CppError : ExceptionHandlerStatus::Error;
+	//-------------------------------------------------------------------------
+	void ExceptionHandler::AddHandlingTime(DWORD exceptionCode, double seconds)
+	{
+		statistics_[exceptionCode].handlingTimeInSeconds_ += seconds;
 	}
 
 	//-------------------------------------------------------------------------
-	void ExceptionHandler::OnExitProcess(HANDLE hProcess)
+	void ExceptionHandler::LogStatistics() const
 	{
-		for (auto& pair : breakPointExceptionCode_)
+		std::vector<std::pair<DWORD, ExceptionStatistics>> statistics{
+			statistics_.begin(), statistics_.end()};
+
+		std::sort(statistics.begin(), statistics.end(), [](const auto& s1, const auto& s2) {
+			return s1.second.firstChanceCount_ + s1.second.unhandledCount_ >
+			       s2.second.firstChanceCount_ + s2.second.unhandledCount_;
+		});
+		for (const auto& pair : statistics)
 		{
-			std::vector<HANDLE>& processes = pair.second;
-			auto it = std::find(processes.begin(), processes.end(), hProcess);
+			const auto& exceptionStatistics = pair.second;
+			auto name = boost::trim_copy(GetExceptionStrFromCode(pair.first));
 
-			if (it != processes.end())
-				processes.erase(it);
+			LOG_INFO << L"Exception 0x" << std::hex << pair.first << std::dec
+			         << L" (" << name << L"): "
+			         << exceptionStatistics.firstChanceCount_ << L" first chance, "
+			         << exceptionStatistics.unhandledCount_ << L" unhandled, "
+			         << exceptionStatistics.handlingTimeInSeconds_ << L"s.";
 		}
 	}
 
 	//-------------------------------------------------------------------------
-	std::wstring ExceptionHandler::GetExceptionStrFromCode(DWORD exceptionCode) const
+	void ExceptionHandler::OnExitProcess(HANDLE hProcess)
+	{
+		receivedBreakPointCodes_.erase(hProcess);
+	}
+
+	//-------------------------------------------------------------------------
+	const std::wstring& ExceptionHandler::GetExceptionStrFromCode(DWORD exceptionCode) const
 	{
 		auto it = exceptionCode_.find(exceptionCode);
 
 		if (it != exceptionCode_.end())
 			return it->second;
-		
+
+		return exceptionCode_.emplace(exceptionCode, FormatExceptionCode(exceptionCode)).first->second;
+	}
+
+	//-------------------------------------------------------------------------
+	std::wstring ExceptionHandler::FormatExceptionCode(DWORD exceptionCode)
+	{
 		LPTSTR message = nullptr;
-		HMODULE ntDllModule = LoadLibrary(L"NTDLL.DLL");
-		Tools::ScopedAction closeLibrary{ [=](){ FreeLibrary(ntDllModule); } };
+		// NTDLL is loaded in every process.
+		HMODULE ntDllModule = GetModuleHandle(L"NTDLL.DLL");
 	
 		FormatMessage(
 			FORMAT_MESSAGE_ALLOCATE_BUFFER |
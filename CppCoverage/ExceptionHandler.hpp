@@ -18,8 +18,9 @@
 
 #include <Windows.h>
 #include <iosfwd>
+#include <string>
 #include <unordered_map>
-#include <map>
+#include <vector>
 
 #include "CppCoverageExport.hpp"
 
@@ -45,18 +46,42 @@ namespace CppCoverage
 
 		ExceptionHandler();
 
+		// EXCEPTION_BREAKPOINT or ExceptionEmulationX86ErrorCode.
+		static bool IsBreakPointExceptionCode(DWORD exceptionCode);
+
+		// The exception is only counted, use FormatUnhandledException for
+		// ExceptionHandlerStatus::Error and ExceptionHandlerStatus::CppError.
+		ExceptionHandlerStatus HandleException(HANDLE hProcess, const EXCEPTION_DEBUG_INFO&);
 		ExceptionHandlerStatus HandleException(HANDLE hProcess, const EXCEPTION_DEBUG_INFO&, std::wostream&);
+		void FormatUnhandledException(const EXCEPTION_RECORD&, std::wostream&) const;
 		void OnExitProcess(HANDLE hProcess);
 
+		// Time spent by the debugger loop on the exceptions of this code,
+		// see DebugEventStatistics::GetExceptionHistograms.
+		void AddHandlingTime(DWORD exceptionCode, double seconds);
+		void LogStatistics() const;
+
 	private:
 		ExceptionHandler(const ExceptionHandler&) = delete;
 		ExceptionHandler& operator=(const ExceptionHandler&) = delete;
 
 		void InitExceptionCode();
-		std::wstring GetExceptionStrFromCode(DWORD) const;
+		const std::wstring& GetExceptionStrFromCode(DWORD) const;
+		static std::wstring FormatExceptionCode(DWORD);
+
+		struct ExceptionStatistics
+		{
+			size_t firstChanceCount_ = 0;
+			size_t unhandledCount_ = 0;
+			double handlingTimeInSeconds_ = 0;
+		};
 
-		std::unordered_map<DWORD, std::wstring> exceptionCode_;
-		std::map<DWORD, std::vector<HANDLE>> breakPointExceptionCode_;
+		// Names of the exception codes, completed by FormatMessage the
+		// first time a code is formatted.
+		mutable std::unordered_map<DWORD, std::wstring> exceptionCode_;
+		std::unordered_map<DWORD, ExceptionStatistics> statistics_;
+		// Breakpoint exception codes already received by each process.
+		std::unordered_map<HANDLE, std::vector<DWORD>> receivedBreakPointCodes_;
 	};
 }
 
@@ -18,6 +18,12 @@
 #include "ExecutedAddressManager.hpp"
 
 #include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include <limits>
 #include <boost/container/small_vector.hpp>
 
 #include "tools/Log.hpp"
@@ -32,22 +38,83 @@ namespace CppCoverage
 	//-------------------------------------------------------------------------
 	struct ExecutedAddressManager::Line
 	{
-		explicit Line(unsigned char instructionToRestore, void* dllBaseOfImage)
+		struct FileLine
+		{
+			uint32_t fileIndex_;
+			// Line number until the module addresses are sealed and
+			// index in File::lineNumbers_ after.
+			uint32_t lineIndex_;
+		};
+
+		explicit Line(unsigned char instructionToRestore)
 			: instructionToRestore_{ instructionToRestore }
-			, dllBaseOfImage_{ dllBaseOfImage }
+			, isArmed_{ true }
 		{
 		}
 
-		const unsigned char instructionToRestore_;
-		void* const dllBaseOfImage_;
-		boost::container::small_vector<bool*, 1> hasBeenExecutedCollection_;
+		unsigned char instructionToRestore_;
+		bool isArmed_;
+		boost::container::small_vector<FileLine, 1> fileLines_;
 	};
 
 	//-------------------------------------------------------------------------
 	struct ExecutedAddressManager::File
-	{		
-		// Use map to have iterator always valid
-		std::map<unsigned int, bool> lines;
+	{
+		explicit File(const std::wstring& path) : path_{ path }
+		{
+		}
+
+		//---------------------------------------------------------------------
+		// Merge pendingLineNumbers_ into lineNumbers_ and return the new
+		// index of each previous line. Return an empty collection if 
+		// the indexes of the previous lines did not change.
+		std::vector<uint32_t> MergePendingLines()
+		{
+			if (pendingLineNumbers_.empty())
+				return {};
+
+			std::sort(pendingLineNumbers_.begin(), pendingLineNumbers_.end());
+			std::vector<unsigned int> lineNumbers;
+			lineNumbers.reserve(lineNumbers_.size() + pendingLineNumbers_.size());
+			std::set_union(lineNumbers_.begin(), lineNumbers_.end(),
+				pendingLineNumbers_.begin(), pendingLineNumbers_.end(),
+				std::back_inserter(lineNumbers));
+			lineNumbers.erase(std::unique(lineNumbers.begin(), lineNumbers.end()), lineNumbers.end());
+			std::vector<unsigned int>{}.swap(pendingLineNumbers_);
+
+			if (lineNumbers.size() == lineNumbers_.size())
+				return {};
+
+			std::vector<uint32_t> newIndexes(lineNumbers_.size());
+			std::vector<bool> executedLines(lineNumbers.size());
+			size_t newIndex = 0;
+			for (size_t i = 0; i < lineNumbers_.size(); ++i)
+			{
+				while (lineNumbers[newIndex] != lineNumbers_[i])
+					++newIndex;
+				newIndexes[i] = static_cast<uint32_t>(newIndex);
+				executedLines[newIndex] = executedLines_[i];
+			}
+			lineNumbers_ = std::move(lineNumbers);
+			executedLines_ = std::move(executedLines);
+
+			return newIndexes;
+		}
+
+		//---------------------------------------------------------------------
+		uint32_t GetLineIndex(unsigned int lineNumber) const
+		{
+			auto it = std::lower_bound(lineNumbers_.begin(), lineNumbers_.end(), lineNumber);
+
+			if (it == lineNumbers_.end() || *it != lineNumber)
+				THROW("Cannot find line " << lineNumber << " in " << path_);
+			return static_cast<uint32_t>(it - lineNumbers_.begin());
+		}
+
+		const std::wstring path_;
+		std::vector<unsigned int> lineNumbers_;
+		std::vector<bool> executedLines_;
+		std::vector<unsigned int> pendingLineNumbers_;
 	};
 
 	//-------------------------------------------------------------------------
@@ -57,12 +124,256 @@ namespace CppCoverage
 		{
 		}
 
+		//---------------------------------------------------------------------
+		uint32_t GetFileIndex(const std::wstring& filename)
+		{
+			auto it = fileIndexes_.find(filename);
+			if (it != fileIndexes_.end())
+				return it->second;
+
+			auto fileIndex = static_cast<uint32_t>(files_.size());
+			files_.emplace_back(filename);
+			fileIndexes_.emplace(filename, fileIndex);
+			return fileIndex;
+		}
+
 		const std::wstring name_;
-		std::unordered_map<std::wstring, File> files_;
+		std::vector<File> files_;
+		std::unordered_map<std::wstring, uint32_t> fileIndexes_;
+		bool hasPendingLines_ = false;
+
+		// RVAs of the lines without breakpoint and their {file index, line}.
+		std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, unsigned int>>> inferredLines_;
+		// RVA of the closest dominator of an address.
+		std::unordered_map<uint32_t, uint32_t> dominators_;
+		// RVAs executed in unloaded modules.
+		std::unordered_set<uint32_t> executedRvas_;
+	};
+
+	//-------------------------------------------------------------------------
+	// Addresses of a module loaded in a process, stored as 32 bits RVAs.
+	// rvas_ is kept sorted (lines_ is in the same order) so lookups are a
+	// binary search in a contiguous array. Addresses registered after the
+	// module addresses are sealed are buffered in pendingRvas_ (with
+	// pendingIndexes_ to detect duplicated RVAs) and merged into rvas_ when
+	// the module addresses are sealed again before the next lookup.
+	struct ExecutedAddressManager::ModuleAddresses
+	{
+		ModuleAddresses(
+			HANDLE hProcess,
+			void* baseOfImage,
+			Module& module,
+			ProcessAddresses& processAddresses)
+			: hProcess_{ hProcess }
+			, baseOfImage_{ baseOfImage }
+			, module_{ module }
+			, processAddresses_{ processAddresses }
+			, isSealed_{ true }
+			, armedLineCount_{ 0 }
+		{
+		}
+
+		//---------------------------------------------------------------------
+		DWORD64 GetBaseOfImage() const
+		{
+			return reinterpret_cast<DWORD64>(baseOfImage_);
+		}
+
+		//---------------------------------------------------------------------
+		std::optional<uint32_t> ToRva(const Address& address) const
+		{
+			auto value = reinterpret_cast<DWORD64>(address.GetValue());
+			auto baseOfImage = GetBaseOfImage();
+
+			if (value < baseOfImage ||
+				value - baseOfImage > std::numeric_limits<uint32_t>::max())
+			{
+				return std::nullopt;
+			}
+			return static_cast<uint32_t>(value - baseOfImage);
+		}
+
+		//---------------------------------------------------------------------
+		std::optional<size_t> FindSorted(uint32_t rva) const
+		{
+			auto it = std::lower_bound(rvas_.begin(), rvas_.end(), rva);
+
+			if (it == rvas_.end() || *it != rva)
+				return std::nullopt;
+			return static_cast<size_t>(it - rvas_.begin());
+		}
+
+		//---------------------------------------------------------------------
+		size_t GetAddressCount() const
+		{
+			return rvas_.size() + pendingRvas_.size();
+		}
+
+		//---------------------------------------------------------------------
+		// Add fileLine (with a line number) to the line of rva and return
+		// true if the line was added.
+		bool Emplace(uint32_t rva, unsigned char instruction, Line::FileLine fileLine)
+		{
+			isSealed_ = false;
+			if (auto index = FindSorted(rva))
+			{
+				pendingFileLines_.emplace_back(*index, fileLine);
+				return false;
+			}
+
+			auto result = pendingIndexes_.emplace(rva, pendingRvas_.size());
+			if (!result.second)
+			{
+				pendingLines_[result.first->second].fileLines_.push_back(fileLine);
+				return false;
+			}
+
+			pendingRvas_.push_back(rva);
+			pendingLines_.emplace_back(instruction);
+			pendingLines_.back().fileLines_.push_back(fileLine);
+			++armedLineCount_;
+			return true;
+		}
+
+		//---------------------------------------------------------------------
+		// Files of module_ must not have pending lines.
+		void Seal()
+		{
+			if (isSealed_)
+				return;
+
+			auto toLineIndex = [&](Line::FileLine& fileLine)
+			{
+				const auto& file = module_.files_.at(fileLine.fileIndex_);
+				fileLine.lineIndex_ = file.GetLineIndex(fileLine.lineIndex_);
+			};
+
+			// Indexes of pendingFileLines_ refer to rvas_ before the merge.
+			for (auto& pair : pendingFileLines_)
+			{
+				toLineIndex(pair.second);
+				lines_[pair.first].fileLines_.push_back(pair.second);
+			}
+			std::vector<std::pair<size_t, Line::FileLine>>{}.swap(pendingFileLines_);
+
+			if (!pendingRvas_.empty())
+			{
+				std::vector<size_t> order(pendingRvas_.size());
+				std::iota(order.begin(), order.end(), 0);
+				std::sort(order.begin(), order.end(), [&](size_t i, size_t j)
+				{
+					return pendingRvas_[i] < pendingRvas_[j];
+				});
+
+				std::vector<uint32_t> rvas;
+				std::vector<Line> lines;
+				rvas.reserve(rvas_.size() + order.size());
+				lines.reserve(rvas_.size() + order.size());
+				size_t sortedIndex = 0;
+				for (auto index : order)
+				{
+					for (; sortedIndex < rvas_.size() && rvas_[sortedIndex] < pendingRvas_[index]; ++sortedIndex)
+					{
+						rvas.push_back(rvas_[sortedIndex]);
+						lines.push_back(std::move(lines_[sortedIndex]));
+					}
+					for (auto& fileLine : pendingLines_[index].fileLines_)
+						toLineIndex(fileLine);
+					rvas.push_back(pendingRvas_[index]);
+					lines.push_back(std::move(pendingLines_[index]));
+				}
+				for (; sortedIndex < rvas_.size(); ++sortedIndex)
+				{
+					rvas.push_back(rvas_[sortedIndex]);
+					lines.push_back(std::move(lines_[sortedIndex]));
+				}
+				rvas_ = std::move(rvas);
+				lines_ = std::move(lines);
+				std::vector<uint32_t>{}.swap(pendingRvas_);
+				std::vector<Line>{}.swap(pendingLines_);
+				std::unordered_map<uint32_t, size_t>{}.swap(pendingIndexes_);
+			}
+			isSealed_ = true;
+		}
+
+		//---------------------------------------------------------------------
+		void UpdateLineIndexes(uint32_t fileIndex, const std::vector<uint32_t>& newIndexes)
+		{
+			for (auto& line : lines_)
+			{
+				for (auto& fileLine : line.fileLines_)
+				{
+					if (fileLine.fileIndex_ == fileIndex)
+						fileLine.lineIndex_ = newIndexes.at(fileLine.lineIndex_);
+				}
+			}
+		}
+
+		//---------------------------------------------------------------------
+		// Executed addresses are required to infer the dominators after the
+		// module is unloaded.
+		void SaveExecutedRvas()
+		{
+			if (module_.dominators_.empty())
+				return;
+			for (size_t i = 0; i < lines_.size(); ++i)
+			{
+				if (!lines_[i].isArmed_)
+					module_.executedRvas_.insert(rvas_[i]);
+			}
+		}
+
+		//---------------------------------------------------------------------
+		Line* Find(const Address& address)
+		{
+			auto rva = ToRva(address);
+			if (!rva)
+				return nullptr;
+
+			auto index = FindSorted(*rva);
+			return index ? &lines_[*index] : nullptr;
+		}
+
+		const HANDLE hProcess_;
+		void* const baseOfImage_;
+		Module& module_;
+		ProcessAddresses& processAddresses_;
+		// Line indexes are stored in the file lines of lines_ and line
+		// numbers in the ones of pendingLines_ and pendingFileLines_.
+		std::vector<uint32_t> rvas_;
+		std::vector<Line> lines_;
+		std::vector<uint32_t> pendingRvas_;
+		std::vector<Line> pendingLines_;
+		std::unordered_map<uint32_t, size_t> pendingIndexes_;
+		// File lines of addresses in rvas_ registered after sealing.
+		std::vector<std::pair<size_t, Line::FileLine>> pendingFileLines_;
+		bool isSealed_;
+		size_t armedLineCount_;
+	};
+
+	//-------------------------------------------------------------------------
+	// [begin_, end_) is the range of registered addresses of moduleAddresses_.
+	struct ExecutedAddressManager::ModuleRange
+	{
+		DWORD64 begin_;
+		DWORD64 end_;
+		ModuleAddresses* moduleAddresses_;
+	};
+
+	//-------------------------------------------------------------------------
+	// Addresses of a process partitioned by module base so unloading a module
+	// or exiting a process only touches its own addresses.
+	struct ExecutedAddressManager::ProcessAddresses
+	{
+		std::map<DWORD64, std::unique_ptr<ModuleAddresses>> moduleAddressesByBase_;
+		std::vector<ModuleRange> moduleRanges_;
+		bool areModuleRangesValid_ = true;
+		size_t armedBreakPointCount_ = 0;
 	};
 	
 	//-------------------------------------------------------------------------
 	ExecutedAddressManager::ExecutedAddressManager()
+		: lastModuleAddresses_{ nullptr }
 	{
 		lastModule_.baseOfImage_ = nullptr;
 		lastModule_.module_ = nullptr;
@@ -84,6 +395,7 @@ namespace CppCoverage
 			it = modules_.emplace(moduleName, Module{ moduleName }).first;
 		lastModule_.module_ = &it->second;
 		lastModule_.baseOfImage_ = dllBaseOfImage;
+		lastModuleAddresses_ = nullptr;
 	}
 	
 	//-------------------------------------------------------------------------
@@ -94,26 +406,67 @@ namespace CppCoverage
 		unsigned char instructionValue)
 	{
 		auto& module = GetLastAddedModule();
-		auto& file = module.files_[filename];
+		auto fileIndex = module.GetFileIndex(filename);
+		auto& moduleAddresses = GetLastAddedModuleAddresses(address.GetProcessHandle());
 
 		LOG_TRACE << "RegisterAddress: " << address << " for " << filename << ":" << lineNumber;
 
+		auto rva = moduleAddresses.ToRva(address);
+		if (!rva)
+			THROW("Address is outside of the module: " << address);
+
 		// Different {filename, line} can have the same address.
 		// Same {filename, line} can have several addresses.		
-		bool keepBreakpoint = false;
-		auto itAddress = addressLineMap_.find(address);
+		auto isAdded = moduleAddresses.Emplace(*rva, instructionValue, { fileIndex, lineNumber });
 
-		if (itAddress == addressLineMap_.end())
-		{
-			itAddress = addressLineMap_.emplace(address, 
-				Line{ instructionValue, lastModule_.baseOfImage_ }).first;
-			keepBreakpoint = true;
-		}
-		
-		auto& line = itAddress->second;
-		line.hasBeenExecutedCollection_.push_back(&file.lines[lineNumber]);
+		module.files_[fileIndex].pendingLineNumbers_.push_back(lineNumber);
+		module.hasPendingLines_ = true;
+		moduleAddresses.processAddresses_.areModuleRangesValid_ = false;
+		if (isAdded)
+			++moduleAddresses.processAddresses_.armedBreakPointCount_;
 		
-		return keepBreakpoint;
+		return isAdded;
+	}
+
+	//-------------------------------------------------------------------------
+	void ExecutedAddressManager::RegisterInferredAddress(
+		const Address& address,
+		const std::wstring& filename,
+		unsigned int lineNumber)
+	{
+		auto& module = GetLastAddedModule();
+		auto fileIndex = module.GetFileIndex(filename);
+		auto& moduleAddresses = GetLastAddedModuleAddresses(address.GetProcessHandle());
+
+		LOG_TRACE << "RegisterInferredAddress: " << address << " for " << filename << ":" << lineNumber;
+
+		auto rva = moduleAddresses.ToRva(address);
+		if (!rva)
+			THROW("Address is outside of the module: " << address);
+
+		// The lines are the same each time the module is loaded.
+		auto& fileLines = module.inferredLines_[*rva];
+		std::pair<uint32_t, unsigned int> fileLine{ fileIndex, lineNumber };
+		if (std::find(fileLines.begin(), fileLines.end(), fileLine) != fileLines.end())
+			return;
+		fileLines.push_back(fileLine);
+		module.files_[fileIndex].pendingLineNumbers_.push_back(lineNumber);
+		module.hasPendingLines_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	void ExecutedAddressManager::RegisterDominator(
+		const Address& address,
+		const Address& dominator)
+	{
+		auto& module = GetLastAddedModule();
+		auto& moduleAddresses = GetLastAddedModuleAddresses(address.GetProcessHandle());
+		auto rva = moduleAddresses.ToRva(address);
+		auto dominatorRva = moduleAddresses.ToRva(dominator);
+
+		if (!rva || !dominatorRva)
+			THROW("Address is outside of the module: " << address << ", " << dominator);
+		module.dominators_[*rva] = *dominatorRva;
 	}
 
 	//-------------------------------------------------------------------------
@@ -125,30 +478,188 @@ namespace CppCoverage
 		return *lastModule_.module_;
 	}
 
+	//-------------------------------------------------------------------------
+	ExecutedAddressManager::ModuleAddresses&
+	ExecutedAddressManager::GetLastAddedModuleAddresses(HANDLE hProcess)
+	{
+		if (lastModuleAddresses_ && lastModuleAddresses_->hProcess_ == hProcess)
+			return *lastModuleAddresses_;
+
+		auto& processAddresses = processAddressesCollection_[hProcess];
+		auto baseOfImage = reinterpret_cast<DWORD64>(lastModule_.baseOfImage_);
+		auto& moduleAddresses = processAddresses.moduleAddressesByBase_[baseOfImage];
+
+		if (!moduleAddresses)
+		{
+			moduleAddresses = std::make_unique<ModuleAddresses>(
+				hProcess, lastModule_.baseOfImage_, GetLastAddedModule(), processAddresses);
+		}
+		lastModuleAddresses_ = moduleAddresses.get();
+		return *lastModuleAddresses_;
+	}
+
+	//-------------------------------------------------------------------------
+	void ExecutedAddressManager::SealModuleAddresses(ModuleAddresses& moduleAddresses)
+	{
+		if (moduleAddresses.isSealed_)
+			return;
+
+		auto& module = moduleAddresses.module_;
+		if (module.hasPendingLines_)
+		{
+			for (uint32_t fileIndex = 0; fileIndex < module.files_.size(); ++fileIndex)
+			{
+				auto newIndexes = module.files_[fileIndex].MergePendingLines();
+
+				if (newIndexes.empty())
+					continue;
+				for (const auto& processAddresses : processAddressesCollection_)
+				{
+					for (const auto& pair : processAddresses.second.moduleAddressesByBase_)
+					{
+						auto& other = *pair.second;
+						if (&other.module_ == &module)
+							other.UpdateLineIndexes(fileIndex, newIndexes);
+					}
+				}
+			}
+			module.hasPendingLines_ = false;
+		}
+		moduleAddresses.Seal();
+	}
+
+	//-------------------------------------------------------------------------
+	void ExecutedAddressManager::UpdateModuleRanges(ProcessAddresses& processAddresses)
+	{
+		auto& moduleRanges = processAddresses.moduleRanges_;
+
+		moduleRanges.clear();
+		for (const auto& pair : processAddresses.moduleAddressesByBase_)
+		{
+			auto& moduleAddresses = *pair.second;
+			SealModuleAddresses(moduleAddresses);
+
+			const auto& rvas = moduleAddresses.rvas_;
+			if (!rvas.empty())
+			{
+				auto baseOfImage = moduleAddresses.GetBaseOfImage();
+				moduleRanges.push_back({ baseOfImage + rvas.front(),
+				                         baseOfImage + rvas.back() + 1,
+				                         &moduleAddresses });
+			}
+		}
+		// moduleAddressesByBase_ is sorted by base so moduleRanges is sorted.
+		processAddresses.areModuleRangesValid_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	ExecutedAddressManager::ModuleAddresses*
+	ExecutedAddressManager::FindModuleAddresses(const Address& address)
+	{
+		auto itProcess = processAddressesCollection_.find(address.GetProcessHandle());
+		if (itProcess == processAddressesCollection_.end())
+			return nullptr;
+
+		auto& processAddresses = itProcess->second;
+		if (!processAddresses.areModuleRangesValid_)
+			UpdateModuleRanges(processAddresses);
+
+		const auto& moduleRanges = processAddresses.moduleRanges_;
+		auto value = reinterpret_cast<DWORD64>(address.GetValue());
+		auto it = std::upper_bound(moduleRanges.begin(), moduleRanges.end(), value,
+			[](DWORD64 value, const ModuleRange& range)
+		{
+			return value < range.begin_;
+		});
+
+		if (it == moduleRanges.begin())
+			return nullptr;
+		--it;
+		if (value >= it->end_)
+			return nullptr;
+		return it->moduleAddresses_;
+	}
+
 	//-------------------------------------------------------------------------
 	std::optional<unsigned char> ExecutedAddressManager::MarkAddressAsExecuted(
 		const Address& address)
 	{
-		auto it = addressLineMap_.find(address);
+		auto* moduleAddresses = FindModuleAddresses(address);
+		auto* line = moduleAddresses ? moduleAddresses->Find(address) : nullptr;
 
-		if (it == addressLineMap_.end())
+		if (!line)
 			return std::nullopt;
 
-		auto& line = it->second;
+		auto& files = moduleAddresses->module_.files_;
+		for (const auto& fileLine : line->fileLines_)
+			files[fileLine.fileIndex_].executedLines_[fileLine.lineIndex_] = true;
 
-		for (bool* hasBeenExecuted : line.hasBeenExecutedCollection_)
+		if (line->isArmed_)
 		{
-			if (!hasBeenExecuted)
-				THROW("Invalid pointer");
-			*hasBeenExecuted = true;
+			line->isArmed_ = false;
+			--moduleAddresses->armedLineCount_;
+			--moduleAddresses->processAddresses_.armedBreakPointCount_;
 		}
-		return line.instructionToRestore_;
+		return line->instructionToRestore_;
 	}
-	
+
+	//-------------------------------------------------------------------------
+	size_t ExecutedAddressManager::GetArmedBreakPointCount(HANDLE hProcess) const
+	{
+		auto it = processAddressesCollection_.find(hProcess);
+
+		return (it != processAddressesCollection_.end()) ? it->second.armedBreakPointCount_ : 0;
+	}
+
+	//-------------------------------------------------------------------------
+	// A line without breakpoint is executed if it dominates an executed address.
+	std::set<std::pair<uint32_t, unsigned int>>
+	ExecutedAddressManager::InferExecutedLines(const Module& module) const
+	{
+		std::set<std::pair<uint32_t, unsigned int>> executedLines;
+
+		if (module.dominators_.empty())
+			return executedLines;
+
+		std::vector<uint32_t> executedRvas{ module.executedRvas_.begin(), module.executedRvas_.end() };
+		for (const auto& processAddresses : processAddressesCollection_)
+		{
+			for (const auto& pair : processAddresses.second.moduleAddressesByBase_)
+			{
+				const auto& moduleAddresses = *pair.second;
+				if (&moduleAddresses.module_ != &module)
+					continue;
+				for (size_t i = 0; i < moduleAddresses.lines_.size(); ++i)
+				{
+					if (!moduleAddresses.lines_[i].isArmed_)
+						executedRvas.push_back(moduleAddresses.rvas_[i]);
+				}
+			}
+		}
+
+		std::unordered_set<uint32_t> visitedRvas;
+		for (auto rva : executedRvas)
+		{
+			while (visitedRvas.insert(rva).second)
+			{
+				auto itLines = module.inferredLines_.find(rva);
+				if (itLines != module.inferredLines_.end())
+					executedLines.insert(itLines->second.begin(), itLines->second.end());
+
+				auto itDominator = module.dominators_.find(rva);
+				if (itDominator == module.dominators_.end())
+					break;
+				rva = itDominator->second;
+			}
+		}
+		return executedLines;
+	}
+
 	//-------------------------------------------------------------------------
 	Plugin::CoverageData ExecutedAddressManager::CreateCoverageData(
 		const std::wstring& name,
-		int exitCode) const
+		int exitCode,
+		bool isFunctionGranularity) const
 	{
 		Plugin::CoverageData coverageData{ name, exitCode };
 
@@ -156,58 +667,89 @@ namespace CppCoverage
 		{
 			const auto& module = pair.second;
 			auto& moduleCoverage = coverageData.AddModule(module.name_);
+			auto inferredLines = InferExecutedLines(module);
 
-			for (const auto& file : module.files_)
+			for (uint32_t fileIndex = 0; fileIndex < module.files_.size(); ++fileIndex)
 			{
-				const std::wstring& name = file.first;
-				const File& fileData = file.second;
+				const auto& file = module.files_[fileIndex];
+				auto& fileCoverage = moduleCoverage.AddFile(file.path_);
+				fileCoverage.SetFunctionGranularity(isFunctionGranularity);
+				const auto& lineNumbers = file.lineNumbers_;
 
-				auto& fileCoverage = moduleCoverage.AddFile(name);
+				// Lines not sealed yet have not been executed.
+				auto pendingLineNumbers = file.pendingLineNumbers_;
+				std::sort(pendingLineNumbers.begin(), pendingLineNumbers.end());
+				pendingLineNumbers.erase(
+					std::unique(pendingLineNumbers.begin(), pendingLineNumbers.end()),
+					pendingLineNumbers.end());
 
-				for (const auto& pair : fileData.lines)
+				size_t i = 0;
+				auto itPending = pendingLineNumbers.begin();
+				while (i < lineNumbers.size() || itPending != pendingLineNumbers.end())
 				{
-					auto lineNumber = pair.first;
-					bool hasLineBeenExecuted = pair.second;
-					
-					fileCoverage.AddLine(lineNumber, hasLineBeenExecuted);
+					if (itPending == pendingLineNumbers.end() ||
+						(i < lineNumbers.size() && lineNumbers[i] <= *itPending))
+					{
+						if (itPending != pendingLineNumbers.end() && lineNumbers[i] == *itPending)
+							++itPending;
+						fileCoverage.AddLine(lineNumbers[i],
+							file.executedLines_[i] || inferredLines.count({ fileIndex, lineNumbers[i] }));
+						++i;
+					}
+					else
+					{
+						auto lineNumber = *itPending++;
+						fileCoverage.AddLine(lineNumber, inferredLines.count({ fileIndex, lineNumber }) != 0);
+					}
 				}
-			}			
+			}
 		}
 
 		return coverageData;
 	}
 
 	//-------------------------------------------------------------------------
-	template <typename Condition>
-	void ExecutedAddressManager::RemoveAddressLineIf(Condition condition)
+	size_t ExecutedAddressManager::OnExitProcess(HANDLE hProcess)
 	{
-		auto it = addressLineMap_.begin();
+		auto it = processAddressesCollection_.find(hProcess);
+		if (it == processAddressesCollection_.end())
+			return 0;
 
-		while (it != addressLineMap_.end())
+		size_t removedAddressCount = 0;
+		for (const auto& pair : it->second.moduleAddressesByBase_)
 		{
-			if (condition(*it))
-				it = addressLineMap_.erase(it);
-			else
-				++it;
+			removedAddressCount += pair.second->GetAddressCount();
+			pair.second->SaveExecutedRvas();
 		}
-	}
 
-	//-------------------------------------------------------------------------
-	void ExecutedAddressManager::OnExitProcess(HANDLE hProcess)
-	{
-		RemoveAddressLineIf([=](const auto& pair)
-		{
-			return pair.first.GetProcessHandle() == hProcess;
-		});
+		if (lastModuleAddresses_ && lastModuleAddresses_->hProcess_ == hProcess)
+			lastModuleAddresses_ = nullptr;
+		processAddressesCollection_.erase(it);
+
+		return removedAddressCount;
 	}
 
 	//-------------------------------------------------------------------------
-	void ExecutedAddressManager::OnUnloadModule(HANDLE hProcess, void* dllBaseOfImage)
+	size_t ExecutedAddressManager::OnUnloadModule(HANDLE hProcess, void* dllBaseOfImage)
 	{
-		RemoveAddressLineIf([=](const auto& pair)
-		{
-			return pair.first.GetProcessHandle() == hProcess
-				&& pair.second.dllBaseOfImage_ == dllBaseOfImage;
-		});
+		auto itProcess = processAddressesCollection_.find(hProcess);
+		if (itProcess == processAddressesCollection_.end())
+			return 0;
+
+		auto& processAddresses = itProcess->second;
+		auto& moduleAddressesByBase = processAddresses.moduleAddressesByBase_;
+		auto it = moduleAddressesByBase.find(reinterpret_cast<DWORD64>(dllBaseOfImage));
+		if (it == moduleAddressesByBase.end())
+			return 0;
+
+		auto removedAddressCount = it->second->GetAddressCount();
+		it->second->SaveExecutedRvas();
+		processAddresses.armedBreakPointCount_ -= it->second->armedLineCount_;
+		if (lastModuleAddresses_ == it->second.get())
+			lastModuleAddresses_ = nullptr;
+		moduleAddressesByBase.erase(it);
+		processAddresses.areModuleRangesValid_ = false;
+
+		return removedAddressCount;
 	}
 }
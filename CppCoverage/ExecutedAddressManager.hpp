@@ -20,7 +20,10 @@
 
 #include <Windows.h>
 #include <map>
+#include <unordered_map>
 #include <set>
+#include <memory>
+#include <vector>
 #include <optional>
 
 #include "Plugin/Exporter/CoverageData.hpp"
@@ -38,7 +41,9 @@ namespace CppCoverage
 		~ExecutedAddressManager();
 
 		void AddModule(const std::wstring& moduleName, void* dllBaseOfImage);
-		void OnUnloadModule(HANDLE hProcess, void* dllBaseOfImage);
+
+		// Return the number of addresses removed.
+		size_t OnUnloadModule(HANDLE hProcess, void* dllBaseOfImage);
 
 		bool RegisterAddress(
 			const Address&,
@@ -46,16 +51,34 @@ namespace CppCoverage
 			unsigned int line,
 			unsigned char instruction);
 
+		// The line has no breakpoint. It is executed if an address it
+		// dominates is executed, see RegisterDominator.
+		void RegisterInferredAddress(
+			const Address&,
+			const std::wstring& filename,
+			unsigned int line);
+
+		// dominator is always executed before address.
+		void RegisterDominator(const Address& address, const Address& dominator);
+
 		std::optional<unsigned char> MarkAddressAsExecuted(const Address&);
 
-		Plugin::CoverageData CreateCoverageData(const std::wstring& name, int exitCode) const;
-		void OnExitProcess(HANDLE hProcess);
+		// Number of breakpoints of the process not executed yet.
+		size_t GetArmedBreakPointCount(HANDLE hProcess) const;
+
+		Plugin::CoverageData CreateCoverageData(
+			const std::wstring& name,
+			int exitCode,
+			bool isFunctionGranularity) const;
+		size_t OnExitProcess(HANDLE hProcess);
 
 	private:
 		struct Module;
 		struct File;
-		struct File;
 		struct Line;
+		struct ModuleAddresses;
+		struct ModuleRange;
+		struct ProcessAddresses;
 		struct LastModule
 		{
 			Module* module_;
@@ -66,11 +89,15 @@ namespace CppCoverage
 		ExecutedAddressManager& operator=(const ExecutedAddressManager&) = delete;
 
 		Module& GetLastAddedModule();
-		template <typename F>
-		void RemoveAddressLineIf(F fct);
+		ModuleAddresses& GetLastAddedModuleAddresses(HANDLE hProcess);
+		ModuleAddresses* FindModuleAddresses(const Address&);
+		void SealModuleAddresses(ModuleAddresses&);
+		void UpdateModuleRanges(ProcessAddresses&);
+		std::set<std::pair<uint32_t, unsigned int>> InferExecutedLines(const Module&) const;
 
 		std::map<std::wstring, Module> modules_;
-		std::map<Address, Line> addressLineMap_;
+		std::unordered_map<HANDLE, ProcessAddresses> processAddressesCollection_;
 		LastModule lastModule_;
+		ModuleAddresses* lastModuleAddresses_;
 	};
 }
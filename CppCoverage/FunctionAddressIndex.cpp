@@ -0,0 +1,110 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "FunctionAddressIndex.hpp"
+
+#include <algorithm>
+
+#include "CppCoverageException.hpp"
+
+namespace CppCoverage
+{
+	//-------------------------------------------------------------------------
+	FunctionAddressIndex::FunctionAddressIndex() : isSealed_{false}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	void FunctionAddressIndex::Add(uint64_t virtualAddress,
+	                               uint64_t length,
+	                               unsigned long symbolIndex)
+	{
+		if (isSealed_)
+			THROW("Cannot add a function to a sealed index.");
+		if (length != 0)
+			functions_.push_back({virtualAddress, virtualAddress + length, symbolIndex});
+	}
+
+	//-------------------------------------------------------------------------
+	void FunctionAddressIndex::Seal()
+	{
+		// Folded functions share the same address: keep the smallest
+		// symbol index so the result does not depend on DIA order.
+		std::sort(functions_.begin(),
+		          functions_.end(),
+		          [](const Function& function1, const Function& function2) {
+			          if (function1.begin_ != function2.begin_)
+				          return function1.begin_ < function2.begin_;
+			          return function1.symbolIndex_ < function2.symbolIndex_;
+		          });
+		functions_.erase(
+		    std::unique(functions_.begin(),
+		                functions_.end(),
+		                [](const Function& function1, const Function& function2) {
+			                return function1.begin_ == function2.begin_;
+		                }),
+		    functions_.end());
+		functions_.shrink_to_fit();
+		isSealed_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	boost::optional<unsigned long>
+	FunctionAddressIndex::Find(uint64_t virtualAddress) const
+	{
+		if (!isSealed_)
+			THROW("Cannot find a function in an index not sealed.");
+
+		auto it = std::upper_bound(
+		    functions_.begin(),
+		    functions_.end(),
+		    virtualAddress,
+		    [](uint64_t address, const Function& function) {
+			    return address < function.begin_;
+		    });
+
+		if (it == functions_.begin())
+			return boost::none;
+		--it;
+		if (virtualAddress >= it->end_)
+			return boost::none;
+		return it->symbolIndex_;
+	}
+
+	//-------------------------------------------------------------------------
+	bool FunctionAddressIndex::IsFunctionStart(uint64_t virtualAddress) const
+	{
+		if (!isSealed_)
+			THROW("Cannot find a function in an index not sealed.");
+
+		auto it = std::lower_bound(
+		    functions_.begin(),
+		    functions_.end(),
+		    virtualAddress,
+		    [](const Function& function, uint64_t address) {
+			    return function.begin_ < address;
+		    });
+
+		return it != functions_.end() && it->begin_ == virtualAddress;
+	}
+
+	//-------------------------------------------------------------------------
+	size_t FunctionAddressIndex::GetSize() const
+	{
+		return functions_.size();
+	}
+}
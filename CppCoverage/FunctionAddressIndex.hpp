@@ -0,0 +1,55 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	// Sorted address ranges of the functions of a module used to find the
+	// symbol index of a line without querying DIA for each line.
+	class CPPCOVERAGE_DLL FunctionAddressIndex
+	{
+	  public:
+		FunctionAddressIndex();
+
+		void Add(uint64_t virtualAddress,
+		         uint64_t length,
+		         unsigned long symbolIndex);
+		void Seal();
+
+		boost::optional<unsigned long> Find(uint64_t virtualAddress) const;
+		bool IsFunctionStart(uint64_t virtualAddress) const;
+		size_t GetSize() const;
+
+	  private:
+		struct Function
+		{
+			uint64_t begin_;
+			uint64_t end_;
+			unsigned long symbolIndex_;
+		};
+
+		std::vector<Function> functions_;
+		bool isSealed_;
+	};
+}
@@ -44,4 +44,10 @@ namespace CppCoverage
 	{ 
 		return IDebugEventsHandler::ExceptionType::NotHandled;
 	}
+
+	//-------------------------------------------------------------------------
+	bool IDebugEventsHandler::ShouldDetach(HANDLE hProcess)
+	{
+		return false;
+	}
 }
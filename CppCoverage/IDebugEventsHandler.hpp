@@ -28,6 +28,8 @@ namespace CppCoverage
 		enum class ExceptionType
 		{
 			BreakPoint,
+			// Access to a page guarded by the debugger.
+			GuardPage,
 			InvalidBreakPoint,
 			NotHandled,
 			Error,
@@ -42,6 +44,10 @@ namespace CppCoverage
 		virtual void OnLoadDll(HANDLE hProcess, HANDLE hThread, const LOAD_DLL_DEBUG_INFO&);
 		virtual void OnUnloadDll(HANDLE hProcess, HANDLE hThread, const UNLOAD_DLL_DEBUG_INFO&);
 		virtual ExceptionType OnException(HANDLE hProcess, HANDLE hThread, const EXCEPTION_DEBUG_INFO&);
+
+		// Called when hProcess is the only debugged process. Return true
+		// to detach from it and let it run without debug events.
+		virtual bool ShouldDetach(HANDLE hProcess);
 		
 	private:
 		IDebugEventsHandler(const IDebugEventsHandler&) = delete;
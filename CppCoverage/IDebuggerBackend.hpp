@@ -0,0 +1,59 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Windows.h>
+
+#include <memory>
+#include <string>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	class StartInfo;
+
+	// Operating system side of the Debugger loop: it starts the debuggee
+	// and reports its activity as DEBUG_EVENT.
+	class CPPCOVERAGE_DLL IDebuggerBackend
+	{
+	public:
+		IDebuggerBackend() = default;
+		virtual ~IDebuggerBackend() = default;
+
+		virtual void Start(const StartInfo&, bool coverChildren) = 0;
+		// Return false if no debug event occurs before the timeout.
+		virtual bool WaitForDebugEvent(DEBUG_EVENT&, DWORD milliseconds) = 0;
+		virtual void ContinueDebugEvent(const DEBUG_EVENT&, DWORD continueStatus) = 0;
+
+		// Stop debugging the process. Return false if it is not possible.
+		virtual bool Detach(DWORD processId) = 0;
+		// Wait for the exit of a detached process.
+		virtual DWORD WaitForExitCode(HANDLE hProcess) = 0;
+
+		// hFile comes from a CREATE_PROCESS or LOAD_DLL event and is
+		// closed by CloseFile.
+		virtual std::wstring GetModulePath(HANDLE hFile, void* baseOfImage) = 0;
+		virtual void CloseFile(HANDLE hFile) = 0;
+
+	private:
+		IDebuggerBackend(const IDebuggerBackend&) = delete;
+		IDebuggerBackend& operator=(const IDebuggerBackend&) = delete;
+	};
+
+	CPPCOVERAGE_DLL std::unique_ptr<IDebuggerBackend> CreateDebuggerBackend();
+}
@@ -0,0 +1,45 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	// Memory operations used by LazyBreakPoints to arm the breakpoints of a
+	// page on its first access.
+	class CPPCOVERAGE_DLL IPageMemory
+	{
+	  public:
+		virtual ~IPageMemory() = default;
+
+		// Make the next access to the page raise
+		// STATUS_GUARD_PAGE_VIOLATION. Return false if the protection
+		// cannot be changed.
+		virtual bool GuardPage(HANDLE hProcess, DWORD64 pageAddress) = 0;
+
+		// Restore the protection the page had before GuardPage.
+		virtual void UnguardPage(HANDLE hProcess, DWORD64 pageAddress) = 0;
+
+		virtual void WriteBreakPoints(HANDLE hProcess,
+		                              std::vector<DWORD64>&& addresses) = 0;
+	};
+}
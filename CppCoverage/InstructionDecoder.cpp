@@ -0,0 +1,527 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "InstructionDecoder.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		const size_t MaxInstructionLength = 15;
+
+		//---------------------------------------------------------------------
+		enum class Immediate
+		{
+			None,
+			Byte,
+			Word,
+			DoubleWord,
+			WordOrDoubleWord,
+			Full,
+			Enter,
+			FarPointer,
+			MemoryOffset
+		};
+
+		//---------------------------------------------------------------------
+		struct Operands
+		{
+			bool hasModRm_;
+			Immediate immediate_;
+		};
+
+		//---------------------------------------------------------------------
+		class Cursor
+		{
+		  public:
+			//-----------------------------------------------------------------
+			Cursor(const std::vector<unsigned char>& code, size_t offset)
+			    : code_{code}, begin_{offset}, position_{offset}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			boost::optional<unsigned char> Peek() const
+			{
+				if (position_ >= code_.size())
+					return boost::none;
+				return code_[position_];
+			}
+
+			//-----------------------------------------------------------------
+			boost::optional<unsigned char> Next()
+			{
+				auto value = Peek();
+				if (value && Skip(1))
+					return value;
+				return boost::none;
+			}
+
+			//-----------------------------------------------------------------
+			bool Skip(size_t size)
+			{
+				if (position_ + size > code_.size() ||
+				    position_ + size - begin_ > MaxInstructionLength)
+				{
+					return false;
+				}
+				position_ += size;
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			boost::optional<int64_t> ReadSigned(size_t size)
+			{
+				auto position = position_;
+				if (!Skip(size))
+					return boost::none;
+
+				uint64_t value = 0;
+				for (size_t i = 0; i < size; ++i)
+					value |= static_cast<uint64_t>(code_[position + i]) << (8 * i);
+
+				auto signBit = uint64_t{1} << (8 * size - 1);
+				if (size < sizeof(value) && (value & signBit))
+					value |= ~((signBit << 1) - 1);
+				return static_cast<int64_t>(value);
+			}
+
+			//-----------------------------------------------------------------
+			size_t GetLength() const
+			{
+				return position_ - begin_;
+			}
+
+		  private:
+			const std::vector<unsigned char>& code_;
+			const size_t begin_;
+			size_t position_;
+		};
+
+		//---------------------------------------------------------------------
+		bool IsLegacyPrefix(unsigned char value)
+		{
+			switch (value)
+			{
+			case 0xF0: case 0xF2: case 0xF3:
+			case 0x26: case 0x2E: case 0x36: case 0x3E: case 0x64: case 0x65:
+			case 0x66: case 0x67:
+				return true;
+			}
+			return false;
+		}
+
+		//---------------------------------------------------------------------
+		bool IsInvalidIn64BitMode(unsigned char opcode)
+		{
+			switch (opcode)
+			{
+			case 0x06: case 0x07: case 0x0E: case 0x16: case 0x17: case 0x1E:
+			case 0x1F: case 0x27: case 0x2F: case 0x37: case 0x3F: case 0x60:
+			case 0x61: case 0x82: case 0x9A: case 0xCE: case 0xD4: case 0xD5:
+			case 0xD6: case 0xEA:
+				return true;
+			}
+			return false;
+		}
+
+		//---------------------------------------------------------------------
+		Operands GetOneByteOperands(unsigned char opcode)
+		{
+			if (opcode < 0x40)
+			{
+				switch (opcode & 7)
+				{
+				case 4: return {false, Immediate::Byte};
+				case 5: return {false, Immediate::WordOrDoubleWord};
+				case 6: case 7: return {false, Immediate::None};
+				default: return {true, Immediate::None};
+				}
+			}
+			if (opcode >= 0xB0 && opcode <= 0xB7)
+				return {false, Immediate::Byte};
+			if (opcode >= 0xB8 && opcode <= 0xBF)
+				return {false, Immediate::Full};
+			if ((opcode >= 0x84 && opcode <= 0x8F) ||
+			    (opcode >= 0xD0 && opcode <= 0xD3) ||
+			    (opcode >= 0xD8 && opcode <= 0xDF))
+			{
+				return {true, Immediate::None};
+			}
+			if ((opcode >= 0x70 && opcode <= 0x7F) ||
+			    (opcode >= 0xE0 && opcode <= 0xE7))
+			{
+				return {false, Immediate::Byte};
+			}
+
+			switch (opcode)
+			{
+			case 0x62: case 0x63: case 0xC4: case 0xC5: case 0xF6: case 0xF7:
+			case 0xFE: case 0xFF:
+				return {true, Immediate::None};
+			case 0x69: case 0x81: case 0xC7:
+				return {true, Immediate::WordOrDoubleWord};
+			case 0x6B: case 0x80: case 0x82: case 0x83: case 0xC0: case 0xC1:
+			case 0xC6:
+				return {true, Immediate::Byte};
+			case 0x6A: case 0xA8: case 0xCD: case 0xD4: case 0xD5: case 0xEB:
+				return {false, Immediate::Byte};
+			case 0x68: case 0xA9: case 0xE8: case 0xE9:
+				return {false, Immediate::WordOrDoubleWord};
+			case 0xC2: case 0xCA:
+				return {false, Immediate::Word};
+			case 0xC8:
+				return {false, Immediate::Enter};
+			case 0x9A: case 0xEA:
+				return {false, Immediate::FarPointer};
+			case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+				return {false, Immediate::MemoryOffset};
+			}
+			return {false, Immediate::None};
+		}
+
+		//---------------------------------------------------------------------
+		boost::optional<Operands> GetTwoByteOperands(unsigned char opcode)
+		{
+			switch (opcode)
+			{
+			case 0x04: case 0x0A: case 0x0C: case 0x24: case 0x25: case 0x26:
+			case 0x27: case 0x36: case 0x39: case 0x3B: case 0x3C: case 0x3D:
+			case 0x3E: case 0x3F: case 0x7A: case 0x7B:
+				return boost::none;
+			case 0x05: case 0x06: case 0x07: case 0x08: case 0x09: case 0x0B:
+			case 0x0E: case 0x30: case 0x31: case 0x32: case 0x33: case 0x34:
+			case 0x35: case 0x37: case 0x77: case 0xA0: case 0xA1: case 0xA2:
+			case 0xA8: case 0xA9: case 0xAA:
+				return Operands{false, Immediate::None};
+			case 0x0F: case 0x70: case 0x71: case 0x72: case 0x73: case 0xA4:
+			case 0xAC: case 0xBA: case 0xC2: case 0xC4: case 0xC5: case 0xC6:
+				return Operands{true, Immediate::Byte};
+			}
+			if (opcode >= 0x80 && opcode <= 0x8F)
+				return Operands{false, Immediate::WordOrDoubleWord};
+			if (opcode >= 0xC8 && opcode <= 0xCF)
+				return Operands{false, Immediate::None};
+			return Operands{true, Immediate::None};
+		}
+
+		//---------------------------------------------------------------------
+		// Operands of the VEX, EVEX and XOP encoded instructions.
+		boost::optional<Operands> GetVectorOperands(unsigned char map,
+		                                            unsigned char opcode)
+		{
+			switch (map)
+			{
+			case 1:
+				switch (opcode)
+				{
+				case 0x70: case 0x71: case 0x72: case 0x73: case 0xC2:
+				case 0xC4: case 0xC5: case 0xC6:
+					return Operands{true, Immediate::Byte};
+				}
+				return Operands{true, Immediate::None};
+			case 2: case 5: case 6:
+				return Operands{true, Immediate::None};
+			case 3: case 8:
+				return Operands{true, Immediate::Byte};
+			case 9:
+				return Operands{true, Immediate::None};
+			case 10:
+				return Operands{true, Immediate::DoubleWord};
+			}
+			return boost::none;
+		}
+
+		//---------------------------------------------------------------------
+		boost::optional<unsigned char> ReadModRm(Cursor& cursor,
+		                                         bool is16BitAddress)
+		{
+			auto modRm = cursor.Next();
+			if (!modRm)
+				return boost::none;
+
+			auto mod = *modRm >> 6;
+			auto rm = *modRm & 7;
+			bool isValid = true;
+
+			if (mod == 3)
+				return modRm;
+			if (is16BitAddress)
+			{
+				if (mod == 0 && rm == 6)
+					isValid = cursor.Skip(2);
+				else
+					isValid = cursor.Skip(mod == 1 ? 1 : mod == 2 ? 2 : 0);
+			}
+			else if (rm == 4)
+			{
+				auto sib = cursor.Next();
+				if (!sib)
+					return boost::none;
+				if (mod == 0 && (*sib & 7) == 5)
+					isValid = cursor.Skip(4);
+				else
+					isValid = cursor.Skip(mod == 1 ? 1 : mod == 2 ? 4 : 0);
+			}
+			else if (mod == 0 && rm == 5)
+				isValid = cursor.Skip(4);
+			else
+				isValid = cursor.Skip(mod == 1 ? 1 : mod == 2 ? 4 : 0);
+
+			if (!isValid)
+				return boost::none;
+			return modRm;
+		}
+
+		//---------------------------------------------------------------------
+		InstructionKind GetOneByteKind(unsigned char opcode, unsigned char modRm)
+		{
+			switch (opcode)
+			{
+			case 0x9A:
+				return InstructionKind::Call;
+			case 0xEA:
+				return InstructionKind::IndirectBranch;
+			case 0xC2: case 0xC3: case 0xCA: case 0xCB: case 0xCF:
+				return InstructionKind::Return;
+			case 0xCC: case 0xCD: case 0xCE: case 0xF1: case 0xF4:
+				return InstructionKind::Trap;
+			case 0xFF:
+				switch ((modRm >> 3) & 7)
+				{
+				case 2: case 3: return InstructionKind::Call;
+				case 4: case 5: return InstructionKind::IndirectBranch;
+				}
+				break;
+			}
+			return InstructionKind::Sequential;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	InstructionDecoder::InstructionDecoder(bool is64Bit) : is64Bit_{is64Bit}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	boost::optional<DecodedInstruction>
+	InstructionDecoder::Decode(const std::vector<unsigned char>& code,
+	                           size_t offset,
+	                           uint64_t codeAddress) const
+	{
+		Cursor cursor{code, offset};
+		bool hasOperandSizePrefix = false;
+		bool hasAddressSizePrefix = false;
+		bool hasRexW = false;
+		boost::optional<unsigned char> opcode;
+
+		for (;;)
+		{
+			opcode = cursor.Next();
+			if (!opcode)
+				return boost::none;
+			if (IsLegacyPrefix(*opcode))
+			{
+				hasOperandSizePrefix |= *opcode == 0x66;
+				hasAddressSizePrefix |= *opcode == 0x67;
+				// REX is ignored when it is not the last prefix.
+				hasRexW = false;
+			}
+			else if (is64Bit_ && (*opcode & 0xF0) == 0x40)
+				hasRexW = (*opcode & 8) != 0;
+			else
+				break;
+		}
+
+		const bool is16BitAddress = !is64Bit_ && hasAddressSizePrefix;
+		const size_t wordOrDoubleWordSize = hasOperandSizePrefix ? 2 : 4;
+		boost::optional<unsigned char> modRm;
+		Operands operands{false, Immediate::None};
+		auto kind = InstructionKind::Sequential;
+		size_t relativeSize = 0;
+
+		// LES, LDS and BOUND cannot have a register operand and POP has
+		// no map selection bits so they are not confused with VEX, EVEX
+		// and XOP.
+		auto nextByte = cursor.Peek();
+		bool isVector =
+		    ((*opcode == 0xC4 || *opcode == 0xC5 || *opcode == 0x62) &&
+		     (is64Bit_ || (nextByte && (*nextByte & 0xC0) == 0xC0))) ||
+		    (*opcode == 0x8F && nextByte && (*nextByte & 0x1F) >= 8);
+		if (isVector)
+		{
+			unsigned char map = 1;
+			if (*opcode != 0xC5)
+			{
+				auto payload = cursor.Next();
+				if (!payload)
+					return boost::none;
+				map = *payload & (*opcode == 0x62 ? 0x07 : 0x1F);
+				if (!cursor.Skip(*opcode == 0x62 ? 2 : 1))
+					return boost::none;
+			}
+			else if (!cursor.Skip(1))
+				return boost::none;
+
+			auto vectorOpcode = cursor.Next();
+			if (!vectorOpcode)
+				return boost::none;
+			auto vectorOperands = GetVectorOperands(map, *vectorOpcode);
+			if (!vectorOperands)
+				return boost::none;
+			operands = *vectorOperands;
+			// VZEROUPPER and VZEROALL have no ModRM.
+			if (*opcode != 0x62 && map == 1 && *vectorOpcode == 0x77)
+				operands.hasModRm_ = false;
+		}
+		else if (*opcode == 0x0F)
+		{
+			auto secondOpcode = cursor.Next();
+			if (!secondOpcode)
+				return boost::none;
+			if (*secondOpcode == 0x38 || *secondOpcode == 0x3A)
+			{
+				if (!cursor.Next())
+					return boost::none;
+				operands = {true, *secondOpcode == 0x3A ? Immediate::Byte
+				                                        : Immediate::None};
+			}
+			else
+			{
+				auto twoByteOperands = GetTwoByteOperands(*secondOpcode);
+				if (!twoByteOperands)
+					return boost::none;
+				operands = *twoByteOperands;
+				// MOV from or to control and debug registers ignores the
+				// ModRM mode.
+				if (*secondOpcode >= 0x20 && *secondOpcode <= 0x23)
+				{
+					if (!cursor.Skip(1))
+						return boost::none;
+					operands.hasModRm_ = false;
+				}
+				else if (*secondOpcode >= 0x80 && *secondOpcode <= 0x8F)
+				{
+					kind = InstructionKind::ConditionalBranch;
+					relativeSize = is64Bit_ ? 4 : wordOrDoubleWordSize;
+				}
+				else if (*secondOpcode == 0x0B || *secondOpcode == 0xB9 ||
+				         *secondOpcode == 0xFF)
+				{
+					kind = InstructionKind::Trap;
+				}
+			}
+		}
+		else
+		{
+			if (is64Bit_ && IsInvalidIn64BitMode(*opcode))
+				return boost::none;
+			operands = GetOneByteOperands(*opcode);
+
+			if ((*opcode >= 0x70 && *opcode <= 0x7F) ||
+			    (*opcode >= 0xE0 && *opcode <= 0xE3))
+			{
+				kind = InstructionKind::ConditionalBranch;
+				relativeSize = 1;
+			}
+			else if (*opcode == 0xEB)
+			{
+				kind = InstructionKind::UnconditionalBranch;
+				relativeSize = 1;
+			}
+			else if (*opcode == 0xE8 || *opcode == 0xE9)
+			{
+				kind = *opcode == 0xE8 ? InstructionKind::Call
+				                       : InstructionKind::UnconditionalBranch;
+				relativeSize = is64Bit_ ? 4 : wordOrDoubleWordSize;
+			}
+		}
+
+		if (operands.hasModRm_)
+		{
+			modRm = ReadModRm(cursor, is16BitAddress);
+			if (!modRm)
+				return boost::none;
+			if (!isVector && *opcode != 0x0F)
+			{
+				auto reg = (*modRm >> 3) & 7;
+				if ((*opcode == 0xF6 || *opcode == 0xF7) && reg <= 1)
+				{
+					operands.immediate_ = *opcode == 0xF6
+					                          ? Immediate::Byte
+					                          : Immediate::WordOrDoubleWord;
+				}
+				kind = GetOneByteKind(*opcode, *modRm);
+				// XBEGIN jumps to its operand when the transaction aborts.
+				if (*opcode == 0xC7 && *modRm == 0xF8)
+				{
+					kind = InstructionKind::ConditionalBranch;
+					relativeSize = wordOrDoubleWordSize;
+				}
+			}
+		}
+		else if (!isVector && *opcode != 0x0F && relativeSize == 0)
+			kind = GetOneByteKind(*opcode, 0);
+
+		// A 16 bits relative branch truncates the instruction pointer.
+		if (relativeSize == 2)
+			return boost::none;
+
+		boost::optional<uint64_t> target;
+		if (relativeSize != 0)
+		{
+			auto displacement = cursor.ReadSigned(relativeSize);
+			if (!displacement)
+				return boost::none;
+			auto nextAddress = codeAddress + offset + cursor.GetLength();
+			target = nextAddress + static_cast<uint64_t>(*displacement);
+			if (!is64Bit_)
+				*target &= 0xFFFFFFFF;
+		}
+		else
+		{
+			size_t immediateSize = 0;
+			switch (operands.immediate_)
+			{
+			case Immediate::None: break;
+			case Immediate::Byte: immediateSize = 1; break;
+			case Immediate::Word: immediateSize = 2; break;
+			case Immediate::DoubleWord: immediateSize = 4; break;
+			case Immediate::WordOrDoubleWord:
+				immediateSize = wordOrDoubleWordSize;
+				break;
+			case Immediate::Full:
+				immediateSize = hasRexW ? 8 : wordOrDoubleWordSize;
+				break;
+			case Immediate::Enter: immediateSize = 3; break;
+			case Immediate::FarPointer:
+				immediateSize = wordOrDoubleWordSize + 2;
+				break;
+			case Immediate::MemoryOffset:
+				if (is64Bit_)
+					immediateSize = hasAddressSizePrefix ? 4 : 8;
+				else
+					immediateSize = hasAddressSizePrefix ? 2 : 4;
+				break;
+			}
+			if (!cursor.Skip(immediateSize))
+				return boost::none;
+		}
+
+		return DecodedInstruction{cursor.GetLength(), kind, target};
+	}
+}
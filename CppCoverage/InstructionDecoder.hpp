@@ -0,0 +1,64 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	enum class InstructionKind
+	{
+		Sequential,
+		ConditionalBranch,
+		UnconditionalBranch,
+		IndirectBranch,
+		Call,
+		Return,
+		Trap
+	};
+
+	struct DecodedInstruction
+	{
+		size_t length_;
+		InstructionKind kind_;
+		boost::optional<uint64_t> target_;
+	};
+
+	// Length and control flow decoder for x86 and x64 instructions. Only
+	// what is required to split code into basic blocks is decoded.
+	class CPPCOVERAGE_DLL InstructionDecoder
+	{
+	  public:
+		explicit InstructionDecoder(bool is64Bit);
+
+		// Decode the instruction at code[offset] where codeAddress is the
+		// address of code[0]. Return boost::none for an unknown or
+		// truncated instruction.
+		boost::optional<DecodedInstruction>
+		Decode(const std::vector<unsigned char>& code,
+		       size_t offset,
+		       uint64_t codeAddress) const;
+
+	  private:
+		const bool is64Bit_;
+	};
+}
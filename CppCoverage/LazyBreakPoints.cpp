@@ -0,0 +1,179 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "LazyBreakPoints.hpp"
+
+#include "IPageMemory.hpp"
+
+#include "Tools/Log.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		DWORD64 GetPageAddress(DWORD64 address)
+		{
+			return address - address % LazyBreakPoints::PageSize;
+		}
+
+		//---------------------------------------------------------------------
+		DWORD64 GetAccessedAddress(const EXCEPTION_RECORD& exceptionRecord)
+		{
+			// The second parameter is the address of the inaccessible data.
+			if (exceptionRecord.NumberParameters >= 2)
+				return exceptionRecord.ExceptionInformation[1];
+			return reinterpret_cast<DWORD64>(exceptionRecord.ExceptionAddress);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	LazyBreakPoints::LazyBreakPoints(std::shared_ptr<IPageMemory> pageMemory)
+	    : pageMemory_{std::move(pageMemory)},
+	      guardedPageCount_{0},
+	      armedPageCount_{0}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	LazyBreakPoints::~LazyBreakPoints() = default;
+
+	//-------------------------------------------------------------------------
+	void LazyBreakPoints::AddBreakPoints(HANDLE hProcess,
+	                                     void* baseOfImage,
+	                                     const std::vector<DWORD64>& addresses)
+	{
+		auto& guardedPages = guardedPagesByProcess_[hProcess];
+		GuardedPages newPages;
+
+		for (auto address : addresses)
+		{
+			auto pageAddress = GetPageAddress(address);
+			auto it = guardedPages.find(pageAddress);
+
+			if (it != guardedPages.end())
+				it->second.addresses_.push_back(address);
+			else
+			{
+				auto& page = newPages[pageAddress];
+				page.baseOfImage_ = baseOfImage;
+				page.addresses_.push_back(address);
+			}
+		}
+
+		std::vector<DWORD64> unguardedAddresses;
+		for (auto& pair : newPages)
+		{
+			auto pageAddress = pair.first;
+			auto& page = pair.second;
+
+			if (pageMemory_->GuardPage(hProcess, pageAddress))
+			{
+				++guardedPageCount_;
+				guardedPages.emplace(pageAddress, std::move(page));
+			}
+			else
+			{
+				unguardedAddresses.insert(unguardedAddresses.end(),
+				                          page.addresses_.begin(),
+				                          page.addresses_.end());
+			}
+		}
+
+		if (!unguardedAddresses.empty())
+		{
+			LOG_DEBUG << L"Cannot guard pages, " << unguardedAddresses.size()
+			          << L" breakpoint(s) are set immediately.";
+			pageMemory_->WriteBreakPoints(hProcess,
+			                              std::move(unguardedAddresses));
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	bool LazyBreakPoints::OnException(HANDLE hProcess,
+	                                  const EXCEPTION_DEBUG_INFO& exceptionDebugInfo)
+	{
+		const auto& exceptionRecord = exceptionDebugInfo.ExceptionRecord;
+
+		if (exceptionRecord.ExceptionCode != STATUS_GUARD_PAGE_VIOLATION ||
+		    !exceptionDebugInfo.dwFirstChance)
+		{
+			return false;
+		}
+
+		auto itProcess = guardedPagesByProcess_.find(hProcess);
+		if (itProcess == guardedPagesByProcess_.end())
+			return false;
+
+		auto& guardedPages = itProcess->second;
+		auto it =
+		    guardedPages.find(GetPageAddress(GetAccessedAddress(exceptionRecord)));
+
+		// The program can use guard pages for its own purpose.
+		if (it == guardedPages.end())
+			return false;
+
+		auto pageAddress = it->first;
+		auto addresses = std::move(it->second.addresses_);
+
+		guardedPages.erase(it);
+		pageMemory_->UnguardPage(hProcess, pageAddress);
+		pageMemory_->WriteBreakPoints(hProcess, std::move(addresses));
+		++armedPageCount_;
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------
+	void LazyBreakPoints::OnUnloadModule(HANDLE hProcess, void* baseOfImage)
+	{
+		auto itProcess = guardedPagesByProcess_.find(hProcess);
+		if (itProcess == guardedPagesByProcess_.end())
+			return;
+
+		auto& guardedPages = itProcess->second;
+		for (auto it = guardedPages.begin(); it != guardedPages.end();)
+		{
+			if (it->second.baseOfImage_ == baseOfImage)
+				it = guardedPages.erase(it);
+			else
+				++it;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void LazyBreakPoints::OnExitProcess(HANDLE hProcess)
+	{
+		guardedPagesByProcess_.erase(hProcess);
+	}
+
+	//-------------------------------------------------------------------------
+	size_t LazyBreakPoints::GetGuardedPageCount(HANDLE hProcess) const
+	{
+		auto it = guardedPagesByProcess_.find(hProcess);
+		return it != guardedPagesByProcess_.end() ? it->second.size() : 0;
+	}
+
+	//-------------------------------------------------------------------------
+	void LazyBreakPoints::LogStatistics() const
+	{
+		LOG_INFO << L"Lazy breakpoints: " << armedPageCount_
+		         << L" page(s) armed out of " << guardedPageCount_
+		         << L" guarded.";
+	}
+}
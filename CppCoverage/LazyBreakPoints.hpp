@@ -0,0 +1,76 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Windows.h>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	class IPageMemory;
+
+	// Breakpoints are written only when their page is accessed for the
+	// first time: pages are guarded instead of being patched when the module
+	// is loaded.
+	class CPPCOVERAGE_DLL LazyBreakPoints
+	{
+	  public:
+		static const DWORD64 PageSize = 4096;
+
+		explicit LazyBreakPoints(std::shared_ptr<IPageMemory>);
+		~LazyBreakPoints();
+
+		// Breakpoints of a page that cannot be guarded are written
+		// immediately.
+		void AddBreakPoints(HANDLE hProcess,
+		                    void* baseOfImage,
+		                    const std::vector<DWORD64>& addresses);
+
+		// Return true if the exception is the first access to a guarded
+		// page. Its breakpoints are written and the program can continue.
+		bool OnException(HANDLE hProcess, const EXCEPTION_DEBUG_INFO&);
+
+		void OnUnloadModule(HANDLE hProcess, void* baseOfImage);
+		void OnExitProcess(HANDLE hProcess);
+
+		size_t GetGuardedPageCount(HANDLE hProcess) const;
+		void LogStatistics() const;
+
+	  private:
+		LazyBreakPoints(const LazyBreakPoints&) = delete;
+		LazyBreakPoints& operator=(const LazyBreakPoints&) = delete;
+
+		struct GuardedPage
+		{
+			void* baseOfImage_;
+			std::vector<DWORD64> addresses_;
+		};
+
+		using GuardedPages = std::map<DWORD64, GuardedPage>;
+
+		const std::shared_ptr<IPageMemory> pageMemory_;
+		std::unordered_map<HANDLE, GuardedPages> guardedPagesByProcess_;
+		size_t guardedPageCount_;
+		size_t armedPageCount_;
+	};
+}
@@ -0,0 +1,481 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "LineTableCache.hpp"
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+
+#include "tools/Log.hpp"
+#include "tools/MappedFileView.hpp"
+
+namespace fs = std::filesystem;
+
+namespace CppCoverage
+{
+	namespace
+	{
+		const uint32_t EntryMagic = 0x544c434f; // "OCLT"
+		const uint32_t EntryVersion = 3;
+		const wchar_t* EntryExtension = L".lines";
+
+		// Minimum sizes of the serialized elements: counts of the empty
+		// vectors and strings they contain.
+		const size_t MinSourceFileSize = 2 * sizeof(uint32_t);
+		const size_t LineSize = 2 * sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint8_t);
+
+		//---------------------------------------------------------------------
+		struct CodeViewPdb70
+		{
+			DWORD signature_;
+			GUID guid_;
+			DWORD age_;
+		};
+
+		const DWORD CodeViewPdb70Signature = 0x53445352; // "RSDS"
+
+		//---------------------------------------------------------------------
+		template <typename T>
+		const T* GetStruct(const Tools::MappedFileView& file,
+		                   uint64_t offset)
+		{
+			if (offset > file.GetSize() || file.GetSize() - offset < sizeof(T))
+				return nullptr;
+			return reinterpret_cast<const T*>(file.GetData() + offset);
+		}
+
+		//---------------------------------------------------------------------
+		boost::optional<uint64_t>
+		RvaToFileOffset(const Tools::MappedFileView& file,
+		                const IMAGE_FILE_HEADER& fileHeader,
+		                uint64_t sectionHeadersOffset,
+		                DWORD rva)
+		{
+			for (WORD i = 0; i < fileHeader.NumberOfSections; ++i)
+			{
+				auto section = GetStruct<IMAGE_SECTION_HEADER>(
+				    file, sectionHeadersOffset + i * sizeof(IMAGE_SECTION_HEADER));
+				if (!section)
+					return boost::none;
+				auto size = std::max<DWORD>(section->Misc.VirtualSize,
+				                            section->SizeOfRawData);
+				if (rva >= section->VirtualAddress &&
+				    rva < section->VirtualAddress + size)
+				{
+					return uint64_t{rva} - section->VirtualAddress +
+					       section->PointerToRawData;
+				}
+			}
+			return boost::none;
+		}
+
+		//---------------------------------------------------------------------
+		std::wstring ToKey(const std::filesystem::path& modulePath,
+		                   const CodeViewPdb70& pdb70)
+		{
+			std::wostringstream ostr;
+			const auto& guid = pdb70.guid_;
+
+			ostr << modulePath.stem().wstring() << L'_' << std::hex
+			     << std::uppercase << std::setfill(L'0');
+			ostr << std::setw(8) << guid.Data1 << std::setw(4) << guid.Data2
+			     << std::setw(4) << guid.Data3;
+			for (auto value : guid.Data4)
+				ostr << std::setw(2) << static_cast<int>(value);
+			ostr << std::setw(0) << pdb70.age_;
+
+			return ostr.str();
+		}
+
+		//---------------------------------------------------------------------
+		class EntryReader
+		{
+		  public:
+			//-----------------------------------------------------------------
+			EntryReader(const char* begin, const char* end)
+			    : current_{begin}, end_{end}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			template <typename T>
+			bool Read(T& value)
+			{
+				return Read(&value, sizeof(T));
+			}
+
+			//-----------------------------------------------------------------
+			bool Read(void* buffer, size_t size)
+			{
+				if (static_cast<size_t>(end_ - current_) < size)
+					return false;
+				std::memcpy(buffer, current_, size);
+				current_ += size;
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			// Read a count of elements using at least elementSize bytes each.
+			// A corrupted count cannot allocate more than the entry size.
+			bool ReadCount(size_t& count, size_t elementSize)
+			{
+				uint32_t value = 0;
+				if (!Read(value) ||
+				    static_cast<size_t>(end_ - current_) / elementSize < value)
+				{
+					return false;
+				}
+				count = value;
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			bool IsAtEnd() const
+			{
+				return current_ == end_;
+			}
+
+		  private:
+			const char* current_;
+			const char* end_;
+		};
+
+		//---------------------------------------------------------------------
+		bool ReadEntry(EntryReader& reader,
+		               std::vector<LineTableCache::SourceFile>& sourceFiles)
+		{
+			uint32_t magic = 0;
+			uint32_t version = 0;
+			size_t sourceFileCount = 0;
+
+			if (!reader.Read(magic) || magic != EntryMagic ||
+			    !reader.Read(version) || version != EntryVersion ||
+			    !reader.ReadCount(sourceFileCount, MinSourceFileSize))
+			{
+				return false;
+			}
+
+			sourceFiles.resize(sourceFileCount);
+			for (auto& sourceFile : sourceFiles)
+			{
+				size_t pathSize = 0;
+				if (!reader.ReadCount(pathSize, sizeof(wchar_t)))
+					return false;
+				sourceFile.path_.resize(pathSize);
+				if (!reader.Read(&sourceFile.path_[0],
+				                 pathSize * sizeof(wchar_t)))
+				{
+					return false;
+				}
+
+				size_t lineCount = 0;
+				if (!reader.ReadCount(lineCount, LineSize))
+					return false;
+				sourceFile.lines_.reserve(lineCount);
+				for (size_t i = 0; i < lineCount; ++i)
+				{
+					uint32_t lineNumber = 0;
+					uint32_t symbolIndex = 0;
+					int64_t virtualAddress = 0;
+					uint8_t isFunctionEntry = 0;
+
+					if (!reader.Read(lineNumber) || !reader.Read(symbolIndex) ||
+					    !reader.Read(virtualAddress) || !reader.Read(isFunctionEntry))
+					{
+						return false;
+					}
+					sourceFile.lines_.emplace_back(
+					    lineNumber, virtualAddress, symbolIndex, isFunctionEntry != 0);
+				}
+			}
+
+			return reader.IsAtEnd();
+		}
+
+		//---------------------------------------------------------------------
+		template <typename T>
+		void Write(std::ofstream& ofs, const T& value)
+		{
+			ofs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		//---------------------------------------------------------------------
+		void WriteEntry(std::ofstream& ofs,
+		                const std::vector<LineTableCache::SourceFile>& sourceFiles)
+		{
+			Write(ofs, EntryMagic);
+			Write(ofs, EntryVersion);
+			Write(ofs, static_cast<uint32_t>(sourceFiles.size()));
+
+			for (const auto& sourceFile : sourceFiles)
+			{
+				Write(ofs, static_cast<uint32_t>(sourceFile.path_.size()));
+				ofs.write(reinterpret_cast<const char*>(sourceFile.path_.data()),
+				          sourceFile.path_.size() * sizeof(wchar_t));
+				Write(ofs, static_cast<uint32_t>(sourceFile.lines_.size()));
+
+				for (const auto& line : sourceFile.lines_)
+				{
+					Write(ofs, static_cast<uint32_t>(line.lineNumber_));
+					Write(ofs, static_cast<uint32_t>(line.symbolIndex_));
+					Write(ofs, line.virtualAddress_);
+					Write(ofs, static_cast<uint8_t>(line.isFunctionEntry_));
+				}
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	const std::uintmax_t LineTableCache::DefaultMaxSizeInMegaBytes = 512;
+
+	//-------------------------------------------------------------------------
+	LineTableCache::LineTableCache(const std::filesystem::path& folder,
+	                               std::uintmax_t maxSizeInBytes)
+	    : folder_{folder},
+	      maxSizeInBytes_{maxSizeInBytes},
+	      hitCount_{0},
+	      missCount_{0},
+	      invalidEntryCount_{0},
+	      storedEntryCount_{0},
+	      evictedEntryCount_{0}
+	{
+		std::error_code error;
+		fs::create_directories(folder_, error);
+		if (error)
+			LOG_WARNING << L"Cannot create line table cache folder "
+			            << folder_.wstring();
+	}
+
+	//-------------------------------------------------------------------------
+	boost::optional<std::wstring>
+	LineTableCache::ComputeKey(const std::filesystem::path& modulePath)
+	{
+		std::unique_ptr<Tools::MappedFileView> file;
+
+		try
+		{
+			file = std::make_unique<Tools::MappedFileView>(modulePath);
+		}
+		catch (const std::exception&)
+		{
+			return boost::none;
+		}
+
+		auto dosHeader = GetStruct<IMAGE_DOS_HEADER>(*file, 0);
+		if (!dosHeader || dosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+			return boost::none;
+
+		auto ntHeaderOffset = static_cast<uint64_t>(dosHeader->e_lfanew);
+		auto ntHeader32 = GetStruct<IMAGE_NT_HEADERS32>(*file, ntHeaderOffset);
+		if (!ntHeader32 || ntHeader32->Signature != IMAGE_NT_SIGNATURE)
+			return boost::none;
+
+		IMAGE_DATA_DIRECTORY debugDirectory;
+		if (ntHeader32->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC)
+		{
+			auto ntHeader64 =
+			    GetStruct<IMAGE_NT_HEADERS64>(*file, ntHeaderOffset);
+			if (!ntHeader64)
+				return boost::none;
+			debugDirectory = ntHeader64->OptionalHeader
+			                     .DataDirectory[IMAGE_DIRECTORY_ENTRY_DEBUG];
+		}
+		else
+		{
+			debugDirectory = ntHeader32->OptionalHeader
+			                     .DataDirectory[IMAGE_DIRECTORY_ENTRY_DEBUG];
+		}
+
+		const auto& fileHeader = ntHeader32->FileHeader;
+		auto sectionHeadersOffset = ntHeaderOffset +
+		                            offsetof(IMAGE_NT_HEADERS32, OptionalHeader) +
+		                            fileHeader.SizeOfOptionalHeader;
+		auto debugDirectoryOffset = RvaToFileOffset(
+		    *file, fileHeader, sectionHeadersOffset, debugDirectory.VirtualAddress);
+		if (!debugDirectoryOffset)
+			return boost::none;
+
+		auto entryCount = debugDirectory.Size / sizeof(IMAGE_DEBUG_DIRECTORY);
+		for (size_t i = 0; i < entryCount; ++i)
+		{
+			auto entry = GetStruct<IMAGE_DEBUG_DIRECTORY>(
+			    *file, *debugDirectoryOffset + i * sizeof(IMAGE_DEBUG_DIRECTORY));
+			if (!entry)
+				return boost::none;
+
+			if (entry->Type == IMAGE_DEBUG_TYPE_CODEVIEW)
+			{
+				auto pdb70 =
+				    GetStruct<CodeViewPdb70>(*file, entry->PointerToRawData);
+				if (pdb70 && pdb70->signature_ == CodeViewPdb70Signature)
+					return ToKey(modulePath, *pdb70);
+			}
+		}
+
+		return boost::none;
+	}
+
+	//-------------------------------------------------------------------------
+	boost::optional<std::vector<LineTableCache::SourceFile>>
+	LineTableCache::Load(const std::wstring& key)
+	{
+		auto entryPath = GetEntryPath(key);
+		std::error_code error;
+
+		if (!fs::exists(entryPath, error))
+		{
+			++missCount_;
+			return boost::none;
+		}
+
+		std::vector<SourceFile> sourceFiles;
+		bool isValid = false;
+		try
+		{
+			Tools::MappedFileView file{entryPath};
+			EntryReader reader{file.GetData(), file.GetData() + file.GetSize()};
+
+			isValid = ReadEntry(reader, sourceFiles);
+		}
+		catch (const std::exception&)
+		{
+		}
+
+		if (!isValid)
+		{
+			LOG_WARNING << L"Remove invalid line table cache entry "
+			            << entryPath.wstring();
+			fs::remove(entryPath, error);
+			++invalidEntryCount_;
+			++missCount_;
+			return boost::none;
+		}
+
+		// The modification time is used as the last access time for LRU.
+		fs::last_write_time(
+		    entryPath, fs::file_time_type::clock::now(), error);
+		++hitCount_;
+		return sourceFiles;
+	}
+
+	//-------------------------------------------------------------------------
+	void LineTableCache::Store(const std::wstring& key,
+	                           const std::vector<SourceFile>& sourceFiles)
+	{
+		auto entryPath = GetEntryPath(key);
+		auto temporaryPath = entryPath;
+		temporaryPath += L"." + std::to_wstring(GetCurrentProcessId());
+
+		{
+			std::ofstream ofs{temporaryPath, std::ios::binary};
+			WriteEntry(ofs, sourceFiles);
+			if (!ofs)
+			{
+				LOG_WARNING << L"Cannot write line table cache entry "
+				            << temporaryPath.wstring();
+				std::error_code error;
+				fs::remove(temporaryPath, error);
+				return;
+			}
+		}
+
+		// Rename is atomic so concurrent runs never read a partial entry.
+		std::error_code error;
+		fs::rename(temporaryPath, entryPath, error);
+		if (error)
+		{
+			fs::remove(temporaryPath, error);
+			return;
+		}
+		++storedEntryCount_;
+		RemoveLeastRecentlyUsedEntries();
+	}
+
+	//-------------------------------------------------------------------------
+	void LineTableCache::LogStatistics() const
+	{
+		LOG_INFO << L"Line table cache: " << hitCount_ << L" hit(s), "
+		         << missCount_ << L" miss(es), " << storedEntryCount_
+		         << L" stored, " << invalidEntryCount_ << L" invalid, "
+		         << evictedEntryCount_ << L" evicted.";
+	}
+
+	//-------------------------------------------------------------------------
+	std::filesystem::path
+	LineTableCache::GetEntryPath(const std::wstring& key) const
+	{
+		return folder_ / (key + EntryExtension);
+	}
+
+	//-------------------------------------------------------------------------
+	void LineTableCache::RemoveLeastRecentlyUsedEntries()
+	{
+		struct Entry
+		{
+			fs::path path_;
+			fs::file_time_type lastAccessTime_;
+			std::uintmax_t size_;
+		};
+
+		std::vector<Entry> entries;
+		std::uintmax_t totalSize = 0;
+		std::error_code error;
+
+		for (const auto& directoryEntry : fs::directory_iterator{folder_, error})
+		{
+			const auto& path = directoryEntry.path();
+			if (path.extension() != EntryExtension)
+				continue;
+			auto size = fs::file_size(path, error);
+			auto lastAccessTime = fs::last_write_time(path, error);
+			if (!error)
+			{
+				entries.push_back({path, lastAccessTime, size});
+				totalSize += size;
+			}
+		}
+
+		if (totalSize <= maxSizeInBytes_)
+			return;
+
+		std::sort(entries.begin(),
+		          entries.end(),
+		          [](const Entry& entry1, const Entry& entry2) {
+			          return entry1.lastAccessTime_ < entry2.lastAccessTime_;
+		          });
+
+		for (const auto& entry : entries)
+		{
+			if (totalSize <= maxSizeInBytes_)
+				break;
+			if (fs::remove(entry.path_, error))
+			{
+				totalSize -= entry.size_;
+				++evictedEntryCount_;
+				LOG_DEBUG << L"Evict line table cache entry "
+				          << entry.path_.wstring();
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "CppCoverageExport.hpp"
+#include "DebugInformationEnumerator.hpp"
+
+namespace CppCoverage
+{
+	// Persistent cache of the line tables read from the pdb files.
+	// An entry is a file of the cache folder named after the pdb signature
+	// (GUID and age) so a rebuilt module never matches an old entry.
+	// The least recently used entries are removed when the folder exceeds
+	// the maximum size.
+	// Load and Store can be called from several threads.
+	class CPPCOVERAGE_DLL LineTableCache
+	{
+	  public:
+		struct SourceFile
+		{
+			std::wstring path_; // Path as written in the pdb.
+			std::vector<IDebugInformationHandler::Line> lines_;
+		};
+
+		static const std::uintmax_t DefaultMaxSizeInMegaBytes;
+
+		LineTableCache(const std::filesystem::path& folder,
+		               std::uintmax_t maxSizeInBytes);
+
+		LineTableCache(const LineTableCache&) = delete;
+		LineTableCache& operator=(const LineTableCache&) = delete;
+
+		// Return boost::none when the module has no pdb signature.
+		static boost::optional<std::wstring>
+		ComputeKey(const std::filesystem::path& modulePath);
+
+		boost::optional<std::vector<SourceFile>> Load(const std::wstring& key);
+		void Store(const std::wstring& key, const std::vector<SourceFile>&);
+
+		void LogStatistics() const;
+
+	  private:
+		std::filesystem::path GetEntryPath(const std::wstring& key) const;
+		void RemoveLeastRecentlyUsedEntries();
+
+		const std::filesystem::path folder_;
+		const std::uintmax_t maxSizeInBytes_;
+
+		std::atomic<size_t> hitCount_;
+		std::atomic<size_t> missCount_;
+		std::atomic<size_t> invalidEntryCount_;
+		std::atomic<size_t> storedEntryCount_;
+		std::atomic<size_t> evictedEntryCount_;
+	};
+}
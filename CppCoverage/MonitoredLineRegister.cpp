@@ -24,12 +24,26 @@
 #include "ExecutedAddressManager.hpp"
 #include "CppCoverageException.hpp"
 #include "FilterAssistant.hpp"
+#include "SymbolLoadingPipeline.hpp"
+#include "CoveredLines.hpp"
+#include "BasicBlockAnalyzer.hpp"
+#include "UnwindTable.hpp"
+#include "LazyBreakPoints.hpp"
 
 #include "FileFilter/ModuleInfo.hpp"
 #include "FileFilter/FileInfo.hpp"
 #include "FileFilter/LineInfo.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <tuple>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/optional.hpp>
+
 #include "Tools/PEFileHeader.hpp"
+#include "Tools/ProcessMemory.hpp"
 #include "Tools/Log.hpp"
 
 namespace CppCoverage
@@ -39,14 +53,33 @@ namespace CppCoverage
 		struct ModuleKind : private Tools::IPEFileHeaderHandler
 		{
 			//----------------------------------------------------------------------------
-			bool IsNativeModule(HANDLE hProcess, DWORD64 baseOfImage)
+			ModuleKind(std::shared_ptr<Tools::IProcessMemory> processMemory,
+			           HANDLE hProcess,
+			           DWORD64 baseOfImage)
 			{
-				Tools::PEFileHeader fileHeader;
+				Tools::PEFileHeader fileHeader{std::move(processMemory)};
 
 				fileHeader.Load(hProcess, baseOfImage, *this);
+			}
+
+			//----------------------------------------------------------------------------
+			bool IsNativeModule() const
+			{
 				return isNativeModule_;
 			}
 
+			//----------------------------------------------------------------------------
+			bool Is64Bit() const
+			{
+				return is64Bit_;
+			}
+
+			//----------------------------------------------------------------------------
+			const IMAGE_DATA_DIRECTORY& GetExceptionDirectory() const
+			{
+				return exceptionDirectory_;
+			}
+
 		  private:
 			//-----------------------------------------------------------------
 			template <typename T_IMAGE_NT_HEADERS>
@@ -58,6 +91,8 @@ namespace CppCoverage
 				        .DataDirectory[IMAGE_DIRECTORY_ENTRY_COM_DESCRIPTOR];
 				isNativeModule_ = dataDirectory.VirtualAddress == 0 &&
 				                  dataDirectory.Size == 0;
+				exceptionDirectory_ =
+				    optionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION];
 			}
 
 			//-----------------------------------------------------------------
@@ -65,6 +100,7 @@ namespace CppCoverage
 			                  DWORD64,
 			                  const IMAGE_NT_HEADERS32& ntHeader) override
 			{
+				is64Bit_ = false;
 				OnNtHeader(ntHeader);
 			}
 
@@ -73,25 +109,92 @@ namespace CppCoverage
 			                  DWORD64,
 			                  const IMAGE_NT_HEADERS64& ntHeader) override
 			{
+				is64Bit_ = true;
 				OnNtHeader(ntHeader);
 			}
 
 			bool isNativeModule_ = true;
+			bool is64Bit_ = false;
+			IMAGE_DATA_DIRECTORY exceptionDirectory_ = {};
 		};
+
+		//----------------------------------------------------------------------------
+		std::unique_ptr<UnwindTable>
+		CreateUnwindTable(std::shared_ptr<Tools::IProcessMemory> processMemory,
+		                  HANDLE hProcess,
+		                  void* baseOfImage,
+		                  const ModuleKind& moduleKind)
+		{
+			try
+			{
+				return std::make_unique<UnwindTable>(
+				    std::move(processMemory),
+				    hProcess,
+				    reinterpret_cast<DWORD64>(baseOfImage),
+				    moduleKind.GetExceptionDirectory());
+			}
+			catch (const std::exception& e)
+			{
+				LOG_WARNING << L"Cannot read the function table: " << e.what();
+				return nullptr;
+			}
+		}
+
+		//----------------------------------------------------------------------------
+		boost::optional<std::wstring>
+		GetModuleTemplateKey(const std::filesystem::path& modulePath)
+		{
+			std::error_code error;
+			auto lastWriteTime = std::filesystem::last_write_time(modulePath, error);
+
+			if (error)
+				return boost::none;
+			return boost::to_lower_copy(modulePath.wstring()) + L'|' +
+			       std::to_wstring(lastWriteTime.time_since_epoch().count());
+		}
 	}
 
+	//----------------------------------------------------------------------------
+	// Result of the debug information enumeration and of the filters for
+	// a module. Addresses are relative to the base of image so the template
+	// can be applied to the same module loaded in another process.
+	struct MonitoredLineRegister::ModuleTemplate
+	{
+		bool hasDebugInformation_;
+		std::vector<std::wstring> sourceFiles_;
+		std::vector<MonitoredLine> monitoredLines_;
+		size_t lastUse_;
+	};
+
 	//----------------------------------------------------------------------------
 	MonitoredLineRegister::MonitoredLineRegister(
 	    std::shared_ptr<BreakPoint> breakPoint,
 	    std::shared_ptr<ExecutedAddressManager> executedAddressManager,
 	    std::shared_ptr<ICoverageFilterManager> coverageFilterManager,
-	    std::unique_ptr<DebugInformationEnumerator> debugInformationEnumerator,
-	    std::shared_ptr<FilterAssistant> filterAssistant)
-	    : breakPoint_{breakPoint},
+	    std::shared_ptr<SymbolLoadingPipeline> symbolLoadingPipeline,
+	    std::shared_ptr<FilterAssistant> filterAssistant,
+	    std::shared_ptr<const CoveredLines> coveredLines,
+	    bool functionCoverage,
+	    bool basicBlockBreakPoints,
+	    bool dominatorBreakPoints,
+	    std::shared_ptr<LazyBreakPoints> lazyBreakPoints,
+	    std::shared_ptr<Tools::IProcessMemory> processMemory)
+	    : moduleTemplateLineCount_{0},
+	      moduleTemplateUseCount_{0},
+	      moduleTemplateHitCount_{0},
+	      skippedCoveredLineCount_{0},
+	      breakPoint_{breakPoint},
 	      executedAddressManager_{executedAddressManager},
 	      coverageFilterManager_{coverageFilterManager},
-	      debugInformationEnumerator_{std::move(debugInformationEnumerator)},
-	      filterAssistant_{std::move(filterAssistant)}
+	      symbolLoadingPipeline_{std::move(symbolLoadingPipeline)},
+	      filterAssistant_{std::move(filterAssistant)},
+	      coveredLines_{std::move(coveredLines)},
+	      functionCoverage_{functionCoverage},
+	      basicBlockBreakPoints_{basicBlockBreakPoints},
+	      dominatorBreakPoints_{dominatorBreakPoints},
+	      lazyBreakPoints_{std::move(lazyBreakPoints)},
+	      processMemory_{std::move(processMemory)},
+	      basicBlockStatistics_{}
 	{
 	}
 
@@ -104,8 +207,9 @@ namespace CppCoverage
 	    HANDLE hProcess,
 	    void* baseOfImage)
 	{
-		if (!ModuleKind{}.IsNativeModule(
-		        hProcess, reinterpret_cast<DWORD64>(baseOfImage)))
+		ModuleKind moduleKind{
+		    processMemory_, hProcess, reinterpret_cast<DWORD64>(baseOfImage)};
+		if (!moduleKind.IsNativeModule())
 		{
 			LOG_INFO << modulePath.wstring()
 			         << " is skipped as it is a managed module.";
@@ -117,7 +221,82 @@ namespace CppCoverage
 		moduleInfo_ = std::make_unique<FileFilter::ModuleInfo>(
 		    hProcess, modulePath, baseOfImage);
 
-		return debugInformationEnumerator_->Enumerate(modulePath, *this);
+		// With --cover_children, the same modules are loaded by many
+		// processes: debug information and filters are evaluated only once.
+		auto moduleTemplateKey = GetModuleTemplateKey(modulePath);
+		if (moduleTemplateKey)
+		{
+			auto it = moduleTemplates_.find(*moduleTemplateKey);
+			if (it != moduleTemplates_.end())
+			{
+				++moduleTemplateHitCount_;
+				it->second.lastUse_ = ++moduleTemplateUseCount_;
+				LOG_DEBUG << L"Reuse module template for " << modulePath.wstring();
+				return ApplyModuleTemplate(it->second, hProcess, baseOfImage);
+			}
+		}
+
+		sourceFiles_.clear();
+		monitoredLines_.clear();
+		symbolLineAddresses_.clear();
+		auto hasDebugInformation =
+		    symbolLoadingPipeline_->Enumerate(modulePath, *this);
+		if (functionCoverage_)
+			KeepFunctionEntries();
+		else if (basicBlockBreakPoints_ || dominatorBreakPoints_)
+		{
+			// Exception handlers are found only for x64.
+			auto unwindTable = dominatorBreakPoints_ && moduleKind.Is64Bit()
+			                       ? CreateUnwindTable(processMemory_, hProcess, baseOfImage, moduleKind)
+			                       : nullptr;
+			MoveLinesToBlockFirstLines(
+			    hProcess, moduleKind.Is64Bit(), unwindTable.get());
+		}
+		if (moduleTemplateKey)
+		{
+			AddModuleTemplate(
+			    *moduleTemplateKey,
+			    CreateModuleTemplate(hasDebugInformation, baseOfImage));
+		}
+		if (!hasDebugInformation)
+			return false;
+
+		// Breakpoints of all source files are set at once as addresses of
+		// different source files (headers, templates...) share the same pages.
+		SetBreakPoints(hProcess, baseOfImage);
+		return true;
+	}
+
+	//----------------------------------------------------------------------------
+	void MonitoredLineRegister::LogStatistics() const
+	{
+		LOG_INFO << L"Module templates: " << moduleTemplates_.size()
+		         << L" kept, " << moduleTemplateHitCount_ << L" reused.";
+		if (basicBlockBreakPoints_ || dominatorBreakPoints_)
+		{
+			const auto& statistics = basicBlockStatistics_;
+			LOG_INFO << L"Basic blocks: "
+			         << statistics.lineAddressCount_ - statistics.breakPointCount_
+			         << L" breakpoint(s) saved out of "
+			         << statistics.lineAddressCount_ << L", "
+			         << statistics.undecodedFunctionCount_
+			         << L" function(s) not decoded.";
+		}
+		if (dominatorBreakPoints_)
+		{
+			const auto& statistics = basicBlockStatistics_;
+			LOG_INFO << L"Dominators: " << statistics.inferredBlockCount_
+			         << L" block(s) inferred, "
+			         << statistics.exceptionHandlerFunctionCount_
+			         << L" function(s) skipped as they have exception handlers, "
+			         << statistics.unknownEntryFunctionCount_
+			         << L" as their entry is unknown.";
+		}
+		if (coveredLines_)
+		{
+			LOG_INFO << skippedCoveredLineCount_
+			         << L" line(s) without breakpoint as already covered.";
+		}
 	}
 
 	//--------------------------------------------------------------------------
@@ -144,63 +323,460 @@ namespace CppCoverage
 
 		FileFilter::FileInfo fileInfo{path, std::move(lineInfos)};
 		const auto& moduleInfo = GetModuleInfo();
+		auto sourceFileIndex = sourceFiles_.size();
+		// With function coverage, covered lines are checked once the entry
+		// of each function is known.
+		const auto* coveredLineNumbers =
+		    coveredLines_ && !functionCoverage_
+		        ? coveredLines_->GetExecutedLines(moduleInfo.path_, path)
+		        : nullptr;
 
-		std::vector<DWORD64> addresses;
-		LineNumberByAddress lineNumberByAddress;
+		const bool analyzeBlocks =
+		    !functionCoverage_ && (basicBlockBreakPoints_ || dominatorBreakPoints_);
 
-		for (const auto& lineInfo : fileInfo.lineInfoColllection_)
+		sourceFiles_.push_back(path.wstring());
+		for (size_t i = 0; i < lines.size(); ++i)
 		{
-			auto lineNumber = lineInfo.lineNumber_;
+			// With function coverage, a function is monitored only if the
+			// line at its start address is selected.
+			if (functionCoverage_ && !lines[i].isFunctionEntry_)
+				continue;
+
+			const auto& lineInfo = fileInfo.lineInfoColllection_[i];
+			auto addressValue = lineInfo.virtualAddress_ +
+			                    reinterpret_cast<DWORD64>(moduleInfo.baseOfImage_);
+
+			if (analyzeBlocks)
+				symbolLineAddresses_.emplace_back(lineInfo.symbolIndex_, addressValue);
 			if (coverageFilterManager_->IsLineSelected(
 			        moduleInfo, fileInfo, lineInfo))
 			{
-				auto addressValue =
-				    lineInfo.virtualAddress_ +
-				    reinterpret_cast<DWORD64>(moduleInfo.baseOfImage_);
+				// The line is reported as executed when merging with the
+				// input coverage, so it does not need a breakpoint.
+				if (coveredLineNumbers &&
+				    std::binary_search(
+				        coveredLineNumbers->begin(),
+				        coveredLineNumbers->end(),
+				        static_cast<unsigned int>(lineInfo.lineNumber_)))
+				{
+					++skippedCoveredLineCount_;
+					continue;
+				}
 
-				lineNumberByAddress[addressValue].push_back(lineNumber);
-				addresses.push_back(addressValue);
+				monitoredLines_.push_back(
+				    {addressValue,
+				     sourceFileIndex,
+				     static_cast<unsigned int>(lineInfo.lineNumber_),
+				     lineInfo.symbolIndex_,
+				     false,
+				     0});
 			}
 		}
-		SetBreakPoint(path,
-		              moduleInfo.hProcess_,
-		              std::move(addresses),
-		              lineNumberByAddress);
 	}
 
 	//--------------------------------------------------------------------------
-	void MonitoredLineRegister::SetBreakPoint(
-	    const std::filesystem::path& path,
+	void MonitoredLineRegister::KeepFunctionEntries()
+	{
+		auto lineCount = monitoredLines_.size();
+
+		// Only the lines at the start address of a function are monitored
+		// but several lines can share this address.
+		std::stable_sort(monitoredLines_.begin(),
+		                 monitoredLines_.end(),
+		                 [](const MonitoredLine& line1, const MonitoredLine& line2) {
+			                 return std::tie(line1.symbolIndex_, line1.address_) <
+			                        std::tie(line2.symbolIndex_, line2.address_);
+		                 });
+		monitoredLines_.erase(
+		    std::unique(monitoredLines_.begin(),
+		                monitoredLines_.end(),
+		                [](const MonitoredLine& line1, const MonitoredLine& line2) {
+			                return line1.symbolIndex_ == line2.symbolIndex_;
+		                }),
+		    monitoredLines_.end());
+		LOG_DEBUG << monitoredLines_.size() << L" function entries kept out of "
+		          << lineCount << L" lines.";
+
+		if (coveredLines_)
+		{
+			auto size = monitoredLines_.size();
+			monitoredLines_.erase(
+			    std::remove_if(monitoredLines_.begin(),
+			                   monitoredLines_.end(),
+			                   [this](const MonitoredLine& line) {
+				                   return IsCovered(line.sourceFileIndex_,
+				                                    line.lineNumber_);
+			                   }),
+			    monitoredLines_.end());
+			skippedCoveredLineCount_ += size - monitoredLines_.size();
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	void MonitoredLineRegister::MoveLinesToBlockFirstLines(
 	    HANDLE hProcess,
-	    std::vector<DWORD64>&& addressCollection,
-	    const LineNumberByAddress& lineNumberByAddress)
+	    bool is64Bit,
+	    const UnwindTable* unwindTable)
 	{
+		BasicBlockAnalyzer basicBlockAnalyzer{is64Bit};
+		auto& statistics = basicBlockStatistics_;
+
+		std::stable_sort(monitoredLines_.begin(),
+		                 monitoredLines_.end(),
+		                 [](const MonitoredLine& line1, const MonitoredLine& line2) {
+			                 return std::tie(line1.symbolIndex_, line1.address_) <
+			                        std::tie(line2.symbolIndex_, line2.address_);
+		                 });
+		std::sort(symbolLineAddresses_.begin(), symbolLineAddresses_.end());
+		symbolLineAddresses_.erase(
+		    std::unique(symbolLineAddresses_.begin(), symbolLineAddresses_.end()),
+		    symbolLineAddresses_.end());
+
+		for (auto itBegin = monitoredLines_.begin(); itBegin != monitoredLines_.end();)
+		{
+			auto itEnd = std::find_if(
+			    itBegin, monitoredLines_.end(), [&](const MonitoredLine& line) {
+				    return line.symbolIndex_ != itBegin->symbolIndex_;
+			    });
+			std::vector<uint64_t> lineAddresses;
+			for (auto it = itBegin; it != itEnd; ++it)
+			{
+				if (lineAddresses.empty() || lineAddresses.back() != it->address_)
+					lineAddresses.push_back(it->address_);
+			}
+			statistics.lineAddressCount_ += lineAddresses.size();
+
+			// The blocks are computed with the unmonitored lines of the
+			// function as the code is decoded from its first line.
+			auto symbolIndex = itBegin->symbolIndex_;
+			auto itFirst = std::lower_bound(
+			    symbolLineAddresses_.cbegin(),
+			    symbolLineAddresses_.cend(),
+			    std::make_pair(symbolIndex, std::numeric_limits<DWORD64>::min()));
+			auto itLast = std::upper_bound(
+			    itFirst,
+			    symbolLineAddresses_.cend(),
+			    std::make_pair(symbolIndex, std::numeric_limits<DWORD64>::max()));
+			std::vector<uint64_t> functionLineAddresses;
+			for (auto it = itFirst; it != itLast; ++it)
+				functionLineAddresses.push_back(it->second);
+
+			auto lineBlocks = GetLineBlocks(basicBlockAnalyzer,
+			                                hProcess,
+			                                unwindTable,
+			                                functionLineAddresses,
+			                                lineAddresses);
+			if (lineBlocks)
+			{
+				std::set<uint64_t> breakPointAddresses;
+				std::set<uint64_t> inferredAddresses;
+				for (auto it = itBegin; it != itEnd; ++it)
+				{
+					auto itLineAddress =
+					    std::lower_bound(functionLineAddresses.cbegin(),
+					                     functionLineAddresses.cend(),
+					                     it->address_);
+					const auto& lineBlock =
+					    (*lineBlocks)[itLineAddress - functionLineAddresses.cbegin()];
+					it->address_ = lineBlock.address_;
+					it->isInferred_ = lineBlock.isInferred_;
+					it->dominatorAddress_ = lineBlock.dominatorAddress_.value_or(0);
+					if (lineBlock.isInferred_)
+						inferredAddresses.insert(lineBlock.address_);
+					else
+						breakPointAddresses.insert(lineBlock.address_);
+				}
+				statistics.breakPointCount_ += breakPointAddresses.size();
+				statistics.inferredBlockCount_ += inferredAddresses.size();
+			}
+			else
+			{
+				++statistics.undecodedFunctionCount_;
+				statistics.breakPointCount_ += lineAddresses.size();
+			}
+			itBegin = itEnd;
+		}
+		symbolLineAddresses_.clear();
+	}
+
+	//--------------------------------------------------------------------------
+	boost::optional<std::vector<LineBlock>> MonitoredLineRegister::GetLineBlocks(
+	    const BasicBlockAnalyzer& basicBlockAnalyzer,
+	    HANDLE hProcess,
+	    const UnwindTable* unwindTable,
+	    const std::vector<uint64_t>& lineAddresses,
+	    const std::vector<uint64_t>& monitoredLineAddresses)
+	{
+		if (lineAddresses.size() == 1)
+			return std::vector<LineBlock>{{lineAddresses.front(), false, boost::none}};
+
+		auto code = ReadFunctionCode(hProcess, lineAddresses);
+		if (!code)
+			return boost::none;
+
+		// The continuation of a catch block is reached from the runtime
+		// so the dominators are valid only without exception handlers.
+		// They are also computed from the entry of the function: its line
+		// can be in a source file which is not enumerated.
+		if (unwindTable && HasExceptionHandler(*unwindTable, lineAddresses))
+			++basicBlockStatistics_.exceptionHandlerFunctionCount_;
+		else if (unwindTable && !IsFunctionEntry(*unwindTable, lineAddresses.front()))
+			++basicBlockStatistics_.unknownEntryFunctionCount_;
+		else if (unwindTable)
+		{
+			return basicBlockAnalyzer.GetLineBlocks(
+			    *code, lineAddresses.front(), lineAddresses, monitoredLineAddresses);
+		}
+
+		auto blockAddresses = basicBlockAnalyzer.GetBlockFirstLineAddresses(
+		    *code, lineAddresses.front(), lineAddresses);
+		if (!blockAddresses)
+			return boost::none;
+
+		std::vector<LineBlock> lineBlocks;
+		for (auto address : *blockAddresses)
+			lineBlocks.push_back({address, false, boost::none});
+		return lineBlocks;
+	}
+
+	//--------------------------------------------------------------------------
+	boost::optional<std::vector<unsigned char>>
+	MonitoredLineRegister::ReadFunctionCode(
+	    HANDLE hProcess,
+	    const std::vector<uint64_t>& lineAddresses) const
+	{
+		auto codeAddress = lineAddresses.front();
+		auto codeSize = lineAddresses.back() - codeAddress;
+
+		if (codeSize > MaxFunctionCodeSize)
+			return boost::none;
+
+		// The code of the last line is read too. Try the page of the last line
+		// address when the next page is not readable.
+		for (auto tailSize : {MaxTailSize, MaxTailSize - lineAddresses.back() % MaxTailSize})
+		{
+			try
+			{
+				std::vector<unsigned char> code(
+				    static_cast<size_t>(codeSize + tailSize));
+				processMemory_->Read(hProcess, codeAddress, code.data(), code.size());
+				return code;
+			}
+			catch (const std::exception& e)
+			{
+				LOG_DEBUG << L"Cannot read function code: " << e.what();
+			}
+		}
+		return boost::none;
+	}
+
+	//--------------------------------------------------------------------------
+	bool MonitoredLineRegister::HasExceptionHandler(
+	    const UnwindTable& unwindTable,
+	    const std::vector<uint64_t>& lineAddresses) const
+	{
+		try
+		{
+			return unwindTable.HasExceptionHandler(lineAddresses.front(),
+			                                       lineAddresses.back() + 1);
+		}
+		catch (const std::exception& e)
+		{
+			LOG_DEBUG << L"Cannot read unwind information: " << e.what();
+			return true;
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	bool MonitoredLineRegister::IsFunctionEntry(const UnwindTable& unwindTable,
+	                                            uint64_t address) const
+	{
+		try
+		{
+			return unwindTable.IsFunctionEntry(address);
+		}
+		catch (const std::exception& e)
+		{
+			LOG_DEBUG << L"Cannot read unwind information: " << e.what();
+			return false;
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	bool MonitoredLineRegister::IsCovered(size_t sourceFileIndex,
+	                                      unsigned int lineNumber) const
+	{
+		const auto* coveredLineNumbers = coveredLines_->GetExecutedLines(
+		    GetModuleInfo().path_, sourceFiles_[sourceFileIndex]);
+
+		return coveredLineNumbers &&
+		       std::binary_search(coveredLineNumbers->begin(),
+		                          coveredLineNumbers->end(),
+		                          lineNumber);
+	}
+
+	//--------------------------------------------------------------------------
+	void MonitoredLineRegister::SetBreakPoints(HANDLE hProcess,
+	                                           void* baseOfImage)
+	{
+		std::stable_sort(monitoredLines_.begin(),
+		                 monitoredLines_.end(),
+		                 [](const MonitoredLine& line1, const MonitoredLine& line2) {
+			                 return line1.address_ < line2.address_;
+		                 });
+
+		std::vector<DWORD64> addresses;
+		addresses.reserve(monitoredLines_.size());
+		for (const auto& monitoredLine : monitoredLines_)
+		{
+			Address address{hProcess, reinterpret_cast<void*>(monitoredLine.address_)};
+
+			if (monitoredLine.dominatorAddress_ != 0)
+			{
+				executedAddressManager_->RegisterDominator(
+				    address,
+				    Address{hProcess,
+				            reinterpret_cast<void*>(monitoredLine.dominatorAddress_)});
+			}
+			if (monitoredLine.isInferred_)
+			{
+				executedAddressManager_->RegisterInferredAddress(
+				    address,
+				    sourceFiles_[monitoredLine.sourceFileIndex_],
+				    monitoredLine.lineNumber_);
+			}
+			else
+				addresses.push_back(monitoredLine.address_);
+		}
+
+		// Old instructions are sorted by address like monitoredLines_.
 		auto oldInstructions =
-		    breakPoint_->SetBreakPoints(hProcess, std::move(addressCollection));
+		    lazyBreakPoints_
+		        ? breakPoint_->ReadInstructions(hProcess, std::move(addresses))
+		        : breakPoint_->SetBreakPoints(hProcess, std::move(addresses));
+		auto itLine = monitoredLines_.cbegin();
+		std::vector<DWORD64> lazyAddresses;
+
 		for (const auto& value : oldInstructions)
 		{
 			auto oldInstruction = value.first;
-			const auto& addressValue = value.second;
+			const auto addressValue = value.second;
+			Address address{hProcess, reinterpret_cast<void*>(addressValue)};
 
-			auto it = lineNumberByAddress.find(addressValue);
-			if (it != lineNumberByAddress.end())
+			while (itLine != monitoredLines_.cend() &&
+			       itLine->address_ < addressValue)
 			{
-				Address address{hProcess,
-				                reinterpret_cast<void*>(addressValue)};
-				const auto& lineNumbers = it->second;
-				for (auto lineNumber : lineNumbers)
-				{
-					if (!executedAddressManager_->RegisterAddress(
-					        address,
-					        path.wstring(),
-					        lineNumber,
-					        oldInstruction))
-					{
-						breakPoint_->RemoveBreakPoint(address, oldInstruction);
-					}
-				}
+				++itLine;
 			}
+
+			// The breakpoint is kept only if the address was not already
+			// registered. Folded functions can have both inferred and
+			// monitored lines at the same address.
+			boost::optional<bool> keepBreakPoint;
+			for (; itLine != monitoredLines_.cend() &&
+			       itLine->address_ == addressValue;
+			     ++itLine)
+			{
+				if (itLine->isInferred_)
+					continue;
+				auto isNewAddress = executedAddressManager_->RegisterAddress(
+				    address,
+				    sourceFiles_[itLine->sourceFileIndex_],
+				    itLine->lineNumber_,
+				    oldInstruction);
+				if (!keepBreakPoint)
+					keepBreakPoint = isNewAddress;
+			}
+
+			if (lazyBreakPoints_)
+			{
+				if (keepBreakPoint.value_or(true))
+					lazyAddresses.push_back(addressValue);
+			}
+			else if (!keepBreakPoint.value_or(true))
+				breakPoint_->RemoveBreakPoint(address, oldInstruction);
+		}
+		if (lazyBreakPoints_)
+			lazyBreakPoints_->AddBreakPoints(hProcess, baseOfImage, lazyAddresses);
+		monitoredLines_.clear();
+	}
+
+	//--------------------------------------------------------------------------
+	MonitoredLineRegister::ModuleTemplate
+	MonitoredLineRegister::CreateModuleTemplate(bool hasDebugInformation,
+	                                            void* baseOfImage) const
+	{
+		ModuleTemplate moduleTemplate{hasDebugInformation, sourceFiles_, {}, 0};
+		auto base = reinterpret_cast<DWORD64>(baseOfImage);
+
+		moduleTemplate.monitoredLines_.reserve(monitoredLines_.size());
+		for (const auto& monitoredLine : monitoredLines_)
+		{
+			auto dominatorAddress = monitoredLine.dominatorAddress_;
+			moduleTemplate.monitoredLines_.push_back(
+			    {monitoredLine.address_ - base,
+			     monitoredLine.sourceFileIndex_,
+			     monitoredLine.lineNumber_,
+			     monitoredLine.symbolIndex_,
+			     monitoredLine.isInferred_,
+			     dominatorAddress != 0 ? dominatorAddress - base : 0});
+		}
+		return moduleTemplate;
+	}
+
+	//--------------------------------------------------------------------------
+	void MonitoredLineRegister::AddModuleTemplate(const std::wstring& key,
+	                                              ModuleTemplate moduleTemplate)
+	{
+		auto lineCount = moduleTemplate.monitoredLines_.size();
+		if (lineCount > MaxModuleTemplateLineCount)
+			return;
+
+		// Remove the least recently used templates: a module loaded by a
+		// single process would otherwise keep its lines for the whole run.
+		while (moduleTemplateLineCount_ + lineCount > MaxModuleTemplateLineCount)
+		{
+			auto it = std::min_element(
+			    moduleTemplates_.begin(),
+			    moduleTemplates_.end(),
+			    [](const auto& pair1, const auto& pair2) {
+				    return pair1.second.lastUse_ < pair2.second.lastUse_;
+			    });
+			moduleTemplateLineCount_ -= it->second.monitoredLines_.size();
+			moduleTemplates_.erase(it);
+		}
+
+		moduleTemplate.lastUse_ = ++moduleTemplateUseCount_;
+		moduleTemplateLineCount_ += lineCount;
+		moduleTemplates_.emplace(key, std::move(moduleTemplate));
+	}
+
+	//--------------------------------------------------------------------------
+	bool MonitoredLineRegister::ApplyModuleTemplate(
+	    const ModuleTemplate& moduleTemplate,
+	    HANDLE hProcess,
+	    void* baseOfImage)
+	{
+		if (!moduleTemplate.hasDebugInformation_)
+			return false;
+
+		auto base = reinterpret_cast<DWORD64>(baseOfImage);
+
+		sourceFiles_ = moduleTemplate.sourceFiles_;
+		monitoredLines_.clear();
+		monitoredLines_.reserve(moduleTemplate.monitoredLines_.size());
+		for (const auto& monitoredLine : moduleTemplate.monitoredLines_)
+		{
+			auto dominatorAddress = monitoredLine.dominatorAddress_;
+			monitoredLines_.push_back({monitoredLine.address_ + base,
+			                           monitoredLine.sourceFileIndex_,
+			                           monitoredLine.lineNumber_,
+			                           monitoredLine.symbolIndex_,
+			                           monitoredLine.isInferred_,
+			                           dominatorAddress != 0 ? dominatorAddress + base : 0});
 		}
+		SetBreakPoints(hProcess, baseOfImage);
+		return true;
 	}
 
 	//--------------------------------------------------------------------------
@@ -17,10 +17,18 @@
 #pragma once
 
 #include "DebugInformationEnumerator.hpp"
+#include <map>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 #include <filesystem>
 
+#include <boost/optional/optional_fwd.hpp>
+
+namespace Tools
+{
+	class IProcessMemory;
+}
+
 namespace FileFilter
 {
 	class LineInfo;
@@ -33,6 +41,12 @@ namespace CppCoverage
 	class BreakPoint;
 	class ExecutedAddressManager;
 	class FilterAssistant;
+	class SymbolLoadingPipeline;
+	class CoveredLines;
+	class BasicBlockAnalyzer;
+	struct LineBlock;
+	class UnwindTable;
+	class LazyBreakPoints;
 
 	class MonitoredLineRegister : private IDebugInformationHandler
 	{
@@ -40,34 +54,109 @@ namespace CppCoverage
 		MonitoredLineRegister(std::shared_ptr<BreakPoint>,
 		                      std::shared_ptr<ExecutedAddressManager>,
 		                      std::shared_ptr<ICoverageFilterManager>,
-		                      std::unique_ptr<DebugInformationEnumerator>,
-		                      std::shared_ptr<FilterAssistant>);
+		                      std::shared_ptr<SymbolLoadingPipeline>,
+		                      std::shared_ptr<FilterAssistant>,
+		                      std::shared_ptr<const CoveredLines>,
+		                      bool functionCoverage,
+		                      bool basicBlockBreakPoints,
+		                      bool dominatorBreakPoints,
+		                      std::shared_ptr<LazyBreakPoints>,
+		                      std::shared_ptr<Tools::IProcessMemory>);
 		~MonitoredLineRegister();
 
 		bool RegisterLineToMonitor(const std::filesystem::path& modulePath,
 		                           HANDLE hProcess,
 		                           void* baseOfImage);
 
+		void LogStatistics() const;
+
 	  private:
+		struct ModuleTemplate;
+
 		bool IsSourceFileSelected(const std::filesystem::path&) override;
 		void OnSourceFile(const std::filesystem::path&,
 		                  const std::vector<Line>&) override;
 
-		using LineNumberByAddress =
-		    std::unordered_map<DWORD64, std::vector<int>>;
-		void SetBreakPoint(const std::filesystem::path&,
-		                   HANDLE hProcess,
-		                   std::vector<DWORD64>&&,
-		                   const LineNumberByAddress&);
+		void KeepFunctionEntries();
+		void MoveLinesToBlockFirstLines(HANDLE hProcess,
+		                                bool is64Bit,
+		                                const UnwindTable*);
+		boost::optional<std::vector<LineBlock>>
+		GetLineBlocks(const BasicBlockAnalyzer&,
+		              HANDLE hProcess,
+		              const UnwindTable*,
+		              const std::vector<uint64_t>& lineAddresses,
+		              const std::vector<uint64_t>& monitoredLineAddresses);
+		boost::optional<std::vector<unsigned char>>
+		ReadFunctionCode(HANDLE hProcess,
+		                 const std::vector<uint64_t>& lineAddresses) const;
+		bool HasExceptionHandler(const UnwindTable&,
+		                         const std::vector<uint64_t>& lineAddresses) const;
+		bool IsFunctionEntry(const UnwindTable&, uint64_t address) const;
+		bool IsCovered(size_t sourceFileIndex, unsigned int lineNumber) const;
+		void SetBreakPoints(HANDLE hProcess, void* baseOfImage);
+		ModuleTemplate CreateModuleTemplate(bool hasDebugInformation,
+		                                    void* baseOfImage) const;
+		void AddModuleTemplate(const std::wstring& key, ModuleTemplate);
+		bool ApplyModuleTemplate(const ModuleTemplate&,
+		                         HANDLE hProcess,
+		                         void* baseOfImage);
 
 		const FileFilter::ModuleInfo& GetModuleInfo() const;
 
+		struct MonitoredLine
+		{
+			DWORD64 address_;
+			size_t sourceFileIndex_;
+			unsigned int lineNumber_;
+			unsigned long symbolIndex_;
+			// The line has no breakpoint, see BasicBlockAnalyzer::GetLineBlocks.
+			bool isInferred_;
+			// 0 if the line has no dominator.
+			DWORD64 dominatorAddress_;
+		};
+
+		struct BasicBlockStatistics
+		{
+			size_t lineAddressCount_;
+			size_t breakPointCount_;
+			size_t inferredBlockCount_;
+			size_t undecodedFunctionCount_;
+			size_t exceptionHandlerFunctionCount_;
+			size_t unknownEntryFunctionCount_;
+		};
+
+		// Larger functions are usually split in several code sections.
+		static const uint64_t MaxFunctionCodeSize = 1024 * 1024;
+		static const uint64_t MaxTailSize = 4096;
+		// Bound the memory of moduleTemplates_.
+		static const size_t MaxModuleTemplateLineCount = 1024 * 1024;
+
 		std::unique_ptr<FileFilter::ModuleInfo> moduleInfo_;
+		std::vector<std::wstring> sourceFiles_;
+		std::vector<MonitoredLine> monitoredLines_;
+		// All the line addresses by symbol index before the line filters:
+		// the control flow of a function is computed from its entry even
+		// if its first lines are not monitored.
+		std::vector<std::pair<unsigned long, DWORD64>> symbolLineAddresses_;
+		std::map<std::wstring, ModuleTemplate> moduleTemplates_;
+		size_t moduleTemplateLineCount_;
+		// Incremented each time a template is created or reused.
+		size_t moduleTemplateUseCount_;
+		size_t moduleTemplateHitCount_;
+		size_t skippedCoveredLineCount_;
 		const std::shared_ptr<BreakPoint> breakPoint_;
 		const std::shared_ptr<ExecutedAddressManager> executedAddressManager_;
 		const std::shared_ptr<ICoverageFilterManager> coverageFilterManager_;
-		const std::unique_ptr<DebugInformationEnumerator>
-		    debugInformationEnumerator_;
+		const std::shared_ptr<SymbolLoadingPipeline> symbolLoadingPipeline_;
 		const std::shared_ptr<FilterAssistant> filterAssistant_;
+		const std::shared_ptr<const CoveredLines> coveredLines_;
+		const bool functionCoverage_;
+		const bool basicBlockBreakPoints_;
+		const bool dominatorBreakPoints_;
+		// Null if breakpoints are set when the module is loaded.
+		const std::shared_ptr<LazyBreakPoints> lazyBreakPoints_;
+		const std::shared_ptr<Tools::IProcessMemory> processMemory_;
+		BasicBlockStatistics basicBlockStatistics_;
 	};
 }
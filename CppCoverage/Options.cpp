@@ -18,6 +18,7 @@
 #include "Options.hpp"
 #include "CppCoverageException.hpp"
 #include "OptionsExport.hpp"
+#include "LineTableCache.hpp"
 
 namespace CppCoverage
 {
@@ -49,6 +50,13 @@ namespace CppCoverage
 		, isAggregateByFileModeEnabled_{true}
 		, isContinueAfterCppExceptionModeEnabled_{false}
 		, isOptimizedBuildSupportEnabled_{false}
+		, isDetachOnSaturationModeEnabled_{false}
+		, isSkipCoveredLinesModeEnabled_{false}
+		, isFunctionCoverageModeEnabled_{false}
+		, isBasicBlockBreakPointsModeEnabled_{false}
+		, isDominatorBreakPointsModeEnabled_{false}
+		, isLazyBreakPointsModeEnabled_{false}
+		, lineTableCacheMaxSizeInMegaBytes_{LineTableCache::DefaultMaxSizeInMegaBytes}
 	{
 		if (startInfo)
 			optionalStartInfo_ = *startInfo;
@@ -135,6 +143,78 @@ namespace CppCoverage
 		return isContinueAfterCppExceptionModeEnabled_;
 	}
 
+	//-------------------------------------------------------------------------
+	void Options::EnableDetachOnSaturationMode()
+	{
+		isDetachOnSaturationModeEnabled_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	bool Options::IsDetachOnSaturationModeEnabled() const
+	{
+		return isDetachOnSaturationModeEnabled_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::EnableSkipCoveredLinesMode()
+	{
+		isSkipCoveredLinesModeEnabled_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	bool Options::IsSkipCoveredLinesModeEnabled() const
+	{
+		return isSkipCoveredLinesModeEnabled_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::EnableFunctionCoverageMode()
+	{
+		isFunctionCoverageModeEnabled_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	bool Options::IsFunctionCoverageModeEnabled() const
+	{
+		return isFunctionCoverageModeEnabled_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::EnableBasicBlockBreakPointsMode()
+	{
+		isBasicBlockBreakPointsModeEnabled_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	bool Options::IsBasicBlockBreakPointsModeEnabled() const
+	{
+		return isBasicBlockBreakPointsModeEnabled_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::EnableDominatorBreakPointsMode()
+	{
+		isDominatorBreakPointsModeEnabled_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	bool Options::IsDominatorBreakPointsModeEnabled() const
+	{
+		return isDominatorBreakPointsModeEnabled_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::EnableLazyBreakPointsMode()
+	{
+		isLazyBreakPointsModeEnabled_ = true;
+	}
+
+	//-------------------------------------------------------------------------
+	bool Options::IsLazyBreakPointsModeEnabled() const
+	{
+		return isLazyBreakPointsModeEnabled_;
+	}
+
     //-------------------------------------------------------------------------
     void Options::EnableStopOnAssertMode()
     {
@@ -219,6 +299,54 @@ namespace CppCoverage
 		return substitutePdbSourcePaths_;
 	}
 
+	//-------------------------------------------------------------------------
+	void Options::SetLineTableCacheFolder(const std::filesystem::path& folder)
+	{
+		optionalLineTableCacheFolder_ = folder;
+	}
+
+	//-------------------------------------------------------------------------
+	const boost::optional<std::filesystem::path>& Options::GetLineTableCacheFolder() const
+	{
+		return optionalLineTableCacheFolder_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::SetLineTableCacheMaxSizeInMegaBytes(std::uintmax_t maxSize)
+	{
+		lineTableCacheMaxSizeInMegaBytes_ = maxSize;
+	}
+
+	//-------------------------------------------------------------------------
+	std::uintmax_t Options::GetLineTableCacheMaxSizeInMegaBytes() const
+	{
+		return lineTableCacheMaxSizeInMegaBytes_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::SetDebugEventsTracePath(const std::filesystem::path& path)
+	{
+		optionalDebugEventsTracePath_ = path;
+	}
+
+	//-------------------------------------------------------------------------
+	const boost::optional<std::filesystem::path>& Options::GetDebugEventsTracePath() const
+	{
+		return optionalDebugEventsTracePath_;
+	}
+
+	//-------------------------------------------------------------------------
+	void Options::SetDebugEventStatisticsPath(const std::filesystem::path& path)
+	{
+		optionalDebugEventStatisticsPath_ = path;
+	}
+
+	//-------------------------------------------------------------------------
+	const boost::optional<std::filesystem::path>& Options::GetDebugEventStatisticsPath() const
+	{
+		return optionalDebugEventStatisticsPath_;
+	}
+
 	//-------------------------------------------------------------------------
 	std::wostream& operator<<(std::wostream& ostr, const Options& options)
 	{
@@ -231,6 +359,12 @@ namespace CppCoverage
 		ostr << L"Aggregate by file: " << options.isAggregateByFileModeEnabled_ << std::endl;
 		ostr << L"Continue after C++ exception: " << options.isContinueAfterCppExceptionModeEnabled_ << std::endl;
 		ostr << L"Optimized build support: " << options.isOptimizedBuildSupportEnabled_ << std::endl;
+		ostr << L"Detach on saturation: " << options.isDetachOnSaturationModeEnabled_ << std::endl;
+		ostr << L"Skip covered lines: " << options.isSkipCoveredLinesModeEnabled_ << std::endl;
+		ostr << L"Function coverage: " << options.isFunctionCoverageModeEnabled_ << std::endl;
+		ostr << L"Basic block breakpoints: " << options.isBasicBlockBreakPointsModeEnabled_ << std::endl;
+		ostr << L"Dominator breakpoints: " << options.isDominatorBreakPointsModeEnabled_ << std::endl;
+		ostr << L"Lazy breakpoints: " << options.isLazyBreakPointsModeEnabled_ << std::endl;
 
 		ostr << L"Export: ";
 		for (const auto& optionExport : options.exports_)
@@ -263,6 +397,24 @@ namespace CppCoverage
 		}
 		ostr << std::endl;
 
+		ostr << L"Line table cache: ";
+		if (options.optionalLineTableCacheFolder_)
+		{
+			ostr << options.optionalLineTableCacheFolder_->wstring() << L" Max size: ";
+			ostr << options.lineTableCacheMaxSizeInMegaBytes_ << L"MB";
+		}
+		ostr << std::endl;
+
+		ostr << L"Debug events trace: ";
+		if (options.optionalDebugEventsTracePath_)
+			ostr << options.optionalDebugEventsTracePath_->wstring();
+		ostr << std::endl;
+
+		ostr << L"Debug event statistics: ";
+		if (options.optionalDebugEventStatisticsPath_)
+			ostr << options.optionalDebugEventStatisticsPath_->wstring();
+		ostr << std::endl;
+
 		return ostr;
 	}
 }
@@ -70,6 +70,24 @@ namespace CppCoverage
 		void EnableContinueAfterCppExceptionMode();
 		bool IsContinueAfterCppExceptionModeEnabled() const;
 
+		void EnableDetachOnSaturationMode();
+		bool IsDetachOnSaturationModeEnabled() const;
+
+		void EnableSkipCoveredLinesMode();
+		bool IsSkipCoveredLinesModeEnabled() const;
+
+		void EnableFunctionCoverageMode();
+		bool IsFunctionCoverageModeEnabled() const;
+
+		void EnableBasicBlockBreakPointsMode();
+		bool IsBasicBlockBreakPointsModeEnabled() const;
+
+		void EnableDominatorBreakPointsMode();
+		bool IsDominatorBreakPointsModeEnabled() const;
+
+		void EnableLazyBreakPointsMode();
+		bool IsLazyBreakPointsModeEnabled() const;
+
 		void AddExport(OptionsExport&&);
 		const std::vector<OptionsExport>& GetExports() const;
 		
@@ -88,6 +106,18 @@ namespace CppCoverage
 		void AddSubstitutePdbSourcePath(SubstitutePdbSourcePath&&);
 		const std::vector<SubstitutePdbSourcePath>& GetSubstitutePdbSourcePaths() const;
 
+		void SetLineTableCacheFolder(const std::filesystem::path&);
+		const boost::optional<std::filesystem::path>& GetLineTableCacheFolder() const;
+
+		void SetLineTableCacheMaxSizeInMegaBytes(std::uintmax_t);
+		std::uintmax_t GetLineTableCacheMaxSizeInMegaBytes() const;
+
+		void SetDebugEventsTracePath(const std::filesystem::path&);
+		const boost::optional<std::filesystem::path>& GetDebugEventsTracePath() const;
+
+		void SetDebugEventStatisticsPath(const std::filesystem::path&);
+		const boost::optional<std::filesystem::path>& GetDebugEventStatisticsPath() const;
+
 		friend CPPCOVERAGE_DLL std::wostream& operator<<(std::wostream&, const Options&);
 
 	private:
@@ -106,10 +136,20 @@ namespace CppCoverage
 		bool isContinueAfterCppExceptionModeEnabled_;
         bool isStopOnAssertModeEnabled_;
         bool isOptimizedBuildSupportEnabled_;
+		bool isDetachOnSaturationModeEnabled_;
+		bool isSkipCoveredLinesModeEnabled_;
+		bool isFunctionCoverageModeEnabled_;
+		bool isBasicBlockBreakPointsModeEnabled_;
+		bool isDominatorBreakPointsModeEnabled_;
+		bool isLazyBreakPointsModeEnabled_;
         std::vector<OptionsExport> exports_;
 		std::vector<std::filesystem::path> inputCoveragePaths_;
 		std::vector<UnifiedDiffSettings> unifiedDiffSettingsCollection_;
 		std::vector<std::wstring> excludedLineRegexes_;
 		std::vector<SubstitutePdbSourcePath> substitutePdbSourcePaths_;
+		boost::optional<std::filesystem::path> optionalLineTableCacheFolder_;
+		std::uintmax_t lineTableCacheMaxSizeInMegaBytes_;
+		boost::optional<std::filesystem::path> optionalDebugEventsTracePath_;
+		boost::optional<std::filesystem::path> optionalDebugEventStatisticsPath_;
 	};
 }
\ No newline at end of file
@@ -298,6 +298,29 @@ namespace CppCoverage
 				}
 			}
 		}
+		//---------------------------------------------------------------------
+		void SetLineTableCache(const ProgramOptionsVariablesMap& variablesMap,
+		                       Options& options)
+		{
+			auto lineTableCacheFolder =
+			    variablesMap.GetOptionalValue<std::string>(
+			        ProgramOptions::LineTableCacheOption);
+			auto maxSize = variablesMap.GetOptionalValue<unsigned int>(
+			    ProgramOptions::LineTableCacheMaxSizeOption);
+
+			if (maxSize && !lineTableCacheFolder)
+			{
+				throw Plugin::OptionsParserException(
+				    "--" + ProgramOptions::LineTableCacheMaxSizeOption +
+				    " requires --" + ProgramOptions::LineTableCacheOption +
+				    '.');
+			}
+			if (lineTableCacheFolder)
+				options.SetLineTableCacheFolder(*lineTableCacheFolder);
+			if (maxSize)
+				options.SetLineTableCacheMaxSizeInMegaBytes(*maxSize);
+		}
+
 		//---------------------------------------------------------------------------
 		void CheckArgumentsSize(int argc,
 		                        const char** argv,
@@ -447,17 +470,61 @@ namespace CppCoverage
 			options.EnableOptimizedBuildSupport();
 		if (variablesMap.IsOptionSelected(ProgramOptions::StopOnAssertOption))
 			options.EnableStopOnAssertMode();
+		if (variablesMap.IsOptionSelected(ProgramOptions::FunctionCoverageOption))
+			options.EnableFunctionCoverageMode();
+		if (variablesMap.IsOptionSelected(ProgramOptions::BasicBlockBreakPointsOption))
+		{
+			if (options.IsFunctionCoverageModeEnabled())
+				throw Plugin::OptionsParserException("--" + ProgramOptions::BasicBlockBreakPointsOption +
+					" and --" + ProgramOptions::FunctionCoverageOption + " cannot be used at the same time.");
+			options.EnableBasicBlockBreakPointsMode();
+		}
+		if (variablesMap.IsOptionSelected(ProgramOptions::DominatorBreakPointsOption))
+		{
+			if (options.IsFunctionCoverageModeEnabled())
+				throw Plugin::OptionsParserException("--" + ProgramOptions::DominatorBreakPointsOption +
+					" and --" + ProgramOptions::FunctionCoverageOption + " cannot be used at the same time.");
+			options.EnableDominatorBreakPointsMode();
+		}
+		if (variablesMap.IsOptionSelected(ProgramOptions::LazyBreakPointsOption))
+			options.EnableLazyBreakPointsMode();
+		if (variablesMap.IsOptionSelected(ProgramOptions::DetachOnSaturationOption))
+		{
+			if (options.IsCoverChildrenModeEnabled())
+				throw Plugin::OptionsParserException("--" + ProgramOptions::DetachOnSaturationOption +
+					" and --" + ProgramOptions::CoverChildrenOption + " cannot be used at the same time.");
+			options.EnableDetachOnSaturationMode();
+		}
 
 		AddInputCoverages(variablesMap, options);
 		AddUnifiedDiff(variablesMap, options);
 		AddExcludedLineRegexes(variablesMap, options);
 		AddSubstitutePdbSourcePaths(variablesMap, options);
+		SetLineTableCache(variablesMap, options);
+
+		auto debugEventsTracePath = variablesMap.GetOptionalValue<std::string>(
+			ProgramOptions::DebugEventsTraceOption);
+		if (debugEventsTracePath)
+			options.SetDebugEventsTracePath(*debugEventsTracePath);
+
+		auto debugEventStatisticsPath = variablesMap.GetOptionalValue<std::string>(
+			ProgramOptions::DebugEventStatisticsOption);
+		if (debugEventStatisticsPath)
+			options.SetDebugEventStatisticsPath(*debugEventStatisticsPath);
 
 		if (!options.GetStartInfo() && options.GetInputCoveragePaths().empty())
 			throw Plugin::OptionsParserException(
 			    "You must specify a program to execute or use --" +
 			    ProgramOptions::InputCoverageValue);
 
+		if (variablesMap.IsOptionSelected(ProgramOptions::SkipCoveredLinesOption))
+		{
+			if (options.GetInputCoveragePaths().empty())
+				throw Plugin::OptionsParserException("--" + ProgramOptions::SkipCoveredLinesOption +
+					" requires --" + ProgramOptions::InputCoverageValue + '.');
+			options.EnableSkipCoveredLinesMode();
+		}
+
 		for (const auto& optionParser : optionParsers_)
 			optionParser->ParseOption(variablesMap, options);
 		return options;
@@ -0,0 +1,97 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "PageMemory.hpp"
+
+#include <boost/optional.hpp>
+
+#include "BreakPoint.hpp"
+#include "CppCoverageException.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		boost::optional<DWORD> GetProtection(HANDLE hProcess,
+		                                     DWORD64 pageAddress)
+		{
+			MEMORY_BASIC_INFORMATION memoryInformation;
+
+			if (!VirtualQueryEx(hProcess,
+			                    reinterpret_cast<void*>(pageAddress),
+			                    &memoryInformation,
+			                    sizeof(memoryInformation)))
+			{
+				return boost::none;
+			}
+			return memoryInformation.Protect;
+		}
+
+		//---------------------------------------------------------------------
+		bool SetProtection(HANDLE hProcess, DWORD64 pageAddress, DWORD protection)
+		{
+			DWORD oldProtection;
+
+			return VirtualProtectEx(hProcess,
+			                        reinterpret_cast<void*>(pageAddress),
+			                        1,
+			                        protection,
+			                        &oldProtection) != 0;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	PageMemory::PageMemory(std::shared_ptr<BreakPoint> breakPoint)
+	    : breakPoint_{std::move(breakPoint)}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	bool PageMemory::GuardPage(HANDLE hProcess, DWORD64 pageAddress)
+	{
+		auto protection = GetProtection(hProcess, pageAddress);
+
+		return protection &&
+		       SetProtection(hProcess, pageAddress, *protection | PAGE_GUARD);
+	}
+
+	//-------------------------------------------------------------------------
+	void PageMemory::UnguardPage(HANDLE hProcess, DWORD64 pageAddress)
+	{
+		auto protection = GetProtection(hProcess, pageAddress);
+
+		if (!protection)
+			THROW_LAST_ERROR("Error in VirtualQueryEx", GetLastError());
+
+		// The guard is usually already removed by the system when the
+		// exception is raised.
+		if ((*protection & PAGE_GUARD) &&
+		    !SetProtection(hProcess, pageAddress, *protection & ~PAGE_GUARD))
+		{
+			THROW_LAST_ERROR("Error in VirtualProtectEx", GetLastError());
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void PageMemory::WriteBreakPoints(HANDLE hProcess,
+	                                  std::vector<DWORD64>&& addresses)
+	{
+		breakPoint_->SetBreakPoints(hProcess, std::move(addresses));
+	}
+}
@@ -0,0 +1,44 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+
+#include "IPageMemory.hpp"
+
+namespace CppCoverage
+{
+	class BreakPoint;
+
+	class CPPCOVERAGE_DLL PageMemory : public IPageMemory
+	{
+	  public:
+		explicit PageMemory(std::shared_ptr<BreakPoint>);
+
+		bool GuardPage(HANDLE hProcess, DWORD64 pageAddress) override;
+		void UnguardPage(HANDLE hProcess, DWORD64 pageAddress) override;
+		void WriteBreakPoints(HANDLE hProcess,
+		                      std::vector<DWORD64>&& addresses) override;
+
+	  private:
+		PageMemory(const PageMemory&) = delete;
+		PageMemory& operator=(const PageMemory&) = delete;
+
+		const std::shared_ptr<BreakPoint> breakPoint_;
+	};
+}
@@ -22,6 +22,7 @@
 #include "CppCoverageException.hpp"
 #include "OptionsParser.hpp"
 #include "ExportOptionParser.hpp"
+#include "LineTableCache.hpp"
 
 namespace po = boost::program_options;
 
@@ -89,7 +90,37 @@ namespace CppCoverage
 					"Exclude all lines match the regular expression. Regular expression must match the whole line.")
 				(ProgramOptions::SubstitutePdbSourcePathOption.c_str(), po::value<T_Strings>()->composing(),
 					"Substitute the starting path defined in the pdb by a local path.\nFormat: <pdbStartPath>?<localPath>. " 
-					"Can have multiple occurrences.");
+					"Can have multiple occurrences.")
+				(ProgramOptions::LineTableCacheOption.c_str(), po::value<std::string>(),
+					"Folder where the line information read from the pdb files is cached between runs.")
+				(ProgramOptions::LineTableCacheMaxSizeOption.c_str(), po::value<unsigned int>(),
+					("Maximum size in megabytes of the line table cache folder. Default value is " +
+					std::to_string(LineTableCache::DefaultMaxSizeInMegaBytes) + '.').c_str())
+				(ProgramOptions::DetachOnSaturationOption.c_str(),
+					"Detach from the program once all its breakpoints are executed and each selected module "
+					"pattern matches a loaded module. Patterns are assumed to match a single module.")
+				(ProgramOptions::SkipCoveredLinesOption.c_str(),
+					("Do not set breakpoints on the lines already executed in --" +
+					ProgramOptions::InputCoverageValue + '.').c_str())
+				(ProgramOptions::FunctionCoverageOption.c_str(),
+					"Monitor only the first line of each function to know which functions were executed.")
+				(ProgramOptions::BasicBlockBreakPointsOption.c_str(),
+					"Set breakpoints only on the first line of each basic block. The other lines of the block "
+					"are executed with it. A crash in the middle of a block can mark its next lines as executed.")
+				(ProgramOptions::DominatorBreakPointsOption.c_str(),
+					("Same as --" + ProgramOptions::BasicBlockBreakPointsOption + " but a block always followed "
+					"by blocks it dominates has no breakpoint. It is executed if one of them is executed. "
+					"Only for x64 functions without exception handlers.").c_str())
+				(ProgramOptions::LazyBreakPointsOption.c_str(),
+					"Guard the code pages instead of setting breakpoints when a module is loaded. The breakpoints "
+					"of a page are set when it is accessed for the first time. Code pages whose protection is "
+					"changed by the program are not monitored anymore.")
+				(ProgramOptions::DebugEventsTraceOption.c_str(), po::value<std::string>(),
+					"Record the debug events, the line tables and the code pages of the selected modules "
+					"into this file. The trace can be replayed without the program.")
+				(ProgramOptions::DebugEventStatisticsOption.c_str(), po::value<std::string>(),
+					"Write the time spent by debug event type and the number of breakpoints by module "
+					"into this JSON file.");
 				for (const auto& optionParser : optionParsers)
 					optionParser->AddOption(options);
 		}
@@ -129,6 +160,16 @@ namespace CppCoverage
 	const std::string ProgramOptions::ExcludedLineRegexOption = "excluded_line_regex";
 	const std::string ProgramOptions::SubstitutePdbSourcePathOption = "substitute_pdb_source_path";
     const std::string ProgramOptions::StopOnAssertOption = "stop_on_assert";
+	const std::string ProgramOptions::LineTableCacheOption = "line_table_cache";
+	const std::string ProgramOptions::LineTableCacheMaxSizeOption = "line_table_cache_max_size";
+	const std::string ProgramOptions::DetachOnSaturationOption = "detach_on_saturation";
+	const std::string ProgramOptions::SkipCoveredLinesOption = "skip_covered_lines";
+	const std::string ProgramOptions::FunctionCoverageOption = "function_coverage";
+	const std::string ProgramOptions::BasicBlockBreakPointsOption = "basic_block_breakpoints";
+	const std::string ProgramOptions::DominatorBreakPointsOption = "dominator_breakpoints";
+	const std::string ProgramOptions::LazyBreakPointsOption = "lazy_breakpoints";
+	const std::string ProgramOptions::DebugEventsTraceOption = "debug_events_trace";
+	const std::string ProgramOptions::DebugEventStatisticsOption = "debug_event_statistics";
 
 	//-------------------------------------------------------------------------
 	ProgramOptions::ProgramOptions(
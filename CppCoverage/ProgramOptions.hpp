@@ -51,6 +51,16 @@ namespace CppCoverage
 		static const std::string OptimizedBuildOption;
 		static const std::string ExcludedLineRegexOption;
 		static const std::string SubstitutePdbSourcePathOption;
+		static const std::string LineTableCacheOption;
+		static const std::string LineTableCacheMaxSizeOption;
+		static const std::string DetachOnSaturationOption;
+		static const std::string SkipCoveredLinesOption;
+		static const std::string FunctionCoverageOption;
+		static const std::string BasicBlockBreakPointsOption;
+		static const std::string DominatorBreakPointsOption;
+		static const std::string LazyBreakPointsOption;
+		static const std::string DebugEventsTraceOption;
+		static const std::string DebugEventStatisticsOption;
 
 		explicit ProgramOptions(const std::vector<std::unique_ptr<IOptionParser>>&);
 
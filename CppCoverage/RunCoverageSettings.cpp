@@ -34,7 +34,13 @@ namespace CppCoverage
 	      maxUnmatchPathsForWarning_{0},
 	      optimizedBuildSupport_{false},
 	      excludedLineRegexes_{excludedLineRegexes},
-	      substitutePdbSourcePath_{substitutePdbSourcePath}
+	      substitutePdbSourcePath_{substitutePdbSourcePath},
+	      lineTableCacheMaxSize_{0},
+	      detachOnSaturation_{false},
+	      functionCoverage_{false},
+	      basicBlockBreakPoints_{false},
+	      dominatorBreakPoints_{false},
+	      lazyBreakPoints_{false}
 	{
 	}
 
@@ -68,6 +74,63 @@ namespace CppCoverage
 		optimizedBuildSupport_ = optimizedBuildSupport;
 	}
 
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetLineTableCache(
+		const std::filesystem::path& folder,
+		std::uintmax_t maxSizeInBytes)
+	{
+		optionalLineTableCacheFolder_ = folder;
+		lineTableCacheMaxSize_ = maxSizeInBytes;
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetDetachOnSaturation(bool detachOnSaturation)
+	{
+		detachOnSaturation_ = detachOnSaturation;
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetCoveredLines(std::shared_ptr<const CoveredLines> coveredLines)
+	{
+		coveredLines_ = std::move(coveredLines);
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetFunctionCoverage(bool functionCoverage)
+	{
+		functionCoverage_ = functionCoverage;
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetBasicBlockBreakPoints(bool basicBlockBreakPoints)
+	{
+		basicBlockBreakPoints_ = basicBlockBreakPoints;
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetDominatorBreakPoints(bool dominatorBreakPoints)
+	{
+		dominatorBreakPoints_ = dominatorBreakPoints;
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetLazyBreakPoints(bool lazyBreakPoints)
+	{
+		lazyBreakPoints_ = lazyBreakPoints;
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetDebugEventsTracePath(const std::filesystem::path& path)
+	{
+		optionalDebugEventsTracePath_ = path;
+	}
+
+	//-------------------------------------------------------------------------
+	void RunCoverageSettings::SetDebugEventStatisticsPath(const std::filesystem::path& path)
+	{
+		optionalDebugEventStatisticsPath_ = path;
+	}
+
 	//-------------------------------------------------------------------------
 	const StartInfo& RunCoverageSettings::GetStartInfo() const
 	{
@@ -127,4 +190,64 @@ namespace CppCoverage
 	{
 		return substitutePdbSourcePath_;
 	}
+
+	//-------------------------------------------------------------------------
+	const boost::optional<std::filesystem::path>& RunCoverageSettings::GetLineTableCacheFolder() const
+	{
+		return optionalLineTableCacheFolder_;
+	}
+
+	//-------------------------------------------------------------------------
+	std::uintmax_t RunCoverageSettings::GetLineTableCacheMaxSize() const
+	{
+		return lineTableCacheMaxSize_;
+	}
+
+	//-------------------------------------------------------------------------
+	bool RunCoverageSettings::GetDetachOnSaturation() const
+	{
+		return detachOnSaturation_;
+	}
+
+	//-------------------------------------------------------------------------
+	const std::shared_ptr<const CoveredLines>& RunCoverageSettings::GetCoveredLines() const
+	{
+		return coveredLines_;
+	}
+
+	//-------------------------------------------------------------------------
+	bool RunCoverageSettings::GetFunctionCoverage() const
+	{
+		return functionCoverage_;
+	}
+
+	//-------------------------------------------------------------------------
+	bool RunCoverageSettings::GetBasicBlockBreakPoints() const
+	{
+		return basicBlockBreakPoints_;
+	}
+
+	//-------------------------------------------------------------------------
+	bool RunCoverageSettings::GetDominatorBreakPoints() const
+	{
+		return dominatorBreakPoints_;
+	}
+
+	//-------------------------------------------------------------------------
+	bool RunCoverageSettings::GetLazyBreakPoints() const
+	{
+		return lazyBreakPoints_;
+	}
+
+	//-------------------------------------------------------------------------
+	const boost::optional<std::filesystem::path>& RunCoverageSettings::GetDebugEventsTracePath() const
+	{
+		return optionalDebugEventsTracePath_;
+	}
+
+	//-------------------------------------------------------------------------
+	const boost::optional<std::filesystem::path>& RunCoverageSettings::GetDebugEventStatisticsPath() const
+	{
+		return optionalDebugEventStatisticsPath_;
+	}
 }
@@ -17,6 +17,10 @@
 #pragma once
 
 #include <vector>
+#include <filesystem>
+#include <memory>
+#include <boost/optional.hpp>
+
 #include "StartInfo.hpp"
 #include "UnifiedDiffSettings.hpp"
 #include "CoverageFilterSettings.hpp"
@@ -26,6 +30,8 @@
 
 namespace CppCoverage
 {
+	class CoveredLines;
+
 	class CPPCOVERAGE_DLL RunCoverageSettings
 	{
 	public:
@@ -44,6 +50,15 @@ namespace CppCoverage
         void SetStopOnAssert(bool);
         void SetMaxUnmatchPathsForWarning(size_t);
 		void SetOptimizedBuildSupport(bool);
+		void SetLineTableCache(const std::filesystem::path& folder, std::uintmax_t maxSizeInBytes);
+		void SetDetachOnSaturation(bool);
+		void SetCoveredLines(std::shared_ptr<const CoveredLines>);
+		void SetFunctionCoverage(bool);
+		void SetBasicBlockBreakPoints(bool);
+		void SetDominatorBreakPoints(bool);
+		void SetLazyBreakPoints(bool);
+		void SetDebugEventsTracePath(const std::filesystem::path&);
+		void SetDebugEventStatisticsPath(const std::filesystem::path&);
 
 		const StartInfo& GetStartInfo() const;
 		const CoverageFilterSettings& GetCoverageFilterSettings() const;
@@ -55,6 +70,16 @@ namespace CppCoverage
 		bool GetOptimizedBuildSupport() const;
 		const std::vector<std::wstring>& GetExcludedLineRegexes() const;
 		const std::vector<SubstitutePdbSourcePath>& GetSubstitutePdbSourcePaths() const;
+		const boost::optional<std::filesystem::path>& GetLineTableCacheFolder() const;
+		std::uintmax_t GetLineTableCacheMaxSize() const;
+		bool GetDetachOnSaturation() const;
+		const std::shared_ptr<const CoveredLines>& GetCoveredLines() const;
+		bool GetFunctionCoverage() const;
+		bool GetBasicBlockBreakPoints() const;
+		bool GetDominatorBreakPoints() const;
+		bool GetLazyBreakPoints() const;
+		const boost::optional<std::filesystem::path>& GetDebugEventsTracePath() const;
+		const boost::optional<std::filesystem::path>& GetDebugEventStatisticsPath() const;
 
 	private:
 		StartInfo startInfo_;
@@ -67,5 +92,15 @@ namespace CppCoverage
 		bool optimizedBuildSupport_;
 		std::vector<std::wstring> excludedLineRegexes_;
 		std::vector<SubstitutePdbSourcePath> substitutePdbSourcePath_;
+		boost::optional<std::filesystem::path> optionalLineTableCacheFolder_;
+		std::uintmax_t lineTableCacheMaxSize_;
+		bool detachOnSaturation_;
+		std::shared_ptr<const CoveredLines> coveredLines_;
+		bool functionCoverage_;
+		bool basicBlockBreakPoints_;
+		bool dominatorBreakPoints_;
+		bool lazyBreakPoints_;
+		boost::optional<std::filesystem::path> optionalDebugEventsTracePath_;
+		boost::optional<std::filesystem::path> optionalDebugEventStatisticsPath_;
 	};
 }
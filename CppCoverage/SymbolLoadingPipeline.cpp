@@ -0,0 +1,382 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "SymbolLoadingPipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+#include <boost/algorithm/string.hpp>
+
+#include "Tools/PEFileHeader.hpp"
+#include "Tools/ProcessMemory.hpp"
+#include "Tools/Log.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		struct RecordedSourceFile
+		{
+			std::filesystem::path path_;
+			std::vector<IDebugInformationHandler::Line> lines_;
+		};
+
+		//---------------------------------------------------------------------
+		struct RecordedModule
+		{
+			bool hasDebugInformation_ = false;
+			std::vector<RecordedSourceFile> sourceFiles_;
+			double loadingTimeInSeconds_ = 0;
+		};
+
+		//---------------------------------------------------------------------
+		// Source files are selected on the main thread when the module is
+		// loaded, so all of them are recorded here.
+		struct DebugInformationRecorder : IDebugInformationHandler
+		{
+			//-----------------------------------------------------------------
+			bool IsSourceFileSelected(const std::filesystem::path&) override
+			{
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			void OnSourceFile(const std::filesystem::path& path,
+			                  const std::vector<Line>& lines) override
+			{
+				sourceFiles_.push_back({path, lines});
+			}
+
+			std::vector<RecordedSourceFile> sourceFiles_;
+		};
+
+		//---------------------------------------------------------------------
+		struct ImportedModules : private Tools::IPEFileHeaderHandler
+		{
+			//-----------------------------------------------------------------
+			std::vector<std::string> Load(HANDLE hProcess, DWORD64 baseOfImage)
+			{
+				Tools::PEFileHeader fileHeader;
+
+				fileHeader.Load(hProcess, baseOfImage, *this);
+				return std::move(names_);
+			}
+
+		  private:
+			//-----------------------------------------------------------------
+			template <typename T_IMAGE_NT_HEADERS>
+			void OnNtHeader(HANDLE hProcess,
+			                DWORD64 baseOfImage,
+			                const T_IMAGE_NT_HEADERS& ntHeaders)
+			{
+				const auto& directory =
+				    ntHeaders.OptionalHeader
+				        .DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
+				if (directory.VirtualAddress == 0)
+					return;
+
+				for (auto descriptorAddress = baseOfImage + directory.VirtualAddress;;
+				     descriptorAddress += sizeof(IMAGE_IMPORT_DESCRIPTOR))
+				{
+					auto descriptor =
+					    Tools::ReadStructInProcessMemory<IMAGE_IMPORT_DESCRIPTOR>(
+					        hProcess, descriptorAddress);
+					if (descriptor->Name == 0)
+						break;
+					names_.push_back(
+					    ReadName(hProcess, baseOfImage + descriptor->Name));
+				}
+			}
+
+			//-----------------------------------------------------------------
+			static std::string ReadName(HANDLE hProcess, DWORD64 address)
+			{
+				const DWORD64 pageSize = 0x1000;
+				std::string name;
+				char buffer[MAX_PATH];
+
+				while (name.size() < MAX_PATH)
+				{
+					// Do not read past the end of the page as the next one
+					// may not be readable.
+					auto chunkAddress = address + name.size();
+					auto chunkSize = static_cast<size_t>(std::min<DWORD64>(
+					    pageSize - chunkAddress % pageSize, MAX_PATH - name.size()));
+					Tools::ReadProcessMemory(hProcess, chunkAddress, buffer, chunkSize);
+
+					auto end = std::find(buffer, buffer + chunkSize, '\0');
+					name.append(buffer, end);
+					if (end != buffer + chunkSize)
+						break;
+				}
+				return name;
+			}
+
+			//-----------------------------------------------------------------
+			void OnNtHeader32(HANDLE hProcess,
+			                  DWORD64 baseOfImage,
+			                  const IMAGE_NT_HEADERS32& ntHeader) override
+			{
+				OnNtHeader(hProcess, baseOfImage, ntHeader);
+			}
+
+			//-----------------------------------------------------------------
+			void OnNtHeader64(HANDLE hProcess,
+			                  DWORD64 baseOfImage,
+			                  const IMAGE_NT_HEADERS64& ntHeader) override
+			{
+				OnNtHeader(hProcess, baseOfImage, ntHeader);
+			}
+
+			std::vector<std::string> names_;
+		};
+
+		//---------------------------------------------------------------------
+		// Approximation of the loader search: the folder of the executable
+		// then the PATH. System modules are usually excluded by the module
+		// filters anyway.
+		boost::optional<std::filesystem::path>
+		FindImportedModule(const std::filesystem::path& executablePath,
+		                   const std::string& moduleName)
+		{
+			std::error_code error;
+			auto path = executablePath.parent_path() / moduleName;
+
+			if (std::filesystem::exists(path, error))
+				return path;
+
+			std::vector<wchar_t> buffer(MAX_PATH);
+			auto wideModuleName = std::filesystem::path{moduleName}.wstring();
+			auto size = SearchPathW(nullptr,
+			                        wideModuleName.c_str(),
+			                        nullptr,
+			                        static_cast<DWORD>(buffer.size()),
+			                        buffer.data(),
+			                        nullptr);
+			if (size == 0 || size >= buffer.size())
+				return boost::none;
+			return std::filesystem::path{buffer.data()};
+		}
+
+		//---------------------------------------------------------------------
+		std::wstring GetJobKey(const std::filesystem::path& modulePath)
+		{
+			return boost::to_lower_copy(modulePath.wstring());
+		}
+
+		//---------------------------------------------------------------------
+		double GetElapsedSeconds(std::chrono::steady_clock::time_point start)
+		{
+			std::chrono::duration<double> elapsed =
+			    std::chrono::steady_clock::now() - start;
+			return elapsed.count();
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	struct SymbolLoadingPipeline::Job
+	{
+		std::filesystem::path modulePath_;
+		bool isStarted_ = false;
+		std::promise<RecordedModule> promise_;
+		std::future<RecordedModule> result_;
+	};
+
+	//-------------------------------------------------------------------------
+	SymbolLoadingPipeline::SymbolLoadingPipeline(
+	    std::unique_ptr<IDebugInformationEnumerator> debugInformationEnumerator,
+	    size_t workerCount)
+	    : debugInformationEnumerator_{std::move(debugInformationEnumerator)},
+	      isStopping_{false},
+	      prefetchedModuleCount_{0},
+	      usedModuleCount_{0},
+	      loadingTimeInSeconds_{0},
+	      hiddenTimeInSeconds_{0}
+	{
+		for (size_t i = 0; i < workerCount; ++i)
+			workers_.emplace_back([this]() { RunWorker(); });
+	}
+
+	//-------------------------------------------------------------------------
+	SymbolLoadingPipeline::~SymbolLoadingPipeline()
+	{
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			isStopping_ = true;
+		}
+		jobAvailable_.notify_all();
+		for (auto& worker : workers_)
+			worker.join();
+	}
+
+	//-------------------------------------------------------------------------
+	void SymbolLoadingPipeline::PrefetchImportedModules(
+	    HANDLE hProcess,
+	    void* baseOfImage,
+	    const std::filesystem::path& modulePath,
+	    const IsModuleSelected& isModuleSelected)
+	{
+		if (workers_.empty())
+			return;
+
+		std::vector<std::string> moduleNames;
+		try
+		{
+			moduleNames = ImportedModules{}.Load(
+			    hProcess, reinterpret_cast<DWORD64>(baseOfImage));
+		}
+		catch (const std::exception& e)
+		{
+			// Prefetching is only an optimization.
+			LOG_WARNING << L"Cannot read the imported modules of "
+			            << modulePath.wstring() << L": " << e.what();
+			return;
+		}
+
+		for (const auto& moduleName : moduleNames)
+		{
+			auto importedModulePath = FindImportedModule(modulePath, moduleName);
+			if (importedModulePath && isModuleSelected(*importedModulePath))
+				Prefetch(*importedModulePath);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void SymbolLoadingPipeline::Prefetch(const std::filesystem::path& modulePath)
+	{
+		if (workers_.empty())
+			return;
+
+		auto job = std::make_shared<Job>();
+		job->modulePath_ = modulePath;
+		job->result_ = job->promise_.get_future();
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			if (!jobs_.emplace(GetJobKey(modulePath), job).second)
+				return;
+			pendingJobs_.push_back(job);
+			++prefetchedModuleCount_;
+		}
+		LOG_DEBUG << L"Prefetch debug information of " << modulePath.wstring();
+		jobAvailable_.notify_one();
+	}
+
+	//-------------------------------------------------------------------------
+	bool SymbolLoadingPipeline::Enumerate(
+	    const std::filesystem::path& modulePath,
+	    IDebugInformationHandler& handler)
+	{
+		std::shared_ptr<Job> job;
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			auto it = jobs_.find(GetJobKey(modulePath));
+			if (it != jobs_.end())
+			{
+				job = it->second;
+				jobs_.erase(it);
+				if (!job->isStarted_)
+				{
+					// Not worth waiting for a worker.
+					pendingJobs_.erase(std::find(
+					    pendingJobs_.begin(), pendingJobs_.end(), job));
+					job = nullptr;
+				}
+			}
+		}
+
+		if (!job)
+			return debugInformationEnumerator_->Enumerate(modulePath, handler);
+
+		auto start = std::chrono::steady_clock::now();
+		RecordedModule recordedModule;
+		try
+		{
+			recordedModule = job->result_.get();
+		}
+		catch (const std::exception& e)
+		{
+			LOG_WARNING << L"Cannot prefetch debug information of "
+			            << modulePath.wstring() << L": " << e.what();
+			return debugInformationEnumerator_->Enumerate(modulePath, handler);
+		}
+		auto waitingTime = GetElapsedSeconds(start);
+
+		++usedModuleCount_;
+		loadingTimeInSeconds_ += recordedModule.loadingTimeInSeconds_;
+		hiddenTimeInSeconds_ += std::max(
+		    0.0, recordedModule.loadingTimeInSeconds_ - waitingTime);
+
+		for (const auto& sourceFile : recordedModule.sourceFiles_)
+		{
+			if (handler.IsSourceFileSelected(sourceFile.path_))
+				handler.OnSourceFile(sourceFile.path_, sourceFile.lines_);
+		}
+		return recordedModule.hasDebugInformation_;
+	}
+
+	//-------------------------------------------------------------------------
+	void SymbolLoadingPipeline::LogStatistics() const
+	{
+		if (prefetchedModuleCount_ == 0)
+			return;
+		LOG_INFO << L"Symbol loading: " << prefetchedModuleCount_
+		         << L" module(s) prefetched, " << usedModuleCount_ << L" used, "
+		         << hiddenTimeInSeconds_ << L"s hidden out of "
+		         << loadingTimeInSeconds_ << L"s.";
+	}
+
+	//-------------------------------------------------------------------------
+	void SymbolLoadingPipeline::RunWorker()
+	{
+		for (;;)
+		{
+			std::shared_ptr<Job> job;
+			{
+				std::unique_lock<std::mutex> lock{mutex_};
+				jobAvailable_.wait(lock, [this]() {
+					return isStopping_ || !pendingJobs_.empty();
+				});
+				if (isStopping_)
+					return;
+				job = pendingJobs_.front();
+				pendingJobs_.pop_front();
+				job->isStarted_ = true;
+			}
+
+			try
+			{
+				auto start = std::chrono::steady_clock::now();
+				DebugInformationRecorder recorder;
+				RecordedModule recordedModule;
+
+				recordedModule.hasDebugInformation_ =
+				    debugInformationEnumerator_->Enumerate(job->modulePath_,
+				                                           recorder);
+				recordedModule.sourceFiles_ = std::move(recorder.sourceFiles_);
+				recordedModule.loadingTimeInSeconds_ = GetElapsedSeconds(start);
+				job->promise_.set_value(std::move(recordedModule));
+			}
+			catch (...)
+			{
+				job->promise_.set_exception(std::current_exception());
+			}
+		}
+	}
+}
@@ -0,0 +1,83 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Windows.h>
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "CppCoverageExport.hpp"
+#include "DebugInformationEnumerator.hpp"
+
+namespace CppCoverage
+{
+	// Enumerate the debug information of the modules imported by the main
+	// executable on background threads while the debuggee starts, so
+	// Enumerate only waits for the results already in flight.
+	class CPPCOVERAGE_DLL SymbolLoadingPipeline
+	{
+	  public:
+		using IsModuleSelected =
+		    std::function<bool(const std::filesystem::path&)>;
+
+		SymbolLoadingPipeline(std::unique_ptr<IDebugInformationEnumerator>,
+		                      size_t workerCount);
+		~SymbolLoadingPipeline();
+
+		SymbolLoadingPipeline(const SymbolLoadingPipeline&) = delete;
+		SymbolLoadingPipeline& operator=(const SymbolLoadingPipeline&) = delete;
+
+		void PrefetchImportedModules(HANDLE hProcess,
+		                             void* baseOfImage,
+		                             const std::filesystem::path& modulePath,
+		                             const IsModuleSelected&);
+		void Prefetch(const std::filesystem::path& modulePath);
+
+		bool Enumerate(const std::filesystem::path& modulePath,
+		               IDebugInformationHandler&);
+
+		void LogStatistics() const;
+
+	  private:
+		struct Job;
+
+		void RunWorker();
+
+		const std::unique_ptr<IDebugInformationEnumerator>
+		    debugInformationEnumerator_;
+
+		std::mutex mutex_;
+		std::condition_variable jobAvailable_;
+		std::unordered_map<std::wstring, std::shared_ptr<Job>> jobs_;
+		std::deque<std::shared_ptr<Job>> pendingJobs_;
+		bool isStopping_;
+		std::vector<std::thread> workers_;
+
+		size_t prefetchedModuleCount_;
+		size_t usedModuleCount_;
+		double loadingTimeInSeconds_;
+		double hiddenTimeInSeconds_;
+	};
+}
@@ -0,0 +1,52 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "TraceDebugInformationEnumerator.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include "DebugEventTrace.hpp"
+
+namespace CppCoverage
+{
+	//-------------------------------------------------------------------------
+	TraceDebugInformationEnumerator::TraceDebugInformationEnumerator(
+	    const DebugEventTrace& trace)
+	    : trace_{trace}
+	{
+		for (size_t i = 0; i < trace_.modules_.size(); ++i)
+			moduleIndexes_.emplace(boost::to_lower_copy(trace_.modules_[i].path_), i);
+	}
+
+	//-------------------------------------------------------------------------
+	bool TraceDebugInformationEnumerator::Enumerate(
+	    const std::filesystem::path& modulePath,
+	    IDebugInformationHandler& handler)
+	{
+		auto it = moduleIndexes_.find(boost::to_lower_copy(modulePath.wstring()));
+		if (it == moduleIndexes_.end())
+			return false;
+
+		const auto& sourceFiles = trace_.modules_[it->second].sourceFiles_;
+		for (const auto& sourceFile : sourceFiles)
+		{
+			if (handler.IsSourceFileSelected(sourceFile.path_))
+				handler.OnSourceFile(sourceFile.path_, sourceFile.lines_);
+		}
+		return !sourceFiles.empty();
+	}
+}
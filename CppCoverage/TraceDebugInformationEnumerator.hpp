@@ -0,0 +1,46 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "DebugInformationEnumerator.hpp"
+#include "CppCoverageExport.hpp"
+
+namespace CppCoverage
+{
+	struct DebugEventTrace;
+
+	// Line tables recorded in a debug event trace, by module path.
+	class CPPCOVERAGE_DLL TraceDebugInformationEnumerator
+	    : public IDebugInformationEnumerator
+	{
+	  public:
+		explicit TraceDebugInformationEnumerator(const DebugEventTrace&);
+
+		bool Enumerate(const std::filesystem::path&,
+		               IDebugInformationHandler&) override;
+
+	  private:
+		TraceDebugInformationEnumerator(const TraceDebugInformationEnumerator&) = delete;
+		TraceDebugInformationEnumerator& operator=(const TraceDebugInformationEnumerator&) = delete;
+
+		const DebugEventTrace& trace_;
+		std::unordered_map<std::wstring, size_t> moduleIndexes_;
+	};
+}
@@ -0,0 +1,165 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "UnwindTable.hpp"
+
+#include <algorithm>
+
+#include "Tools/ProcessMemory.hpp"
+
+namespace CppCoverage
+{
+	namespace
+	{
+		// Flags of UNWIND_INFO which are defined by Windows.h only for x64.
+		const unsigned char UnwindFlagExceptionHandler = 0x1;
+		const unsigned char UnwindFlagTerminationHandler = 0x2;
+		const unsigned char UnwindFlagChainInfo = 0x4;
+
+		// Long chains are not expected.
+		const int MaxChainLength = 32;
+
+		struct UnwindInfoHeader
+		{
+			unsigned char versionAndFlags_;
+			unsigned char sizeOfProlog_;
+			unsigned char countOfCodes_;
+			unsigned char frameRegisterAndOffset_;
+		};
+
+		//---------------------------------------------------------------------
+		unsigned char GetFlags(const UnwindInfoHeader& header)
+		{
+			return static_cast<unsigned char>(header.versionAndFlags_ >> 3);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	UnwindTable::UnwindTable(HANDLE hProcess,
+	                         DWORD64 baseOfImage,
+	                         const IMAGE_DATA_DIRECTORY& exceptionDirectory)
+	    : UnwindTable{std::make_shared<Tools::ProcessMemory>(),
+	                  hProcess,
+	                  baseOfImage,
+	                  exceptionDirectory}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	UnwindTable::UnwindTable(std::shared_ptr<Tools::IProcessMemory> processMemory,
+	                         HANDLE hProcess,
+	                         DWORD64 baseOfImage,
+	                         const IMAGE_DATA_DIRECTORY& exceptionDirectory)
+	    : processMemory_{std::move(processMemory)},
+	      hProcess_{hProcess},
+	      baseOfImage_{baseOfImage}
+	{
+		auto count = exceptionDirectory.Size / sizeof(RuntimeFunction);
+
+		if (exceptionDirectory.VirtualAddress == 0 || count == 0)
+			return;
+
+		runtimeFunctions_.resize(count);
+		processMemory_->Read(hProcess,
+		                     baseOfImage + exceptionDirectory.VirtualAddress,
+		                     runtimeFunctions_.data(),
+		                     count * sizeof(RuntimeFunction));
+	}
+
+	//-------------------------------------------------------------------------
+	bool UnwindTable::HasExceptionHandler(DWORD64 begin, DWORD64 end) const
+	{
+		if (begin < baseOfImage_ || end <= begin)
+			return false;
+		auto beginRva = begin - baseOfImage_;
+		auto endRva = end - baseOfImage_;
+
+		// The table is sorted by address.
+		auto it = std::lower_bound(runtimeFunctions_.begin(),
+		                           runtimeFunctions_.end(),
+		                           endRva,
+		                           [](const RuntimeFunction& runtimeFunction,
+		                              DWORD64 rva) {
+			                           return runtimeFunction.beginAddress_ < rva;
+		                           });
+		while (it != runtimeFunctions_.begin())
+		{
+			--it;
+			if (it->endAddress_ <= beginRva)
+				break;
+			if (HasExceptionHandler(*it))
+				return true;
+		}
+		return false;
+	}
+
+	//-------------------------------------------------------------------------
+	bool UnwindTable::IsFunctionEntry(DWORD64 address) const
+	{
+		if (address < baseOfImage_)
+			return false;
+		auto rva = address - baseOfImage_;
+
+		auto it = std::lower_bound(runtimeFunctions_.begin(),
+		                           runtimeFunctions_.end(),
+		                           rva,
+		                           [](const RuntimeFunction& runtimeFunction,
+		                              DWORD64 rva) {
+			                           return runtimeFunction.beginAddress_ < rva;
+		                           });
+		return it != runtimeFunctions_.end() && it->beginAddress_ == rva &&
+		       !(GetUnwindFlags(it->unwindInfoAddress_) & UnwindFlagChainInfo);
+	}
+
+	//-------------------------------------------------------------------------
+	bool UnwindTable::HasExceptionHandler(
+	    const RuntimeFunction& runtimeFunction) const
+	{
+		auto unwindInfoAddress = runtimeFunction.unwindInfoAddress_;
+
+		for (int i = 0; i < MaxChainLength; ++i)
+		{
+			auto header = Tools::ReadStructInProcessMemory<UnwindInfoHeader>(
+			    *processMemory_, hProcess_, baseOfImage_ + unwindInfoAddress);
+			auto flags = GetFlags(*header);
+
+			if (flags & (UnwindFlagExceptionHandler | UnwindFlagTerminationHandler))
+				return true;
+			if (!(flags & UnwindFlagChainInfo))
+				return false;
+
+			// The chained function follows the unwind codes which are
+			// aligned on 4 bytes.
+			auto chainedFunctionAddress = baseOfImage_ + unwindInfoAddress +
+			                              sizeof(UnwindInfoHeader) +
+			                              ((header->countOfCodes_ + 1) & ~1) * 2;
+			auto chainedFunction = Tools::ReadStructInProcessMemory<RuntimeFunction>(
+			    *processMemory_, hProcess_, chainedFunctionAddress);
+			unwindInfoAddress = chainedFunction->unwindInfoAddress_;
+		}
+		// Be conservative.
+		return true;
+	}
+
+	//-------------------------------------------------------------------------
+	unsigned char UnwindTable::GetUnwindFlags(DWORD unwindInfoAddress) const
+	{
+		auto header = Tools::ReadStructInProcessMemory<UnwindInfoHeader>(
+		    *processMemory_, hProcess_, baseOfImage_ + unwindInfoAddress);
+		return GetFlags(*header);
+	}
+}
@@ -0,0 +1,71 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Windows.h>
+#include <memory>
+#include <vector>
+
+#include "CppCoverageExport.hpp"
+
+namespace Tools
+{
+	class IProcessMemory;
+}
+
+namespace CppCoverage
+{
+	// Function table (.pdata section) of a x64 module loaded in a process.
+	class CPPCOVERAGE_DLL UnwindTable
+	{
+	  public:
+		// exceptionDirectory is IMAGE_DIRECTORY_ENTRY_EXCEPTION.
+		UnwindTable(HANDLE hProcess,
+		            DWORD64 baseOfImage,
+		            const IMAGE_DATA_DIRECTORY& exceptionDirectory);
+		UnwindTable(std::shared_ptr<Tools::IProcessMemory>,
+		            HANDLE hProcess,
+		            DWORD64 baseOfImage,
+		            const IMAGE_DATA_DIRECTORY& exceptionDirectory);
+
+		// Return true if a function of the table overlapping [begin, end)
+		// has an exception or a termination handler (try/catch, __try,
+		// destructors...). begin and end are addresses in the process.
+		bool HasExceptionHandler(DWORD64 begin, DWORD64 end) const;
+
+		// Return true if address is the beginning of a function of the table
+		// which is not a chained part of another function. Leaf functions
+		// are not in the table.
+		bool IsFunctionEntry(DWORD64 address) const;
+
+	  private:
+		struct RuntimeFunction
+		{
+			DWORD beginAddress_;
+			DWORD endAddress_;
+			DWORD unwindInfoAddress_;
+		};
+
+		bool HasExceptionHandler(const RuntimeFunction&) const;
+		unsigned char GetUnwindFlags(DWORD unwindInfoAddress) const;
+
+		const std::shared_ptr<Tools::IProcessMemory> processMemory_;
+		const HANDLE hProcess_;
+		const DWORD64 baseOfImage_;
+		std::vector<RuntimeFunction> runtimeFunctions_;
+	};
+}
@@ -17,6 +17,8 @@
 #include "stdafx.h"
 #include "WildcardCoverageFilter.hpp"
 
+#include <algorithm>
+#include <filesystem>
 #include <sstream>
 #include <boost/regex.hpp>
 
@@ -104,6 +106,25 @@ namespace CppCoverage
 		return isSelected;		
 	}
 
+	//-------------------------------------------------------------------------
+	bool WildcardCoverageFilter::AreSelectedModulesLoaded(
+		const std::vector<std::wstring>& loadedModules) const
+	{
+		// A pattern which is only a part of a path, for example a folder,
+		// can also match modules loaded later.
+		for (const auto& wildcards : moduleFilter_->selectedWildcards)
+		{
+			auto isLoaded = std::any_of(loadedModules.begin(), loadedModules.end(),
+				[&](const std::wstring& module) {
+					return wildcards.IsExactMatch(module) ||
+					       wildcards.IsExactMatch(std::filesystem::path{module}.filename().wstring());
+				});
+			if (!isLoaded)
+				return false;
+		}
+		return true;
+	}
+
 	//-------------------------------------------------------------------------
 	std::unique_ptr<WildcardCoverageFilter::Filter> 
 		WildcardCoverageFilter::BuildFilter(const Patterns& patterns) const
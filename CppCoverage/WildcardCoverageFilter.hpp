@@ -36,6 +36,11 @@ namespace CppCoverage
 		bool IsModuleSelected(const std::wstring& filename) const;
 		bool IsSourceFileSelected(const std::wstring& filename) const;
 
+		// Return true if each selected module pattern is the full path or
+		// the filename of one of loadedModules. Patterns with wildcards
+		// never return true as they can match modules loaded later.
+		bool AreSelectedModulesLoaded(const std::vector<std::wstring>& loadedModules) const;
+
 	private:
 		WildcardCoverageFilter(const WildcardCoverageFilter&) = delete;
 		WildcardCoverageFilter& operator=(const WildcardCoverageFilter&) = delete;
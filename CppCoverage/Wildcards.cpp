@@ -30,6 +30,7 @@ namespace CppCoverage
 	//-------------------------------------------------------------------------
 	Wildcards::Wildcards(std::wstring str, bool isRegexCaseSensitiv)
 		: originalStr_( str )
+		, isRegexCaseSensitiv_( isRegexCaseSensitiv )
 	{
 		auto flags = (isRegexCaseSensitiv) ? std::regex::basic : std::regex::icase;
 		// Do not escaped '*'
@@ -49,6 +50,8 @@ namespace CppCoverage
 	//-------------------------------------------------------------------------
 	Wildcards::Wildcards(Wildcards&& wildcards)
 		: wildcars_(std::move(wildcards.wildcars_))
+		, originalStr_(std::move(wildcards.originalStr_))
+		, isRegexCaseSensitiv_(wildcards.isRegexCaseSensitiv_)
 	{
 	}
 
@@ -58,6 +61,15 @@ namespace CppCoverage
 		return std::regex_search(str, wildcars_);
 	}
 
+	//-------------------------------------------------------------------------
+	bool Wildcards::IsExactMatch(const std::wstring& str) const
+	{
+		if (originalStr_.find(L'*') != std::wstring::npos)
+			return false;
+		return isRegexCaseSensitiv_ ? originalStr_ == str
+		                            : boost::iequals(originalStr_, str);
+	}
+
 	//-------------------------------------------------------------------------
 	std::wostream& operator<<(std::wostream& ostr, const Wildcards& wildcards)
 	{
@@ -33,6 +33,9 @@ namespace CppCoverage
 		Wildcards(Wildcards&&);
 
 		bool Match(const std::wstring& str) const;
+		// True if the pattern has no wildcard and is str itself. Match is a
+		// substring search so it is true for more strings.
+		bool IsExactMatch(const std::wstring& str) const;
 
 		friend CPPCOVERAGE_DLL std::wostream& operator<<(std::wostream&, const Wildcards&);
 
@@ -43,5 +46,6 @@ namespace CppCoverage
 	private:
 		std::wregex wildcars_;
 		std::wstring originalStr_;
+		bool isRegexCaseSensitiv_;
 	};
 }
\ No newline at end of file
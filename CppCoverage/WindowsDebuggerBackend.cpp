@@ -0,0 +1,116 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "WindowsDebuggerBackend.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include "Tools/Log.hpp"
+
+#include "CppCoverageException.hpp"
+#include "Process.hpp"
+
+namespace CppCoverage
+{
+	//-------------------------------------------------------------------------
+	WindowsDebuggerBackend::WindowsDebuggerBackend() = default;
+
+	//-------------------------------------------------------------------------
+	WindowsDebuggerBackend::~WindowsDebuggerBackend() = default;
+
+	//-------------------------------------------------------------------------
+	void WindowsDebuggerBackend::Start(const StartInfo& startInfo, bool coverChildren)
+	{
+		process_ = std::make_unique<Process>(startInfo);
+		process_->Start((coverChildren) ? DEBUG_PROCESS : DEBUG_ONLY_THIS_PROCESS);
+	}
+
+	//-------------------------------------------------------------------------
+	bool WindowsDebuggerBackend::WaitForDebugEvent(DEBUG_EVENT& debugEvent, DWORD milliseconds)
+	{
+		if (::WaitForDebugEvent(&debugEvent, milliseconds))
+			return true;
+
+		auto lastError = GetLastError();
+		if (lastError == ERROR_SEM_TIMEOUT)
+			return false;
+		THROW_LAST_ERROR(L"Error WaitForDebugEvent:", lastError);
+	}
+
+	//-------------------------------------------------------------------------
+	void WindowsDebuggerBackend::ContinueDebugEvent(
+		const DEBUG_EVENT& debugEvent,
+		DWORD continueStatus)
+	{
+		if (!::ContinueDebugEvent(debugEvent.dwProcessId, debugEvent.dwThreadId, continueStatus))
+			THROW_LAST_ERROR("Error in ContinueDebugEvent:", GetLastError());
+	}
+
+	//-------------------------------------------------------------------------
+	bool WindowsDebuggerBackend::Detach(DWORD processId)
+	{
+		if (!DebugActiveProcessStop(processId))
+		{
+			LOG_WARNING << "Cannot detach from process " << processId << ": "
+				<< GetErrorMessage(GetLastError());
+			return false;
+		}
+		return true;
+	}
+
+	//-------------------------------------------------------------------------
+	DWORD WindowsDebuggerBackend::WaitForExitCode(HANDLE hProcess)
+	{
+		DWORD exitCode = 0;
+		if (WaitForSingleObject(hProcess, INFINITE) != WAIT_OBJECT_0 || !GetExitCodeProcess(hProcess, &exitCode))
+			THROW_LAST_ERROR("Cannot get the exit code of the detached process:", GetLastError());
+		return exitCode;
+	}
+
+	//-------------------------------------------------------------------------
+	// Only one system call: module paths are used for statistics only.
+	std::wstring WindowsDebuggerBackend::GetModulePath(HANDLE hFile, void* baseOfImage)
+	{
+		std::vector<wchar_t> buffer(MAX_PATH);
+
+		for (;;)
+		{
+			auto size = GetFinalPathNameByHandleW(
+				hFile, buffer.data(), static_cast<DWORD>(buffer.size()), FILE_NAME_NORMALIZED);
+			if (size == 0)
+			{
+				std::wostringstream ostr;
+				ostr << L"0x" << std::hex << baseOfImage;
+				return ostr.str();
+			}
+			if (size < buffer.size())
+			{
+				std::wstring path{ buffer.data(), size };
+				const std::wstring prefix = L"\\\\?\\";
+				return path.compare(0, prefix.size(), prefix) ? path : path.substr(prefix.size());
+			}
+			buffer.resize(size);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void WindowsDebuggerBackend::CloseFile(HANDLE hFile)
+	{
+		CloseHandle(hFile);
+	}
+}
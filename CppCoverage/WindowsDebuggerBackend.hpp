@@ -0,0 +1,48 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+
+#include "IDebuggerBackend.hpp"
+
+namespace CppCoverage
+{
+	class Process;
+
+	// Win32 debugging API.
+	class CPPCOVERAGE_DLL WindowsDebuggerBackend : public IDebuggerBackend
+	{
+	public:
+		WindowsDebuggerBackend();
+		~WindowsDebuggerBackend();
+
+		void Start(const StartInfo&, bool coverChildren) override;
+		bool WaitForDebugEvent(DEBUG_EVENT&, DWORD milliseconds) override;
+		void ContinueDebugEvent(const DEBUG_EVENT&, DWORD continueStatus) override;
+
+		bool Detach(DWORD processId) override;
+		DWORD WaitForExitCode(HANDLE hProcess) override;
+
+		std::wstring GetModulePath(HANDLE hFile, void* baseOfImage) override;
+		void CloseFile(HANDLE hFile) override;
+
+	private:
+		std::unique_ptr<Process> process_;
+	};
+}
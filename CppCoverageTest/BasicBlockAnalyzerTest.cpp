@@ -0,0 +1,232 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include "CppCoverage/BasicBlockAnalyzer.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		const uint64_t codeAddress = 0x180001050;
+
+		// Captured from msdia140.dll.
+		const std::vector<unsigned char> code = {
+		    0x48, 0x83, 0xEC, 0x28,                   // 1050 sub rsp, 28h
+		    0xBA, 0x10, 0x00, 0x00, 0x00,             // 1054 mov edx, 10h
+		    0x33, 0xC9,                               // 1059 xor ecx, ecx
+		    0xFF, 0x15, 0xDF, 0xAF, 0x0F, 0x00,       // 105B call [rip+0FAFDFh]
+		    0x48, 0x85, 0xC0,                         // 1061 test rax, rax
+		    0x74, 0x11,                               // 1064 je 1077
+		    0x48, 0x8D, 0x0D, 0xC3, 0x0A, 0x12, 0x00, // 1066 lea rcx, [rip+120AC3h]
+		    0xC7, 0x40, 0x08, 0x00, 0x00, 0x00, 0x00, // 106D mov dword ptr [rax+8], 0
+		    0x48, 0x89, 0x08,                         // 1074 mov [rax], rcx
+		    0x48, 0x89, 0x05, 0x9A, 0x8F, 0x13, 0x00, // 1077 mov [rip+138F9Ah], rax
+		    0x48, 0x85, 0xC0,                         // 107E test rax, rax
+		    0x74, 0x03,                               // 1081 je 1086
+		    0xFF, 0x40, 0x08,                         // 1083 inc dword ptr [rax+8]
+		    0x48, 0x8D, 0x05, 0xCB, 0x19, 0x11, 0x00, // 1086 lea rax, [rip+1119CBh]
+		    0xC7, 0x05, 0x89, 0x8F, 0x13, 0x00, 0x03, 0x00, 0x00, 0x00 // 108D mov dword ptr [rip+138F89h], 3
+		};
+
+		// Same code as loopCode in BranchAfterLastLine.
+		const std::vector<unsigned char> loopCode = {
+		    0x31, 0xC0,       // 00 xor eax, eax
+		    0xEB, 0x04,       // 02 jmp 08
+		    0xFF, 0xC0,       // 04 inc eax
+		    0xFF, 0xC1,       // 06 inc ecx
+		    0x83, 0xF8, 0x0A, // 08 cmp eax, 0Ah
+		    0x7C, 0xF9,       // 0B jl 06
+		    0xC3,             // 0D ret
+		    0xFF, 0xE0        // 0E jmp rax (next function)
+		};
+
+		//---------------------------------------------------------------------
+		std::vector<uint64_t> ToAddresses(const std::vector<uint64_t>& offsets)
+		{
+			std::vector<uint64_t> addresses;
+			for (auto offset : offsets)
+				addresses.push_back(codeAddress + offset);
+			return addresses;
+		}
+
+		//---------------------------------------------------------------------
+		void CheckLineBlock(const cov::LineBlock& lineBlock,
+		                    uint64_t offset,
+		                    bool isInferred,
+		                    boost::optional<uint64_t> dominatorOffset)
+		{
+			ASSERT_EQ(codeAddress + offset, lineBlock.address_);
+			ASSERT_EQ(isInferred, lineBlock.isInferred_);
+			ASSERT_EQ(static_cast<bool>(dominatorOffset),
+			          static_cast<bool>(lineBlock.dominatorAddress_));
+			if (dominatorOffset)
+				ASSERT_EQ(codeAddress + *dominatorOffset, *lineBlock.dominatorAddress_);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, GetBlockFirstLineAddresses)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+		auto lineAddresses = ToAddresses({0x00, 0x04, 0x11, 0x16, 0x24, 0x27, 0x33, 0x36, 0x47});
+
+		auto blockAddresses = analyzer.GetBlockFirstLineAddresses(code, codeAddress, lineAddresses);
+		ASSERT_TRUE(static_cast<bool>(blockAddresses));
+		ASSERT_EQ(ToAddresses({0x00, 0x00, 0x11, 0x16, 0x16, 0x27, 0x33, 0x36, 0x36}), *blockAddresses);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, SameAddress)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+		auto lineAddresses = ToAddresses({0x00, 0x00, 0x04});
+
+		auto blockAddresses = analyzer.GetBlockFirstLineAddresses(code, codeAddress, lineAddresses);
+		ASSERT_TRUE(static_cast<bool>(blockAddresses));
+		ASSERT_EQ(ToAddresses({0x00, 0x00, 0x00}), *blockAddresses);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, LineInsideInstruction)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+
+		ASSERT_FALSE(analyzer.GetBlockFirstLineAddresses(
+		    code, codeAddress, ToAddresses({0x00, 0x01, 0x47})));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, IndirectBranch)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+		// mov eax, ecx; jmp qword ptr [rax*8+rdx]
+		std::vector<unsigned char> switchCode = {0x8B, 0xC1, 0xFF, 0x24, 0xC2};
+
+		ASSERT_FALSE(analyzer.GetBlockFirstLineAddresses(
+		    switchCode, codeAddress, ToAddresses({0x00, 0x02, 0x05})));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, BranchAfterLastLine)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+
+		auto blockAddresses = analyzer.GetBlockFirstLineAddresses(
+		    loopCode, codeAddress, ToAddresses({0x00, 0x04, 0x06, 0x08}));
+		ASSERT_TRUE(static_cast<bool>(blockAddresses));
+		ASSERT_EQ(ToAddresses({0x00, 0x04, 0x06, 0x08}), *blockAddresses);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, SingleLine)
+	{
+		cov::BasicBlockAnalyzer analyzer{false};
+
+		auto blockAddresses = analyzer.GetBlockFirstLineAddresses({}, codeAddress, {codeAddress});
+		ASSERT_TRUE(static_cast<bool>(blockAddresses));
+		ASSERT_EQ(std::vector<uint64_t>{codeAddress}, *blockAddresses);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, GetLineBlocks)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+		auto lineAddresses = ToAddresses({0x00, 0x04, 0x11, 0x16, 0x24, 0x27, 0x33, 0x36, 0x47});
+
+		auto lineBlocks = analyzer.GetLineBlocks(code, codeAddress, lineAddresses, lineAddresses);
+		ASSERT_TRUE(static_cast<bool>(lineBlocks));
+		ASSERT_EQ(lineAddresses.size(), lineBlocks->size());
+		CheckLineBlock((*lineBlocks)[0], 0x00, false, boost::none);
+		CheckLineBlock((*lineBlocks)[1], 0x00, false, boost::none);
+		// Both branches of "je 1077" are dominated by this block.
+		CheckLineBlock((*lineBlocks)[2], 0x11, true, 0x00);
+		CheckLineBlock((*lineBlocks)[3], 0x16, false, 0x11);
+		CheckLineBlock((*lineBlocks)[4], 0x16, false, 0x11);
+		CheckLineBlock((*lineBlocks)[5], 0x27, true, 0x11);
+		CheckLineBlock((*lineBlocks)[6], 0x33, false, 0x27);
+		CheckLineBlock((*lineBlocks)[7], 0x36, false, 0x27);
+		CheckLineBlock((*lineBlocks)[8], 0x36, false, 0x27);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, GetLineBlocksLoop)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+
+		auto lineAddresses = ToAddresses({0x00, 0x04, 0x06, 0x08});
+		auto lineBlocks = analyzer.GetLineBlocks(
+		    loopCode, codeAddress, lineAddresses, lineAddresses);
+		ASSERT_TRUE(static_cast<bool>(lineBlocks));
+		ASSERT_EQ(4, lineBlocks->size());
+		CheckLineBlock((*lineBlocks)[0], 0x00, true, boost::none);
+		// Unreachable from the function entry.
+		CheckLineBlock((*lineBlocks)[1], 0x04, false, boost::none);
+		CheckLineBlock((*lineBlocks)[2], 0x06, false, 0x08);
+		// "ret" is not covered by a line.
+		CheckLineBlock((*lineBlocks)[3], 0x08, false, 0x00);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, GetLineBlocksEntryLineNotMonitored)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+		auto lineAddresses = ToAddresses({0x00, 0x04, 0x06, 0x08});
+
+		auto lineBlocks = analyzer.GetLineBlocks(
+		    loopCode, codeAddress, lineAddresses, ToAddresses({0x04, 0x06, 0x08}));
+		ASSERT_TRUE(static_cast<bool>(lineBlocks));
+		ASSERT_EQ(4, lineBlocks->size());
+		// Decoding from 0x04 would make it dominate 0x06 which is reached
+		// from "jl 06" and it would be inferred.
+		CheckLineBlock((*lineBlocks)[1], 0x04, false, boost::none);
+		CheckLineBlock((*lineBlocks)[2], 0x06, false, 0x08);
+		// The entry block has no breakpoint so it is not a dominator.
+		CheckLineBlock((*lineBlocks)[3], 0x08, false, boost::none);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, GetLineBlocksNotMonitoredSuccessor)
+	{
+		cov::BasicBlockAnalyzer analyzer{true};
+		auto lineAddresses = ToAddresses({0x00, 0x04, 0x11, 0x16, 0x24, 0x27, 0x33, 0x36, 0x47});
+
+		// The block of "je 1077" cannot be inferred without breakpoint in the
+		// block of 1066.
+		auto lineBlocks = analyzer.GetLineBlocks(
+		    code, codeAddress, lineAddresses, ToAddresses({0x00, 0x11, 0x27, 0x33, 0x36}));
+		ASSERT_TRUE(static_cast<bool>(lineBlocks));
+		ASSERT_EQ(lineAddresses.size(), lineBlocks->size());
+		CheckLineBlock((*lineBlocks)[0], 0x00, false, boost::none);
+		CheckLineBlock((*lineBlocks)[2], 0x11, false, 0x00);
+		CheckLineBlock((*lineBlocks)[5], 0x27, true, 0x11);
+		CheckLineBlock((*lineBlocks)[6], 0x33, false, 0x27);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BasicBlockAnalyzerTest, GetLineBlocksSingleLine)
+	{
+		cov::BasicBlockAnalyzer analyzer{false};
+
+		auto lineBlocks = analyzer.GetLineBlocks({}, codeAddress, {codeAddress}, {codeAddress});
+		ASSERT_TRUE(static_cast<bool>(lineBlocks));
+		ASSERT_EQ(1, lineBlocks->size());
+		CheckLineBlock((*lineBlocks)[0], 0x00, false, boost::none);
+	}
+}
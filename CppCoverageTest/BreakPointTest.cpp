@@ -17,8 +17,11 @@
 #include "stdafx.h"
 
 #include "CppCoverage/BreakPoint.hpp"
+#include "CppCoverage/Address.hpp"
 #include <random>
 
+#include "Tools/SimulatedProcessMemory.hpp"
+
 using CppCoverage::BreakPoint;
 
 namespace CppCoverageTest
@@ -73,6 +76,22 @@ namespace CppCoverageTest
 		{
 			return reinterpret_cast<DWORD64>(address);
 		}
+
+		const auto hSimulatedProcess = reinterpret_cast<HANDLE>(42);
+		const DWORD64 SimulatedBaseOfImage = 0x140000000;
+		const unsigned char SimulatedInstruction = 0x90;
+
+		//---------------------------------------------------------------------
+		std::shared_ptr<Tools::SimulatedProcessMemory>
+		CreateSimulatedProcessMemory(DWORD64 size)
+		{
+			auto processMemory = std::make_shared<Tools::SimulatedProcessMemory>();
+			processMemory->Allocate(hSimulatedProcess,
+			                        SimulatedBaseOfImage,
+			                        static_cast<size_t>(size),
+			                        SimulatedInstruction);
+			return processMemory;
+		}
 	}
 
 	//-------------------------------------------------------------------------
@@ -121,4 +140,95 @@ namespace CppCoverageTest
 		ASSERT_EQ(42, oldInstructionCollection.at(0).first);
 		ASSERT_EQ(ToDWORD64(&value), oldInstructionCollection.at(0).second);
 	}
-}
\ No newline at end of file
+
+	//-------------------------------------------------------------------------
+	TEST(BreakPointTest, SetBreakPointsDuplicatedAddressesOnSeveralPages)
+	{
+		BreakPoint breakPoint;
+		const int pageSize = 4096;
+		auto values = GenerateValues(10 * pageSize, 100);
+		std::vector<size_t> indexes{
+		    5 * pageSize, 0, 1, 1, 2 * pageSize + 3, 9 * pageSize, 0};
+
+		std::vector<DWORD64> addresses;
+		for (auto index : indexes)
+			addresses.push_back(ToDWORD64(&values[index]));
+
+		auto oldInstructionCollection =
+		    breakPoint.SetBreakPoints(GetCurrentProcess(), std::move(addresses));
+
+		std::set<size_t> uniqueIndexes{indexes.begin(), indexes.end()};
+		ASSERT_EQ(uniqueIndexes.size(), oldInstructionCollection.size());
+
+		auto itIndex = uniqueIndexes.begin();
+		for (const auto& oldInstruction : oldInstructionCollection)
+		{
+			ASSERT_EQ(ToDWORD64(&values[*itIndex]), oldInstruction.second);
+			ASSERT_EQ(*itIndex % 100, oldInstruction.first);
+			++itIndex;
+		}
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			if (uniqueIndexes.count(i))
+				ASSERT_EQ(BreakPoint::breakPointInstruction, values[i]);
+			else
+				ASSERT_EQ(i % 100, values[i]);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BreakPointTest, SimulatedProcessMemory)
+	{
+		const DWORD64 pageSize = Tools::SimulatedProcessMemory::PageSize;
+		auto processMemory = CreateSimulatedProcessMemory(10 * pageSize);
+		BreakPoint breakPoint{processMemory};
+		std::vector<DWORD64> addresses{SimulatedBaseOfImage + 1,
+		                               SimulatedBaseOfImage + pageSize + 10,
+		                               SimulatedBaseOfImage + 1,
+		                               SimulatedBaseOfImage + 5 * pageSize};
+
+		auto oldInstructions =
+		    breakPoint.SetBreakPoints(hSimulatedProcess, std::move(addresses));
+		auto statistics = processMemory->GetStatistics();
+
+		// The two first pages are contiguous and patched together.
+		ASSERT_EQ(2, statistics.readCount_);
+		ASSERT_EQ(2, statistics.writeCount_);
+		ASSERT_EQ(3, statistics.writtenPageCount_);
+
+		ASSERT_EQ(3, oldInstructions.size());
+		for (const auto& oldInstruction : oldInstructions)
+		{
+			unsigned char value = 0;
+			processMemory->Read(hSimulatedProcess, oldInstruction.second, &value, 1);
+			ASSERT_EQ(SimulatedInstruction, oldInstruction.first);
+			ASSERT_EQ(BreakPoint::breakPointInstruction, value);
+		}
+
+		for (const auto& oldInstruction : oldInstructions)
+		{
+			breakPoint.RemoveBreakPoint(
+			    {hSimulatedProcess,
+			     reinterpret_cast<void*>(oldInstruction.second)},
+			    oldInstruction.first);
+		}
+		std::vector<unsigned char> buffer(2 * pageSize);
+		processMemory->Read(
+		    hSimulatedProcess, SimulatedBaseOfImage, buffer.data(), buffer.size());
+		ASSERT_EQ(std::vector<unsigned char>(buffer.size(), SimulatedInstruction),
+		          buffer);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(BreakPointTest, ReadInstructionsSimulatedProcessMemory)
+	{
+		auto processMemory = CreateSimulatedProcessMemory(4096);
+		BreakPoint breakPoint{processMemory};
+
+		auto oldInstructions = breakPoint.ReadInstructions(
+		    hSimulatedProcess, {SimulatedBaseOfImage, SimulatedBaseOfImage + 2});
+		ASSERT_EQ(2, oldInstructions.size());
+		ASSERT_EQ(1, processMemory->GetStatistics().readCount_);
+		ASSERT_EQ(0, processMemory->GetStatistics().writeCount_);
+	}
+}
@@ -161,6 +161,21 @@ namespace CppCoverageTest
 		CheckLineHasBeenExecuted(mergedFile, 3, true);
 	}
 
+	//-------------------------------------------------------------------------
+	TEST(CoverageDataMergerTest, FunctionGranularity)
+	{
+		auto coverageDatas = CreateCoverageDataCollection(2);
+
+		coverageDatas[0].AddModule(modulePath).AddFile(filePath).SetFunctionGranularity(true);
+		coverageDatas[1].AddModule(modulePath).AddFile(filePath).SetFunctionGranularity(true);
+		auto coverageDataMerged = cov::CoverageDataMerger{}.Merge(coverageDatas);
+		ASSERT_TRUE(coverageDataMerged.GetModules().at(0)->GetFiles().at(0)->IsFunctionGranularity());
+
+		coverageDatas[1].AddModule(modulePath).AddFile(filePath);
+		coverageDataMerged = cov::CoverageDataMerger{}.Merge(coverageDatas);
+		ASSERT_FALSE(coverageDataMerged.GetModules().at(0)->GetFiles().at(0)->IsFunctionGranularity());
+	}
+
 	//-------------------------------------------------------------------------
 	TEST(CoverageDataMergerTest, MergeFileCoverageEmpty)
 	{
@@ -0,0 +1,81 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include <filesystem>
+
+#include "CppCoverage/CoveredLines.hpp"
+#include "Plugin/Exporter/CoverageData.hpp"
+#include "Plugin/Exporter/ModuleCoverage.hpp"
+#include "Plugin/Exporter/FileCoverage.hpp"
+
+namespace cov = CppCoverage;
+namespace fs = std::filesystem;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		const fs::path modulePath1 = L"modulePath1";
+		const fs::path modulePath2 = L"modulePath2";
+		const fs::path filePath = L"filePath";
+
+		//---------------------------------------------------------------------
+		std::vector<Plugin::CoverageData> CreateCoverageDataCollection()
+		{
+			std::vector<Plugin::CoverageData> coverageDataCollection;
+
+			coverageDataCollection.emplace_back(Plugin::CoverageData{ L"", 0 });
+			auto& file1 = coverageDataCollection.back().AddModule(modulePath1).AddFile(filePath);
+			file1.AddLine(10, true);
+			file1.AddLine(5, false);
+			file1.AddLine(3, true);
+
+			coverageDataCollection.emplace_back(Plugin::CoverageData{ L"", 0 });
+			auto& file2 = coverageDataCollection.back().AddModule(modulePath2).AddFile(filePath);
+			file2.AddLine(5, true);
+			file2.AddLine(10, true);
+
+			return coverageDataCollection;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(CoveredLinesTest, ByModule)
+	{
+		cov::CoveredLines coveredLines{ CreateCoverageDataCollection(), false };
+
+		const auto* executedLines = coveredLines.GetExecutedLines(modulePath1, filePath);
+		ASSERT_NE(nullptr, executedLines);
+		ASSERT_EQ((std::vector<unsigned int>{ 3, 10 }), *executedLines);
+		ASSERT_EQ(nullptr, coveredLines.GetExecutedLines(L"otherModulePath", filePath));
+		ASSERT_EQ(nullptr, coveredLines.GetExecutedLines(modulePath1, L"otherFilePath"));
+		ASSERT_EQ(4, coveredLines.GetExecutedLineCount());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(CoveredLinesTest, AggregatedByFile)
+	{
+		cov::CoveredLines coveredLines{ CreateCoverageDataCollection(), true };
+
+		const auto* executedLines = coveredLines.GetExecutedLines(L"otherModulePath", filePath);
+		ASSERT_NE(nullptr, executedLines);
+		ASSERT_EQ((std::vector<unsigned int>{ 3, 5, 10 }), *executedLines);
+		ASSERT_EQ(3, coveredLines.GetExecutedLineCount());
+	}
+}
@@ -0,0 +1,37 @@
+// Source of LlvmDwarf5.exe: DWARF 5 debug information emitted by LLVM
+// with DW_FORM_addrx addresses and a function split in two address ranges.
+//
+// rustc -g -C dwarf-version=5 -C opt-level=1 -C panic=abort
+//       -C llvm-args=-basic-block-sections=all
+//       --remap-path-prefix <dir>=C:/LlvmDwarf5 --emit=obj LlvmDwarf5.rs
+// gcc -nostdlib -static -no-pie -Wl,-e,main LlvmDwarf5.o -o LlvmDwarf5
+//
+// The .debug_* sections of the ELF output are then copied into a PE file
+// with an image base of 0x400000.
+
+#![no_std]
+#![no_main]
+
+#[inline(never)]
+#[no_mangle]
+pub extern "C" fn add(a: i32, b: i32) -> i32 {
+    if a > b {
+        return a - b;
+    }
+    a + b
+}
+
+#[inline(never)]
+fn twice(a: i32) -> i32 {
+    add(a, a)
+}
+
+#[no_mangle]
+pub extern "C" fn main() -> i32 {
+    twice(3)
+}
+
+#[panic_handler]
+fn panic(_: &core::panic::PanicInfo) -> ! {
+    loop {}
+}
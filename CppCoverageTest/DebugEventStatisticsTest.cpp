@@ -0,0 +1,154 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#include "CppCoverage/DebugEventStatistics.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		using EventType = cov::DebugEventStatistics::EventType;
+
+		const DWORD ProcessId = 42;
+
+		//---------------------------------------------------------------------
+		void* ToAddress(DWORD64 address)
+		{
+			return reinterpret_cast<void*>(address);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventStatisticsTest, Histogram)
+	{
+		cov::DebugEventStatistics::Histogram histogram;
+
+		histogram.Add(std::chrono::nanoseconds{ 500 });
+		histogram.Add(std::chrono::microseconds{ 1 });
+		histogram.Add(std::chrono::microseconds{ 3 });
+		histogram.Add(std::chrono::hours{ 1 });
+
+		const auto& buckets = histogram.GetBuckets();
+		ASSERT_EQ(1, buckets[0]);
+		ASSERT_EQ(1, buckets[1]);
+		ASSERT_EQ(1, buckets[2]);
+		ASSERT_EQ(1, buckets.back());
+		ASSERT_EQ(4, histogram.GetCount());
+		ASSERT_EQ(std::chrono::hours{ 1 }, histogram.GetMax());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventStatisticsTest, BreakPointsByModule)
+	{
+		cov::DebugEventStatistics statistics;
+
+		statistics.OnLoadModule(ProcessId, ToAddress(0x1000), L"Module1");
+		statistics.OnLoadModule(ProcessId, ToAddress(0x5000), L"Module2");
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x1010));
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x5010));
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x5020));
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x10));
+		statistics.OnBreakPoint(ProcessId + 1, ToAddress(0x1010));
+
+		statistics.OnUnloadModule(ProcessId, ToAddress(0x5000));
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x5010));
+
+		// A module loaded again keeps its count.
+		statistics.OnLoadModule(ProcessId, ToAddress(0x8000), L"Module1");
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x8010));
+		statistics.OnExitProcess(ProcessId);
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x8010));
+
+		ASSERT_EQ(3, statistics.GetBreakPointCount(L"Module1"));
+		ASSERT_EQ(2, statistics.GetBreakPointCount(L"Module2"));
+		ASSERT_EQ(0, statistics.GetBreakPointCount(L"Module3"));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventStatisticsTest, WriteJson)
+	{
+		cov::DebugEventStatistics statistics;
+
+		statistics.AddDuration(EventType::BreakPoint, std::chrono::microseconds{ 3 });
+		statistics.AddDuration(EventType::Wait, std::chrono::microseconds{ 10 });
+		statistics.SetRunTime(std::chrono::seconds{ 1 });
+		statistics.OnLoadModule(ProcessId, ToAddress(0x1000), L"C:\\Dev\\\"Module\".dll");
+		statistics.OnBreakPoint(ProcessId, ToAddress(0x1010));
+
+		std::ostringstream ostr;
+		statistics.WriteJson(ostr);
+		auto json = ostr.str();
+
+		ASSERT_NE(std::string::npos, json.find("\"eventCount\": 1,"));
+		ASSERT_NE(std::string::npos, json.find("\"eventsPerSecond\": 1,"));
+		ASSERT_NE(std::string::npos, json.find("\"breakPointsPerSecond\": 1,"));
+		ASSERT_NE(std::string::npos, json.find(
+			"\"breakPoint\": {\"count\": 1, \"totalMicroseconds\": 3, \"maxMicroseconds\": 3, "
+			"\"buckets\": [0, 0, 1, 0"));
+		ASSERT_NE(std::string::npos, json.find(
+			"{\"path\": \"C:\\\\Dev\\\\\\\"Module\\\".dll\", \"count\": 1}"));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventStatisticsTest, ExceptionsByCode)
+	{
+		cov::DebugEventStatistics statistics;
+
+		statistics.AddExceptionDuration(EXCEPTION_ACCESS_VIOLATION, std::chrono::microseconds{ 3 });
+		statistics.AddExceptionDuration(EXCEPTION_ACCESS_VIOLATION, std::chrono::microseconds{ 5 });
+		statistics.AddExceptionDuration(0xE06D7363, std::chrono::microseconds{ 7 });
+
+		const auto& histograms = statistics.GetExceptionHistograms();
+		ASSERT_EQ(2, histograms.size());
+		ASSERT_EQ(2, histograms.at(EXCEPTION_ACCESS_VIOLATION).GetCount());
+		ASSERT_EQ(std::chrono::microseconds{ 8 }, histograms.at(EXCEPTION_ACCESS_VIOLATION).GetTotal());
+		ASSERT_EQ(1, histograms.at(0xE06D7363).GetCount());
+
+		std::ostringstream ostr;
+		statistics.WriteJson(ostr);
+		ASSERT_NE(std::string::npos, ostr.str().find(
+			"\"0xc0000005\": {\"count\": 2, \"totalMicroseconds\": 8,"));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventStatisticsTest, DISABLED_BenchmarkAddDuration)
+	{
+		const int eventCount = 10000000;
+		cov::DebugEventStatistics statistics;
+		statistics.OnLoadModule(ProcessId, ToAddress(0x1000), L"Module");
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < eventCount; ++i)
+		{
+			auto eventStart = std::chrono::steady_clock::now();
+			statistics.OnBreakPoint(ProcessId, ToAddress(0x1000 + i));
+			statistics.AddDuration(EventType::BreakPoint, std::chrono::steady_clock::now() - eventStart);
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "Statistics cost: " << elapsed.count() * 1e9 / eventCount
+			<< "ns by event" << std::endl;
+	}
+}
@@ -30,6 +30,7 @@ namespace CppCoverageTest
 		MOCK_METHOD3(OnLoadDll, void(HANDLE, HANDLE, const LOAD_DLL_DEBUG_INFO&));
 		MOCK_METHOD3(OnUnloadDll, void(HANDLE, HANDLE, const UNLOAD_DLL_DEBUG_INFO&));
 		MOCK_METHOD3(OnException, ExceptionType(HANDLE, HANDLE, const EXCEPTION_DEBUG_INFO&));
+		MOCK_METHOD1(ShouldDetach, bool(HANDLE));
 
 	private:
 		DebugEventsHandlerMock(const DebugEventsHandlerMock&) = delete;
@@ -0,0 +1,341 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "CppCoverage/CodeCoverageRunner.hpp"
+#include "CppCoverage/CoverageFilterSettings.hpp"
+#include "CppCoverage/CppCoverageException.hpp"
+#include "CppCoverage/DebugEventsReplayer.hpp"
+#include "CppCoverage/DebugEventTrace.hpp"
+#include "CppCoverage/Patterns.hpp"
+#include "CppCoverage/RunCoverageSettings.hpp"
+#include "CppCoverage/StartInfo.hpp"
+#include "Plugin/Exporter/CoverageData.hpp"
+#include "Plugin/Exporter/FileCoverage.hpp"
+#include "Plugin/Exporter/LineCoverage.hpp"
+#include "Plugin/Exporter/ModuleCoverage.hpp"
+#include "TestHelper/TemporaryPath.hpp"
+#include "Tools/SimulatedProcessMemory.hpp"
+#include "Tools/WarningManager.hpp"
+
+#include "DebugEventsMock.hpp"
+
+using testing::_;
+using testing::Invoke;
+using testing::Return;
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		const DWORD ProcessId = 42;
+		const DWORD ExitCode = 3;
+		const DWORD64 BaseOfImage = 0x400000;
+		const DWORD CodeRva = 0x1000;
+		const unsigned char Nop = 0x90;
+		const std::wstring ModulePath = L"Module.exe";
+		const std::wstring SourceFilePath = L"Source.cpp";
+
+		using EventType = cov::DebugEventTrace::EventType;
+
+		//---------------------------------------------------------------------
+		cov::DebugEventTrace::Event CreateTraceEvent(
+			EventType type,
+			DWORD64 address,
+			DWORD code = 0,
+			int32_t moduleIndex = cov::DebugEventTrace::NoModule)
+		{
+			return { type, ProcessId, 1, address, code, true, moduleIndex, {} };
+		}
+
+		//---------------------------------------------------------------------
+		// Header of a native x64 module.
+		cov::DebugEventTrace::Page CreateHeaderPage()
+		{
+			cov::DebugEventTrace::Page page{ 0, std::vector<unsigned char>(cov::DebugEventTrace::PageSize) };
+			IMAGE_DOS_HEADER dosHeader{};
+			IMAGE_NT_HEADERS64 ntHeaders{};
+
+			dosHeader.e_magic = IMAGE_DOS_SIGNATURE;
+			dosHeader.e_lfanew = sizeof(dosHeader);
+			ntHeaders.Signature = IMAGE_NT_SIGNATURE;
+			ntHeaders.FileHeader.Machine = IMAGE_FILE_MACHINE_AMD64;
+			std::memcpy(page.bytes_.data(), &dosHeader, sizeof(dosHeader));
+			std::memcpy(page.bytes_.data() + sizeof(dosHeader), &ntHeaders, sizeof(ntHeaders));
+			return page;
+		}
+
+		//---------------------------------------------------------------------
+		// One module with lineCount lines of one byte. Odd lines are executed.
+		cov::DebugEventTrace CreateTrace(unsigned long lineCount)
+		{
+			cov::DebugEventTrace trace;
+			cov::DebugEventTrace::Module module;
+			cov::DebugEventTrace::SourceFile sourceFile;
+
+			sourceFile.path_ = SourceFilePath;
+			for (unsigned long i = 0; i < lineCount; ++i)
+				sourceFile.lines_.emplace_back(i + 1, CodeRva + i, 0);
+			module.path_ = ModulePath;
+			module.sourceFiles_.push_back(std::move(sourceFile));
+
+			module.pages_.push_back(CreateHeaderPage());
+			for (DWORD rva = CodeRva; rva < CodeRva + lineCount; rva += cov::DebugEventTrace::PageSize)
+			{
+				module.pages_.push_back(
+					{ rva, std::vector<unsigned char>(cov::DebugEventTrace::PageSize, Nop) });
+			}
+			trace.modules_.push_back(std::move(module));
+
+			trace.events_.push_back(CreateTraceEvent(EventType::CreateProcess, BaseOfImage, 0, 0));
+			for (unsigned long i = 0; i < lineCount; i += 2)
+			{
+				trace.events_.push_back(CreateTraceEvent(
+					EventType::Exception, BaseOfImage + CodeRva + i, EXCEPTION_BREAKPOINT));
+			}
+			trace.events_.push_back(CreateTraceEvent(EventType::ExitProcess, 0, ExitCode));
+
+			return trace;
+		}
+
+		//---------------------------------------------------------------------
+		// Access to the first code page from another address.
+		cov::DebugEventTrace::Event CreateGuardPageEvent()
+		{
+			auto event = CreateTraceEvent(EventType::Exception, BaseOfImage, STATUS_GUARD_PAGE_VIOLATION);
+			event.exceptionInformation_ = { 8, BaseOfImage + CodeRva };
+			return event;
+		}
+
+		//---------------------------------------------------------------------
+		struct ReplaySettings
+		{
+			//-----------------------------------------------------------------
+			ReplaySettings()
+				: modulePatterns_{ false }
+				, sourcePatterns_{ false }
+			{
+				modulePatterns_.AddSelectedPatterns(ModulePath);
+				sourcePatterns_.AddSelectedPatterns(L"*");
+				settings_ = std::make_unique<cov::RunCoverageSettings>(
+					cov::StartInfo{ ModulePath },
+					cov::CoverageFilterSettings{ modulePatterns_, sourcePatterns_ },
+					std::vector<cov::UnifiedDiffSettings>{},
+					std::vector<std::wstring>{},
+					std::vector<cov::SubstitutePdbSourcePath>{});
+			}
+
+			cov::Patterns modulePatterns_;
+			cov::Patterns sourcePatterns_;
+			std::unique_ptr<cov::RunCoverageSettings> settings_;
+		};
+
+		//---------------------------------------------------------------------
+		Plugin::CoverageData ReplayCoverage(
+			const cov::DebugEventTrace& trace,
+			const cov::RunCoverageSettings& settings)
+		{
+			cov::CodeCoverageRunner codeCoverageRunner{ std::make_shared<Tools::WarningManager>() };
+
+			return codeCoverageRunner.ReplayCoverage(settings, trace);
+		}
+
+		//---------------------------------------------------------------------
+		void CheckOddLinesExecuted(const Plugin::CoverageData& coverageData, unsigned int lineCount)
+		{
+			ASSERT_EQ(static_cast<int>(ExitCode), coverageData.GetExitCode());
+			const auto& modules = coverageData.GetModules();
+			ASSERT_EQ(1, modules.size());
+			const auto& files = modules.front()->GetFiles();
+			ASSERT_EQ(1, files.size());
+
+			const auto& file = *files.front();
+			for (unsigned int lineNumber = 1; lineNumber <= lineCount; ++lineNumber)
+			{
+				const auto* line = file[lineNumber];
+				ASSERT_NE(nullptr, line);
+				ASSERT_EQ(lineNumber % 2 == 1, line->HasBeenExecuted());
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventsReplayerTest, SaveAndLoad)
+	{
+		TestHelper::TemporaryPath path;
+		auto trace = CreateTrace(10);
+		trace.events_.push_back(CreateGuardPageEvent());
+
+		cov::SaveDebugEventTrace(trace, path);
+		auto loadedTrace = cov::LoadDebugEventTrace(path);
+
+		ASSERT_EQ(trace.events_.size(), loadedTrace.events_.size());
+		for (size_t i = 0; i < trace.events_.size(); ++i)
+		{
+			const auto& event = trace.events_[i];
+			const auto& loadedEvent = loadedTrace.events_[i];
+			ASSERT_EQ(event.type_, loadedEvent.type_);
+			ASSERT_EQ(event.processId_, loadedEvent.processId_);
+			ASSERT_EQ(event.address_, loadedEvent.address_);
+			ASSERT_EQ(event.code_, loadedEvent.code_);
+			ASSERT_EQ(event.moduleIndex_, loadedEvent.moduleIndex_);
+			ASSERT_EQ(event.exceptionInformation_, loadedEvent.exceptionInformation_);
+		}
+
+		ASSERT_EQ(1, loadedTrace.modules_.size());
+		const auto& module = loadedTrace.modules_[0];
+		ASSERT_EQ(ModulePath, module.path_);
+		ASSERT_EQ(1, module.sourceFiles_.size());
+		ASSERT_EQ(SourceFilePath, module.sourceFiles_[0].path_);
+		ASSERT_EQ(10, module.sourceFiles_[0].lines_.size());
+		ASSERT_EQ(CodeRva + 9, module.sourceFiles_[0].lines_[9].virtualAddress_);
+		ASSERT_EQ(trace.modules_[0].pages_[1].bytes_, module.pages_[1].bytes_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventsReplayerTest, LoadInvalidTrace)
+	{
+		TestHelper::TemporaryPath path;
+		cov::SaveDebugEventTrace(CreateTrace(10), path);
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+		ASSERT_THROW(cov::LoadDebugEventTrace(path), cov::CppCoverageException);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventsReplayerTest, LoadInvalidCount)
+	{
+		TestHelper::TemporaryPath path;
+		cov::SaveDebugEventTrace(CreateTrace(10), path);
+
+		// Source file count of the first module after the magic, the version,
+		// the module count and the module path.
+		std::fstream fs{ path.GetPath(), std::ios::in | std::ios::out | std::ios::binary };
+		fs.seekp(3 * sizeof(uint32_t) + sizeof(uint32_t) + ModulePath.size() * sizeof(wchar_t));
+		uint32_t count = 0xFFFFFFFF;
+		fs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		fs.close();
+
+		ASSERT_THROW(cov::LoadDebugEventTrace(path), cov::CppCoverageException);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventsReplayerTest, Replay)
+	{
+		auto trace = CreateTrace(4);
+		trace.events_.insert(trace.events_.end() - 1, CreateGuardPageEvent());
+		cov::DebugEventsReplayer replayer{ trace };
+		DebugEventsHandlerMock handler;
+		HANDLE hReplayedProcess = nullptr;
+		auto baseOfImage = reinterpret_cast<void*>(BaseOfImage);
+
+		EXPECT_CALL(handler, OnCreateProcess(_)).WillOnce(
+			Invoke([&](const CREATE_PROCESS_DEBUG_INFO& processDebugInfo) {
+			hReplayedProcess = processDebugInfo.hProcess;
+			ASSERT_EQ(baseOfImage, processDebugInfo.lpBaseOfImage);
+			ASSERT_NE(nullptr, replayer.FindModule(hReplayedProcess, baseOfImage));
+			unsigned char instruction = 0;
+			replayer.GetProcessMemory()->Read(
+				hReplayedProcess, BaseOfImage + CodeRva, &instruction, sizeof(instruction));
+			ASSERT_EQ(Nop, instruction);
+		}));
+		EXPECT_CALL(handler, OnException(_, _, _)).Times(3).WillRepeatedly(
+			Invoke([&](HANDLE, HANDLE, const EXCEPTION_DEBUG_INFO& exceptionDebugInfo) {
+			const auto& exceptionRecord = exceptionDebugInfo.ExceptionRecord;
+			if (exceptionRecord.ExceptionCode == STATUS_GUARD_PAGE_VIOLATION)
+			{
+				EXPECT_EQ(2, exceptionRecord.NumberParameters);
+				EXPECT_EQ(BaseOfImage + CodeRva, exceptionRecord.ExceptionInformation[1]);
+				return cov::IDebugEventsHandler::ExceptionType::GuardPage;
+			}
+			auto address = reinterpret_cast<DWORD64>(exceptionRecord.ExceptionAddress);
+			EXPECT_GE(address, BaseOfImage + CodeRva);
+			EXPECT_LT(address, BaseOfImage + CodeRva + 4);
+			return cov::IDebugEventsHandler::ExceptionType::BreakPoint;
+		}));
+		EXPECT_CALL(handler, OnExitProcess(_, _, _));
+
+		ASSERT_EQ(trace.events_.size(), replayer.Replay(handler));
+		ASSERT_EQ(nullptr, replayer.FindModule(hReplayedProcess, baseOfImage));
+		ASSERT_EQ(static_cast<int>(ExitCode), replayer.GetExitCode());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventsReplayerTest, ReplayCoverage)
+	{
+		ReplaySettings replaySettings;
+
+		CheckOddLinesExecuted(ReplayCoverage(CreateTrace(4), *replaySettings.settings_), 4);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventsReplayerTest, ReplayLazyCoverage)
+	{
+		ReplaySettings replaySettings;
+		auto trace = CreateTrace(4);
+
+		replaySettings.settings_->SetLazyBreakPoints(true);
+		trace.events_.insert(trace.events_.begin() + 1, CreateGuardPageEvent());
+		CheckOddLinesExecuted(ReplayCoverage(trace, *replaySettings.settings_), 4);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugEventsReplayerTest, ReplayUnselectedModule)
+	{
+		ReplaySettings replaySettings;
+		auto trace = CreateTrace(4);
+		cov::DebugEventTrace::Module module;
+
+		module.path_ = L"Unselected.dll";
+		trace.modules_.push_back(module);
+		trace.events_.insert(trace.events_.begin() + 1,
+			CreateTraceEvent(EventType::LoadDll, 2 * BaseOfImage, 0, 1));
+		CheckOddLinesExecuted(ReplayCoverage(trace, *replaySettings.settings_), 4);
+	}
+
+	//-------------------------------------------------------------------------
+	// Each breakpoint event of the trace goes through
+	// CodeCoverageRunner::OnException. The replay of the same trace without
+	// breakpoint events measures the rest: module loading and coverage data.
+	TEST(DebugEventsReplayerTest, DISABLED_BenchmarkBreakPointDispatch)
+	{
+		ReplaySettings replaySettings;
+		auto trace = CreateTrace(1000000);
+		auto traceWithoutBreakPoints = trace;
+		traceWithoutBreakPoints.events_ = { trace.events_.front(), trace.events_.back() };
+
+		auto getReplaySeconds = [&](const cov::DebugEventTrace& replayedTrace) {
+			auto start = std::chrono::steady_clock::now();
+			ReplayCoverage(replayedTrace, *replaySettings.settings_);
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			return elapsed.count();
+		};
+		auto breakPointSeconds = getReplaySeconds(trace) - getReplaySeconds(traceWithoutBreakPoints);
+
+		auto breakPointCount = trace.events_.size() - traceWithoutBreakPoints.events_.size();
+		std::cout << breakPointCount << " breakpoints dispatched in " << breakPointSeconds << "s: "
+			<< breakPointCount / breakPointSeconds << " breakpoints/s" << std::endl;
+	}
+}
@@ -17,10 +17,14 @@
 #include "stdafx.h"
 
 #include <fstream>
+#include <set>
+#include <tuple>
 
 #include "CppCoverage/DebugInformationEnumerator.hpp"
+#include "CppCoverage/LineTableCache.hpp"
 #include "TestCoverageConsole/TestDebugInformationEnumerator.hpp"
 #include "TestCoverageConsole/TestCoverageConsole.hpp"
+#include "TestHelper/TemporaryPath.hpp"
 
 namespace CppCoverageTest
 {
@@ -57,6 +61,32 @@ namespace CppCoverageTest
 			std::vector<int> lines_;
 		};
 
+		//--------------------------------------------------------------------------
+		struct AllSourceFilesHandler : CppCoverage::IDebugInformationHandler
+		{
+			//--------------------------------------------------------------------------
+			bool IsSourceFileSelected(const std::filesystem::path&) override
+			{
+				return true;
+			}
+
+			//--------------------------------------------------------------------------
+			void OnSourceFile(const std::filesystem::path& path,
+			                  const std::vector<Line>& lines) override
+			{
+				paths_.push_back(path);
+				for (const auto& line : lines)
+				{
+					addresses_.push_back(line.virtualAddress_);
+					lines_.emplace(path, line.lineNumber_, line.virtualAddress_, line.symbolIndex_);
+				}
+			}
+
+			std::vector<std::filesystem::path> paths_;
+			std::vector<int64_t> addresses_;
+			std::multiset<std::tuple<std::filesystem::path, unsigned long, int64_t, unsigned long>> lines_;
+		};
+
 		//---------------------------------------------------------------------------
 		std::vector<int>
 		GetLineNumbersWithTag(const std::filesystem::path& path,
@@ -95,4 +125,64 @@ namespace CppCoverageTest
 
 		ASSERT_EQ(debugInformationHandler.lines_, lineWithDebugInfo);
 	}
-}
\ No newline at end of file
+
+	//-------------------------------------------------------------------------
+	TEST(DebugInformationEnumeratorTest, EnumerateWithLineTableCache)
+	{
+		TestHelper::TemporaryPath cacheFolder;
+		auto selectedPath =
+		    TestCoverageConsole::GetDebugInformationEnumeratorTestPath();
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		auto lineTableCache = std::make_shared<CppCoverage::LineTableCache>(
+		    cacheFolder, std::numeric_limits<std::uintmax_t>::max());
+		CppCoverage::DebugInformationEnumerator debugInformationEnumerator{
+		    {}, lineTableCache};
+
+		DebugInformationHandlerMock handlerWithoutCache{selectedPath.filename()};
+		ASSERT_TRUE(
+		    debugInformationEnumerator.Enumerate(binary, handlerWithoutCache));
+		ASSERT_FALSE(std::filesystem::is_empty(cacheFolder.GetPath()));
+
+		DebugInformationHandlerMock handlerWithCache{selectedPath.filename()};
+		ASSERT_TRUE(
+		    debugInformationEnumerator.Enumerate(binary, handlerWithCache));
+
+		ASSERT_EQ(handlerWithoutCache.selectedFullPath_,
+		          handlerWithCache.selectedFullPath_);
+		ASSERT_EQ(handlerWithoutCache.lines_, handlerWithCache.lines_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugInformationEnumeratorTest, EnumerateIsDeterministic)
+	{
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		CppCoverage::DebugInformationEnumerator debugInformationEnumerator{{}};
+		AllSourceFilesHandler handler1;
+		AllSourceFilesHandler handler2;
+
+		ASSERT_TRUE(debugInformationEnumerator.Enumerate(binary, handler1));
+		ASSERT_TRUE(debugInformationEnumerator.Enumerate(binary, handler2));
+
+		ASSERT_FALSE(handler1.paths_.empty());
+		ASSERT_EQ(handler1.paths_, handler2.paths_);
+		ASSERT_EQ(handler1.addresses_, handler2.addresses_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DebugInformationEnumeratorTest, SinglePass)
+	{
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		CppCoverage::DebugInformationEnumerator bySourceFileEnumerator{
+		    {}, nullptr, CppCoverage::LineEnumerationMode::BySourceFile};
+		CppCoverage::DebugInformationEnumerator singlePassEnumerator{
+		    {}, nullptr, CppCoverage::LineEnumerationMode::SinglePass};
+		AllSourceFilesHandler bySourceFileHandler;
+		AllSourceFilesHandler singlePassHandler;
+
+		ASSERT_TRUE(bySourceFileEnumerator.Enumerate(binary, bySourceFileHandler));
+		ASSERT_TRUE(singlePassEnumerator.Enumerate(binary, singlePassHandler));
+
+		ASSERT_EQ(bySourceFileHandler.paths_, singlePassHandler.paths_);
+		ASSERT_EQ(bySourceFileHandler.lines_, singlePassHandler.lines_);
+	}
+}
@@ -16,8 +16,12 @@
 
 #include "stdafx.h"
 
+#include <chrono>
+#include <iostream>
+
 #include "CppCoverage/StartInfo.hpp"
 #include "CppCoverage/Debugger.hpp"
+#include "CppCoverage/DebugEventStatistics.hpp"
 #include "TestCoverageConsole/TestCoverageConsole.hpp"
 
 #include "DebugEventsMock.hpp"
@@ -30,7 +34,7 @@ namespace CppCoverageTest
 	TEST(DebugerTest, Debug)
 	{		
 		cov::StartInfo startInfo{ TestCoverageConsole::GetOutputBinaryPath() };
-		cov::Debugger debugger{ false, false, false };
+		cov::Debugger debugger{ false, false, false, false };
 		DebugEventsHandlerMock debugEventsHandlerMock;
 
 		EXPECT_CALL(debugEventsHandlerMock, OnCreateProcess(testing::_));
@@ -39,9 +43,67 @@ namespace CppCoverageTest
 		EXPECT_CALL(debugEventsHandlerMock, OnUnloadDll(testing::_, testing::_, testing::_)).Times(testing::AnyNumber());
 		EXPECT_CALL(debugEventsHandlerMock, OnException(testing::_, testing::_, testing::_))
 			.WillRepeatedly(testing::Return(cov::IDebugEventsHandler::ExceptionType::NotHandled));
+		EXPECT_CALL(debugEventsHandlerMock, ShouldDetach(testing::_))
+			.WillRepeatedly(testing::Return(false));
 
 		debugger.Debug(startInfo, debugEventsHandlerMock);
 		ASSERT_EQ(0, debugger.GetRunningProcesses());
 		ASSERT_EQ(0, debugger.GetRunningThreads());
+
+		using EventType = cov::DebugEventStatistics::EventType;
+		const auto& statistics = debugger.GetStatistics();
+		ASSERT_EQ(1, statistics.GetHistogram(EventType::CreateProcess).GetCount());
+		ASSERT_EQ(1, statistics.GetHistogram(EventType::ExitProcess).GetCount());
+		ASSERT_NE(0, statistics.GetHistogram(EventType::Wait).GetCount());
 	}	
+
+	//-----------------------------------------------------------------------------
+	TEST(DebugerTest, Detach)
+	{
+		cov::StartInfo startInfo{ TestCoverageConsole::GetOutputBinaryPath() };
+		cov::Debugger debugger{ false, false, false, false };
+		DebugEventsHandlerMock debugEventsHandlerMock;
+
+		EXPECT_CALL(debugEventsHandlerMock, OnCreateProcess(testing::_));
+		EXPECT_CALL(debugEventsHandlerMock, OnLoadDll(testing::_, testing::_, testing::_)).Times(testing::AnyNumber());
+		EXPECT_CALL(debugEventsHandlerMock, OnException(testing::_, testing::_, testing::_))
+			.WillRepeatedly(testing::Return(cov::IDebugEventsHandler::ExceptionType::NotHandled));
+		EXPECT_CALL(debugEventsHandlerMock, ShouldDetach(testing::_)).WillRepeatedly(testing::Return(true));
+		EXPECT_CALL(debugEventsHandlerMock, OnExitProcess(testing::_, testing::_, testing::_));
+
+		ASSERT_EQ(0, debugger.Debug(startInfo, debugEventsHandlerMock));
+		ASSERT_EQ(0, debugger.GetRunningProcesses());
+		ASSERT_EQ(0, debugger.GetRunningThreads());
+	}
+
+	//-----------------------------------------------------------------------------
+	// Baseline of the breakpoints (traps) the debugger loop can handle per
+	// second, whatever the operating system backend.
+	TEST(DebugerTest, DISABLED_BenchmarkBreakPoints)
+	{
+		cov::StartInfo startInfo{ TestCoverageConsole::GetOutputBinaryPath() };
+		startInfo.AddArgument(TestCoverageConsole::TestBreakPointLoop);
+		cov::Debugger debugger{ false, false, false, false };
+		DebugEventsHandlerMock debugEventsHandlerMock;
+
+		EXPECT_CALL(debugEventsHandlerMock, OnCreateProcess(testing::_));
+		EXPECT_CALL(debugEventsHandlerMock, OnExitProcess(testing::_, testing::_, testing::_));
+		EXPECT_CALL(debugEventsHandlerMock, OnLoadDll(testing::_, testing::_, testing::_)).Times(testing::AnyNumber());
+		EXPECT_CALL(debugEventsHandlerMock, OnUnloadDll(testing::_, testing::_, testing::_)).Times(testing::AnyNumber());
+		EXPECT_CALL(debugEventsHandlerMock, OnException(testing::_, testing::_, testing::_))
+			.WillRepeatedly(testing::Return(cov::IDebugEventsHandler::ExceptionType::BreakPoint));
+		EXPECT_CALL(debugEventsHandlerMock, ShouldDetach(testing::_))
+			.WillRepeatedly(testing::Return(false));
+
+		debugger.Debug(startInfo, debugEventsHandlerMock);
+
+		using EventType = cov::DebugEventStatistics::EventType;
+		const auto& statistics = debugger.GetStatistics();
+		const auto& breakPoint = statistics.GetHistogram(EventType::BreakPoint);
+		auto runTime = std::chrono::duration<double>(statistics.GetRunTime()).count();
+
+		ASSERT_LE(static_cast<uint64_t>(TestCoverageConsole::BreakPointLoopCount), breakPoint.GetCount());
+		std::cout << breakPoint.GetCount() << " breakpoints in " << runTime << "s: "
+		          << breakPoint.GetCount() / runTime << " breakpoints/s" << std::endl;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include <tuple>
+
+#include "CppCoverage/DebugInformationEnumerator.hpp"
+#include "CppCoverage/DwarfDebugInformationEnumerator.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		struct LineRecorder : cov::IDebugInformationHandler
+		{
+			//-----------------------------------------------------------------
+			bool IsSourceFileSelected(const std::filesystem::path&) override
+			{
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			void OnSourceFile(const std::filesystem::path& path,
+			                  const std::vector<Line>& lines) override
+			{
+				for (const auto& line : lines)
+				{
+					lines_.emplace_back(path.filename().string(),
+					                    line.lineNumber_,
+					                    line.virtualAddress_,
+					                    line.symbolIndex_);
+					if (line.isFunctionEntry_)
+						functionEntries_.push_back(line.virtualAddress_);
+				}
+			}
+
+			std::vector<std::tuple<std::string, unsigned long, int64_t, unsigned long>> lines_;
+			std::vector<int64_t> functionEntries_;
+		};
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DwarfDebugInformationEnumeratorTest, LlvmDwarf5)
+	{
+		auto path = std::filesystem::path(PROJECT_DIR) / "Data" / "LlvmDwarf5.exe";
+		LineRecorder recorder;
+		ASSERT_TRUE(cov::DwarfDebugInformationEnumerator{}.Enumerate(path, recorder));
+
+		// The symbol indexes are the offsets of the DW_TAG_subprogram
+		// entries: the addresses use DW_FORM_addrx and panic has two
+		// address ranges.
+		const auto addFunction = 0x2dul;
+		const auto twiceFunction = 0x51ul;
+		const auto mainFunction = 0x6cul;
+		const auto panicFunction = 0x7bul;
+		using Row = std::tuple<std::string, unsigned long, int64_t, unsigned long>;
+		std::vector<Row> expectedLines = {Row{"LlvmDwarf5.rs", 18, 0x1000, addFunction},
+		                                  Row{"LlvmDwarf5.rs", 22, 0x100b, addFunction},
+		                                  Row{"LlvmDwarf5.rs", 26, 0x1010, twiceFunction},
+		                                  Row{"LlvmDwarf5.rs", 31, 0x1020, mainFunction},
+		                                  Row{"LlvmDwarf5.rs", 35, 0x1030, panicFunction},
+		                                  Row{"LlvmDwarf5.rs", 35, 0x1030, panicFunction},
+		                                  Row{"LlvmDwarf5.rs", 36, 0x1040, panicFunction}};
+		ASSERT_EQ(expectedLines, recorder.lines_);
+
+		std::vector<int64_t> expectedFunctionEntries = {0x1000, 0x1010, 0x1020, 0x1030, 0x1030};
+		ASSERT_EQ(expectedFunctionEntries, recorder.functionEntries_);
+	}
+}
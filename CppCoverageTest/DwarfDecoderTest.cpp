@@ -0,0 +1,540 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include <tuple>
+
+#include "CppCoverage/DwarfDecoder.hpp"
+#include "CppCoverage/CppCoverageException.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		const uint8_t DW_TAG_compile_unit = 0x11;
+		const uint8_t DW_TAG_subprogram = 0x2e;
+		const uint8_t DW_AT_name = 0x03;
+		const uint8_t DW_AT_stmt_list = 0x10;
+		const uint8_t DW_AT_low_pc = 0x11;
+		const uint8_t DW_AT_high_pc = 0x12;
+		const uint8_t DW_AT_comp_dir = 0x1b;
+		const uint8_t DW_AT_ranges = 0x55;
+		const uint8_t DW_AT_addr_base = 0x73;
+		const uint8_t DW_AT_rnglists_base = 0x74;
+		const uint8_t DW_FORM_addr = 0x01;
+		const uint8_t DW_FORM_data4 = 0x06;
+		const uint8_t DW_FORM_string = 0x08;
+		const uint8_t DW_FORM_udata = 0x0f;
+		const uint8_t DW_FORM_sec_offset = 0x17;
+		const uint8_t DW_FORM_addrx = 0x1b;
+		const uint8_t DW_FORM_line_strp = 0x1f;
+		const uint8_t DW_FORM_rnglistx = 0x23;
+		const uint8_t DW_FORM_addrx1 = 0x29;
+		const uint8_t DW_UT_compile = 0x01;
+		const uint8_t DW_RLE_end_of_list = 0x00;
+		const uint8_t DW_RLE_startx_length = 0x03;
+		const uint8_t DW_RLE_offset_pair = 0x04;
+		const uint8_t DW_RLE_base_address = 0x05;
+		const uint8_t DW_LNCT_path = 0x1;
+		const uint8_t DW_LNCT_directory_index = 0x2;
+		const uint8_t DW_LNS_copy = 0x01;
+		const uint8_t DW_LNS_advance_pc = 0x02;
+		const uint8_t DW_LNS_advance_line = 0x03;
+		const uint8_t DW_LNS_set_file = 0x04;
+		const uint8_t DW_LNS_negate_stmt = 0x06;
+		const uint8_t DW_LNE_end_sequence = 0x01;
+		const uint8_t DW_LNE_set_address = 0x02;
+
+		const int8_t LineBase = -5;
+		const uint8_t LineRange = 14;
+		const uint8_t OpcodeBase = 13;
+
+		//---------------------------------------------------------------------
+		class ByteWriter
+		{
+		  public:
+			//-----------------------------------------------------------------
+			ByteWriter& U8(uint8_t value)
+			{
+				bytes_.push_back(value);
+				return *this;
+			}
+
+			//-----------------------------------------------------------------
+			ByteWriter& Unsigned(uint64_t value, int size)
+			{
+				for (int i = 0; i < size; ++i)
+					U8(static_cast<uint8_t>(value >> (8 * i)));
+				return *this;
+			}
+
+			//-----------------------------------------------------------------
+			ByteWriter& ULEB128(uint64_t value)
+			{
+				do
+				{
+					auto byte = static_cast<uint8_t>(value & 0x7f);
+					value >>= 7;
+					U8(value ? byte | 0x80 : byte);
+				} while (value);
+				return *this;
+			}
+
+			//-----------------------------------------------------------------
+			ByteWriter& SLEB128(int64_t value)
+			{
+				for (;;)
+				{
+					auto byte = static_cast<uint8_t>(value & 0x7f);
+					value >>= 7;
+					if ((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40)))
+						return U8(byte);
+					U8(byte | 0x80);
+				}
+			}
+
+			//-----------------------------------------------------------------
+			ByteWriter& CString(const std::string& value)
+			{
+				bytes_.insert(bytes_.end(), value.begin(), value.end());
+				return U8(0);
+			}
+
+			//-----------------------------------------------------------------
+			ByteWriter& Bytes(const std::vector<unsigned char>& bytes)
+			{
+				bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+				return *this;
+			}
+
+			//-----------------------------------------------------------------
+			// 32-bit DWARF unit: the length is written before the content.
+			ByteWriter& Unit(const ByteWriter& content)
+			{
+				Unsigned(content.bytes_.size(), 4);
+				return Bytes(content.bytes_);
+			}
+
+			//-----------------------------------------------------------------
+			size_t GetSize() const
+			{
+				return bytes_.size();
+			}
+
+			//-----------------------------------------------------------------
+			cov::DwarfSection GetSection() const
+			{
+				return {bytes_.data(), bytes_.size()};
+			}
+
+			std::vector<unsigned char> bytes_;
+		};
+
+		//---------------------------------------------------------------------
+		class LineProgramWriter
+		{
+		  public:
+			//-----------------------------------------------------------------
+			LineProgramWriter& SetAddress(uint64_t address)
+			{
+				program_.U8(0).ULEB128(9).U8(DW_LNE_set_address).Unsigned(address, 8);
+				return *this;
+			}
+
+			//-----------------------------------------------------------------
+			LineProgramWriter& Advance(uint64_t addressAdvance, int lineAdvance)
+			{
+				program_.U8(static_cast<uint8_t>(
+				    (lineAdvance - LineBase) + LineRange * addressAdvance + OpcodeBase));
+				return *this;
+			}
+
+			//-----------------------------------------------------------------
+			LineProgramWriter& EndSequence(uint64_t addressAdvance)
+			{
+				program_.U8(DW_LNS_advance_pc).ULEB128(addressAdvance);
+				program_.U8(0).ULEB128(1).U8(DW_LNE_end_sequence);
+				return *this;
+			}
+
+			ByteWriter program_;
+		};
+
+		//---------------------------------------------------------------------
+		// Header fields after header_length and up to the file table.
+		ByteWriter CreateLineProgramParameters(int version)
+		{
+			ByteWriter parameters;
+
+			parameters.U8(1); // minimum_instruction_length
+			if (version >= 4)
+				parameters.U8(1); // maximum_operations_per_instruction
+			parameters.U8(1).U8(static_cast<uint8_t>(LineBase)).U8(LineRange).U8(OpcodeBase);
+			parameters.Bytes({0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1});
+			return parameters;
+		}
+
+		//---------------------------------------------------------------------
+		ByteWriter CreateLineProgramV4(const ByteWriter& program)
+		{
+			auto header = CreateLineProgramParameters(4);
+			header.CString("include").U8(0);
+			header.CString("main.cpp").ULEB128(0).ULEB128(0).ULEB128(0);
+			header.CString("helper.hpp").ULEB128(1).ULEB128(0).ULEB128(0);
+			header.CString("C:/lib/lib.hpp").ULEB128(0).ULEB128(0).ULEB128(0);
+			header.U8(0);
+
+			ByteWriter content;
+			content.Unsigned(4, 2).Unsigned(header.GetSize(), 4);
+			content.Bytes(header.bytes_).Bytes(program.bytes_);
+			return ByteWriter{}.Unit(content);
+		}
+
+		//---------------------------------------------------------------------
+		struct DwarfInfoV4
+		{
+			//-----------------------------------------------------------------
+			DwarfInfoV4()
+			{
+				debugAbbrev_.U8(1).U8(DW_TAG_compile_unit).U8(1);
+				debugAbbrev_.U8(DW_AT_stmt_list).U8(DW_FORM_sec_offset);
+				debugAbbrev_.U8(DW_AT_comp_dir).U8(DW_FORM_string).U8(0).U8(0);
+				debugAbbrev_.U8(2).U8(DW_TAG_subprogram).U8(0);
+				debugAbbrev_.U8(DW_AT_name).U8(DW_FORM_string);
+				debugAbbrev_.U8(DW_AT_low_pc).U8(DW_FORM_addr);
+				debugAbbrev_.U8(DW_AT_high_pc).U8(DW_FORM_data4).U8(0).U8(0);
+				debugAbbrev_.U8(3).U8(DW_TAG_subprogram).U8(0);
+				debugAbbrev_.U8(DW_AT_low_pc).U8(DW_FORM_addr);
+				debugAbbrev_.U8(DW_AT_high_pc).U8(DW_FORM_addr).U8(0).U8(0);
+				debugAbbrev_.U8(4).U8(DW_TAG_subprogram).U8(0);
+				debugAbbrev_.U8(DW_AT_ranges).U8(DW_FORM_sec_offset).U8(0).U8(0);
+				debugAbbrev_.U8(0);
+			}
+
+			//-----------------------------------------------------------------
+			void AddCompileUnit(uint64_t stmtList, const std::string& compilationDirectory)
+			{
+				unit_.Unsigned(4, 2).Unsigned(0, 4).U8(8);
+				unit_.U8(1).Unsigned(stmtList, 4).CString(compilationDirectory);
+			}
+
+			//-----------------------------------------------------------------
+			// Return the offset of the debug information entry in .debug_info.
+			unsigned long AddFunction(uint64_t address, uint32_t size)
+			{
+				auto offset = GetOffset();
+				unit_.U8(2).CString("function").Unsigned(address, 8).Unsigned(size, 4);
+				return offset;
+			}
+
+			//-----------------------------------------------------------------
+			unsigned long AddFunctionWithHighPc(uint64_t lowPc, uint64_t highPc)
+			{
+				auto offset = GetOffset();
+				unit_.U8(3).Unsigned(lowPc, 8).Unsigned(highPc, 8);
+				return offset;
+			}
+
+			//-----------------------------------------------------------------
+			unsigned long AddFunctionWithRanges(uint64_t rangesOffset)
+			{
+				auto offset = GetOffset();
+				unit_.U8(4).Unsigned(rangesOffset, 4);
+				return offset;
+			}
+
+			//-----------------------------------------------------------------
+			ByteWriter CreateDebugInfo() const
+			{
+				auto unit = unit_;
+				return ByteWriter{}.Unit(unit.U8(0));
+			}
+
+			//-----------------------------------------------------------------
+			unsigned long GetOffset() const
+			{
+				// The unit length is written before the unit content.
+				return static_cast<unsigned long>(unit_.GetSize() + 4);
+			}
+
+			ByteWriter debugAbbrev_;
+			ByteWriter unit_;
+		};
+
+		//---------------------------------------------------------------------
+		struct DwarfRecorder : cov::IDwarfHandler
+		{
+			//-----------------------------------------------------------------
+			void OnFunction(uint64_t address, uint64_t size, unsigned long id) override
+			{
+				functions_.emplace_back(address, size, id);
+			}
+
+			//-----------------------------------------------------------------
+			void OnFiles(const std::vector<std::string>& paths) override
+			{
+				paths_ = paths;
+			}
+
+			//-----------------------------------------------------------------
+			void OnLine(size_t fileIndex, unsigned long lineNumber, uint64_t address) override
+			{
+				lines_.emplace_back(paths_.at(fileIndex), lineNumber, address);
+			}
+
+			std::vector<std::string> paths_;
+			std::vector<std::tuple<uint64_t, uint64_t, unsigned long>> functions_;
+			std::vector<std::tuple<std::string, unsigned long, uint64_t>> lines_;
+		};
+
+		//---------------------------------------------------------------------
+		DwarfRecorder Decode(const cov::DwarfSections& sections)
+		{
+			DwarfRecorder recorder;
+			cov::DwarfDecoder{sections}.Decode(recorder);
+			return recorder;
+		}
+
+		//---------------------------------------------------------------------
+		std::vector<unsigned long> AddFunctions(DwarfInfoV4& dwarfInfo)
+		{
+			std::vector<unsigned long> ids;
+
+			dwarfInfo.AddCompileUnit(0, "C:/src");
+			ids.push_back(dwarfInfo.AddFunction(0x401000, 0x20));
+			// Function discarded by the linker.
+			dwarfInfo.AddFunction(0, 0x10);
+			ids.push_back(dwarfInfo.AddFunctionWithHighPc(0x401020, 0x401050));
+			return ids;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DwarfDecoderTest, Functions)
+	{
+		DwarfInfoV4 dwarfInfo;
+		auto ids = AddFunctions(dwarfInfo);
+		auto debugInfo = dwarfInfo.CreateDebugInfo();
+
+		cov::DwarfSections sections;
+		sections.debugInfo_ = debugInfo.GetSection();
+		sections.debugAbbrev_ = dwarfInfo.debugAbbrev_.GetSection();
+		auto recorder = Decode(sections);
+
+		ASSERT_EQ(2, recorder.functions_.size());
+		ASSERT_EQ(std::make_tuple(0x401000ull, 0x20ull, ids[0]), recorder.functions_[0]);
+		ASSERT_EQ(std::make_tuple(0x401020ull, 0x30ull, ids[1]), recorder.functions_[1]);
+		ASSERT_TRUE(recorder.lines_.empty());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DwarfDecoderTest, FunctionRangesV4)
+	{
+		ByteWriter debugRanges;
+		debugRanges.Unsigned(0x401000, 8).Unsigned(0x401010, 8);
+		// Base address selection entry.
+		debugRanges.Unsigned(~0ull, 8).Unsigned(0x402000, 8);
+		debugRanges.Unsigned(0x20, 8).Unsigned(0x28, 8);
+		debugRanges.Unsigned(0, 8).Unsigned(0, 8);
+
+		DwarfInfoV4 dwarfInfo;
+		dwarfInfo.AddCompileUnit(0, "C:/src");
+		auto id = dwarfInfo.AddFunctionWithRanges(0);
+		auto debugInfo = dwarfInfo.CreateDebugInfo();
+
+		cov::DwarfSections sections;
+		sections.debugInfo_ = debugInfo.GetSection();
+		sections.debugAbbrev_ = dwarfInfo.debugAbbrev_.GetSection();
+		sections.debugRanges_ = debugRanges.GetSection();
+		auto recorder = Decode(sections);
+
+		using Function = std::tuple<uint64_t, uint64_t, unsigned long>;
+		std::vector<Function> expectedFunctions = {Function{0x401000, 0x10, id},
+		                                           Function{0x402020, 0x8, id}};
+		ASSERT_EQ(expectedFunctions, recorder.functions_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DwarfDecoderTest, FunctionAddressIndexesV5)
+	{
+		ByteWriter debugAbbrev;
+		// DW_AT_addr_base follows DW_AT_low_pc as in the units of clang.
+		debugAbbrev.U8(1).U8(DW_TAG_compile_unit).U8(1);
+		debugAbbrev.U8(DW_AT_low_pc).U8(DW_FORM_addrx);
+		debugAbbrev.U8(DW_AT_addr_base).U8(DW_FORM_sec_offset);
+		debugAbbrev.U8(DW_AT_rnglists_base).U8(DW_FORM_sec_offset).U8(0).U8(0);
+		debugAbbrev.U8(2).U8(DW_TAG_subprogram).U8(0);
+		debugAbbrev.U8(DW_AT_low_pc).U8(DW_FORM_addrx1);
+		debugAbbrev.U8(DW_AT_high_pc).U8(DW_FORM_data4).U8(0).U8(0);
+		debugAbbrev.U8(3).U8(DW_TAG_subprogram).U8(0);
+		debugAbbrev.U8(DW_AT_ranges).U8(DW_FORM_rnglistx).U8(0).U8(0);
+		debugAbbrev.U8(0);
+
+		ByteWriter addresses;
+		addresses.Unsigned(0x401000, 8).Unsigned(0x401100, 8).Unsigned(0x403000, 8);
+		ByteWriter debugAddr;
+		debugAddr.Unit(ByteWriter{}.Unsigned(5, 2).U8(8).U8(0).Bytes(addresses.bytes_));
+		const uint64_t addressBase = 8;
+
+		ByteWriter rangeList;
+		rangeList.U8(DW_RLE_offset_pair).ULEB128(0x200).ULEB128(0x210);
+		rangeList.U8(DW_RLE_startx_length).ULEB128(2).ULEB128(0x30);
+		rangeList.U8(DW_RLE_base_address).Unsigned(0x404000, 8);
+		rangeList.U8(DW_RLE_offset_pair).ULEB128(0x10).ULEB128(0x18);
+		rangeList.U8(DW_RLE_end_of_list);
+		ByteWriter debugRngLists;
+		debugRngLists.Unit(ByteWriter{}
+		                       .Unsigned(5, 2)
+		                       .U8(8)
+		                       .U8(0)
+		                       .Unsigned(1, 4) // offset_entry_count
+		                       .Unsigned(4, 4) // Offset of the range list.
+		                       .Bytes(rangeList.bytes_));
+		const uint64_t rangeListsBase = 12;
+
+		ByteWriter unit;
+		unit.Unsigned(5, 2).U8(DW_UT_compile).U8(8).Unsigned(0, 4);
+		unit.U8(1).ULEB128(0).Unsigned(addressBase, 4).Unsigned(rangeListsBase, 4);
+		auto id1 = static_cast<unsigned long>(unit.GetSize() + 4);
+		unit.U8(2).U8(1).Unsigned(0x40, 4);
+		auto id2 = static_cast<unsigned long>(unit.GetSize() + 4);
+		unit.U8(3).ULEB128(0);
+		unit.U8(0);
+		auto debugInfo = ByteWriter{}.Unit(unit);
+
+		cov::DwarfSections sections;
+		sections.debugInfo_ = debugInfo.GetSection();
+		sections.debugAbbrev_ = debugAbbrev.GetSection();
+		sections.debugAddr_ = debugAddr.GetSection();
+		sections.debugRngLists_ = debugRngLists.GetSection();
+		auto recorder = Decode(sections);
+
+		// The offset pairs are relative to the low_pc of the compile unit.
+		using Function = std::tuple<uint64_t, uint64_t, unsigned long>;
+		std::vector<Function> expectedFunctions = {Function{0x401100, 0x40, id1},
+		                                           Function{0x401200, 0x10, id2},
+		                                           Function{0x403000, 0x30, id2},
+		                                           Function{0x404010, 0x8, id2}};
+		ASSERT_EQ(expectedFunctions, recorder.functions_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DwarfDecoderTest, LinesV4)
+	{
+		DwarfInfoV4 dwarfInfo;
+		auto ids = AddFunctions(dwarfInfo);
+		auto debugInfo = dwarfInfo.CreateDebugInfo();
+
+		LineProgramWriter writer;
+		writer.SetAddress(0x401000);
+		writer.program_.U8(DW_LNS_advance_line).SLEB128(9).U8(DW_LNS_copy);
+		writer.Advance(4, 1);
+		writer.program_.U8(DW_LNS_set_file).ULEB128(2);
+		writer.program_.U8(DW_LNS_advance_line).SLEB128(-7);
+		writer.Advance(2, 0);
+		writer.program_.U8(DW_LNS_negate_stmt);
+		writer.Advance(2, 1);
+		writer.program_.U8(DW_LNS_negate_stmt).U8(DW_LNS_set_file).ULEB128(3);
+		writer.Advance(3, 2);
+		writer.EndSequence(5);
+		// Sequence of a function discarded by the linker.
+		writer.SetAddress(0).Advance(0, 1).EndSequence(4);
+		auto debugLine = CreateLineProgramV4(writer.program_);
+
+		cov::DwarfSections sections;
+		sections.debugInfo_ = debugInfo.GetSection();
+		sections.debugAbbrev_ = dwarfInfo.debugAbbrev_.GetSection();
+		sections.debugLine_ = debugLine.GetSection();
+		auto recorder = Decode(sections);
+
+		using Row = std::tuple<std::string, unsigned long, uint64_t>;
+		std::vector<std::string> expectedPaths = {
+		    "", "C:/src/main.cpp", "C:/src/include/helper.hpp", "C:/lib/lib.hpp"};
+		std::vector<Row> expectedLines = {Row{"C:/src/main.cpp", 10, 0x401000},
+		                                  Row{"C:/src/main.cpp", 11, 0x401004},
+		                                  Row{"C:/src/include/helper.hpp", 4, 0x401006},
+		                                  Row{"C:/lib/lib.hpp", 7, 0x40100B}};
+		ASSERT_EQ(expectedPaths, recorder.paths_);
+		ASSERT_EQ(expectedLines, recorder.lines_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DwarfDecoderTest, LinesV5)
+	{
+		ByteWriter debugLineStr;
+		auto compilationDirectory = debugLineStr.GetSize();
+		debugLineStr.CString("/home/user/src");
+		auto includeDirectory = debugLineStr.GetSize();
+		debugLineStr.CString("include");
+		auto mainFile = debugLineStr.GetSize();
+		debugLineStr.CString("main.cpp");
+		auto helperFile = debugLineStr.GetSize();
+		debugLineStr.CString("helper.hpp");
+
+		auto header = CreateLineProgramParameters(5);
+		header.U8(1).U8(DW_LNCT_path).U8(DW_FORM_line_strp);
+		header.ULEB128(2).Unsigned(compilationDirectory, 4).Unsigned(includeDirectory, 4);
+		header.U8(2).U8(DW_LNCT_path).U8(DW_FORM_line_strp);
+		header.U8(DW_LNCT_directory_index).U8(DW_FORM_udata);
+		header.ULEB128(3);
+		header.Unsigned(mainFile, 4).ULEB128(0);
+		header.Unsigned(mainFile, 4).ULEB128(0);
+		header.Unsigned(helperFile, 4).ULEB128(1);
+
+		LineProgramWriter writer;
+		writer.SetAddress(0x1400);
+		writer.program_.U8(DW_LNS_advance_line).SLEB128(4).U8(DW_LNS_copy);
+		writer.program_.U8(DW_LNS_set_file).ULEB128(2);
+		writer.program_.U8(DW_LNS_advance_line).SLEB128(14);
+		writer.Advance(8, 6);
+		writer.EndSequence(2);
+
+		ByteWriter content;
+		content.Unsigned(5, 2).U8(8).U8(0).Unsigned(header.GetSize(), 4);
+		content.Bytes(header.bytes_).Bytes(writer.program_.bytes_);
+		auto debugLine = ByteWriter{}.Unit(content);
+
+		cov::DwarfSections sections;
+		sections.debugLine_ = debugLine.GetSection();
+		sections.debugLineStr_ = debugLineStr.GetSection();
+		auto recorder = Decode(sections);
+
+		using Row = std::tuple<std::string, unsigned long, uint64_t>;
+		std::vector<std::string> expectedPaths = {"/home/user/src/main.cpp",
+		                                          "/home/user/src/main.cpp",
+		                                          "/home/user/src/include/helper.hpp"};
+		std::vector<Row> expectedLines = {Row{"/home/user/src/main.cpp", 5, 0x1400},
+		                                  Row{"/home/user/src/include/helper.hpp", 25, 0x1408}};
+		ASSERT_EQ(expectedPaths, recorder.paths_);
+		ASSERT_EQ(expectedLines, recorder.lines_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(DwarfDecoderTest, TruncatedSection)
+	{
+		LineProgramWriter writer;
+		writer.SetAddress(0x401000).Advance(1, 1).EndSequence(1);
+		auto debugLine = CreateLineProgramV4(writer.program_);
+		debugLine.bytes_.resize(debugLine.bytes_.size() - 3);
+
+		cov::DwarfSections sections;
+		sections.debugLine_ = debugLine.GetSection();
+		ASSERT_THROW(Decode(sections), cov::CppCoverageException);
+	}
+}
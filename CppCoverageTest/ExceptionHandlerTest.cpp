@@ -38,7 +38,7 @@ namespace CppCoverageTest
 			void Run(const std::wstring& commandLineArgument)
 			{
 				cov::StartInfo startInfo{ TestCoverageConsole::GetOutputBinaryPath() };
-				cov::Debugger debugger{ false, false, false };
+				cov::Debugger debugger{ false, false, false, false };
 
 				startInfo.AddArgument(commandLineArgument);
 				debugger.Debug(startInfo, *this);
@@ -116,6 +116,18 @@ namespace CppCoverageTest
 		ASSERT_NE(std::string::npos, message.find(cov::ExceptionHandler::ExceptionUnknown));
 	}
 
+	//-----------------------------------------------------------------------------
+	TEST_F(ExceptionHandlerTest, FormatUnhandledException)
+	{
+		auto exceptionDebugInfo = CreateExceptionDebugInfo(EXCEPTION_ACCESS_VIOLATION, false);
+
+		ASSERT_EQ(cov::ExceptionHandlerStatus::Error, handler_.HandleException(nullptr, exceptionDebugInfo));
+
+		std::wostringstream message;
+		handler_.FormatUnhandledException(exceptionDebugInfo.ExceptionRecord, message);
+		ASSERT_NE(std::string::npos, message.str().find(cov::ExceptionHandler::ExceptionAccesViolation));
+	}
+
 	//-----------------------------------------------------------------------------
 	TEST_F(ExceptionHandlerTest, ChildProcess)
 	{
@@ -148,4 +160,13 @@ namespace CppCoverageTest
 		ASSERT_EQ(cov::ExceptionHandlerStatus::FirstChanceException,
 			handler_.HandleException(handle, exceptionDebugInfo, ostr_));
 	}
-}
\ No newline at end of file
+
+	//-----------------------------------------------------------------------------
+	TEST_F(ExceptionHandlerTest, IsBreakPointExceptionCode)
+	{
+		ASSERT_TRUE(cov::ExceptionHandler::IsBreakPointExceptionCode(EXCEPTION_BREAKPOINT));
+		ASSERT_TRUE(cov::ExceptionHandler::IsBreakPointExceptionCode(
+			cov::ExceptionHandler::ExceptionEmulationX86ErrorCode));
+		ASSERT_FALSE(cov::ExceptionHandler::IsBreakPointExceptionCode(EXCEPTION_ACCESS_VIOLATION));
+	}
+}
@@ -38,6 +38,12 @@ namespace CppCoverageTest
 			return cov::Address{ nullptr, reinterpret_cast<void*>(addressValue) };
 		}
 
+		//-------------------------------------------------------------------------
+		cov::Address CreateAddress(HANDLE hProcess, DWORD64 addressValue)
+		{
+			return cov::Address{ hProcess, reinterpret_cast<void*>(addressValue) };
+		}
+
 		#pragma warning(pop)
 	}
 
@@ -85,7 +91,7 @@ namespace CppCoverageTest
 		manager.MarkAddressAsExecuted(address2);
 		manager.OnExitProcess(hProcess);
 
-		const Plugin::CoverageData coverageData = manager.CreateCoverageData(L"", 0);
+		const Plugin::CoverageData coverageData = manager.CreateCoverageData(L"", 0, false);
 		
 		const auto& modules = coverageData.GetModules();
 		ASSERT_EQ(1, modules.size());
@@ -98,6 +104,7 @@ namespace CppCoverageTest
 
 		const auto& file = *files.front();
 		ASSERT_EQ(filename, file.GetPath());
+		ASSERT_FALSE(file.IsFunctionGranularity());
 
 		const auto* line42 = file[42];
 		const auto* line43 = file[43];
@@ -120,11 +127,173 @@ namespace CppCoverageTest
 		manager.AddModule(moduleName2, nullptr);
 		manager.AddModule(moduleName1, nullptr);
 
-		auto coverageData = manager.CreateCoverageData(L"", 0);
+		auto coverageData = manager.CreateCoverageData(L"", 0, false);
 
 		const auto& modules = coverageData.GetModules();
 		ASSERT_EQ(2, modules.size());
 		ASSERT_EQ(moduleName1, modules.at(0)->GetPath().wstring());
 		ASSERT_EQ(moduleName2, modules.at(1)->GetPath().wstring());
 	}
-}
\ No newline at end of file
+
+	//-------------------------------------------------------------------------
+	TEST(ExecutedAddressManagerTest, SeveralModules)
+	{
+		cov::ExecutedAddressManager manager;
+		auto hProcess1 = reinterpret_cast<HANDLE>(1);
+		auto hProcess2 = reinterpret_cast<HANDLE>(2);
+		const DWORD64 baseOfImage1 = 0x10000;
+		const DWORD64 baseOfImage2 = 0x20000;
+
+		manager.AddModule(L"module1", reinterpret_cast<void*>(baseOfImage1));
+		ASSERT_TRUE(manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage1 + 0x10), L"file1", 1, 10));
+		ASSERT_FALSE(manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage1 + 0x10), L"file1", 2, 10));
+		ASSERT_THROW(manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage1 - 1), L"file1", 3, 10),
+			cov::CppCoverageException);
+
+		manager.AddModule(L"module2", reinterpret_cast<void*>(baseOfImage2));
+		ASSERT_TRUE(manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage2 + 0x10), L"file2", 1, 20));
+		ASSERT_TRUE(manager.RegisterAddress(CreateAddress(hProcess2, baseOfImage2 + 0x10), L"file2", 1, 21));
+
+		ASSERT_EQ(10, manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage1 + 0x10)));
+		ASSERT_EQ(20, manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage2 + 0x10)));
+		ASSERT_EQ(21, manager.MarkAddressAsExecuted(CreateAddress(hProcess2, baseOfImage2 + 0x10)));
+		ASSERT_FALSE(manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage1 + 0x11)));
+		ASSERT_FALSE(manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage1 - 1)));
+
+		ASSERT_EQ(1, manager.OnUnloadModule(hProcess1, reinterpret_cast<void*>(baseOfImage2)));
+		ASSERT_EQ(0, manager.OnUnloadModule(hProcess1, reinterpret_cast<void*>(baseOfImage2)));
+		ASSERT_FALSE(manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage2 + 0x10)));
+		ASSERT_EQ(21, manager.MarkAddressAsExecuted(CreateAddress(hProcess2, baseOfImage2 + 0x10)));
+
+		ASSERT_EQ(1, manager.OnExitProcess(hProcess2));
+		ASSERT_FALSE(manager.MarkAddressAsExecuted(CreateAddress(hProcess2, baseOfImage2 + 0x10)));
+		ASSERT_EQ(10, manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage1 + 0x10)));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(ExecutedAddressManagerTest, NewLinesAfterFirstLookup)
+	{
+		cov::ExecutedAddressManager manager;
+		auto hProcess1 = reinterpret_cast<HANDLE>(1);
+		auto hProcess2 = reinterpret_cast<HANDLE>(2);
+		const std::wstring filename = L"file";
+
+		manager.AddModule(L"module", nullptr);
+		manager.RegisterAddress(CreateAddress(hProcess1, 10), filename, 10, 0);
+		manager.RegisterAddress(CreateAddress(hProcess1, 30), filename, 30, 0);
+		manager.MarkAddressAsExecuted(CreateAddress(hProcess1, 30));
+
+		manager.AddModule(L"module", nullptr);
+		manager.RegisterAddress(CreateAddress(hProcess2, 20), filename, 20, 0);
+		manager.RegisterAddress(CreateAddress(hProcess2, 30), filename, 30, 0);
+		manager.RegisterAddress(CreateAddress(hProcess2, 30), filename, 31, 0);
+		manager.MarkAddressAsExecuted(CreateAddress(hProcess2, 20));
+		manager.MarkAddressAsExecuted(CreateAddress(hProcess1, 10));
+
+		auto coverageData = manager.CreateCoverageData(L"", 0, false);
+		const auto& file = *coverageData.GetModules().at(0)->GetFiles().at(0);
+		std::vector<std::pair<unsigned int, bool>> lines;
+		for (const auto& line : file.GetLines())
+			lines.emplace_back(line.GetLineNumber(), line.HasBeenExecuted());
+
+		std::vector<std::pair<unsigned int, bool>> expectedLines{
+			{ 10, true }, { 20, true }, { 30, true }, { 31, false } };
+		ASSERT_EQ(expectedLines, lines);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(ExecutedAddressManagerTest, NewAddressesAfterFirstLookup)
+	{
+		cov::ExecutedAddressManager manager;
+		auto hProcess = reinterpret_cast<HANDLE>(1);
+		const std::wstring filename = L"file";
+
+		manager.AddModule(L"module", nullptr);
+		manager.RegisterAddress(CreateAddress(hProcess, 10), filename, 10, 0);
+		manager.RegisterAddress(CreateAddress(hProcess, 30), filename, 30, 3);
+		manager.MarkAddressAsExecuted(CreateAddress(hProcess, 10));
+
+		ASSERT_TRUE(manager.RegisterAddress(CreateAddress(hProcess, 40), filename, 40, 4));
+		ASSERT_FALSE(manager.RegisterAddress(CreateAddress(hProcess, 30), filename, 31, 0));
+		ASSERT_TRUE(manager.RegisterAddress(CreateAddress(hProcess, 20), filename, 20, 2));
+		ASSERT_TRUE(manager.RegisterAddress(CreateAddress(hProcess, 5), filename, 5, 0));
+		ASSERT_EQ(4, manager.GetArmedBreakPointCount(hProcess));
+
+		ASSERT_EQ(2, manager.MarkAddressAsExecuted(CreateAddress(hProcess, 20)));
+		ASSERT_EQ(3, manager.MarkAddressAsExecuted(CreateAddress(hProcess, 30)));
+		ASSERT_EQ(4, manager.MarkAddressAsExecuted(CreateAddress(hProcess, 40)));
+		ASSERT_EQ(1, manager.GetArmedBreakPointCount(hProcess));
+
+		auto coverageData = manager.CreateCoverageData(L"", 0, false);
+		const auto& file = *coverageData.GetModules().at(0)->GetFiles().at(0);
+		std::vector<std::pair<unsigned int, bool>> lines;
+		for (const auto& line : file.GetLines())
+			lines.emplace_back(line.GetLineNumber(), line.HasBeenExecuted());
+
+		std::vector<std::pair<unsigned int, bool>> expectedLines{
+			{ 5, false }, { 10, true }, { 20, true }, { 30, true }, { 31, true }, { 40, true } };
+		ASSERT_EQ(expectedLines, lines);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(ExecutedAddressManagerTest, ArmedBreakPointCount)
+	{
+		cov::ExecutedAddressManager manager;
+		auto hProcess1 = reinterpret_cast<HANDLE>(1);
+		auto hProcess2 = reinterpret_cast<HANDLE>(2);
+		const DWORD64 baseOfImage1 = 0x10000;
+		const DWORD64 baseOfImage2 = 0x20000;
+
+		manager.AddModule(L"module1", reinterpret_cast<void*>(baseOfImage1));
+		manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage1 + 0x10), L"file1", 1, 10);
+		manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage1 + 0x10), L"file1", 2, 10);
+		manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage1 + 0x20), L"file1", 3, 10);
+		manager.AddModule(L"module2", reinterpret_cast<void*>(baseOfImage2));
+		manager.RegisterAddress(CreateAddress(hProcess1, baseOfImage2 + 0x10), L"file2", 1, 20);
+		manager.RegisterAddress(CreateAddress(hProcess2, baseOfImage2 + 0x10), L"file2", 1, 20);
+
+		ASSERT_EQ(3, manager.GetArmedBreakPointCount(hProcess1));
+		ASSERT_EQ(1, manager.GetArmedBreakPointCount(hProcess2));
+
+		manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage1 + 0x10));
+		manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage1 + 0x10));
+		ASSERT_EQ(2, manager.GetArmedBreakPointCount(hProcess1));
+
+		manager.OnUnloadModule(hProcess1, reinterpret_cast<void*>(baseOfImage2));
+		ASSERT_EQ(1, manager.GetArmedBreakPointCount(hProcess1));
+		manager.MarkAddressAsExecuted(CreateAddress(hProcess1, baseOfImage1 + 0x20));
+		ASSERT_EQ(0, manager.GetArmedBreakPointCount(hProcess1));
+
+		manager.OnExitProcess(hProcess2);
+		ASSERT_EQ(0, manager.GetArmedBreakPointCount(hProcess2));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(ExecutedAddressManagerTest, InferredAddresses)
+	{
+		cov::ExecutedAddressManager manager;
+		const std::wstring filename = L"filename";
+		HANDLE hProcess = nullptr;
+
+		manager.AddModule(L"module", nullptr);
+		manager.RegisterInferredAddress(CreateAddress(1), filename, 10);
+		manager.RegisterAddress(CreateAddress(2), filename, 11, 0);
+		manager.RegisterDominator(CreateAddress(2), CreateAddress(1));
+		manager.RegisterInferredAddress(CreateAddress(3), filename, 12);
+		manager.RegisterDominator(CreateAddress(3), CreateAddress(1));
+		manager.RegisterAddress(CreateAddress(4), filename, 13, 0);
+		manager.RegisterDominator(CreateAddress(4), CreateAddress(3));
+		ASSERT_EQ(2, manager.GetArmedBreakPointCount(hProcess));
+
+		manager.MarkAddressAsExecuted(CreateAddress(2));
+		manager.OnExitProcess(hProcess);
+
+		// Executed addresses are kept after the process exits.
+		const auto coverageData = manager.CreateCoverageData(L"", 0, false);
+		const auto& file = *coverageData.GetModules().at(0)->GetFiles().at(0);
+		ASSERT_TRUE(file[10]->HasBeenExecuted());
+		ASSERT_TRUE(file[11]->HasBeenExecuted());
+		ASSERT_FALSE(file[12]->HasBeenExecuted());
+		ASSERT_FALSE(file[13]->HasBeenExecuted());
+	}
+}
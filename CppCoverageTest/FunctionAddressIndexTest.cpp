@@ -0,0 +1,120 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include <boost/optional/optional_io.hpp>
+
+#include "CppCoverage/FunctionAddressIndex.hpp"
+#include "CppCoverage/CppCoverageException.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		using OptionalIndex = boost::optional<unsigned long>;
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(FunctionAddressIndexTest, Find)
+	{
+		cov::FunctionAddressIndex index;
+
+		index.Add(0x2000, 0x10, 2);
+		index.Add(0x1000, 0x100, 1);
+		index.Add(0x3000, 0, 3);
+		ASSERT_THROW(index.Find(0x1000), cov::CppCoverageException);
+		index.Seal();
+		ASSERT_THROW(index.Add(0x4000, 0x10, 4), cov::CppCoverageException);
+
+		ASSERT_EQ(2, index.GetSize());
+		ASSERT_FALSE(index.Find(0xFFF));
+		ASSERT_EQ(OptionalIndex{1}, index.Find(0x1000));
+		ASSERT_EQ(OptionalIndex{1}, index.Find(0x10FF));
+		ASSERT_FALSE(index.Find(0x1100));
+		ASSERT_EQ(OptionalIndex{2}, index.Find(0x200F));
+		ASSERT_FALSE(index.Find(0x2010));
+		ASSERT_FALSE(index.Find(0x3000));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(FunctionAddressIndexTest, IsFunctionStart)
+	{
+		cov::FunctionAddressIndex index;
+
+		index.Add(0x2000, 0x10, 2);
+		index.Add(0x1000, 0x100, 1);
+		ASSERT_THROW(index.IsFunctionStart(0x1000), cov::CppCoverageException);
+		index.Seal();
+
+		ASSERT_TRUE(index.IsFunctionStart(0x1000));
+		ASSERT_TRUE(index.IsFunctionStart(0x2000));
+		ASSERT_FALSE(index.IsFunctionStart(0xFFF));
+		ASSERT_FALSE(index.IsFunctionStart(0x1001));
+		ASSERT_FALSE(index.IsFunctionStart(0x3000));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(FunctionAddressIndexTest, FoldedFunctions)
+	{
+		cov::FunctionAddressIndex index;
+
+		index.Add(0x1000, 0x10, 7);
+		index.Add(0x1000, 0x10, 5);
+		index.Seal();
+
+		ASSERT_EQ(1, index.GetSize());
+		ASSERT_EQ(OptionalIndex{5}, index.Find(0x1008));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(FunctionAddressIndexTest, DISABLED_BenchmarkFind)
+	{
+		const unsigned long functionCount = 100 * 1000;
+		const uint64_t functionSize = 0x100;
+		const size_t lineCount = 2 * 1000 * 1000;
+
+		cov::FunctionAddressIndex index;
+		for (unsigned long i = 0; i < functionCount; ++i)
+			index.Add(i * functionSize, functionSize - 0x10, i);
+
+		auto start = std::chrono::steady_clock::now();
+		index.Seal();
+		std::chrono::duration<double> sealTime = std::chrono::steady_clock::now() - start;
+
+		std::mt19937 generator;
+		std::uniform_int_distribution<uint64_t> distribution{0, functionCount * functionSize};
+		std::vector<uint64_t> addresses(lineCount);
+		for (auto& address : addresses)
+			address = distribution(generator);
+
+		size_t found = 0;
+		start = std::chrono::steady_clock::now();
+		for (auto address : addresses)
+			found += index.Find(address) ? 1 : 0;
+		std::chrono::duration<double> findTime = std::chrono::steady_clock::now() - start;
+
+		ASSERT_NE(0, found);
+		std::cout << functionCount << " functions, " << lineCount << " lines" << std::endl;
+		std::cout << "Seal " << sealTime.count() << "s, find " << findTime.count() << "s" << std::endl;
+	}
+}
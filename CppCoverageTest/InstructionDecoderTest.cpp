@@ -0,0 +1,160 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include "CppCoverage/InstructionDecoder.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		const uint64_t codeAddress = 0x180001000;
+
+		//---------------------------------------------------------------------
+		boost::optional<cov::DecodedInstruction>
+		Decode(bool is64Bit, const std::vector<unsigned char>& code)
+		{
+			return cov::InstructionDecoder{is64Bit}.Decode(code, 0, codeAddress);
+		}
+
+		//---------------------------------------------------------------------
+		size_t GetLength(bool is64Bit, const std::vector<unsigned char>& code)
+		{
+			auto instruction = Decode(is64Bit, code);
+			return instruction ? instruction->length_ : 0;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(InstructionDecoderTest, Length64)
+	{
+		// sub rsp, 28h
+		ASSERT_EQ(4, GetLength(true, {0x48, 0x83, 0xEC, 0x28}));
+		// mov qword ptr [rsp+8], rbx
+		ASSERT_EQ(5, GetLength(true, {0x48, 0x89, 0x5C, 0x24, 0x08}));
+		// mov dword ptr [rip+138F89h], 3
+		ASSERT_EQ(10, GetLength(true, {0xC7, 0x05, 0x89, 0x8F, 0x13, 0x00, 0x03, 0x00, 0x00, 0x00}));
+		// mov rax, 1122334455667788h
+		ASSERT_EQ(10, GetLength(true, {0x48, 0xB8, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11}));
+		// mov eax, dword ptr [1122334455667788h]
+		ASSERT_EQ(9, GetLength(true, {0xA1, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11}));
+		// test ecx, 1
+		ASSERT_EQ(6, GetLength(true, {0xF7, 0xC1, 0x01, 0x00, 0x00, 0x00}));
+		// nop word ptr [rax+rax]
+		ASSERT_EQ(6, GetLength(true, {0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00}));
+		// endbr64
+		ASSERT_EQ(4, GetLength(true, {0xF3, 0x0F, 0x1E, 0xFA}));
+		// pshufd xmm0, xmm1, 0
+		ASSERT_EQ(5, GetLength(true, {0x66, 0x0F, 0x70, 0xC1, 0x00}));
+		// vzeroupper
+		ASSERT_EQ(3, GetLength(true, {0xC5, 0xF8, 0x77}));
+		// vpextrd eax, xmm0, 1
+		ASSERT_EQ(6, GetLength(true, {0xC4, 0xE3, 0x79, 0x16, 0xC0, 0x01}));
+		// vmovups zmm0, zmmword ptr [rsp]
+		ASSERT_EQ(7, GetLength(true, {0x62, 0xF1, 0x7C, 0x48, 0x10, 0x04, 0x24}));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(InstructionDecoderTest, Length32)
+	{
+		// inc eax
+		ASSERT_EQ(1, GetLength(false, {0x40}));
+		// les eax, [esi]
+		ASSERT_EQ(2, GetLength(false, {0xC4, 0x06}));
+		// mov eax, dword ptr [11223344h]
+		ASSERT_EQ(5, GetLength(false, {0xA1, 0x44, 0x33, 0x22, 0x11}));
+		// mov eax, dword ptr [bp+si+10h]
+		ASSERT_EQ(4, GetLength(false, {0x67, 0x8B, 0x42, 0x10}));
+		// vzeroupper
+		ASSERT_EQ(3, GetLength(false, {0xC5, 0xF8, 0x77}));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(InstructionDecoderTest, ControlFlow)
+	{
+		// je $+13h
+		auto instruction = Decode(true, {0x74, 0x11});
+		ASSERT_TRUE(static_cast<bool>(instruction));
+		ASSERT_EQ(cov::InstructionKind::ConditionalBranch, instruction->kind_);
+		ASSERT_EQ(codeAddress + 0x13, instruction->target_.get_value_or(0));
+
+		// jmp $
+		instruction = Decode(true, {0xEB, 0xFE});
+		ASSERT_EQ(cov::InstructionKind::UnconditionalBranch, instruction->kind_);
+		ASSERT_EQ(codeAddress, instruction->target_.get_value_or(0));
+
+		// call $-1000h
+		instruction = Decode(true, {0xE8, 0xFB, 0xEF, 0xFF, 0xFF});
+		ASSERT_EQ(cov::InstructionKind::Call, instruction->kind_);
+		ASSERT_EQ(codeAddress - 0x1000, instruction->target_.get_value_or(0));
+
+		// jne $+100h
+		instruction = Decode(false, {0x0F, 0x85, 0xFA, 0x00, 0x00, 0x00});
+		ASSERT_EQ(cov::InstructionKind::ConditionalBranch, instruction->kind_);
+		ASSERT_EQ((codeAddress + 0x100) & 0xFFFFFFFF, instruction->target_.get_value_or(0));
+
+		// call qword ptr [rip+0FAFDFh]
+		instruction = Decode(true, {0xFF, 0x15, 0xDF, 0xAF, 0x0F, 0x00});
+		ASSERT_EQ(cov::InstructionKind::Call, instruction->kind_);
+		ASSERT_FALSE(instruction->target_);
+
+		// jmp qword ptr [rax*8+rcx]
+		ASSERT_EQ(cov::InstructionKind::IndirectBranch, Decode(true, {0xFF, 0x24, 0xC1})->kind_);
+		// ret 8
+		ASSERT_EQ(cov::InstructionKind::Return, Decode(true, {0xC2, 0x08, 0x00})->kind_);
+		// int 3
+		ASSERT_EQ(cov::InstructionKind::Trap, Decode(true, {0xCC})->kind_);
+		// ud2
+		ASSERT_EQ(cov::InstructionKind::Trap, Decode(true, {0x0F, 0x0B})->kind_);
+		// add rsp, 58h
+		ASSERT_EQ(cov::InstructionKind::Sequential, Decode(true, {0x48, 0x83, 0xC4, 0x58})->kind_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(InstructionDecoderTest, InvalidInstruction)
+	{
+		// Truncated call.
+		ASSERT_FALSE(Decode(true, {0xE8, 0x00, 0x00}));
+		// push es is not valid in 64 bits.
+		ASSERT_FALSE(Decode(true, {0x06}));
+		// Longer than 15 bytes.
+		ASSERT_FALSE(Decode(true, std::vector<unsigned char>(15, 0x66)));
+		// 16 bits relative jump.
+		ASSERT_FALSE(Decode(false, {0x66, 0xE9, 0x00, 0x00}));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(InstructionDecoderTest, Offset)
+	{
+		// Captured from msdia140.dll: sub rsp, 28h; mov edx, 10h; xor ecx, ecx
+		std::vector<unsigned char> code = {
+		    0x48, 0x83, 0xEC, 0x28, 0xBA, 0x10, 0x00, 0x00, 0x00, 0x33, 0xC9};
+		cov::InstructionDecoder instructionDecoder{true};
+		std::vector<size_t> lengths;
+
+		for (size_t offset = 0; offset < code.size();)
+		{
+			auto instruction = instructionDecoder.Decode(code, offset, codeAddress);
+			ASSERT_TRUE(static_cast<bool>(instruction));
+			lengths.push_back(instruction->length_);
+			offset += instruction->length_;
+		}
+		ASSERT_EQ((std::vector<size_t>{4, 5, 2}), lengths);
+	}
+}
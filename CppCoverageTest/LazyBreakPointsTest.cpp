@@ -0,0 +1,187 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+
+#include <set>
+
+#include <boost/optional.hpp>
+
+#include "CppCoverage/IPageMemory.hpp"
+#include "CppCoverage/LazyBreakPoints.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		const auto PageSize = cov::LazyBreakPoints::PageSize;
+		const HANDLE hProcess = reinterpret_cast<HANDLE>(1);
+		void* const baseOfImage = reinterpret_cast<void*>(0x10000);
+
+		//---------------------------------------------------------------------
+		// Memory of a process: accessing a guarded page raises an exception
+		// and removes its guard like the system does.
+		class SimulatedPageMemory : public cov::IPageMemory
+		{
+		  public:
+			//-----------------------------------------------------------------
+			bool GuardPage(HANDLE, DWORD64 pageAddress) override
+			{
+				if (unprotectablePages_.count(pageAddress))
+					return false;
+				guardedPages_.insert(pageAddress);
+				return true;
+			}
+
+			//-----------------------------------------------------------------
+			void UnguardPage(HANDLE, DWORD64 pageAddress) override
+			{
+				guardedPages_.erase(pageAddress);
+			}
+
+			//-----------------------------------------------------------------
+			void WriteBreakPoints(HANDLE,
+			                      std::vector<DWORD64>&& addresses) override
+			{
+				breakPoints_.insert(addresses.begin(), addresses.end());
+				++writeCount_;
+			}
+
+			//-----------------------------------------------------------------
+			boost::optional<EXCEPTION_DEBUG_INFO> Access(DWORD64 address)
+			{
+				if (guardedPages_.erase(address - address % PageSize) == 0)
+					return boost::none;
+
+				EXCEPTION_DEBUG_INFO exceptionDebugInfo{};
+				auto& exceptionRecord = exceptionDebugInfo.ExceptionRecord;
+				exceptionRecord.ExceptionCode = STATUS_GUARD_PAGE_VIOLATION;
+				exceptionRecord.NumberParameters = 2;
+				exceptionRecord.ExceptionInformation[1] =
+				    static_cast<ULONG_PTR>(address);
+				exceptionDebugInfo.dwFirstChance = 1;
+				return exceptionDebugInfo;
+			}
+
+			std::set<DWORD64> unprotectablePages_;
+			std::set<DWORD64> guardedPages_;
+			std::set<DWORD64> breakPoints_;
+			int writeCount_ = 0;
+		};
+
+		//---------------------------------------------------------------------
+		struct LazyBreakPointsTest : public ::testing::Test
+		{
+			LazyBreakPointsTest()
+			    : pageMemory_{std::make_shared<SimulatedPageMemory>()},
+			      lazyBreakPoints_{pageMemory_}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			bool Access(DWORD64 address)
+			{
+				auto exceptionDebugInfo = pageMemory_->Access(address);
+				return exceptionDebugInfo &&
+				       lazyBreakPoints_.OnException(hProcess, *exceptionDebugInfo);
+			}
+
+			std::shared_ptr<SimulatedPageMemory> pageMemory_;
+			cov::LazyBreakPoints lazyBreakPoints_;
+		};
+	}
+
+	//-------------------------------------------------------------------------
+	TEST_F(LazyBreakPointsTest, ArmPageOnFirstAccess)
+	{
+		lazyBreakPoints_.AddBreakPoints(
+		    hProcess, baseOfImage, {0x11000, 0x11010, 0x12020, 0x14000});
+
+		ASSERT_EQ(std::set<DWORD64>({0x11000, 0x12000, 0x14000}),
+		          pageMemory_->guardedPages_);
+		ASSERT_TRUE(pageMemory_->breakPoints_.empty());
+		ASSERT_EQ(3, lazyBreakPoints_.GetGuardedPageCount(hProcess));
+
+		ASSERT_TRUE(Access(0x11008));
+		ASSERT_EQ(std::set<DWORD64>({0x11000, 0x11010}),
+		          pageMemory_->breakPoints_);
+		ASSERT_EQ(std::set<DWORD64>({0x12000, 0x14000}),
+		          pageMemory_->guardedPages_);
+
+		ASSERT_FALSE(Access(0x11010));
+		ASSERT_FALSE(Access(0x13000));
+		ASSERT_TRUE(Access(0x14FFF));
+		ASSERT_EQ(std::set<DWORD64>({0x11000, 0x11010, 0x14000}),
+		          pageMemory_->breakPoints_);
+		ASSERT_EQ(1, lazyBreakPoints_.GetGuardedPageCount(hProcess));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST_F(LazyBreakPointsTest, UnprotectablePage)
+	{
+		pageMemory_->unprotectablePages_.insert(0x12000);
+		lazyBreakPoints_.AddBreakPoints(
+		    hProcess, baseOfImage, {0x11000, 0x12000, 0x12010});
+
+		ASSERT_EQ(std::set<DWORD64>({0x12000, 0x12010}),
+		          pageMemory_->breakPoints_);
+		ASSERT_EQ(1, lazyBreakPoints_.GetGuardedPageCount(hProcess));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST_F(LazyBreakPointsTest, OtherExceptions)
+	{
+		lazyBreakPoints_.AddBreakPoints(hProcess, baseOfImage, {0x11000});
+
+		auto exceptionDebugInfo = pageMemory_->Access(0x11000);
+		ASSERT_TRUE(exceptionDebugInfo);
+
+		auto otherProcess = reinterpret_cast<HANDLE>(2);
+		ASSERT_FALSE(lazyBreakPoints_.OnException(otherProcess, *exceptionDebugInfo));
+
+		auto secondChanceException = *exceptionDebugInfo;
+		secondChanceException.dwFirstChance = 0;
+		ASSERT_FALSE(lazyBreakPoints_.OnException(hProcess, secondChanceException));
+
+		auto breakPointException = *exceptionDebugInfo;
+		breakPointException.ExceptionRecord.ExceptionCode = EXCEPTION_BREAKPOINT;
+		ASSERT_FALSE(lazyBreakPoints_.OnException(hProcess, breakPointException));
+
+		ASSERT_TRUE(lazyBreakPoints_.OnException(hProcess, *exceptionDebugInfo));
+		ASSERT_EQ(1, pageMemory_->writeCount_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST_F(LazyBreakPointsTest, UnloadModule)
+	{
+		auto otherBaseOfImage = reinterpret_cast<void*>(0x20000);
+		lazyBreakPoints_.AddBreakPoints(hProcess, baseOfImage, {0x11000});
+		lazyBreakPoints_.AddBreakPoints(hProcess, otherBaseOfImage, {0x21000});
+
+		lazyBreakPoints_.OnUnloadModule(hProcess, baseOfImage);
+		ASSERT_EQ(1, lazyBreakPoints_.GetGuardedPageCount(hProcess));
+		ASSERT_FALSE(Access(0x11000));
+		ASSERT_TRUE(Access(0x21000));
+
+		lazyBreakPoints_.AddBreakPoints(hProcess, otherBaseOfImage, {0x22000});
+		lazyBreakPoints_.OnExitProcess(hProcess);
+		ASSERT_EQ(0, lazyBreakPoints_.GetGuardedPageCount(hProcess));
+		ASSERT_FALSE(Access(0x22000));
+	}
+}
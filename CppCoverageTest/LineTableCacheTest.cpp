@@ -0,0 +1,181 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include <fstream>
+
+#include "CppCoverage/LineTableCache.hpp"
+#include "TestCoverageConsole/TestCoverageConsole.hpp"
+#include "TestHelper/TemporaryPath.hpp"
+
+namespace cov = CppCoverage;
+namespace fs = std::filesystem;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		const std::uintmax_t NoLimit = std::numeric_limits<std::uintmax_t>::max();
+
+		//---------------------------------------------------------------------
+		std::vector<cov::LineTableCache::SourceFile> CreateSourceFiles()
+		{
+			cov::LineTableCache::SourceFile sourceFile1{L"C:\\Dev\\File1.cpp", {}};
+			sourceFile1.lines_.emplace_back(10, 0x1000, 1, true);
+			sourceFile1.lines_.emplace_back(11, 0x1010, 1);
+			cov::LineTableCache::SourceFile sourceFile2{L"C:\\Dev\\File2.cpp", {}};
+			sourceFile2.lines_.emplace_back(42, 0x2000, 2);
+
+			return { sourceFile1, sourceFile2, {L"C:\\Dev\\Empty.cpp", {}} };
+		}
+
+		//---------------------------------------------------------------------
+		fs::path GetEntryPath(const fs::path& folder, const std::wstring& key)
+		{
+			return folder / (key + L".lines");
+		}
+
+		//---------------------------------------------------------------------
+		void SetLastAccessTime(const fs::path& folder,
+		                       const std::wstring& key,
+		                       std::chrono::hours age)
+		{
+			fs::last_write_time(GetEntryPath(folder, key),
+			                    fs::file_time_type::clock::now() - age);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(LineTableCacheTest, StoreAndLoad)
+	{
+		TestHelper::TemporaryPath folder{TestHelper::TemporaryPathOption::CreateAsFolder};
+		cov::LineTableCache lineTableCache{folder, NoLimit};
+		auto sourceFiles = CreateSourceFiles();
+
+		ASSERT_FALSE(lineTableCache.Load(L"Key"));
+		lineTableCache.Store(L"Key", sourceFiles);
+		auto loadedSourceFiles = lineTableCache.Load(L"Key");
+
+		ASSERT_TRUE(loadedSourceFiles);
+		ASSERT_EQ(sourceFiles.size(), loadedSourceFiles->size());
+		for (size_t i = 0; i < sourceFiles.size(); ++i)
+		{
+			const auto& expectedLines = sourceFiles[i].lines_;
+			const auto& lines = loadedSourceFiles->at(i).lines_;
+
+			ASSERT_EQ(sourceFiles[i].path_, loadedSourceFiles->at(i).path_);
+			ASSERT_EQ(expectedLines.size(), lines.size());
+			for (size_t j = 0; j < lines.size(); ++j)
+			{
+				ASSERT_EQ(expectedLines[j].lineNumber_, lines[j].lineNumber_);
+				ASSERT_EQ(expectedLines[j].virtualAddress_, lines[j].virtualAddress_);
+				ASSERT_EQ(expectedLines[j].symbolIndex_, lines[j].symbolIndex_);
+				ASSERT_EQ(expectedLines[j].isFunctionEntry_, lines[j].isFunctionEntry_);
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(LineTableCacheTest, InvalidEntry)
+	{
+		TestHelper::TemporaryPath folder{TestHelper::TemporaryPathOption::CreateAsFolder};
+		cov::LineTableCache lineTableCache{folder, NoLimit};
+
+		lineTableCache.Store(L"Key", CreateSourceFiles());
+		auto entryPath = GetEntryPath(folder, L"Key");
+		fs::resize_file(entryPath, fs::file_size(entryPath) - 1);
+
+		ASSERT_FALSE(lineTableCache.Load(L"Key"));
+		ASSERT_FALSE(fs::exists(entryPath));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(LineTableCacheTest, InvalidSourceFileCount)
+	{
+		TestHelper::TemporaryPath folder{TestHelper::TemporaryPathOption::CreateAsFolder};
+		cov::LineTableCache lineTableCache{folder, NoLimit};
+
+		lineTableCache.Store(L"Key", CreateSourceFiles());
+		auto entryPath = GetEntryPath(folder, L"Key");
+		{
+			// The source file count follows the magic and the version.
+			std::fstream file{entryPath, std::ios::in | std::ios::out | std::ios::binary};
+			const uint32_t sourceFileCount = std::numeric_limits<uint32_t>::max();
+			file.seekp(2 * sizeof(uint32_t));
+			file.write(reinterpret_cast<const char*>(&sourceFileCount), sizeof(sourceFileCount));
+		}
+
+		ASSERT_FALSE(lineTableCache.Load(L"Key"));
+		ASSERT_FALSE(fs::exists(entryPath));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(LineTableCacheTest, RemoveLeastRecentlyUsedEntries)
+	{
+		TestHelper::TemporaryPath folder{TestHelper::TemporaryPathOption::CreateAsFolder};
+		auto sourceFiles = CreateSourceFiles();
+		std::uintmax_t entrySize = 0;
+		{
+			cov::LineTableCache lineTableCache{folder, NoLimit};
+			lineTableCache.Store(L"Key1", sourceFiles);
+			entrySize = fs::file_size(GetEntryPath(folder, L"Key1"));
+		}
+
+		cov::LineTableCache lineTableCache{folder, 2 * entrySize};
+		lineTableCache.Store(L"Key2", sourceFiles);
+		SetLastAccessTime(folder, L"Key1", std::chrono::hours{2});
+		SetLastAccessTime(folder, L"Key2", std::chrono::hours{1});
+
+		ASSERT_TRUE(lineTableCache.Load(L"Key1"));
+		lineTableCache.Store(L"Key3", sourceFiles);
+
+		ASSERT_TRUE(fs::exists(GetEntryPath(folder, L"Key1")));
+		ASSERT_FALSE(fs::exists(GetEntryPath(folder, L"Key2")));
+		ASSERT_TRUE(fs::exists(GetEntryPath(folder, L"Key3")));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(LineTableCacheTest, ComputeKey)
+	{
+		TestHelper::TemporaryPath notAModule{TestHelper::TemporaryPathOption::CreateAsFile};
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		auto key = cov::LineTableCache::ComputeKey(binary);
+
+		ASSERT_TRUE(key);
+		ASSERT_EQ(0, key->find(binary.stem().wstring()));
+		ASSERT_EQ(*key, cov::LineTableCache::ComputeKey(binary).get_value_or(L""));
+		ASSERT_FALSE(cov::LineTableCache::ComputeKey(notAModule));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(LineTableCacheTest, NonAsciiPath)
+	{
+		TestHelper::TemporaryPath folder{TestHelper::TemporaryPathOption::CreateAsFolder};
+		auto binary = folder.GetPath() / L"\u00e9\u4e2d.exe";
+		fs::copy_file(TestCoverageConsole::GetOutputBinaryPath(), binary);
+
+		auto key = cov::LineTableCache::ComputeKey(binary);
+		ASSERT_TRUE(key);
+		ASSERT_EQ(0, key->find(binary.stem().wstring()));
+
+		cov::LineTableCache lineTableCache{folder.GetPath() / L"\u0416", NoLimit};
+		lineTableCache.Store(*key, CreateSourceFiles());
+		auto loadedSourceFiles = lineTableCache.Load(*key);
+		ASSERT_TRUE(loadedSourceFiles);
+		ASSERT_EQ(CreateSourceFiles().size(), loadedSourceFiles->size());
+	}
+}
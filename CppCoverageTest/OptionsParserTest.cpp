@@ -50,6 +50,15 @@ namespace CppCoverageTest
 		ASSERT_FALSE(options->IsOptimizedBuildSupportEnabled());
 		ASSERT_TRUE(options->GetExcludedLineRegexes().empty());
 		ASSERT_TRUE(options->GetSubstitutePdbSourcePaths().empty());
+		ASSERT_FALSE(options->GetLineTableCacheFolder());
+		ASSERT_FALSE(options->IsDetachOnSaturationModeEnabled());
+		ASSERT_FALSE(options->IsSkipCoveredLinesModeEnabled());
+		ASSERT_FALSE(options->IsFunctionCoverageModeEnabled());
+		ASSERT_FALSE(options->IsBasicBlockBreakPointsModeEnabled());
+		ASSERT_FALSE(options->IsDominatorBreakPointsModeEnabled());
+		ASSERT_FALSE(options->IsLazyBreakPointsModeEnabled());
+		ASSERT_FALSE(options->GetDebugEventsTracePath());
+		ASSERT_FALSE(options->GetDebugEventStatisticsPath());
 	}
 
 	//-------------------------------------------------------------------------
@@ -135,6 +144,17 @@ namespace CppCoverageTest
         ->IsStopOnAssertModeEnabled());
     }
     
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, DetachOnSaturation)
+	{
+		cov::OptionsParser parser;
+		auto detachOnSaturation = TestTools::GetOptionPrefix() + cov::ProgramOptions::DetachOnSaturationOption;
+
+		ASSERT_TRUE(TestTools::Parse(parser, { detachOnSaturation })->IsDetachOnSaturationModeEnabled());
+		ASSERT_FALSE(TestTools::Parse(parser,
+			{ detachOnSaturation, TestTools::GetOptionPrefix() + cov::ProgramOptions::CoverChildrenOption }));
+	}
+
     //-------------------------------------------------------------------------
 	TEST(OptionsParserTest, WorkingDirectory)
 	{
@@ -217,6 +237,61 @@ namespace CppCoverageTest
 		ASSERT_NE(L"", ostr.str());		
 	}
 
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, SkipCoveredLines)
+	{
+		cov::OptionsParser parser;
+		TestHelper::TemporaryPath temporaryPath{ TestHelper::TemporaryPathOption::CreateAsFile };
+		auto skipCoveredLines = TestTools::GetOptionPrefix() + cov::ProgramOptions::SkipCoveredLinesOption;
+
+		auto options = TestTools::Parse(parser, { skipCoveredLines,
+			TestTools::GetOptionPrefix() + cov::ProgramOptions::InputCoverageValue, temporaryPath.GetPath().string() });
+		ASSERT_TRUE(static_cast<bool>(options));
+		ASSERT_TRUE(options->IsSkipCoveredLinesModeEnabled());
+		ASSERT_FALSE(TestTools::Parse(parser, { skipCoveredLines }));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, FunctionCoverage)
+	{
+		cov::OptionsParser parser;
+
+		ASSERT_TRUE(TestTools::Parse(parser,
+		{ TestTools::GetOptionPrefix() + cov::ProgramOptions::FunctionCoverageOption })
+			->IsFunctionCoverageModeEnabled());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, BasicBlockBreakPoints)
+	{
+		cov::OptionsParser parser;
+		auto basicBlockBreakPoints = TestTools::GetOptionPrefix() + cov::ProgramOptions::BasicBlockBreakPointsOption;
+		auto functionCoverage = TestTools::GetOptionPrefix() + cov::ProgramOptions::FunctionCoverageOption;
+
+		ASSERT_TRUE(TestTools::Parse(parser, { basicBlockBreakPoints })->IsBasicBlockBreakPointsModeEnabled());
+		ASSERT_FALSE(TestTools::Parse(parser, { basicBlockBreakPoints, functionCoverage }));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, DominatorBreakPoints)
+	{
+		cov::OptionsParser parser;
+		auto dominatorBreakPoints = TestTools::GetOptionPrefix() + cov::ProgramOptions::DominatorBreakPointsOption;
+		auto functionCoverage = TestTools::GetOptionPrefix() + cov::ProgramOptions::FunctionCoverageOption;
+
+		ASSERT_TRUE(TestTools::Parse(parser, { dominatorBreakPoints })->IsDominatorBreakPointsModeEnabled());
+		ASSERT_FALSE(TestTools::Parse(parser, { dominatorBreakPoints, functionCoverage }));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, LazyBreakPoints)
+	{
+		cov::OptionsParser parser;
+		auto lazyBreakPoints = TestTools::GetOptionPrefix() + cov::ProgramOptions::LazyBreakPointsOption;
+
+		ASSERT_TRUE(TestTools::Parse(parser, { lazyBreakPoints })->IsLazyBreakPointsModeEnabled());
+	}
+
 	//-------------------------------------------------------------------------
 	TEST(OptionsParserTest, OptimizedBuild)
 	{
@@ -294,4 +369,63 @@ namespace CppCoverageTest
 		ASSERT_TRUE(ParseSubstitutePdbSourcePath(validPath, localPath));
 		ASSERT_FALSE(ParseSubstitutePdbSourcePath("C:\\Dev/Invalid", localPath));
 	}
-}
\ No newline at end of file
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, LineTableCache)
+	{
+		cov::OptionsParser parser;
+		TestHelper::TemporaryPath folder;
+
+		auto options = TestTools::Parse(
+			parser,
+			{ TestTools::GetOptionPrefix() + cov::ProgramOptions::LineTableCacheOption,
+			folder.GetPath().string(),
+			TestTools::GetOptionPrefix() + cov::ProgramOptions::LineTableCacheMaxSizeOption,
+			"42" });
+
+		ASSERT_TRUE(options.is_initialized());
+		ASSERT_EQ(folder.GetPath(), options->GetLineTableCacheFolder());
+		ASSERT_EQ(42, options->GetLineTableCacheMaxSizeInMegaBytes());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, LineTableCacheMaxSizeWithoutFolder)
+	{
+		cov::OptionsParser parser;
+
+		ASSERT_FALSE(TestTools::Parse(
+			parser,
+			{ TestTools::GetOptionPrefix() + cov::ProgramOptions::LineTableCacheMaxSizeOption,
+			"42" }));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, DebugEventsTrace)
+	{
+		cov::OptionsParser parser;
+		TestHelper::TemporaryPath path;
+
+		auto options = TestTools::Parse(
+			parser,
+			{ TestTools::GetOptionPrefix() + cov::ProgramOptions::DebugEventsTraceOption,
+			path.GetPath().string() });
+
+		ASSERT_TRUE(options.is_initialized());
+		ASSERT_EQ(path.GetPath(), options->GetDebugEventsTracePath());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(OptionsParserTest, DebugEventStatistics)
+	{
+		cov::OptionsParser parser;
+		TestHelper::TemporaryPath path;
+
+		auto options = TestTools::Parse(
+			parser,
+			{ TestTools::GetOptionPrefix() + cov::ProgramOptions::DebugEventStatisticsOption,
+			path.GetPath().string() });
+
+		ASSERT_TRUE(options.is_initialized());
+		ASSERT_EQ(path.GetPath(), options->GetDebugEventStatisticsPath());
+	}
+}
@@ -0,0 +1,150 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2017 OpenCppCoverage
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include <set>
+#include <tuple>
+
+#include "CppCoverage/SymbolLoadingPipeline.hpp"
+#include "TestCoverageConsole/TestDebugInformationEnumerator.hpp"
+#include "TestCoverageConsole/TestCoverageConsole.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		struct LineRecorder : cov::IDebugInformationHandler
+		{
+			//-----------------------------------------------------------------
+			explicit LineRecorder(const std::filesystem::path& selectedFilename = {})
+			    : selectedFilename_{selectedFilename}
+			{
+			}
+
+			//-----------------------------------------------------------------
+			bool IsSourceFileSelected(const std::filesystem::path& path) override
+			{
+				return selectedFilename_.empty() ||
+				       path.filename() == selectedFilename_;
+			}
+
+			//-----------------------------------------------------------------
+			void OnSourceFile(const std::filesystem::path& path,
+			                  const std::vector<Line>& lines) override
+			{
+				paths_.push_back(path);
+				for (const auto& line : lines)
+				{
+					lines_.emplace(path,
+					               line.lineNumber_,
+					               line.virtualAddress_,
+					               line.symbolIndex_);
+				}
+			}
+
+			const std::filesystem::path selectedFilename_;
+			std::vector<std::filesystem::path> paths_;
+			std::multiset<std::tuple<std::filesystem::path,
+			                         unsigned long,
+			                         int64_t,
+			                         unsigned long>>
+			    lines_;
+		};
+
+		//---------------------------------------------------------------------
+		std::unique_ptr<cov::SymbolLoadingPipeline>
+		CreateSymbolLoadingPipeline(size_t workerCount)
+		{
+			return std::make_unique<cov::SymbolLoadingPipeline>(
+			    std::make_unique<cov::DebugInformationEnumerator>(
+			        std::vector<cov::SubstitutePdbSourcePath>{}),
+			    workerCount);
+		}
+
+		//---------------------------------------------------------------------
+		LineRecorder EnumerateDirectly(const std::filesystem::path& binary)
+		{
+			cov::DebugInformationEnumerator debugInformationEnumerator{{}};
+			LineRecorder lineRecorder;
+
+			debugInformationEnumerator.Enumerate(binary, lineRecorder);
+			return lineRecorder;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(SymbolLoadingPipelineTest, EnumerateWithoutPrefetch)
+	{
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		auto symbolLoadingPipeline = CreateSymbolLoadingPipeline(2);
+		LineRecorder lineRecorder;
+
+		ASSERT_TRUE(symbolLoadingPipeline->Enumerate(binary, lineRecorder));
+		ASSERT_EQ(EnumerateDirectly(binary).lines_, lineRecorder.lines_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(SymbolLoadingPipelineTest, EnumeratePrefetchedModule)
+	{
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		auto symbolLoadingPipeline = CreateSymbolLoadingPipeline(2);
+		auto expectedLineRecorder = EnumerateDirectly(binary);
+
+		symbolLoadingPipeline->Prefetch(binary);
+		symbolLoadingPipeline->Prefetch(binary);
+		LineRecorder lineRecorder;
+		ASSERT_TRUE(symbolLoadingPipeline->Enumerate(binary, lineRecorder));
+		ASSERT_EQ(expectedLineRecorder.paths_, lineRecorder.paths_);
+		ASSERT_EQ(expectedLineRecorder.lines_, lineRecorder.lines_);
+
+		// The prefetched result is used only once.
+		LineRecorder secondLineRecorder;
+		ASSERT_TRUE(symbolLoadingPipeline->Enumerate(binary, secondLineRecorder));
+		ASSERT_EQ(expectedLineRecorder.lines_, secondLineRecorder.lines_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(SymbolLoadingPipelineTest, SourceFileSelection)
+	{
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		auto selectedFilename =
+		    TestCoverageConsole::GetDebugInformationEnumeratorTestPath().filename();
+		auto symbolLoadingPipeline = CreateSymbolLoadingPipeline(1);
+
+		symbolLoadingPipeline->Prefetch(binary);
+		LineRecorder lineRecorder{selectedFilename};
+		ASSERT_TRUE(symbolLoadingPipeline->Enumerate(binary, lineRecorder));
+
+		ASSERT_EQ(1, lineRecorder.paths_.size());
+		ASSERT_EQ(selectedFilename, lineRecorder.paths_[0].filename());
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(SymbolLoadingPipelineTest, NoWorker)
+	{
+		auto binary = TestCoverageConsole::GetOutputBinaryPath();
+		auto symbolLoadingPipeline = CreateSymbolLoadingPipeline(0);
+		LineRecorder lineRecorder;
+
+		symbolLoadingPipeline->Prefetch(binary);
+		ASSERT_TRUE(symbolLoadingPipeline->Enumerate(binary, lineRecorder));
+		ASSERT_EQ(EnumerateDirectly(binary).lines_, lineRecorder.lines_);
+	}
+}
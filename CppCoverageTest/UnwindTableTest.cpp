@@ -0,0 +1,102 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+
+#include <cstring>
+
+#include "CppCoverage/UnwindTable.hpp"
+
+namespace cov = CppCoverage;
+
+namespace CppCoverageTest
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		void Write(std::vector<unsigned char>& image, size_t offset, DWORD value)
+		{
+			std::memcpy(&image[offset], &value, sizeof(value));
+		}
+
+		//---------------------------------------------------------------------
+		void WriteRuntimeFunction(std::vector<unsigned char>& image,
+		                          size_t offset,
+		                          DWORD beginAddress,
+		                          DWORD endAddress,
+		                          DWORD unwindInfoAddress)
+		{
+			Write(image, offset, beginAddress);
+			Write(image, offset + 4, endAddress);
+			Write(image, offset + 8, unwindInfoAddress);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(UnwindTableTest, HasExceptionHandler)
+	{
+		// Image in the memory of the current process.
+		std::vector<unsigned char> image(0x100);
+		WriteRuntimeFunction(image, 0x10, 0x100, 0x110, 0x80);
+		WriteRuntimeFunction(image, 0x1C, 0x110, 0x120, 0x88);
+		WriteRuntimeFunction(image, 0x28, 0x120, 0x130, 0x90);
+		image[0x80] = 0x01; // Version 1 without flags.
+		image[0x88] = 0x09; // UNW_FLAG_EHANDLER
+		image[0x90] = 0x21; // UNW_FLAG_CHAININFO without unwind codes.
+		WriteRuntimeFunction(image, 0x94, 0x110, 0x120, 0x88);
+
+		IMAGE_DATA_DIRECTORY exceptionDirectory{0x10, 3 * 12};
+		auto base = reinterpret_cast<DWORD64>(image.data());
+		cov::UnwindTable unwindTable{GetCurrentProcess(), base, exceptionDirectory};
+
+		ASSERT_FALSE(unwindTable.HasExceptionHandler(base + 0x100, base + 0x110));
+		ASSERT_TRUE(unwindTable.HasExceptionHandler(base + 0x100, base + 0x111));
+		ASSERT_TRUE(unwindTable.HasExceptionHandler(base + 0x118, base + 0x119));
+		ASSERT_TRUE(unwindTable.HasExceptionHandler(base + 0x120, base + 0x121));
+		ASSERT_FALSE(unwindTable.HasExceptionHandler(base + 0x130, base + 0x140));
+		ASSERT_FALSE(unwindTable.HasExceptionHandler(base + 0xF0, base + 0x100));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(UnwindTableTest, IsFunctionEntry)
+	{
+		std::vector<unsigned char> image(0x100);
+		WriteRuntimeFunction(image, 0x10, 0x100, 0x110, 0x80);
+		WriteRuntimeFunction(image, 0x1C, 0x110, 0x120, 0x88);
+		image[0x80] = 0x01; // Version 1 without flags.
+		image[0x88] = 0x21; // UNW_FLAG_CHAININFO without unwind codes.
+		WriteRuntimeFunction(image, 0x8C, 0x100, 0x110, 0x80);
+
+		IMAGE_DATA_DIRECTORY exceptionDirectory{0x10, 2 * 12};
+		auto base = reinterpret_cast<DWORD64>(image.data());
+		cov::UnwindTable unwindTable{GetCurrentProcess(), base, exceptionDirectory};
+
+		ASSERT_TRUE(unwindTable.IsFunctionEntry(base + 0x100));
+		ASSERT_FALSE(unwindTable.IsFunctionEntry(base + 0x104));
+		// Second part of the function at 0x100.
+		ASSERT_FALSE(unwindTable.IsFunctionEntry(base + 0x110));
+		ASSERT_FALSE(unwindTable.IsFunctionEntry(base + 0x120));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(UnwindTableTest, NoExceptionDirectory)
+	{
+		cov::UnwindTable unwindTable{GetCurrentProcess(), 0x1000, {}};
+
+		ASSERT_FALSE(unwindTable.HasExceptionHandler(0x1000, 0x2000));
+		ASSERT_FALSE(unwindTable.IsFunctionEntry(0x1000));
+	}
+}
@@ -86,4 +86,46 @@ namespace CppCoverageTest
 			return filter.IsSourceFileSelected(str);
 		});		
 	}
-}
\ No newline at end of file
+
+	//-------------------------------------------------------------------------
+	TEST_F(WildcardCoverageFilterTest, AreSelectedModulesLoaded)
+	{
+		cov::Patterns modulePatterns{false};
+		modulePatterns.AddSelectedPatterns(L"C:\\Dev\\A.exe");
+		modulePatterns.AddSelectedPatterns(L"b.dll");
+		cov::WildcardCoverageFilter filter{
+			cov::CoverageFilterSettings{ modulePatterns, emptyPatterns_ }};
+
+		ASSERT_FALSE(filter.AreSelectedModulesLoaded({}));
+		ASSERT_FALSE(filter.AreSelectedModulesLoaded({ L"C:\\Dev\\a.exe" }));
+		ASSERT_FALSE(filter.AreSelectedModulesLoaded({ L"C:\\Dev\\a.exe", L"C:\\Dev\\ab.dll" }));
+		ASSERT_TRUE(filter.AreSelectedModulesLoaded({ L"C:\\Dev\\a.exe", L"C:\\Lib\\B.dll" }));
+
+		cov::Patterns allPatterns{false};
+		allPatterns.AddSelectedPatterns(L"*");
+		cov::WildcardCoverageFilter allFilter{
+			cov::CoverageFilterSettings{ allPatterns, emptyPatterns_ }};
+
+		ASSERT_FALSE(allFilter.AreSelectedModulesLoaded({ L"ab" }));
+
+		cov::Patterns wildcardPatterns{false};
+		wildcardPatterns.AddSelectedPatterns(L"a*b");
+		cov::WildcardCoverageFilter wildcardFilter{
+			cov::CoverageFilterSettings{ wildcardPatterns, emptyPatterns_ }};
+
+		ASSERT_FALSE(wildcardFilter.AreSelectedModulesLoaded({ L"ab" }));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST_F(WildcardCoverageFilterTest, AreSelectedModulesLoadedFolderPattern)
+	{
+		// A folder pattern also selects the plugins loaded later.
+		cov::Patterns modulePatterns{false};
+		modulePatterns.AddSelectedPatterns(L"C:\\Dev\\Project");
+		cov::WildcardCoverageFilter filter{
+			cov::CoverageFilterSettings{ modulePatterns, emptyPatterns_ }};
+
+		ASSERT_TRUE(filter.IsModuleSelected(L"C:\\Dev\\Project\\App.exe"));
+		ASSERT_FALSE(filter.AreSelectedModulesLoaded({ L"C:\\Dev\\Project\\App.exe" }));
+	}
+}
@@ -73,6 +73,7 @@ namespace Exporter
 				for (const auto& fileProtoBuff : moduleProtoBuff.files())
 				{
 					auto& file = module.AddFile(Tools::Utf8ToWString(fileProtoBuff.path()));
+					file.SetFunctionGranularity(fileProtoBuff.isfunctiongranularity());
 
 					for (const auto& line : fileProtoBuff.lines())
 						file.AddLine(line.linenumber(), line.hasbeenexecuted());
@@ -44,6 +44,7 @@ namespace Exporter
 			pb::FileCoverage& fileProtoBuff)
 		{
 			fileProtoBuff.set_path(Tools::ToUtf8String(file.GetPath().wstring()));
+			fileProtoBuff.set_isfunctiongranularity(file.IsFunctionGranularity());
 
 			for (const auto& line : file.GetLines())
 			{
@@ -164,7 +164,11 @@ namespace Exporter
 
 		auto title = fileCoverage.GetPath().filename().wstring();
 		exporter_.GenerateSourceTemplate(
-			title, ostr.str(), enableCodePrettify, htmlFilePath.GetAbsolutePath());
+			title,
+			ostr.str(),
+			enableCodePrettify,
+			fileCoverage.IsFunctionGranularity(),
+			htmlFilePath.GetAbsolutePath());
 
 		return htmlFilePath.GetRelativeLinkPath();
 	}	
@@ -101,6 +101,8 @@ namespace Exporter
 	const std::string TemplateHtmlExporter::BodyOnLoadFct = "prettyPrint()";
 	const std::string TemplateHtmlExporter::SyntaxHighlightingDisabledMsg 
 		= "Syntax highlighting has been disabled for performance reasons.";
+	const std::string TemplateHtmlExporter::FunctionGranularityMsg
+		= "Only the first line of each function has been monitored.";
 	const std::string TemplateHtmlExporter::MainMessageTemplate = "MAIN_MESSAGE";
 	const std::string TemplateHtmlExporter::CoverRateTemplate = "COVER_RATE";
 	const std::string TemplateHtmlExporter::UncoverRateTemplate = "UNCOVER_RATE";
@@ -188,6 +190,7 @@ namespace Exporter
 		const std::wstring& title,
 		const std::wstring& codeContent,
 		bool enableCodePrettify,
+		bool isFunctionGranularity,
 		const fs::path& output) const
 	{
 		auto titleStr = ToString(title);
@@ -200,6 +203,8 @@ namespace Exporter
 			bodyLoad = "";
 			warning = SyntaxHighlightingDisabledMsg;
 		}
+		if (isFunctionGranularity)
+			warning += (warning.empty() ? "" : " ") + FunctionGranularityMsg;
 
 		dictionary.SetValue(TitleTemplate, titleStr);
 		dictionary.SetValue(CodeTemplate, ToString(codeContent));
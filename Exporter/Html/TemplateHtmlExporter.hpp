@@ -58,6 +58,7 @@ namespace Exporter
 		static const std::string SourceWarningMessageTemplate;
 		static const std::string BodyOnLoadFct;
 		static const std::string SyntaxHighlightingDisabledMsg;
+		static const std::string FunctionGranularityMsg;
 		static const std::string MainMessageTemplate;
 		static const std::string CoverRateTemplate;
 		static const std::string UncoverRateTemplate;
@@ -102,6 +103,7 @@ namespace Exporter
 			const std::wstring& title, 
 			const std::wstring& codeContent,
 			bool enableCodePrettify,
+			bool isFunctionGranularity,
 			const fs::path& output) const;
 
 	private:
@@ -188,7 +188,7 @@ namespace ExporterTest
 		auto outputFile = output_folder.GetPath() / "file";
 		std::wstring sourceTitle = L"SourceTitle";
 		std::wstring sourceContent = L"SourceContent";
-		exporter.GenerateSourceTemplate(sourceTitle, sourceContent, true, outputFile);
+		exporter.GenerateSourceTemplate(sourceTitle, sourceContent, true, false, outputFile);
 		auto templateValues = ReadTemplate(outputFile);
 
 		ASSERT_EQ(sourceTitle, templateValues.at(TemplateHtmlExporter::TitleTemplate));
@@ -196,10 +196,16 @@ namespace ExporterTest
 		ASSERT_NE(L"", templateValues.at(TemplateHtmlExporter::BodyOnLoadTemplate));
 		ASSERT_EQ(L"", templateValues.at(TemplateHtmlExporter::SourceWarningMessageTemplate));
 
-		exporter.GenerateSourceTemplate(sourceTitle, sourceContent, false, outputFile);
+		exporter.GenerateSourceTemplate(sourceTitle, sourceContent, false, false, outputFile);
 		templateValues = ReadTemplate(outputFile);
 
 		ASSERT_EQ(L"", templateValues.at(TemplateHtmlExporter::BodyOnLoadTemplate));
 		ASSERT_NE(L"", templateValues.at(TemplateHtmlExporter::SourceWarningMessageTemplate));
+
+		exporter.GenerateSourceTemplate(sourceTitle, sourceContent, true, true, outputFile);
+		templateValues = ReadTemplate(outputFile);
+
+		ASSERT_NE(L"", templateValues.at(TemplateHtmlExporter::BodyOnLoadTemplate));
+		ASSERT_NE(L"", templateValues.at(TemplateHtmlExporter::SourceWarningMessageTemplate));
 	}
 }
\ No newline at end of file
@@ -22,11 +22,13 @@
 
 namespace FileFilter
 {
+	class ModuleInfo;
+
 	class FILEFILTER_DLL IRelocationsExtractor
 	{
 	public:
 		~IRelocationsExtractor() {}
 		virtual std::unordered_set<DWORD64>
-		Extract(HANDLE hProcess, DWORD64 baseOfImage) const = 0;
+		Extract(const ModuleInfo&) const = 0;
 	};
 }
\ No newline at end of file
@@ -83,9 +83,7 @@ namespace FileFilter
 		{
 			mModuleData_ = std::make_unique<ModuleData>();
 			mModuleData_->path_ = modulePath;
-			mModuleData_->relocations_ = relocationsExtractor_->Extract(
-				moduleInfo.hProcess_,
-				reinterpret_cast<DWORD64>(moduleInfo.baseOfImage_));
+			mModuleData_->relocations_ = relocationsExtractor_->Extract(moduleInfo);
 		}
 		
 		if (!mModuleData_->fileData_ || mModuleData_->fileData_->path_ != filePath)
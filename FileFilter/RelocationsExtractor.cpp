@@ -16,8 +16,13 @@
 
 #include "stdafx.h"
 #include "RelocationsExtractor.hpp"
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include "FileFilterException.hpp"
+#include "ModuleInfo.hpp"
+#include "Tools/Log.hpp"
+#include "Tools/MappedFileView.hpp"
 #include "Tools/ProcessMemory.hpp"
 #include "Tools/PEFileHeader.hpp"
 
@@ -26,38 +31,38 @@ namespace FileFilter
 	namespace
 	{
 		//-------------------------------------------------------------------------
-		DWORD64 ExtractRelocations(
-			HANDLE hProcess,
+		// Collect the addresses of the relocations of the block at offset
+		// in the relocations directory. Their values are read later all at
+		// once.
+		size_t ExtractRelocationAddresses(
+			const unsigned char* directoryData,
+			size_t directorySize,
+			size_t offset,
 			DWORD64 baseOfImage,
-			DWORD64 imageBaseRelocationPtr,
-			int sizeOfPointer,
-			std::unordered_set<DWORD64>& relocations)
+			std::vector<DWORD64>& relocationAddresses)
 		{
-			auto imageBaseRelocation = Tools::ReadStructInProcessMemory<IMAGE_BASE_RELOCATION>(
-				hProcess, imageBaseRelocationPtr);
-			auto sizeOfBlock = imageBaseRelocation->SizeOfBlock;
-			auto count = (sizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD);
+			IMAGE_BASE_RELOCATION imageBaseRelocation;
+			if (offset + sizeof(imageBaseRelocation) > directorySize)
+				THROW("Invalid relocation block.");
+			std::memcpy(&imageBaseRelocation, directoryData + offset, sizeof(imageBaseRelocation));
 
-			std::vector<WORD> relocationPtrs(count);
-			Tools::ReadProcessMemory(
-				hProcess,
-				imageBaseRelocationPtr + sizeof(IMAGE_BASE_RELOCATION),
-				&relocationPtrs[0],
-				relocationPtrs.size() * sizeof(WORD));
+			auto sizeOfBlock = imageBaseRelocation.SizeOfBlock;
+			if (sizeOfBlock < sizeof(imageBaseRelocation) || offset + sizeOfBlock > directorySize)
+				THROW("Invalid relocation block size.");
+			auto count = (sizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD);
+			auto entries = directoryData + offset + sizeof(IMAGE_BASE_RELOCATION);
 
-			for (auto relocationPtr : relocationPtrs)
+			for (size_t i = 0; i < count; ++i)
 			{
+				WORD relocationPtr;
+				std::memcpy(&relocationPtr, entries + i * sizeof(WORD), sizeof(WORD));
 				auto relocationType = (relocationPtr & 0xf000) >> 12;
 
 				if (relocationType == IMAGE_REL_BASED_HIGHLOW || relocationType == IMAGE_REL_BASED_DIR64)
 				{
 					auto rva = relocationPtr & 0x0fff;
-					auto relocationAddress = imageBaseRelocation->VirtualAddress + rva + baseOfImage;
-					DWORD_PTR relocationValue = 0;
-					Tools::ReadProcessMemory(hProcess, relocationAddress, &relocationValue, sizeOfPointer);
-
-					auto relocation = relocationValue - baseOfImage;
-					relocations.insert(relocation);
+					auto relocationAddress = imageBaseRelocation.VirtualAddress + rva + baseOfImage;
+					relocationAddresses.push_back(relocationAddress);
 				}
 			}
 
@@ -89,6 +94,12 @@ namespace FileFilter
 		//-------------------------------------------------------------------------
 		struct PEFileHeaderHandler : public Tools::IPEFileHeaderHandler
 		{
+			//-----------------------------------------------------------------
+			explicit PEFileHeaderHandler(Tools::IProcessMemory& processMemory)
+			    : processMemory_{processMemory}
+			{
+			}
+
 			//-----------------------------------------------------------------
 			void OnNtHeader32(HANDLE hProcess,
 			                  DWORD64 baseOfImage,
@@ -118,35 +129,223 @@ namespace FileFilter
 			    std::unique_ptr<RelocationsDirectoryInfo> relocationsInfo)
 			{
 				const auto& directory = relocationsInfo->directory;
-				auto imageBaseRelocationPtr =
-				    baseOfImage + directory.VirtualAddress;
-				auto endBaseRelocationPtr =
-				    imageBaseRelocationPtr + directory.Size;
+				std::vector<unsigned char> directoryData(directory.Size);
+				std::vector<DWORD64> relocationAddresses;
+
+				// Read the whole directory at once instead of each block.
+				if (!directoryData.empty())
+				{
+					processMemory_.Read(hProcess,
+					                    baseOfImage + directory.VirtualAddress,
+					                    directoryData.data(),
+					                    directoryData.size());
+				}
+				for (size_t offset = 0; offset < directoryData.size();)
+				{
+					offset += ExtractRelocationAddresses(directoryData.data(),
+					                                     directoryData.size(),
+					                                     offset,
+					                                     baseOfImage,
+					                                     relocationAddresses);
+				}
 
-				while (imageBaseRelocationPtr < endBaseRelocationPtr)
+				std::vector<DWORD64> relocationValues(relocationAddresses.size());
+				std::vector<Tools::ProcessMemorySpan> spans;
+				spans.reserve(relocationAddresses.size());
+				for (size_t i = 0; i < relocationAddresses.size(); ++i)
 				{
-					imageBaseRelocationPtr +=
-					    ExtractRelocations(hProcess,
-					                       baseOfImage,
-					                       imageBaseRelocationPtr,
-					                       relocationsInfo->sizeOfPointer,
-					                       relocations_);
+					spans.push_back({relocationAddresses[i],
+					                 &relocationValues[i],
+					                 static_cast<size_t>(
+					                     relocationsInfo->sizeOfPointer)});
 				}
+				processMemory_.ReadSpans(hProcess, spans);
+
+				for (auto relocationValue : relocationValues)
+					relocations_.insert(relocationValue - baseOfImage);
 			}
 
+			Tools::IProcessMemory& processMemory_;
 			std::unordered_set<DWORD64> relocations_;
 		};
+
+		//-------------------------------------------------------------------------
+		template <typename T>
+		T ReadImage(const Tools::MappedFileView& image, DWORD64 offset)
+		{
+			T value;
+			if (offset > image.GetSize() || sizeof(T) > image.GetSize() - offset)
+				THROW("Invalid image file: unexpected end of file.");
+			std::memcpy(&value, image.GetData() + offset, sizeof(T));
+			return value;
+		}
+
+		//-------------------------------------------------------------------------
+		// Convert the relative virtual addresses to offsets in the image file.
+		class ImageSections
+		{
+		public:
+			//---------------------------------------------------------------------
+			ImageSections(const Tools::MappedFileView& image,
+			              DWORD64 sectionHeaderOffset,
+			              WORD numberOfSections)
+			{
+				for (WORD i = 0; i < numberOfSections; ++i)
+				{
+					auto section = ReadImage<IMAGE_SECTION_HEADER>(
+					    image, sectionHeaderOffset + i * sizeof(IMAGE_SECTION_HEADER));
+					if (section.PointerToRawData > image.GetSize() ||
+					    section.SizeOfRawData > image.GetSize() - section.PointerToRawData)
+					{
+						THROW("Invalid image file: invalid section.");
+					}
+					sections_.push_back(section);
+				}
+			}
+
+			//---------------------------------------------------------------------
+			DWORD64 GetFileOffset(DWORD64 rva, size_t size)
+			{
+				// Consecutive relocations are almost always in the same section.
+				if (!lastSection_ || !Contains(*lastSection_, rva, size))
+				{
+					auto it = std::find_if(
+					    sections_.begin(), sections_.end(), [&](const auto& section) {
+						    return Contains(section, rva, size);
+					    });
+					if (it == sections_.end())
+						THROW("Invalid image file: address " << rva << " is not in a section.");
+					lastSection_ = &*it;
+				}
+				return lastSection_->PointerToRawData + (rva - lastSection_->VirtualAddress);
+			}
+
+		private:
+			//---------------------------------------------------------------------
+			static bool Contains(const IMAGE_SECTION_HEADER& section, DWORD64 rva, size_t size)
+			{
+				return rva >= section.VirtualAddress &&
+				       rva - section.VirtualAddress + size <= section.SizeOfRawData;
+			}
+
+			std::vector<IMAGE_SECTION_HEADER> sections_;
+			const IMAGE_SECTION_HEADER* lastSection_ = nullptr;
+		};
+
+		//-------------------------------------------------------------------------
+		// The values of the relocations in the image file are relative to
+		// the preferred image base.
+		std::unordered_set<DWORD64>
+		ExtractImageRelocations(const Tools::MappedFileView& image,
+		                        ImageSections& sections,
+		                        DWORD64 imageBase,
+		                        const RelocationsDirectoryInfo& relocationsInfo)
+		{
+			const auto& directory = relocationsInfo.directory;
+			std::unordered_set<DWORD64> relocations;
+			if (directory.Size == 0)
+				return relocations;
+
+			auto directoryData = reinterpret_cast<const unsigned char*>(image.GetData()) +
+			                     sections.GetFileOffset(directory.VirtualAddress, directory.Size);
+			std::vector<DWORD64> relocationRvas;
+			for (size_t offset = 0; offset < directory.Size;)
+			{
+				offset += ExtractRelocationAddresses(
+				    directoryData, directory.Size, offset, 0, relocationRvas);
+			}
+
+			relocations.reserve(relocationRvas.size());
+			for (auto rva : relocationRvas)
+			{
+				DWORD64 relocationValue = 0;
+				auto size = static_cast<size_t>(relocationsInfo.sizeOfPointer);
+				std::memcpy(&relocationValue, image.GetData() + sections.GetFileOffset(rva, size), size);
+				relocations.insert(relocationValue - imageBase);
+			}
+			return relocations;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	RelocationsExtractor::RelocationsExtractor()
+	    : RelocationsExtractor{std::make_shared<Tools::ProcessMemory>()}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	RelocationsExtractor::RelocationsExtractor(
+	    std::shared_ptr<Tools::IProcessMemory> processMemory)
+	    : processMemory_{std::move(processMemory)}
+	{
 	}
 
 	//-------------------------------------------------------------------------
 	std::unordered_set<DWORD64>
 	RelocationsExtractor::Extract(HANDLE hProcess, DWORD64 baseOfImage) const
 	{
-		Tools::PEFileHeader peFileHeader;
-		PEFileHeaderHandler handler;
+		Tools::PEFileHeader peFileHeader{processMemory_};
+		PEFileHeaderHandler handler{*processMemory_};
 
 		peFileHeader.Load(hProcess, baseOfImage, handler);
 
 		return std::move(handler.relocations_);
 	}
-}
+
+	//-------------------------------------------------------------------------
+	std::unordered_set<DWORD64>
+	RelocationsExtractor::Extract(const ModuleInfo& moduleInfo) const
+	{
+		try
+		{
+			return ExtractFromImage(moduleInfo.path_);
+		}
+		catch (const std::exception& e)
+		{
+			LOG_DEBUG << L"Cannot read the relocations from " << moduleInfo.path_.wstring()
+			          << L", read them from the process memory: " << e.what();
+		}
+		return Extract(moduleInfo.hProcess_,
+		               reinterpret_cast<DWORD64>(moduleInfo.baseOfImage_));
+	}
+
+	//-------------------------------------------------------------------------
+	std::unordered_set<DWORD64>
+	RelocationsExtractor::ExtractFromImage(const std::filesystem::path& imagePath) const
+	{
+		Tools::MappedFileView image{imagePath};
+
+		auto dosHeader = ReadImage<IMAGE_DOS_HEADER>(image, 0);
+		if (dosHeader.e_magic != IMAGE_DOS_SIGNATURE)
+			THROW("Invalid image file: invalid DOS signature.");
+		DWORD64 ntHeadersOffset = dosHeader.e_lfanew;
+		auto ntHeaders32 = ReadImage<IMAGE_NT_HEADERS32>(image, ntHeadersOffset);
+		if (ntHeaders32.Signature != IMAGE_NT_SIGNATURE)
+			THROW("Invalid image file: invalid NT signature.");
+
+		const auto& fileHeader = ntHeaders32.FileHeader;
+		ImageSections sections{image,
+		                       ntHeadersOffset + sizeof(DWORD) + sizeof(IMAGE_FILE_HEADER) +
+		                           fileHeader.SizeOfOptionalHeader,
+		                       fileHeader.NumberOfSections};
+
+		if (ntHeaders32.OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC)
+		{
+			auto ntHeaders64 = ReadImage<IMAGE_NT_HEADERS64>(image, ntHeadersOffset);
+			if (ntHeaders64.OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_BASERELOC)
+				return {};
+			return ExtractImageRelocations(image,
+			                               sections,
+			                               ntHeaders64.OptionalHeader.ImageBase,
+			                               *GetRelocationsDirectory(ntHeaders64, sizeof(DWORD64)));
+		}
+		if (ntHeaders32.OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR32_MAGIC)
+			THROW("Invalid image file: invalid optional header.");
+		if (ntHeaders32.OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_BASERELOC)
+			return {};
+		return ExtractImageRelocations(image,
+		                               sections,
+		                               ntHeaders32.OptionalHeader.ImageBase,
+		                               *GetRelocationsDirectory(ntHeaders32, sizeof(DWORD)));
+	}
+}
\ No newline at end of file
@@ -17,18 +17,41 @@
 #pragma once
 
 #include <windows.h>
+#include <filesystem>
+#include <memory>
 #include <unordered_set>
 #include "FileFilterExport.hpp"
 #include "IRelocationsExtractor.hpp"
 
+namespace Tools
+{
+	class IProcessMemory;
+}
+
 namespace FileFilter
 {
 	class IRelocationsExtractor;
+	class ModuleInfo;
 
 	class FILEFILTER_DLL RelocationsExtractor: public IRelocationsExtractor
 	{
 	public:
+	  RelocationsExtractor();
+	  explicit RelocationsExtractor(std::shared_ptr<Tools::IProcessMemory>);
+
+	  // Read the relocations from the image file and fall back to the
+	  // process memory when the file cannot be read.
+	  std::unordered_set<DWORD64> Extract(const ModuleInfo&) const override;
+
 	  std::unordered_set<DWORD64> Extract(HANDLE hProcess,
 		                                  DWORD64 baseOfImage) const;
+
+	  // The image file is memory-mapped and only the pages of the
+	  // relocations are read.
+	  std::unordered_set<DWORD64>
+	  ExtractFromImage(const std::filesystem::path& imagePath) const;
+
+	private:
+	  const std::shared_ptr<Tools::IProcessMemory> processMemory_;
 	};
 }
\ No newline at end of file
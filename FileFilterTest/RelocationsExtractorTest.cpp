@@ -16,12 +16,18 @@
 
 #include "stdafx.h"
 #include <windows.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
 #include <regex>
 #include <boost/algorithm/string.hpp>
 
+#include "FileFilter/ModuleInfo.hpp"
 #include "FileFilter/RelocationsExtractor.hpp"
+#include "Tools/SimulatedProcessMemory.hpp"
 #include "TestCoverageOptimizedBuild/TestCoverageOptimizedBuild.hpp"
 
+#include "TestHelper/TemporaryPath.hpp"
 #include "TestHelper/Tools.hpp"
 
 namespace fs = std::filesystem;
@@ -116,5 +122,205 @@ namespace FileFilterTest
 			relocationsWithBaseAddress.insert(relocation + baseAddress);
 		auto expectedRelocations = ExtractRelocations(dumpBinPath);
 		ASSERT_EQ(relocationsWithBaseAddress, expectedRelocations);
+		ASSERT_EQ(relocations,
+		          extractor.ExtractFromImage(TestCoverageOptimizedBuild::GetOutputBinaryPath()));
+	}
+
+	//-------------------------------------------------------------------------
+	std::unordered_set<DWORD64> WriteSimulatedImage(
+		Tools::SimulatedProcessMemory& processMemory,
+		HANDLE hProcess,
+		DWORD64 baseOfImage)
+	{
+		processMemory.Allocate(hProcess, baseOfImage, 0x4000, 0);
+
+		IMAGE_DOS_HEADER dosHeader{};
+		dosHeader.e_magic = IMAGE_DOS_SIGNATURE;
+		dosHeader.e_lfanew = 0x80;
+		processMemory.Write(hProcess, baseOfImage, &dosHeader, sizeof(dosHeader));
+
+		IMAGE_NT_HEADERS64 ntHeaders{};
+		ntHeaders.FileHeader.Machine = IMAGE_FILE_MACHINE_AMD64;
+		auto& directory = ntHeaders.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+		directory.VirtualAddress = 0x1000;
+		directory.Size = sizeof(IMAGE_BASE_RELOCATION) + 4 * sizeof(WORD);
+		processMemory.Write(hProcess, baseOfImage + dosHeader.e_lfanew, &ntHeaders, sizeof(ntHeaders));
+
+		IMAGE_BASE_RELOCATION block{ 0x2000, directory.Size };
+		WORD entries[] = {
+			IMAGE_REL_BASED_DIR64 << 12 | 0x10,
+			IMAGE_REL_BASED_DIR64 << 12 | 0x20,
+			IMAGE_REL_BASED_DIR64 << 12 | 0x800,
+			0 }; // IMAGE_REL_BASED_ABSOLUTE padding
+		processMemory.Write(hProcess, baseOfImage + 0x1000, &block, sizeof(block));
+		processMemory.Write(hProcess, baseOfImage + 0x1000 + sizeof(block), entries, sizeof(entries));
+
+		DWORD64 offset = 0;
+		for (auto entryOffset : { 0x10, 0x20, 0x800 })
+		{
+			auto value = baseOfImage + 0x3000 + offset;
+			processMemory.Write(hProcess, baseOfImage + 0x2000 + entryOffset, &value, sizeof(value));
+			offset += 8;
+		}
+		processMemory.ResetStatistics();
+
+		return { 0x3000, 0x3008, 0x3010 };
+	}
+
+	//-------------------------------------------------------------------------
+	// Write a 64-bit image file with a data section of dataSize bytes.
+	// Each relocation of the data section is relocationStride bytes after
+	// the previous one and points to itself.
+	std::unordered_set<DWORD64> WriteImageFile(
+		const fs::path& path,
+		DWORD dataSize,
+		DWORD relocationStride)
+	{
+		const DWORD64 imageBase = 0x140000000;
+		const DWORD pageSize = 0x1000;
+		const DWORD headersSize = 0x400;
+		const DWORD dataRva = 0x1000;
+		std::unordered_set<DWORD64> expectedRelocations;
+
+		std::vector<char> relocationsData;
+		std::vector<char> data(dataSize);
+		for (DWORD page = 0; page < dataSize; page += pageSize)
+		{
+			std::vector<WORD> entries;
+			for (DWORD offset = 0;
+			     offset < pageSize && page + offset + sizeof(DWORD64) <= dataSize;
+			     offset += relocationStride)
+			{
+				DWORD64 rva = dataRva + page + offset;
+				DWORD64 value = imageBase + rva;
+				std::memcpy(&data[page + offset], &value, sizeof(value));
+				entries.push_back(static_cast<WORD>(IMAGE_REL_BASED_DIR64 << 12 | offset));
+				expectedRelocations.insert(rva);
+			}
+			if (entries.size() % 2)
+				entries.push_back(0); // IMAGE_REL_BASED_ABSOLUTE padding
+
+			IMAGE_BASE_RELOCATION block{ dataRva + page,
+				static_cast<DWORD>(sizeof(IMAGE_BASE_RELOCATION) + entries.size() * sizeof(WORD)) };
+			auto blockBytes = reinterpret_cast<const char*>(&block);
+			auto entriesBytes = reinterpret_cast<const char*>(entries.data());
+			relocationsData.insert(relocationsData.end(), blockBytes, blockBytes + sizeof(block));
+			relocationsData.insert(relocationsData.end(), entriesBytes, entriesBytes + entries.size() * sizeof(WORD));
+		}
+
+		auto relocationsRva = dataRva + (dataSize + pageSize - 1) / pageSize * pageSize;
+		IMAGE_SECTION_HEADER sections[2] = {};
+		sections[0].VirtualAddress = dataRva;
+		sections[0].Misc.VirtualSize = dataSize;
+		sections[0].SizeOfRawData = dataSize;
+		sections[0].PointerToRawData = headersSize;
+		sections[1].VirtualAddress = relocationsRva;
+		sections[1].Misc.VirtualSize = static_cast<DWORD>(relocationsData.size());
+		sections[1].SizeOfRawData = static_cast<DWORD>(relocationsData.size());
+		sections[1].PointerToRawData = headersSize + dataSize;
+
+		IMAGE_DOS_HEADER dosHeader{};
+		dosHeader.e_magic = IMAGE_DOS_SIGNATURE;
+		dosHeader.e_lfanew = 0x80;
+
+		IMAGE_NT_HEADERS64 ntHeaders{};
+		ntHeaders.Signature = IMAGE_NT_SIGNATURE;
+		ntHeaders.FileHeader.Machine = IMAGE_FILE_MACHINE_AMD64;
+		ntHeaders.FileHeader.NumberOfSections = 2;
+		ntHeaders.FileHeader.SizeOfOptionalHeader = sizeof(IMAGE_OPTIONAL_HEADER64);
+		ntHeaders.OptionalHeader.Magic = IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+		ntHeaders.OptionalHeader.ImageBase = imageBase;
+		ntHeaders.OptionalHeader.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+		auto& directory = ntHeaders.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+		directory.VirtualAddress = relocationsRva;
+		directory.Size = static_cast<DWORD>(relocationsData.size());
+
+		std::vector<char> headers(headersSize);
+		std::memcpy(&headers[0], &dosHeader, sizeof(dosHeader));
+		std::memcpy(&headers[dosHeader.e_lfanew], &ntHeaders, sizeof(ntHeaders));
+		std::memcpy(&headers[dosHeader.e_lfanew + sizeof(ntHeaders)], sections, sizeof(sections));
+
+		std::ofstream ofs{ path, std::ios::binary };
+		ofs.write(headers.data(), headers.size());
+		ofs.write(data.data(), data.size());
+		ofs.write(relocationsData.data(), relocationsData.size());
+		return expectedRelocations;
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(RelocationsExtractorTest, ExtractSimulatedProcessMemory)
+	{
+		auto processMemory = std::make_shared<Tools::SimulatedProcessMemory>();
+		auto hProcess = reinterpret_cast<HANDLE>(42);
+		const DWORD64 baseOfImage = 0x140000000;
+		auto expectedRelocations = WriteSimulatedImage(*processMemory, hProcess, baseOfImage);
+
+		FileFilter::RelocationsExtractor extractor{ processMemory };
+		ASSERT_EQ(expectedRelocations, extractor.Extract(hProcess, baseOfImage));
+
+		// DOS header, 32 and 64 bits NT headers, the relocations directory
+		// and a single read for all the relocation values.
+		ASSERT_EQ(5, processMemory->GetStatistics().readCount_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(RelocationsExtractorTest, ExtractFromImage)
+	{
+		TestHelper::TemporaryPath imagePath;
+		auto expectedRelocations = WriteImageFile(imagePath, 0x2800, 0x300);
+		auto processMemory = std::make_shared<Tools::SimulatedProcessMemory>();
+
+		FileFilter::RelocationsExtractor extractor{ processMemory };
+		ASSERT_EQ(expectedRelocations, extractor.ExtractFromImage(imagePath));
+
+		FileFilter::ModuleInfo moduleInfo{ reinterpret_cast<HANDLE>(42), imagePath, nullptr };
+		ASSERT_EQ(expectedRelocations, extractor.Extract(moduleInfo));
+		ASSERT_EQ(0, processMemory->GetStatistics().readCount_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(RelocationsExtractorTest, ExtractFromImageNonAsciiPath)
+	{
+		TestHelper::TemporaryPath folder{ TestHelper::TemporaryPathOption::CreateAsFolder };
+		auto imagePath = folder.GetPath() / L"\u00e9\u4e2d\u0416.dll";
+		auto expectedRelocations = WriteImageFile(imagePath, 0x2800, 0x300);
+		auto processMemory = std::make_shared<Tools::SimulatedProcessMemory>();
+
+		FileFilter::RelocationsExtractor extractor{ processMemory };
+		FileFilter::ModuleInfo moduleInfo{ reinterpret_cast<HANDLE>(42), imagePath, nullptr };
+		ASSERT_EQ(expectedRelocations, extractor.Extract(moduleInfo));
+		ASSERT_EQ(0, processMemory->GetStatistics().readCount_);
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(RelocationsExtractorTest, ExtractFromProcessMemoryWithoutImage)
+	{
+		auto processMemory = std::make_shared<Tools::SimulatedProcessMemory>();
+		auto hProcess = reinterpret_cast<HANDLE>(42);
+		const DWORD64 baseOfImage = 0x140000000;
+		auto expectedRelocations = WriteSimulatedImage(*processMemory, hProcess, baseOfImage);
+
+		FileFilter::RelocationsExtractor extractor{ processMemory };
+		FileFilter::ModuleInfo moduleInfo{
+			hProcess, "MissingFile", reinterpret_cast<void*>(baseOfImage) };
+		ASSERT_THROW(extractor.ExtractFromImage(moduleInfo.path_), std::exception);
+		ASSERT_EQ(expectedRelocations, extractor.Extract(moduleInfo));
+	}
+
+	//-------------------------------------------------------------------------
+	TEST(RelocationsExtractorTest, DISABLED_BenchmarkExtractFromImage)
+	{
+		const DWORD dataSize = 512 * 1024 * 1024;
+		TestHelper::TemporaryPath imagePath;
+		auto expectedRelocations = WriteImageFile(imagePath, dataSize, 0x100);
+		FileFilter::RelocationsExtractor extractor;
+
+		auto start = std::chrono::steady_clock::now();
+		auto relocations = extractor.ExtractFromImage(imagePath);
+		auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		ASSERT_EQ(expectedRelocations.size(), relocations.size());
+		std::cout << relocations.size() << " relocations of a "
+		          << dataSize / (1024 * 1024) << "MB image in " << duration << "s" << std::endl;
 	}
 }
\ No newline at end of file
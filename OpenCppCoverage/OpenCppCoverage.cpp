@@ -25,6 +25,7 @@
 #include "CppCoverage/Options.hpp"
 #include "CppCoverage/ProgramOptions.hpp"
 #include "CppCoverage/CoverageDataMerger.hpp"
+#include "CppCoverage/CoveredLines.hpp"
 #include "CppCoverage/OptionsExport.hpp"
 #include "CppCoverage/RunCoverageSettings.hpp"
 #include "CppCoverage/ExportOptionParser.hpp"
@@ -182,6 +183,28 @@ namespace OpenCppCoverage
                 runCoverageSettings.SetStopOnAssert(options.IsStopOnAssertModeEnabled());
                 runCoverageSettings.SetMaxUnmatchPathsForWarning(maxUnmatchPathsForWarning);
 				runCoverageSettings.SetOptimizedBuildSupport(options.IsOptimizedBuildSupportEnabled());
+				runCoverageSettings.SetDetachOnSaturation(options.IsDetachOnSaturationModeEnabled());
+				runCoverageSettings.SetFunctionCoverage(options.IsFunctionCoverageModeEnabled());
+				runCoverageSettings.SetBasicBlockBreakPoints(options.IsBasicBlockBreakPointsModeEnabled());
+				runCoverageSettings.SetDominatorBreakPoints(options.IsDominatorBreakPointsModeEnabled());
+				runCoverageSettings.SetLazyBreakPoints(options.IsLazyBreakPointsModeEnabled());
+				if (options.IsSkipCoveredLinesModeEnabled())
+				{
+					auto coveredLines = std::make_shared<cov::CoveredLines>(
+						coveraDatas, options.IsAggregateByFileModeEnabled());
+					LOG_INFO << coveredLines->GetExecutedLineCount() << L" line(s) already covered.";
+					runCoverageSettings.SetCoveredLines(std::move(coveredLines));
+				}
+				if (const auto& lineTableCacheFolder = options.GetLineTableCacheFolder())
+				{
+					runCoverageSettings.SetLineTableCache(
+						*lineTableCacheFolder,
+						options.GetLineTableCacheMaxSizeInMegaBytes() * 1024 * 1024);
+				}
+				if (const auto& debugEventsTracePath = options.GetDebugEventsTracePath())
+					runCoverageSettings.SetDebugEventsTracePath(*debugEventsTracePath);
+				if (const auto& debugEventStatisticsPath = options.GetDebugEventStatisticsPath())
+					runCoverageSettings.SetDebugEventStatisticsPath(*debugEventStatisticsPath);
 				auto coverageData = codeCoverageRunner.RunCoverage(runCoverageSettings);
 				exitCode = coverageData.GetExitCode();
 				coveraDatas.push_back(std::move(coverageData));
@@ -22,6 +22,7 @@ namespace Plugin
 	//-------------------------------------------------------------------------
 	FileCoverage::FileCoverage(const std::filesystem::path& path)
 		: path_(path)
+		, isFunctionGranularity_{false}
 	{
 	}
 
@@ -50,6 +51,18 @@ namespace Plugin
 		AddLine(lineNumber, hasBeenExecuted);
 	}
 
+	//-------------------------------------------------------------------------
+	void FileCoverage::SetFunctionGranularity(bool isFunctionGranularity)
+	{
+		isFunctionGranularity_ = isFunctionGranularity;
+	}
+
+	//-------------------------------------------------------------------------
+	bool FileCoverage::IsFunctionGranularity() const
+	{
+		return isFunctionGranularity_;
+	}
+
 	//-------------------------------------------------------------------------
 	const std::filesystem::path& FileCoverage::GetPath() const
 	{
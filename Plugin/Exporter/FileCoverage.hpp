@@ -32,6 +32,10 @@ namespace Plugin
 		void AddLine(unsigned int lineNumber, bool hasBeenExecuted);
 		void UpdateLine(unsigned int lineNumber, bool hasBeenExecuted);
 
+		// Only the first line of each function is reported.
+		void SetFunctionGranularity(bool);
+		bool IsFunctionGranularity() const;
+
 		const std::filesystem::path& GetPath() const;
 		const LineCoverage* operator[](unsigned int line) const;
 		std::vector<LineCoverage> GetLines() const;
@@ -44,6 +48,7 @@ namespace Plugin
 	private:
 		std::filesystem::path path_;
 		std::map<unsigned int, LineCoverage> lines_;	
+		bool isFunctionGranularity_;
 	};
 }
 
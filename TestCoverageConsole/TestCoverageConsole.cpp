@@ -50,6 +50,13 @@ namespace
 		TestCoverageSharedLib::CallSharedFunctionFromSharedLib();
 		TestCoverageSharedLib::SharedFunction(false);
 	}
+
+	//-----------------------------------------------------------------------------
+	void TestBreakPointLoop()
+	{
+		for (int i = 0; i < TestCoverageConsole::BreakPointLoopCount; ++i)
+			DebugBreak();
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -75,6 +82,8 @@ int _tmain(int argc, _TCHAR* argv[])
 			*reinterpret_cast<int*>(0) = 42;
 		else if (type == TestCoverageConsole::TestBreakPoint)
 			DebugBreak();
+		else if (type == TestCoverageConsole::TestBreakPointLoop)
+			TestBreakPointLoop();
 		else if (type == TestCoverageConsole::TestChildProcess)
 			TestCoverageConsole::RunChildProcesses(argc, argv);
 		else if (type == TestCoverageConsole::TestFileInSeveralModules)
@@ -0,0 +1,132 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "IProcessMemory.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ToolsException.hpp"
+
+namespace Tools
+{
+	namespace
+	{
+		const DWORD64 MaxGapSize = 4096;
+		const DWORD64 MaxRegionSize = 1024 * 1024;
+
+		using SpanIt = std::vector<const ProcessMemorySpan*>::const_iterator;
+
+		//---------------------------------------------------------------------
+		DWORD64 GetEnd(const ProcessMemorySpan& span)
+		{
+			return span.address_ + span.size_;
+		}
+
+		//---------------------------------------------------------------------
+		void ReadRegion(IProcessMemory& processMemory,
+		                HANDLE hProcess,
+		                SpanIt begin,
+		                SpanIt end,
+		                DWORD64 endAddress,
+		                std::vector<unsigned char>& buffer)
+		{
+			auto firstAddress = (*begin)->address_;
+
+			if (end - begin == 1)
+			{
+				processMemory.Read(
+				    hProcess, firstAddress, (*begin)->buffer_, (*begin)->size_);
+				return;
+			}
+
+			buffer.resize(static_cast<size_t>(endAddress - firstAddress));
+			try
+			{
+				processMemory.Read(
+				    hProcess, firstAddress, buffer.data(), buffer.size());
+			}
+			catch (const ToolsException&)
+			{
+				for (auto it = begin; it != end; ++it)
+				{
+					const auto& span = **it;
+					processMemory.Read(
+					    hProcess, span.address_, span.buffer_, span.size_);
+				}
+				return;
+			}
+
+			for (auto it = begin; it != end; ++it)
+			{
+				const auto& span = **it;
+				std::memcpy(span.buffer_,
+				            &buffer[static_cast<size_t>(span.address_ -
+				                                        firstAddress)],
+				            span.size_);
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void IProcessMemory::ReadSpans(HANDLE hProcess,
+	                               const std::vector<ProcessMemorySpan>& spans)
+	{
+		std::vector<const ProcessMemorySpan*> sortedSpans;
+		std::vector<unsigned char> buffer;
+
+		for (const auto& span : spans)
+		{
+			if (span.size_ != 0)
+				sortedSpans.push_back(&span);
+		}
+		std::sort(sortedSpans.begin(),
+		          sortedSpans.end(),
+		          [](const ProcessMemorySpan* span1,
+		             const ProcessMemorySpan* span2) {
+			          return span1->address_ < span2->address_;
+		          });
+
+		auto beginRegion = sortedSpans.cbegin();
+		DWORD64 endAddress = 0;
+		for (auto it = beginRegion; it != sortedSpans.cend(); ++it)
+		{
+			const auto& span = **it;
+			if (it != beginRegion &&
+			    (span.address_ > endAddress + MaxGapSize ||
+			     GetEnd(span) - (*beginRegion)->address_ > MaxRegionSize))
+			{
+				ReadRegion(
+				    *this, hProcess, beginRegion, it, endAddress, buffer);
+				beginRegion = it;
+			}
+			endAddress = (it == beginRegion)
+			                 ? GetEnd(span)
+			                 : std::max(endAddress, GetEnd(span));
+		}
+		if (beginRegion != sortedSpans.cend())
+		{
+			ReadRegion(*this,
+			           hProcess,
+			           beginRegion,
+			           sortedSpans.cend(),
+			           endAddress,
+			           buffer);
+		}
+	}
+}
@@ -0,0 +1,55 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <Windows.h>
+#include <vector>
+
+#include "ToolsExport.hpp"
+
+namespace Tools
+{
+	struct ProcessMemorySpan
+	{
+		DWORD64 address_;
+		void* buffer_;
+		size_t size_;
+	};
+
+	// Memory of a debugged process. Both methods throw ToolsException when
+	// the memory cannot be accessed.
+	class TOOLS_DLL IProcessMemory
+	{
+	  public:
+		virtual ~IProcessMemory() = default;
+
+		virtual void
+		Read(HANDLE hProcess, DWORD64 address, void* buffer, size_t size) = 0;
+		virtual void Write(HANDLE hProcess,
+		                   DWORD64 address,
+		                   const void* buffer,
+		                   size_t size) = 0;
+
+		// Read all the spans with as few calls to Read as possible: close
+		// spans are read together. If such a read fails, for example
+		// because the gap between two spans is not accessible, the spans
+		// are read one by one.
+		virtual void ReadSpans(HANDLE hProcess,
+		                       const std::vector<ProcessMemorySpan>& spans);
+	};
+}
@@ -0,0 +1,99 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "MappedFileView.hpp"
+
+#include "ToolsException.hpp"
+#include "Log.hpp"
+
+namespace Tools
+{
+	//-------------------------------------------------------------------------
+	MappedFileView::MappedFileView(const std::filesystem::path& path)
+		: hFile_{INVALID_HANDLE_VALUE}
+		, hFileMapping_{nullptr}
+		, data_{nullptr}
+		, size_{0}
+	{
+		hFile_ = CreateFileW(path.wstring().c_str(),
+		                     GENERIC_READ,
+		                     FILE_SHARE_READ,
+		                     nullptr,
+		                     OPEN_EXISTING,
+		                     FILE_ATTRIBUTE_NORMAL,
+		                     nullptr);
+		if (hFile_ == INVALID_HANDLE_VALUE)
+			THROW(L"Cannot open " << path.wstring());
+
+		try
+		{
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(hFile_, &fileSize))
+				THROW(L"Cannot get the size of " << path.wstring());
+			size_ = static_cast<size_t>(fileSize.QuadPart);
+
+			// A file mapping cannot be created for an empty file.
+			if (size_ != 0)
+			{
+				hFileMapping_ = CreateFileMapping(hFile_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (!hFileMapping_)
+					THROW(L"Cannot create a file mapping for " << path.wstring());
+				data_ = static_cast<const char*>(
+				    MapViewOfFile(hFileMapping_, FILE_MAP_READ, 0, 0, 0));
+				if (!data_)
+					THROW(L"Cannot map " << path.wstring());
+			}
+		}
+		catch (...)
+		{
+			Close();
+			throw;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	MappedFileView::~MappedFileView()
+	{
+		Close();
+	}
+
+	//-------------------------------------------------------------------------
+	const char* MappedFileView::GetData() const
+	{
+		return data_;
+	}
+
+	//-------------------------------------------------------------------------
+	size_t MappedFileView::GetSize() const
+	{
+		return size_;
+	}
+
+	//-------------------------------------------------------------------------
+	void MappedFileView::Close()
+	{
+		if (data_ && !UnmapViewOfFile(data_))
+			LOG_ERROR << L"Cannot unmap file view.";
+		if (hFileMapping_ && !CloseHandle(hFileMapping_))
+			LOG_ERROR << L"Cannot close file mapping.";
+		if (hFile_ != INVALID_HANDLE_VALUE && !CloseHandle(hFile_))
+			LOG_ERROR << L"Cannot close file.";
+		data_ = nullptr;
+		hFileMapping_ = nullptr;
+		hFile_ = INVALID_HANDLE_VALUE;
+	}
+}
@@ -0,0 +1,50 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Windows.h>
+#include <filesystem>
+
+#include "ToolsExport.hpp"
+
+namespace Tools
+{
+	// Read-only view of a whole file. The file is opened with its wide path
+	// so paths which cannot be represented in the local code page work.
+	class TOOLS_DLL MappedFileView
+	{
+	public:
+		explicit MappedFileView(const std::filesystem::path&);
+		~MappedFileView();
+
+		// nullptr for an empty file.
+		const char* GetData() const;
+		size_t GetSize() const;
+
+	private:
+		MappedFileView(const MappedFileView&) = delete;
+		MappedFileView& operator=(const MappedFileView&) = delete;
+
+		void Close();
+
+	private:
+		HANDLE hFile_;
+		HANDLE hFileMapping_;
+		const char* data_;
+		size_t size_;
+	};
+}
@@ -21,17 +21,29 @@
 
 namespace Tools
 {
+	//-------------------------------------------------------------------------
+	PEFileHeader::PEFileHeader()
+	    : PEFileHeader{std::make_shared<ProcessMemory>()}
+	{
+	}
+
+	//-------------------------------------------------------------------------
+	PEFileHeader::PEFileHeader(std::shared_ptr<IProcessMemory> processMemory)
+	    : processMemory_{std::move(processMemory)}
+	{
+	}
+
 	//-------------------------------------------------------------------------
 	void PEFileHeader::Load(HANDLE hProcess,
 	                        DWORD64 baseOfImage,
 	                        IPEFileHeaderHandler& handler) const
 	{
-		auto dosHeader = Tools::ReadStructInProcessMemory<IMAGE_DOS_HEADER>(
-		    hProcess, baseOfImage);
+		auto dosHeader = ReadStructInProcessMemory<IMAGE_DOS_HEADER>(
+		    *processMemory_, hProcess, baseOfImage);
 		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE)
 			THROW("The image is not a valid DOS image.");
-		auto ntHeader32 = Tools::ReadStructInProcessMemory<IMAGE_NT_HEADERS32>(
-		    hProcess, baseOfImage + dosHeader->e_lfanew);
+		auto ntHeader32 = ReadStructInProcessMemory<IMAGE_NT_HEADERS32>(
+		    *processMemory_, hProcess, baseOfImage + dosHeader->e_lfanew);
 		auto machine = ntHeader32->FileHeader.Machine;
 
 		if (machine == IMAGE_FILE_MACHINE_I386)
@@ -39,7 +51,7 @@ namespace Tools
 		else if (machine == IMAGE_FILE_MACHINE_AMD64)
 		{
 			auto ntHeader64 = ReadStructInProcessMemory<IMAGE_NT_HEADERS64>(
-			    hProcess, baseOfImage + dosHeader->e_lfanew);
+			    *processMemory_, hProcess, baseOfImage + dosHeader->e_lfanew);
 			handler.OnNtHeader64(hProcess, baseOfImage, *ntHeader64);
 		}
 		else
@@ -19,9 +19,12 @@
 #include "ToolsExport.hpp"
 
 #include <Windows.h>
+#include <memory>
 
 namespace Tools
 {
+	class IProcessMemory;
+
 	class IPEFileHeaderHandler
 	{
 	  public:
@@ -37,7 +40,13 @@ namespace Tools
 	class TOOLS_DLL PEFileHeader
 	{
 	  public:
+		PEFileHeader();
+		explicit PEFileHeader(std::shared_ptr<IProcessMemory>);
+
 		void
 		Load(HANDLE hProcess, DWORD64 baseOfImage, IPEFileHeaderHandler&) const;
+
+	  private:
+		const std::shared_ptr<IProcessMemory> processMemory_;
 	};
 }
\ No newline at end of file
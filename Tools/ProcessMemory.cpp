@@ -46,7 +46,7 @@ namespace Tools
 		{
 			if (!::ReadProcessMemory(
 			        hProcess,
-			        reinterpret_cast<void*>(address),
+			        reinterpret_cast<void*>(address + totalBytesRead),
 			        &reinterpret_cast<char*>(buffer)[totalBytesRead],
 			        size - totalBytesRead,
 			        &bytesRead))
@@ -72,8 +72,9 @@ namespace Tools
 		while (totalWritten < size)
 		{
 			auto startBuffer = static_cast<char*>(buffer) + totalWritten;
+			auto startAddress = static_cast<char*>(address) + totalWritten;
 			if (!::WriteProcessMemory(hProcess,
-			                          address,
+			                          startAddress,
 			                          startBuffer,
 			                          size - totalWritten,
 			                          &written))
@@ -83,10 +84,31 @@ namespace Tools
 
 			if (written == 0)
 				THROW("Cannot write process memory");
-
-			if (!FlushInstructionCache(hProcess, startBuffer, written))
-				THROW("Cannot flush memory:");
 			totalWritten += written;
 		}
+
+		if (!FlushInstructionCache(hProcess, address, size))
+			THROW("Cannot flush memory:");
+	}
+
+	//-------------------------------------------------------------------------
+	void ProcessMemory::Read(HANDLE hProcess,
+	                         DWORD64 address,
+	                         void* buffer,
+	                         size_t size)
+	{
+		ReadProcessMemory(hProcess, address, buffer, size);
+	}
+
+	//-------------------------------------------------------------------------
+	void ProcessMemory::Write(HANDLE hProcess,
+	                          DWORD64 address,
+	                          const void* buffer,
+	                          size_t size)
+	{
+		WriteProcessMemory(hProcess,
+		                   reinterpret_cast<void*>(address),
+		                   const_cast<void*>(buffer),
+		                   size);
 	}
 }
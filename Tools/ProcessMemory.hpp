@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "ToolsExport.hpp"
+#include "IProcessMemory.hpp"
 
 namespace Tools
 {
@@ -47,4 +48,30 @@ namespace Tools
 
 		return data;
 	}
+
+	//-------------------------------------------------------------------------
+	template <typename T>
+	std::unique_ptr<T> ReadStructInProcessMemory(IProcessMemory& processMemory,
+	                                             HANDLE hProcess,
+	                                             DWORD64 address)
+	{
+		auto data = std::make_unique<T>();
+		processMemory.Read(hProcess, address, data.get(), sizeof(T));
+
+		return data;
+	}
+
+	// IProcessMemory of the processes of this machine.
+	class TOOLS_DLL ProcessMemory : public IProcessMemory
+	{
+	  public:
+		void Read(HANDLE hProcess,
+		          DWORD64 address,
+		          void* buffer,
+		          size_t size) override;
+		void Write(HANDLE hProcess,
+		           DWORD64 address,
+		           const void* buffer,
+		           size_t size) override;
+	};
 }
\ No newline at end of file
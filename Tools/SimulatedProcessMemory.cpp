@@ -0,0 +1,181 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+#include "SimulatedProcessMemory.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ToolsException.hpp"
+
+namespace Tools
+{
+	//-------------------------------------------------------------------------
+	void SimulatedProcessMemory::Allocate(HANDLE hProcess,
+	                                      DWORD64 address,
+	                                      size_t size,
+	                                      unsigned char value)
+	{
+		auto& pages = addressSpaces_[hProcess];
+		auto firstPage = address / PageSize;
+		auto endPage = (address + size + PageSize - 1) / PageSize;
+
+		for (auto page = firstPage; page < endPage; ++page)
+		{
+			auto& bytes = pages[page].bytes_;
+			if (bytes.empty())
+				bytes.assign(PageSize, value);
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	template <typename T_Function>
+	void SimulatedProcessMemory::ForEachPage(HANDLE hProcess,
+	                                         DWORD64 address,
+	                                         size_t size,
+	                                         T_Function function)
+	{
+		auto addressSpaceIt = addressSpaces_.find(hProcess);
+		if (addressSpaceIt == addressSpaces_.end())
+			THROW("Invalid process handle.");
+		auto& pages = addressSpaceIt->second;
+
+		// Check all the pages first: a failed access has no effect.
+		for (auto page = address / PageSize; page * PageSize < address + size;
+		     ++page)
+		{
+			if (pages.count(page) == 0)
+				THROW(L"Cannot access memory at " << address);
+		}
+
+		for (size_t offset = 0; offset < size;)
+		{
+			auto current = address + offset;
+			auto& page = pages.at(current / PageSize);
+			auto offsetInPage = static_cast<size_t>(current % PageSize);
+			auto chunkSize = std::min<size_t>(size - offset,
+			                                  PageSize - offsetInPage);
+
+			function(page, offsetInPage, offset, chunkSize);
+			offset += chunkSize;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	void SimulatedProcessMemory::Read(HANDLE hProcess,
+	                                  DWORD64 address,
+	                                  void* buffer,
+	                                  size_t size)
+	{
+		++statistics_.readCount_;
+		ForEachPage(hProcess,
+		            address,
+		            size,
+		            [&](Page& page,
+		                size_t offsetInPage,
+		                size_t offset,
+		                size_t chunkSize) {
+			            std::memcpy(static_cast<char*>(buffer) + offset,
+			                        &page.bytes_[offsetInPage],
+			                        chunkSize);
+		            });
+		statistics_.readByteCount_ += size;
+	}
+
+	//-------------------------------------------------------------------------
+	void SimulatedProcessMemory::Write(HANDLE hProcess,
+	                                   DWORD64 address,
+	                                   const void* buffer,
+	                                   size_t size)
+	{
+		++statistics_.writeCount_;
+		ForEachPage(hProcess,
+		            address,
+		            size,
+		            [&](Page& page,
+		                size_t offsetInPage,
+		                size_t offset,
+		                size_t chunkSize) {
+			            std::memcpy(&page.bytes_[offsetInPage],
+			                        static_cast<const char*>(buffer) + offset,
+			                        chunkSize);
+			            if (!page.isWritten_)
+			            {
+				            page.isWritten_ = true;
+				            ++statistics_.writtenPageCount_;
+			            }
+		            });
+		statistics_.writtenByteCount_ += size;
+	}
+
+	//-------------------------------------------------------------------------
+	void SimulatedProcessMemory::Allocate(HANDLE hProcess,
+	                                      DWORD64 address,
+	                                      const void* buffer,
+	                                      size_t size)
+	{
+		Allocate(hProcess, address, size, 0);
+		ForEachPage(hProcess,
+		            address,
+		            size,
+		            [&](Page& page,
+		                size_t offsetInPage,
+		                size_t offset,
+		                size_t chunkSize) {
+			            std::memcpy(&page.bytes_[offsetInPage],
+			                        static_cast<const char*>(buffer) + offset,
+			                        chunkSize);
+		            });
+	}
+
+	//-------------------------------------------------------------------------
+	void SimulatedProcessMemory::Free(HANDLE hProcess,
+	                                  DWORD64 address,
+	                                  size_t size)
+	{
+		auto addressSpaceIt = addressSpaces_.find(hProcess);
+		if (addressSpaceIt == addressSpaces_.end())
+			return;
+
+		auto& pages = addressSpaceIt->second;
+		auto firstPage = address / PageSize;
+		auto endPage = (address + size + PageSize - 1) / PageSize;
+		for (auto page = firstPage; page < endPage; ++page)
+			pages.erase(page);
+		if (pages.empty())
+			addressSpaces_.erase(addressSpaceIt);
+	}
+
+	//-------------------------------------------------------------------------
+	const SimulatedProcessMemory::Statistics&
+	SimulatedProcessMemory::GetStatistics() const
+	{
+		return statistics_;
+	}
+
+	//-------------------------------------------------------------------------
+	void SimulatedProcessMemory::ResetStatistics()
+	{
+		statistics_ = {};
+		for (auto& addressSpace : addressSpaces_)
+		{
+			for (auto& pair : addressSpace.second)
+				pair.second.isWritten_ = false;
+		}
+	}
+}
@@ -0,0 +1,98 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "IProcessMemory.hpp"
+
+namespace Tools
+{
+	// In-memory address spaces with page granularity. Only the allocated
+	// pages can be accessed. Each call is counted so the cost of an
+	// algorithm in system calls can be measured without a process.
+	class TOOLS_DLL SimulatedProcessMemory : public IProcessMemory
+	{
+	  public:
+		static const DWORD64 PageSize = 4096;
+
+		struct Statistics
+		{
+			size_t readCount_ = 0;
+			size_t writeCount_ = 0;
+			uint64_t readByteCount_ = 0;
+			uint64_t writtenByteCount_ = 0;
+			// Pages written at least once: copy on write pages of a module.
+			size_t writtenPageCount_ = 0;
+		};
+
+		SimulatedProcessMemory() = default;
+
+		SimulatedProcessMemory(const SimulatedProcessMemory&) = delete;
+		SimulatedProcessMemory&
+		operator=(const SimulatedProcessMemory&) = delete;
+
+		// Allocate the pages containing [address, address + size) filled
+		// with value. Pages already allocated are not modified.
+		void Allocate(HANDLE hProcess,
+		              DWORD64 address,
+		              size_t size,
+		              unsigned char value);
+
+		// Same as Allocate but the pages are filled with buffer. The copy is
+		// not counted as a write.
+		void Allocate(HANDLE hProcess,
+		              DWORD64 address,
+		              const void* buffer,
+		              size_t size);
+
+		// Free the pages containing [address, address + size).
+		void Free(HANDLE hProcess, DWORD64 address, size_t size);
+
+		void Read(HANDLE hProcess,
+		          DWORD64 address,
+		          void* buffer,
+		          size_t size) override;
+		void Write(HANDLE hProcess,
+		           DWORD64 address,
+		           const void* buffer,
+		           size_t size) override;
+
+		const Statistics& GetStatistics() const;
+		void ResetStatistics();
+
+	  private:
+		struct Page
+		{
+			std::vector<unsigned char> bytes_;
+			bool isWritten_ = false;
+		};
+
+		template <typename T_Function>
+		void ForEachPage(HANDLE hProcess,
+		                 DWORD64 address,
+		                 size_t size,
+		                 T_Function);
+
+		std::unordered_map<HANDLE, std::unordered_map<DWORD64, Page>>
+		    addressSpaces_;
+		Statistics statistics_;
+	};
+}
@@ -0,0 +1,72 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stdafx.h"
+#include "Tools/MappedFileView.hpp"
+#include "Tools/ToolsException.hpp"
+#include <fstream>
+
+#include "TestHelper/TemporaryPath.hpp"
+
+namespace ToolsTests
+{
+	namespace
+	{
+		//---------------------------------------------------------------------
+		void WriteFile(const std::filesystem::path& path, const std::string& content)
+		{
+			std::ofstream ofs(path, std::ios::binary);
+			ofs.write(content.c_str(), content.size());
+		}
+	}
+
+	//---------------------------------------------------------------------
+	TEST(MappedFileViewTest, Content)
+	{
+		TestHelper::TemporaryPath path;
+		WriteFile(path, std::string("abc\0def", 7));
+
+		Tools::MappedFileView file{ path };
+		ASSERT_EQ(std::string("abc\0def", 7), std::string(file.GetData(), file.GetSize()));
+	}
+
+	//---------------------------------------------------------------------
+	TEST(MappedFileViewTest, NonAsciiPath)
+	{
+		TestHelper::TemporaryPath folder{ TestHelper::TemporaryPathOption::CreateAsFolder };
+		auto path = folder.GetPath() / L"\u00e9\u4e2d\u0416.bin";
+		WriteFile(path, "content");
+
+		Tools::MappedFileView file{ path };
+		ASSERT_EQ("content", std::string(file.GetData(), file.GetSize()));
+	}
+
+	//---------------------------------------------------------------------
+	TEST(MappedFileViewTest, EmptyFile)
+	{
+		TestHelper::TemporaryPath path{ TestHelper::TemporaryPathOption::CreateAsFile };
+		Tools::MappedFileView file{ path };
+
+		ASSERT_EQ(nullptr, file.GetData());
+		ASSERT_EQ(0, file.GetSize());
+	}
+
+	//---------------------------------------------------------------------
+	TEST(MappedFileViewTest, MissingFile)
+	{
+		ASSERT_THROW(Tools::MappedFileView{ "MissingFile" }, Tools::ToolsException);
+	}
+}
@@ -0,0 +1,169 @@
+// OpenCppCoverage is an open source code coverage for C++.
+// Copyright (C) 2014 OpenCppCoverage
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Tools/SimulatedProcessMemory.hpp"
+#include "Tools/ToolsException.hpp"
+
+namespace ToolsTests
+{
+	namespace
+	{
+		const auto hProcess = reinterpret_cast<HANDLE>(42);
+		const DWORD64 PageSize = Tools::SimulatedProcessMemory::PageSize;
+	}
+
+	//---------------------------------------------------------------------
+	TEST(SimulatedProcessMemoryTest, ReadWriteAcrossPages)
+	{
+		Tools::SimulatedProcessMemory processMemory;
+		processMemory.Allocate(hProcess, PageSize, 2 * PageSize, 0x90);
+
+		std::vector<unsigned char> buffer(PageSize + 2);
+		processMemory.Read(hProcess, PageSize, buffer.data(), buffer.size());
+		ASSERT_EQ(std::vector<unsigned char>(buffer.size(), 0x90), buffer);
+
+		const unsigned char values[] = {1, 2, 3, 4};
+		processMemory.Write(
+		    hProcess, 2 * PageSize - 2, values, sizeof(values));
+		unsigned char readValues[sizeof(values)] = {};
+		processMemory.Read(
+		    hProcess, 2 * PageSize - 2, readValues, sizeof(readValues));
+		ASSERT_TRUE(std::equal(
+		    std::begin(values), std::end(values), std::begin(readValues)));
+	}
+
+	//---------------------------------------------------------------------
+	TEST(SimulatedProcessMemoryTest, UnallocatedMemory)
+	{
+		Tools::SimulatedProcessMemory processMemory;
+		unsigned char value = 0;
+
+		ASSERT_THROW(processMemory.Read(hProcess, 0, &value, 1),
+		             Tools::ToolsException);
+		processMemory.Allocate(hProcess, 0, PageSize, 0);
+		ASSERT_THROW(processMemory.Read(hProcess, PageSize, &value, 1),
+		             Tools::ToolsException);
+
+		// A failed write spanning two pages does not modify the first one.
+		unsigned char values[] = {1, 2};
+		ASSERT_THROW(
+		    processMemory.Write(hProcess, PageSize - 1, values, sizeof(values)),
+		    Tools::ToolsException);
+		processMemory.Read(hProcess, PageSize - 1, &value, 1);
+		ASSERT_EQ(0, value);
+
+		auto otherProcess = reinterpret_cast<HANDLE>(43);
+		ASSERT_THROW(processMemory.Read(otherProcess, 0, &value, 1),
+		             Tools::ToolsException);
+	}
+
+	//---------------------------------------------------------------------
+	TEST(SimulatedProcessMemoryTest, AllocateBufferAndFree)
+	{
+		Tools::SimulatedProcessMemory processMemory;
+		const unsigned char values[] = {1, 2, 3, 4};
+
+		processMemory.Allocate(hProcess, PageSize - 2, values, sizeof(values));
+		unsigned char readValues[sizeof(values)] = {};
+		processMemory.Read(
+		    hProcess, PageSize - 2, readValues, sizeof(readValues));
+		ASSERT_TRUE(std::equal(
+		    std::begin(values), std::end(values), std::begin(readValues)));
+		ASSERT_EQ(0, processMemory.GetStatistics().writeCount_);
+
+		processMemory.Free(hProcess, PageSize, 1);
+		ASSERT_THROW(processMemory.Read(hProcess, PageSize, readValues, 1),
+		             Tools::ToolsException);
+		processMemory.Read(hProcess, 0, readValues, 1);
+		ASSERT_EQ(0, readValues[0]);
+	}
+
+	//---------------------------------------------------------------------
+	TEST(SimulatedProcessMemoryTest, Statistics)
+	{
+		Tools::SimulatedProcessMemory processMemory;
+		processMemory.Allocate(hProcess, 0, 4 * PageSize, 0);
+
+		std::vector<unsigned char> buffer(PageSize + 1);
+		processMemory.Read(hProcess, 0, buffer.data(), buffer.size());
+		processMemory.Write(hProcess, PageSize - 1, buffer.data(), 2);
+		processMemory.Write(hProcess, PageSize, buffer.data(), 1);
+
+		const auto& statistics = processMemory.GetStatistics();
+		ASSERT_EQ(1, statistics.readCount_);
+		ASSERT_EQ(2, statistics.writeCount_);
+		ASSERT_EQ(PageSize + 1, statistics.readByteCount_);
+		ASSERT_EQ(3, statistics.writtenByteCount_);
+		ASSERT_EQ(2, statistics.writtenPageCount_);
+
+		processMemory.ResetStatistics();
+		ASSERT_EQ(0, statistics.readCount_);
+		ASSERT_EQ(0, statistics.writtenPageCount_);
+		processMemory.Write(hProcess, PageSize, buffer.data(), 1);
+		ASSERT_EQ(1, statistics.writtenPageCount_);
+	}
+
+	//---------------------------------------------------------------------
+	TEST(SimulatedProcessMemoryTest, ReadSpans)
+	{
+		Tools::SimulatedProcessMemory processMemory;
+		processMemory.Allocate(hProcess, 0, 2 * PageSize, 0);
+		processMemory.Allocate(hProcess, 100 * PageSize, PageSize, 0);
+
+		std::vector<DWORD64> addresses{
+		    PageSize + 8, 16, 100 * PageSize, 2 * PageSize - 8, 16};
+		for (auto address : addresses)
+			processMemory.Write(hProcess, address, &address, sizeof(address));
+		processMemory.ResetStatistics();
+
+		std::vector<DWORD64> values(addresses.size());
+		std::vector<Tools::ProcessMemorySpan> spans;
+		for (size_t i = 0; i < addresses.size(); ++i)
+			spans.push_back({addresses[i], &values[i], sizeof(DWORD64)});
+		processMemory.ReadSpans(hProcess, spans);
+
+		ASSERT_EQ(addresses, values);
+		// The spans of the two first pages are read together.
+		ASSERT_EQ(2, processMemory.GetStatistics().readCount_);
+	}
+
+	//---------------------------------------------------------------------
+	TEST(SimulatedProcessMemoryTest, ReadSpansWithUnallocatedGap)
+	{
+		Tools::SimulatedProcessMemory processMemory;
+		processMemory.Allocate(hProcess, 0, PageSize, 1);
+		processMemory.Allocate(hProcess, 2 * PageSize, PageSize, 2);
+
+		unsigned char values[2] = {};
+		processMemory.ReadSpans(hProcess,
+		                        {{PageSize - 1, &values[0], 1},
+		                         {2 * PageSize, &values[1], 1}});
+		ASSERT_EQ(1, values[0]);
+		ASSERT_EQ(2, values[1]);
+		// The failed read of the whole region then one read per span.
+		ASSERT_EQ(3, processMemory.GetStatistics().readCount_);
+
+		ASSERT_THROW(
+		    processMemory.ReadSpans(hProcess, {{PageSize, &values[0], 1}}),
+		    Tools::ToolsException);
+	}
+}